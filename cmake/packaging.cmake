@@ -31,6 +31,9 @@ endif()
 if(DAXA_ENABLE_UTILS_MEM)
 # No package management work to do
 endif()
+if(DAXA_ENABLE_UTILS_PROFILER)
+# No package management work to do
+endif()
 if(DAXA_ENABLE_UTILS_PIPELINE_MANAGER_GLSLANG)
     file(APPEND ${CMAKE_BINARY_DIR}/config.cmake.in [=[
 find_package(glslang CONFIG REQUIRED)
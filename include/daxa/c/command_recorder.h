@@ -27,6 +27,26 @@ typedef struct
     daxa_SmallString name;
 } daxa_CommandRecorderInfo;
 
+// Counts over the lifetime of a recorder.
+// Binds are elided when the pipeline or the bindless descriptor set is already bound at the bind point.
+// Push constant uploads only contain the bytes changed since the last upload, pushes that change nothing are elided.
+// Barriers recorded with the pipeline barrier commands are batched and coalesced until the next non barrier command.
+// The barrier counts are the ones of the emitted vkCmdPipelineBarrier2 calls, after merging.
+typedef struct
+{
+    uint64_t pipeline_binds;
+    uint64_t elided_pipeline_binds;
+    uint64_t descriptor_set_binds;
+    uint64_t elided_descriptor_set_binds;
+    uint64_t push_constant_uploads;
+    uint64_t push_constant_bytes_uploaded;
+    uint64_t elided_push_constants;
+    uint64_t pipeline_barrier_batches;
+    uint64_t memory_barriers;
+    uint64_t buffer_barriers;
+    uint64_t image_barriers;
+} daxa_CommandRecorderStatistics;
+
 static daxa_CommandRecorderInfo const DAXA_DEFAULT_COMMAND_RECORDER_INFO = DAXA_ZERO_INIT;
 
 typedef struct
@@ -243,6 +263,23 @@ typedef struct
 
 static daxa_DispatchIndirectInfo const DAXA_DEFAULT_DISPATCH_INDIRECT_INFO = DAXA_ZERO_INIT;
 
+typedef struct
+{
+    daxa_BufferId indirect_buffer;
+    size_t offset;
+    uint32_t dispatch_count;
+    uint32_t stride;
+    daxa_Bool8 chained;
+} daxa_DispatchIndirectBatchInfo;
+
+static daxa_DispatchIndirectBatchInfo const DAXA_DEFAULT_DISPATCH_INDIRECT_BATCH_INFO = {
+    .indirect_buffer = DAXA_ZERO_INIT,
+    .offset = 0,
+    .dispatch_count = 0,
+    .stride = 12,
+    .chained = 0,
+};
+
 typedef struct
 {
     daxa_BufferId indirect_buffer;
@@ -373,6 +410,62 @@ typedef struct
     uint32_t count;
 } daxa_ResetTimestampsInfo;
 
+typedef struct
+{
+    daxa_QueryPool * query_pool;
+    uint32_t query_index;
+    // Occlusion queries count exact samples instead of only reporting non zero, requires DAXA_IMPLICIT_FEATURE_FLAG_PRECISE_OCCLUSION_QUERY.
+    daxa_Bool8 precise;
+} daxa_BeginQueryInfo;
+
+typedef struct
+{
+    daxa_QueryPool * query_pool;
+    uint32_t query_index;
+} daxa_EndQueryInfo;
+
+typedef struct
+{
+    daxa_QueryPool * query_pool;
+    uint32_t start_index;
+    uint32_t count;
+} daxa_ResetQueriesInfo;
+
+typedef struct
+{
+    daxa_QueryPool * query_pool;
+    uint32_t start_index;
+    uint32_t count;
+    daxa_BufferId dst_buffer;
+    size_t dst_offset;
+    // Waits on the gpu for the results to become available.
+    daxa_Bool8 wait;
+    // Appends the availability value to the values of each query.
+    daxa_Bool8 with_availability;
+} daxa_CopyQueryPoolResultsInfo;
+
+typedef struct
+{
+    daxa_QueryPool * query_pool;
+    uint32_t first_query;
+    daxa_BlasId const * blas;
+    size_t blas_count;
+} daxa_WriteBlasCompactedSizesInfo;
+
+typedef enum
+{
+    DAXA_ACCELERATION_STRUCTURE_COPY_MODE_CLONE = 0,
+    DAXA_ACCELERATION_STRUCTURE_COPY_MODE_COMPACT = 1,
+    DAXA_ACCELERATION_STRUCTURE_COPY_MODE_MAX_ENUM = 0x7fffffff,
+} daxa_AccelerationStructureCopyMode;
+
+typedef struct
+{
+    daxa_BlasId src_blas;
+    daxa_BlasId dst_blas;
+    daxa_AccelerationStructureCopyMode mode;
+} daxa_CopyBlasInfo;
+
 typedef struct
 {
     daxa_f32vec4 label_color;
@@ -439,14 +532,21 @@ daxa_cmd_clear_image(daxa_CommandRecorder cmd_enc, daxa_ImageClearInfo const * i
 
 /// @brief  Successive pipeline barrier calls are combined.
 ///         As soon as a non-pipeline barrier command is recorded, the currently recorded barriers are flushed with a vkCmdPipelineBarrier2 call.
+///         All memory barriers of a batch are merged into one. Image transitions between the same layouts on adjacent subresources are merged as well.
 /// @param info parameters.
 DAXA_EXPORT void
 daxa_cmd_pipeline_barrier(daxa_CommandRecorder cmd_enc, daxa_MemoryBarrierInfo const * info);
 /// @brief  Successive pipeline barrier calls are combined.
 ///         As soon as a non-pipeline barrier command is recorded, the currently recorded barriers are flushed with a vkCmdPipelineBarrier2 call.
+///         All memory barriers of a batch are merged into one. Image transitions between the same layouts on adjacent subresources are merged as well.
 /// @param info parameters.
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_cmd_pipeline_barrier_image_transition(daxa_CommandRecorder cmd_enc, daxa_ImageMemoryBarrierInfo const * info);
+/// @brief  Synchronizes a range of a buffer, optionally transferring it between queue families.
+///         Batched together with the other pipeline barriers. Barriers on touching ranges of the same buffer are merged.
+/// @param info parameters.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_pipeline_buffer_barrier(daxa_CommandRecorder cmd_enc, daxa_BufferMemoryBarrierInfo const * info);
 DAXA_EXPORT void
 daxa_cmd_signal_event(daxa_CommandRecorder cmd_enc, daxa_EventSignalInfo const * info);
 DAXA_EXPORT void
@@ -469,6 +569,11 @@ DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_cmd_dispatch(daxa_CommandRecorder cmd_enc, daxa_DispatchInfo const * info);
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_cmd_dispatch_indirect(daxa_CommandRecorder cmd_enc, daxa_DispatchIndirectInfo const * info);
+/// @brief  Records dispatch_count indirect dispatches of the current compute pipeline in one call.
+///         Pending barriers and push constants are flushed once for the whole batch.
+///         The stride must be at least 12 and, like the offset, a multiple of 4, all commands must lie within the indirect buffer.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_dispatch_indirect_batch(daxa_CommandRecorder cmd_enc, daxa_DispatchIndirectBatchInfo const * info);
 
 /// @brief  Destroys the buffer AFTER the gpu is finished executing the command list.
 ///         Useful for large uploads exceeding staging memory pools.
@@ -490,6 +595,15 @@ daxa_cmd_destroy_image_view_deferred(daxa_CommandRecorder cmd_enc, daxa_ImageVie
 /// @param id image sampler be destroyed after command list finishes.
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_cmd_destroy_sampler_deferred(daxa_CommandRecorder cmd_enc, daxa_SamplerId id);
+/// @brief  Destroys the tlas AFTER the gpu is finished executing the command list.
+/// @param id tlas to be destroyed after command list finishes.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_destroy_tlas_deferred(daxa_CommandRecorder cmd_enc, daxa_TlasId id);
+/// @brief  Destroys the blas AFTER the gpu is finished executing the command list.
+///         Useful to replace a blas with its compacted copy.
+/// @param id blas to be destroyed after command list finishes.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_destroy_blas_deferred(daxa_CommandRecorder cmd_enc, daxa_BlasId id);
 
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_cmd_trace_rays(daxa_CommandRecorder cmd_enc, daxa_TraceRaysInfo const * info);
@@ -534,6 +648,27 @@ DAXA_EXPORT void
 daxa_cmd_write_timestamp(daxa_CommandRecorder cmd_enc, daxa_WriteTimestampInfo const * info);
 DAXA_EXPORT void
 daxa_cmd_reset_timestamps(daxa_CommandRecorder cmd_enc, daxa_ResetTimestampsInfo const * info);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_begin_query(daxa_CommandRecorder cmd_enc, daxa_BeginQueryInfo const * info);
+DAXA_EXPORT void
+daxa_cmd_end_query(daxa_CommandRecorder cmd_enc, daxa_EndQueryInfo const * info);
+DAXA_EXPORT void
+daxa_cmd_reset_queries(daxa_CommandRecorder cmd_enc, daxa_ResetQueriesInfo const * info);
+/// @brief  Copies 64 bit query results into a buffer, tightly packed per query.
+///         The dst_offset must be a multiple of 8.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_copy_query_pool_results(daxa_CommandRecorder cmd_enc, daxa_CopyQueryPoolResultsInfo const * info);
+/// @brief  Writes the compacted size of each blas into consecutive queries of a DAXA_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE pool.
+///         The blas must be built with DAXA_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_COMPACTION and their builds must be visible to acceleration structure build reads.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_write_blas_compacted_sizes(daxa_CommandRecorder cmd_enc, daxa_WriteBlasCompactedSizesInfo const * info);
+/// @brief  Copies a blas into another, compacting copies require the dst blas to be at least the compacted size large.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_copy_blas(daxa_CommandRecorder cmd_enc, daxa_CopyBlasInfo const * info);
+/// @brief  Begins the next pass of the devices defragmentation and records its copies.
+///         Writes 0 moves when no defragmentation is active or the previous pass is still in flight.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_cmd_record_defragmentation_pass(daxa_CommandRecorder cmd_enc, uint32_t * out_move_count);
 
 DAXA_EXPORT void
 daxa_cmd_begin_label(daxa_CommandRecorder cmd_enc, daxa_CommandLabelInfo const * info);
@@ -547,6 +682,9 @@ DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_cmd_complete_current_commands(daxa_CommandRecorder cmd_enc, daxa_ExecutableCommandList * out_executable_cmds);
 DAXA_EXPORT daxa_CommandRecorderInfo const *
 daxa_cmd_info(daxa_CommandRecorder cmd_enc);
+DAXA_EXPORT daxa_CommandRecorderStatistics const *
+daxa_cmd_statistics(daxa_CommandRecorder cmd_enc);
+// Forgets all tracked binds, as the caller may record its own binds into the returned command buffer.
 DAXA_EXPORT VkCommandBuffer
 daxa_cmd_get_vk_command_buffer(daxa_CommandRecorder cmd_enc);
 DAXA_EXPORT VkCommandPool
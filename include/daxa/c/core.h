@@ -46,7 +46,9 @@ typedef struct daxa_ImplBinarySemaphore * daxa_BinarySemaphore;
 typedef struct daxa_ImplTimelineSemaphore * daxa_TimelineSemaphore;
 typedef struct daxa_ImplEvent * daxa_Event;
 typedef struct daxa_ImplTimelineQueryPool * daxa_TimelineQueryPool;
+typedef struct daxa_ImplQueryPool * daxa_QueryPool;
 typedef struct daxa_ImplMemoryBlock * daxa_MemoryBlock;
+typedef struct daxa_ImplMemoryPool * daxa_MemoryPool;
 
 typedef uint64_t daxa_Flags;
 
@@ -11,6 +11,7 @@
 
 #define DAXA_MAX_COMPUTE_QUEUE_COUNT 8u
 #define DAXA_MAX_TRANSFER_QUEUE_COUNT 2u
+#define DAXA_MAX_MEMORY_HEAPS 16u
 
 typedef enum
 {
@@ -269,6 +270,10 @@ typedef enum
     DAXA_IMPLICIT_FEATURE_FLAG_DYNAMIC_STATE_3 =  0x1 << 10,
     DAXA_IMPLICIT_FEATURE_FLAG_SHADER_ATOMIC_FLOAT =  0x1 << 11,
     DAXA_IMPLICIT_FEATURE_FLAG_SWAPCHAIN =  0x1 << 12,
+    DAXA_IMPLICIT_FEATURE_FLAG_PIPELINE_STATISTICS_QUERY =  0x1 << 13,
+    DAXA_IMPLICIT_FEATURE_FLAG_PRECISE_OCCLUSION_QUERY =  0x1 << 14,
+    DAXA_IMPLICIT_FEATURE_FLAG_MEMORY_PRIORITY =  0x1 << 15,
+    DAXA_IMPLICIT_FEATURE_FLAG_PRESENT_WAIT =  0x1 << 16,
 } daxa_DeviceImplicitFeatureFlagBits;
 
 typedef daxa_DeviceImplicitFeatureFlagBits daxa_ImplicitFeatureFlags;
@@ -427,6 +432,22 @@ typedef struct
 
 static daxa_MemoryBlockImageInfo const DAXA_DEFAULT_MEMORY_BLOCK_IMAGE_INFO = DAXA_ZERO_INIT;
 
+typedef struct
+{
+    daxa_BufferInfo buffer_info;
+    daxa_MemoryPool * memory_pool;
+} daxa_MemoryPoolBufferInfo;
+
+static daxa_MemoryPoolBufferInfo const DAXA_DEFAULT_MEMORY_POOL_BUFFER_INFO = DAXA_ZERO_INIT;
+
+typedef struct
+{
+    daxa_ImageInfo image_info;
+    daxa_MemoryPool * memory_pool;
+} daxa_MemoryPoolImageInfo;
+
+static daxa_MemoryPoolImageInfo const DAXA_DEFAULT_MEMORY_POOL_IMAGE_INFO = DAXA_ZERO_INIT;
+
 typedef struct
 {
     daxa_TlasInfo tlas_info;
@@ -452,12 +473,91 @@ typedef struct
     uint64_t build_scratch_size;
 } daxa_AccelerationStructureBuildSizesInfo;
 
+typedef struct
+{
+    uint64_t budget;
+    uint64_t usage;
+    uint64_t block_bytes;
+    uint64_t allocation_bytes;
+    uint32_t block_count;
+    uint32_t allocation_count;
+    daxa_Bool8 device_local;
+} daxa_MemoryHeapReport;
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t bytes;
+} daxa_ResourceMemoryReport;
+
+typedef struct
+{
+    daxa_MemoryHeapReport heaps[DAXA_MAX_MEMORY_HEAPS];
+    uint32_t heap_count;
+    daxa_Bool8 budget_from_driver;
+    daxa_ResourceMemoryReport buffers;
+    daxa_ResourceMemoryReport images;
+    daxa_ResourceMemoryReport acceleration_structures;
+    daxa_ResourceMemoryReport memory_blocks;
+} daxa_MemoryReport;
+
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_memory_report(daxa_Device device, daxa_MemoryReport * out_report);
+
+typedef struct
+{
+    daxa_SmallString name;
+    uint64_t count;
+    uint64_t bytes;
+} daxa_NamedMemoryReport;
+
+/// @brief  Aggregates the memory of buffers, images and acceleration structures by name, sorted by size.
+///         When out_reports is null, the number of names is written to inout_report_count.
+///         Otherwise up to inout_report_count reports are written, DAXA_RESULT_INCOMPLETE is returned when there are more.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_memory_report_per_name(daxa_Device device, daxa_NamedMemoryReport * out_reports, uint32_t * inout_report_count);
+
+typedef struct
+{
+    uint64_t max_bytes_per_pass;
+    uint32_t max_moves_per_pass;
+    daxa_Bool8 move_buffers;
+    daxa_Bool8 move_images;
+    daxa_ImageLayout image_layout;
+} daxa_DefragmentationInfo;
+
+typedef struct
+{
+    uint64_t bytes_moved;
+    uint64_t bytes_freed;
+    uint32_t allocations_moved;
+    uint32_t device_memory_blocks_freed;
+    uint32_t passes;
+    daxa_Bool8 active;
+} daxa_DefragmentationStatistics;
+
+/// @brief  Starts an incremental defragmentation of the default memory pools.
+///         Passes are recorded with daxa_cmd_record_defragmentation_pass and finished by daxa_dvc_collect_garbage.
+///         A pass switches to the moved resources once its copies executed and all completed command lists were submitted.
+///         The old resources are freed once all submits from before the switch finished.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_begin_defragmentation(daxa_Device device, daxa_DefragmentationInfo const * info);
+/// @brief  Stops the defragmentation once the pass in flight finished.
+DAXA_EXPORT void
+daxa_dvc_end_defragmentation(daxa_Device device);
+DAXA_EXPORT void
+daxa_dvc_defragmentation_statistics(daxa_Device device, daxa_DefragmentationStatistics * out_statistics);
+
 DAXA_EXPORT VkMemoryRequirements
 daxa_dvc_buffer_memory_requirements(daxa_Device device, daxa_BufferInfo const * info);
 DAXA_EXPORT VkMemoryRequirements
 daxa_dvc_image_memory_requirements(daxa_Device device, daxa_ImageInfo const * info);
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_create_memory(daxa_Device device, daxa_MemoryBlockInfo const * info, daxa_MemoryBlock * out_memory_block);
+/// @brief  Creates a custom memory pool. Resources created from it are placed in its blocks instead of the default pools.
+///         The pool is destroyed once all references and all resources created from it are destroyed.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_create_memory_pool(daxa_Device device, daxa_MemoryPoolInfo const * info, daxa_MemoryPool * out_memory_pool);
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_get_tlas_build_sizes(daxa_Device device, daxa_TlasBuildInfo const * build_info, daxa_AccelerationStructureBuildSizesInfo * out);
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
@@ -472,6 +572,10 @@ daxa_dvc_create_buffer_from_memory_block(daxa_Device device, daxa_MemoryBlockBuf
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_create_image_from_block(daxa_Device device, daxa_MemoryBlockImageInfo const * info, daxa_ImageId * out_id);
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_create_buffer_from_memory_pool(daxa_Device device, daxa_MemoryPoolBufferInfo const * info, daxa_BufferId * out_id);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_create_image_from_memory_pool(daxa_Device device, daxa_MemoryPoolImageInfo const * info, daxa_ImageId * out_id);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_create_image_view(daxa_Device device, daxa_ImageViewInfo const * info, daxa_ImageViewId * out_id);
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_create_sampler(daxa_Device device, daxa_SamplerInfo const * info, daxa_SamplerId * out_id);
@@ -563,6 +667,8 @@ DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_create_event(daxa_Device device, daxa_EventInfo const * info, daxa_Event * out_event);
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_create_timeline_query_pool(daxa_Device device, daxa_TimelineQueryPoolInfo const * info, daxa_TimelineQueryPool * out_timeline_query_pool);
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_create_query_pool(daxa_Device device, daxa_QueryPoolInfo const * info, daxa_QueryPool * out_query_pool);
 
 DAXA_EXPORT VkDevice
 daxa_dvc_get_vk_device(daxa_Device device);
@@ -582,12 +688,33 @@ DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_present(daxa_Device device, daxa_PresentInfo const * info);
 DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
 daxa_dvc_collect_garbage(daxa_Device device);
+/// @brief  Index of the latest submit on any queue, each submit increments it by one.
+DAXA_EXPORT uint64_t
+daxa_dvc_latest_submit_index(daxa_Device device);
+/// @brief  Index of the oldest submit still pending on any queue, UINT64_MAX when all queues are idle.
+///         Work tagged with daxa_dvc_latest_submit_index after it was submitted is finished once the tag is below this.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_dvc_oldest_pending_submit_index(daxa_Device device, uint64_t * out_submit_index);
 
 DAXA_EXPORT daxa_DeviceInfo2 const *
 daxa_dvc_info(daxa_Device device);
 DAXA_EXPORT daxa_DeviceProperties const *
 daxa_dvc_properties(daxa_Device device);
 
+typedef struct
+{
+    uint64_t physical_device_query_ns;
+    uint64_t vk_device_creation_ns;
+    uint64_t allocator_creation_ns;
+    uint64_t null_resource_creation_ns;
+    uint64_t resource_table_creation_ns;
+    uint64_t init_submit_ns;
+    uint64_t total_ns;
+} daxa_DeviceCreationTimings;
+
+DAXA_EXPORT void
+daxa_dvc_creation_timings(daxa_Device device, daxa_DeviceCreationTimings * out_timings);
+
 // Returns previous ref count.
 DAXA_EXPORT uint64_t
 daxa_dvc_inc_refcnt(daxa_Device device);
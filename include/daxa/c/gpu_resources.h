@@ -31,12 +31,21 @@ typedef struct
     uint64_t address;
 } daxa_DeviceAddress;
 
+typedef enum
+{
+    DAXA_SHARING_MODE_EXCLUSIVE,
+    DAXA_SHARING_MODE_CONCURRENT,
+} daxa_SharingMode;
+
 typedef struct
 {
     size_t size;
     // Ignored when allocating with a memory block.
     daxa_MemoryFlags allocate_info;
     daxa_SmallString name;
+    // Exclusive buffers must be transferred between queue families with buffer memory barriers.
+    // DAXA_DEFAULT_BUFFER_INFO is concurrent, buffers stay shared across all queues unless requested otherwise.
+    daxa_SharingMode sharing_mode;
 } daxa_BufferInfo;
 
 typedef uint32_t daxa_ImageFlags;
@@ -58,12 +67,6 @@ static daxa_ImageUsageFlags const DAXA_IMAGE_USE_FLAG_TRANSIENT_ATTACHMENT = 0x0
 static daxa_ImageUsageFlags const DAXA_IMAGE_USE_FLAG_FRAGMENT_DENSITY_MAP = 0x00000200;
 static daxa_ImageUsageFlags const DAXA_IMAGE_USE_FLAG_FRAGMENT_SHADING_RATE_ATTACHMENT = 0x00000100;
 
-typedef enum
-{
-    DAXA_SHARING_MODE_EXCLUSIVE,
-    DAXA_SHARING_MODE_CONCURRENT,
-} daxa_SharingMode;
-
 typedef struct
 {
     daxa_ImageFlags flags;
@@ -114,6 +117,7 @@ static daxa_BufferInfo const DAXA_DEFAULT_BUFFER_INFO = {
     .size = 0,
     .allocate_info = DAXA_MEMORY_FLAG_NONE,
     .name = {.data = DAXA_ZERO_INIT, .size = 0},
+    .sharing_mode = DAXA_SHARING_MODE_CONCURRENT,
 };
 static daxa_ImageInfo const DAXA_DEFAULT_IMAGE_INFO = {
     .flags = 0,
@@ -3,6 +3,15 @@
 
 #include <daxa/c/types.h>
 
+typedef struct
+{
+    uint32_t constant_id;
+    // Size in bytes of the constant's type. Booleans are 4 bytes.
+    uint32_t size;
+    // Raw bits of the constant, only the lowest size bytes are used.
+    uint64_t value;
+} daxa_SpecializationConstant;
+
 typedef struct
 {
     uint32_t const * byte_code;
@@ -10,6 +19,7 @@ typedef struct
     VkPipelineShaderStageCreateFlags create_flags;
     daxa_Optional(uint32_t) required_subgroup_size;
     daxa_SmallString entry_point;
+    daxa_SpanToConst(daxa_SpecializationConstant) specialization_constants;
 } daxa_ShaderInfo;
 
 // RAY TRACING PIPELINE
@@ -11,6 +11,7 @@ daxa_default_format_selector(VkFormat format);
 ///         On Windows, this is an `HWND`
 ///         On Linux X11, this is a `Window`
 ///         On Linux Wayland, this is a `wl_surface *`
+///         With the headless platform it is ignored
 typedef void * daxa_NativeWindowHandle;
 
 typedef enum
@@ -19,9 +20,18 @@ typedef enum
     DAXA_NATIVE_WINDOW_PLATFORM_WIN32_API,
     DAXA_NATIVE_WINDOW_PLATFORM_XLIB_API,
     DAXA_NATIVE_WINDOW_PLATFORM_WAYLAND_API,
+    DAXA_NATIVE_WINDOW_PLATFORM_HEADLESS,
     DAXA_NATIVE_WINDOW_PLATFORM_MAX_ENUM = 0x7fffffff,
 } daxa_NativeWindowPlatform;
 
+typedef enum
+{
+    DAXA_FRAME_PACING_MODE_DISABLED,
+    DAXA_FRAME_PACING_MODE_MEASURE,
+    DAXA_FRAME_PACING_MODE_LOW_LATENCY,
+    DAXA_FRAME_PACING_MODE_MAX_ENUM = 0x7fffffff,
+} daxa_FramePacingMode;
+
 typedef struct
 {
     daxa_NativeWindowHandle native_window;
@@ -33,8 +43,25 @@ typedef struct
     size_t max_allowed_frames_in_flight;
     daxa_QueueFamily queue_family;
     daxa_SmallString name;
+    VkExtent2D headless_extent;
+    daxa_FramePacingMode frame_pacing_mode;
 } daxa_SwapchainInfo;
 
+/// @brief  Timings of the most recent frame that has the respective value, all in nanoseconds.
+typedef struct
+{
+    uint64_t frame_count;
+    uint64_t acquire_wait_ns;
+    uint64_t pacing_wait_ns;
+    uint64_t pacing_sleep_ns;
+    uint64_t cpu_frame_ns;
+    uint64_t gpu_frame_ns;
+    // Stamped at the first present or pace_frame after the present completed, so quantized to those points.
+    uint64_t present_latency_ns;
+    daxa_Bool8 gpu_frame_time_supported;
+    daxa_Bool8 present_latency_supported;
+} daxa_FramePacingStatistics;
+
 DAXA_EXPORT VkExtent2D
 daxa_swp_get_surface_extent(daxa_Swapchain swapchain);
 DAXA_EXPORT VkFormat
@@ -54,6 +81,15 @@ DAXA_EXPORT uint64_t
 daxa_swp_current_cpu_timeline_value(daxa_Swapchain swapchain);
 DAXA_EXPORT daxa_TimelineSemaphore *
 daxa_swp_gpu_timeline_semaphore(daxa_Swapchain swapchain);
+/// @brief  Returns the image of the last present, an empty id before the first present.
+DAXA_EXPORT daxa_ImageId
+daxa_swp_presented_image(daxa_Swapchain swapchain);
+/// @brief  Marks the start of the next frame, call it right before sampling input.
+///         With DAXA_FRAME_PACING_MODE_LOW_LATENCY it sleeps and waits until the frame should be started.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_swp_pace_frame(daxa_Swapchain swapchain);
+DAXA_EXPORT void
+daxa_swp_frame_pacing_statistics(daxa_Swapchain swapchain, daxa_FramePacingStatistics * out_statistics);
 
 DAXA_EXPORT daxa_SwapchainInfo const *
 daxa_swp_info(daxa_Swapchain swapchain);
@@ -108,6 +108,21 @@ typedef struct
     daxa_ImageId image_id;
 } daxa_ImageMemoryBarrierInfo;
 
+typedef struct
+{
+    daxa_Access src_access;
+    daxa_Access dst_access;
+    daxa_BufferId buffer_id;
+    uint64_t offset;
+    // VK_WHOLE_SIZE covers the buffer from offset to its end.
+    uint64_t size;
+    // When both are set and differ, the barrier is a queue family ownership transfer.
+    // It must then be recorded as release on the src queue and again as acquire on the dst queue.
+    // Ignored for concurrent buffers, as they are owned by all queue families.
+    daxa_Optional(daxa_QueueFamily) src_queue_family;
+    daxa_Optional(daxa_QueueFamily) dst_queue_family;
+} daxa_BufferMemoryBarrierInfo;
+
 typedef struct
 {
     daxa_SmallString name;
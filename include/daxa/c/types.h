@@ -123,6 +123,13 @@ typedef enum
     DAXA_RESULT_ERROR_DEVICE_NOT_SUPPORTED = (1 << 30) + 69,
     DAXA_RESULT_DEVICE_DOES_NOT_SUPPORT_ACCELERATION_STRUCTURE_COUNT = (1 << 30) + 70,
     DAXA_RESULT_ERROR_NO_SUITABLE_DEVICE_FOUND = (1 << 30) + 71,
+    DAXA_RESULT_ERROR_ACCELERATION_STRUCTURE_UPDATE_WITHOUT_ALLOW_UPDATE = (1 << 30) + 72,
+    DAXA_RESULT_ERROR_DEFRAGMENTATION_ALREADY_ACTIVE = (1 << 30) + 73,
+    DAXA_RESULT_INVALID_DEFRAGMENTATION_INFO = (1 << 30) + 74,
+    DAXA_RESULT_INVALID_MEMORY_POOL_INFO = (1 << 30) + 75,
+    DAXA_RESULT_INVALID_HEADLESS_EXTENT = (1 << 30) + 76,
+    DAXA_RESULT_INVALID_QUERY_TYPE = (1 << 30) + 77,
+    DAXA_RESULT_PRECISE_OCCLUSION_QUERY_NOT_DEVICE_ENABLED = (1 << 30) + 78,
     DAXA_RESULT_MAX_ENUM = 0x7FFFFFFF,
 } daxa_Result;
 
@@ -223,6 +230,50 @@ daxa_memory_block_inc_refcnt(daxa_MemoryBlock memory_block);
 DAXA_EXPORT uint64_t
 daxa_memory_block_dec_refcnt(daxa_MemoryBlock memory_block);
 
+typedef enum
+{
+    // General purpose allocator, allocations may be freed in any order.
+    DAXA_MEMORY_POOL_ALGORITHM_TLSF,
+    // Allocations are placed one after another. Freeing in allocation order makes a pool with one block a ring buffer.
+    DAXA_MEMORY_POOL_ALGORITHM_LINEAR,
+    DAXA_MEMORY_POOL_ALGORITHM_MAX_ENUM = 0x7fffffff,
+} daxa_MemoryPoolAlgorithm;
+
+typedef struct
+{
+    daxa_MemoryPoolAlgorithm algorithm;
+    // Selects the memory type like the allocate_info of a buffer. Only host access flags are considered.
+    daxa_MemoryFlags memory_flags;
+    // Restricts the memory types the pool may use, zero allows all.
+    uint32_t memory_type_bits;
+    // Size of each device memory block, zero uses the allocators default.
+    uint64_t block_size;
+    uint32_t min_block_count;
+    // Zero means unlimited.
+    uint32_t max_block_count;
+    // Residency priority of the pools memory between 0 and 1, requires DAXA_IMPLICIT_FEATURE_FLAG_MEMORY_PRIORITY.
+    float priority;
+    daxa_SmallString name;
+} daxa_MemoryPoolInfo;
+
+typedef struct
+{
+    uint64_t block_bytes;
+    uint64_t allocation_bytes;
+    uint32_t block_count;
+    uint32_t allocation_count;
+} daxa_MemoryPoolStatistics;
+
+DAXA_EXPORT daxa_MemoryPoolInfo const *
+daxa_memory_pool_info(daxa_MemoryPool memory_pool);
+DAXA_EXPORT void
+daxa_memory_pool_statistics(daxa_MemoryPool memory_pool, daxa_MemoryPoolStatistics * out_statistics);
+
+DAXA_EXPORT uint64_t
+daxa_memory_pool_inc_refcnt(daxa_MemoryPool memory_pool);
+DAXA_EXPORT uint64_t
+daxa_memory_pool_dec_refcnt(daxa_MemoryPool memory_pool);
+
 typedef struct
 {
     uint32_t query_count;
@@ -240,6 +291,42 @@ daxa_timeline_query_pool_inc_refcnt(daxa_TimelineQueryPool timeline_query_pool);
 DAXA_EXPORT uint64_t
 daxa_timeline_query_pool_dec_refcnt(daxa_TimelineQueryPool timeline_query_pool);
 
+typedef enum
+{
+    DAXA_QUERY_TYPE_OCCLUSION = 0,
+    DAXA_QUERY_TYPE_PIPELINE_STATISTICS = 1,
+    DAXA_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE = 1000150000,
+    DAXA_QUERY_TYPE_MAX_ENUM = 0x7fffffff,
+} daxa_QueryType;
+
+typedef struct
+{
+    daxa_QueryType query_type;
+    // Only used for pipeline statistics queries, requires DAXA_IMPLICIT_FEATURE_FLAG_PIPELINE_STATISTICS_QUERY.
+    VkQueryPipelineStatisticFlags pipeline_statistics;
+    uint32_t query_count;
+    daxa_SmallString name;
+} daxa_QueryPoolInfo;
+
+DAXA_EXPORT daxa_QueryPoolInfo const *
+daxa_query_pool_info(daxa_QueryPool query_pool);
+
+// Returns the number of 64 bit values written per query, excluding the availability value.
+DAXA_EXPORT uint32_t
+daxa_query_pool_values_per_query(daxa_QueryPool query_pool);
+
+// Writes the values of each query followed by its availability.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_query_pool_query_results(daxa_QueryPool query_pool, uint32_t start, uint32_t count, uint64_t * out_results);
+// Resets queries from the host, the gpu must not use them anymore.
+DAXA_EXPORT DAXA_NO_DISCARD daxa_Result
+daxa_query_pool_reset(daxa_QueryPool query_pool, uint32_t start, uint32_t count);
+
+DAXA_EXPORT uint64_t
+daxa_query_pool_inc_refcnt(daxa_QueryPool query_pool);
+DAXA_EXPORT uint64_t
+daxa_query_pool_dec_refcnt(daxa_QueryPool query_pool);
+
 typedef enum
 {
     DAXA_QUEUE_FAMILY_MAIN,
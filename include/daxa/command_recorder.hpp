@@ -24,6 +24,21 @@ namespace daxa
         SmallString name = {};
     };
 
+    struct CommandRecorderStatistics
+    {
+        u64 pipeline_binds = {};
+        u64 elided_pipeline_binds = {};
+        u64 descriptor_set_binds = {};
+        u64 elided_descriptor_set_binds = {};
+        u64 push_constant_uploads = {};
+        u64 push_constant_bytes_uploaded = {};
+        u64 elided_push_constants = {};
+        u64 pipeline_barrier_batches = {};
+        u64 memory_barriers = {};
+        u64 buffer_barriers = {};
+        u64 image_barriers = {};
+    };
+
     struct ImageBlitInfo
     {
         ImageId src_image = {};
@@ -166,6 +181,18 @@ namespace daxa
         usize offset = {};
     };
 
+    struct DispatchIndirectBatchInfo
+    {
+        BufferId indirect_buffer = {};
+        usize offset = {};
+        u32 dispatch_count = {};
+        // Distance between the dispatch commands in bytes, defaults to tightly packed u32 x, y, z.
+        u32 stride = sizeof(u32) * 3;
+        // Each dispatch waits for the shader writes of the previous one, including writes to the indirect buffer.
+        // Allows gpu driven chains where a pass writes the dispatch of the next pass.
+        bool chained = {};
+    };
+
     struct DrawMeshTasksIndirectInfo
     {
         BufferId indirect_buffer = {};
@@ -246,6 +273,62 @@ namespace daxa
         u32 count = {};
     };
 
+    struct BeginQueryInfo
+    {
+        QueryPool & query_pool;
+        u32 query_index = {};
+        // Occlusion queries count exact samples instead of only reporting non zero, requires ImplicitFeatureFlagBits::PRECISE_OCCLUSION_QUERY.
+        // Only valid for occlusion queries.
+        bool precise = {};
+    };
+
+    struct EndQueryInfo
+    {
+        QueryPool & query_pool;
+        u32 query_index = {};
+    };
+
+    struct ResetQueriesInfo
+    {
+        QueryPool & query_pool;
+        u32 start_index = {};
+        u32 count = {};
+    };
+
+    struct CopyQueryPoolResultsInfo
+    {
+        QueryPool & query_pool;
+        u32 start_index = {};
+        u32 count = {};
+        BufferId dst_buffer = {};
+        usize dst_offset = {};
+        // Waits on the gpu for the results to become available.
+        bool wait = {};
+        // Appends the availability value to the values of each query.
+        bool with_availability = {};
+    };
+
+    struct WriteBlasCompactedSizesInfo
+    {
+        QueryPool & query_pool;
+        u32 first_query = {};
+        std::span<BlasId const> blas = {};
+    };
+
+    enum struct AccelerationStructureCopyMode
+    {
+        CLONE = 0,
+        COMPACT = 1,
+        MAX_ENUM = 0x7fffffff,
+    };
+
+    struct CopyBlasInfo
+    {
+        BlasId src_blas = {};
+        BlasId dst_blas = {};
+        AccelerationStructureCopyMode mode = AccelerationStructureCopyMode::COMPACT;
+    };
+
     struct CommandLabelInfo
     {
         std::array<f32, 4> label_color = {0.463f, 0.333f, 0.671f, 1.0f};
@@ -334,6 +417,10 @@ namespace daxa
         void draw_mesh_tasks(u32 x, u32 y, u32 z);
         void draw_mesh_tasks_indirect(DrawMeshTasksIndirectInfo const & info);
         void draw_mesh_tasks_indirect_count(DrawMeshTasksIndirectCountInfo const & info);
+
+        /// @brief  Queries may span draws within a renderpass, for example to test the visibility of a bounding volume.
+        void begin_query(BeginQueryInfo const & info);
+        void end_query(EndQueryInfo const & info);
     };
 
     /**
@@ -382,12 +469,18 @@ namespace daxa
 
         /// @brief  Successive pipeline barrier calls are combined.
         ///         As soon as a non-pipeline barrier command is recorded, the currently recorded barriers are flushed with a vkCmdPipelineBarrier2 call.
+        ///         All memory barriers of a batch are merged into one. Image transitions between the same layouts on adjacent subresources are merged as well.
         /// @param info parameters.
         void pipeline_barrier(MemoryBarrierInfo const & info);
         /// @brief  Successive pipeline barrier calls are combined.
         ///         As soon as a non-pipeline barrier command is recorded, the currently recorded barriers are flushed with a vkCmdPipelineBarrier2 call.
+        ///         All memory barriers of a batch are merged into one. Image transitions between the same layouts on adjacent subresources are merged as well.
         /// @param info parameters.
         void pipeline_barrier_image_transition(ImageMemoryBarrierInfo const & info);
+        /// @brief  Synchronizes a range of a buffer, optionally transferring it between queue families.
+        ///         Batched together with the other pipeline barriers. Barriers on touching ranges of the same buffer are merged.
+        /// @param info parameters.
+        void pipeline_buffer_barrier(BufferMemoryBarrierInfo const & info);
         void signal_event(EventSignalInfo const & info);
         void wait_events(std::span<EventWaitInfo const> const & infos);
         void wait_event(EventWaitInfo const & info);
@@ -413,6 +506,21 @@ namespace daxa
         ///         Useful for large uploads exceeding staging memory pools.
         /// @param id image sampler be destroyed after command list finishes.
         void destroy_sampler_deferred(SamplerId id);
+        /// @brief  Destroys the tlas AFTER the gpu is finished executing the command list.
+        ///         Zombifies object after submitting the commands.
+        /// @param id tlas to be destroyed after command list finishes.
+        void destroy_tlas_deferred(TlasId id);
+        /// @brief  Destroys the blas AFTER the gpu is finished executing the command list.
+        ///         Zombifies object after submitting the commands.
+        ///         Useful to replace a blas with its compacted copy.
+        /// @param id blas to be destroyed after command list finishes.
+        void destroy_blas_deferred(BlasId id);
+
+        /// @brief  Begins the next pass of the devices defragmentation and records the copies of the moved resources.
+        ///         The moved resources switch to their new memory in the first collect_garbage after the commands executed.
+        ///         Exclusive resources are only moved by recorders of the main queue family.
+        /// @return number of moved resources, 0 when no defragmentation is active or its previous pass is still in flight.
+        auto record_defragmentation_pass() -> u32;
 
         void write_timestamp(WriteTimestampInfo const & info);
         void reset_timestamps(ResetTimestampsInfo const & info);
@@ -426,6 +534,11 @@ namespace daxa
         /// * reference MUST NOT be read after the device is destroyed.
         /// @return reference to info of object.
         [[nodiscard]] auto info() const -> CommandRecorderInfo const &;
+
+        /// THREADSAFETY:
+        /// * reference MUST NOT be read after the device is destroyed.
+        /// @return reference to the bind, push constant and barrier counts, including the redundant binds and pushes that were skipped.
+        [[nodiscard]] auto statistics() const -> CommandRecorderStatistics const &;
     };
 
     /**
@@ -472,11 +585,28 @@ namespace daxa
 
         void dispatch_indirect(DispatchIndirectInfo const & info);
 
+        /// @brief  Records many indirect dispatches of the current pipeline with a single call.
+        void dispatch_indirect_batch(DispatchIndirectBatchInfo const & info);
+
         void set_pipeline(RayTracingPipeline const & pipeline);
 
         void trace_rays(TraceRaysInfo const & info);
 
         void trace_rays_indirect(TraceRaysIndirectInfo const & info);
+
+        /// @brief  Queries must be reset before they are begun, outside of a renderpass.
+        void reset_queries(ResetQueriesInfo const & info);
+        void begin_query(BeginQueryInfo const & info);
+        void end_query(EndQueryInfo const & info);
+        /// @brief  Copies 64 bit query results into a buffer for gpu driven consumption, tightly packed per query.
+        ///         Must be recorded outside of a renderpass, dst_offset must be a multiple of 8.
+        void copy_query_pool_results(CopyQueryPoolResultsInfo const & info);
+        /// @brief  Writes the compacted sizes of blas built with AccelerationStructureBuildFlagBits::ALLOW_COMPACTION into consecutive queries.
+        ///         The queries must be reset and the builds must be visible to ACCELERATION_STRUCTURE_BUILD_READ.
+        void write_blas_compacted_sizes(WriteBlasCompactedSizesInfo const & info);
+        /// @brief  Compacting copies need a dst blas of at least the queried compacted size.
+        ///         Instances of tlas need to be rebuilt with the device address of the dst blas.
+        void copy_blas(CopyBlasInfo const & info);
     };
 
     /**
@@ -63,6 +63,7 @@ namespace daxa
     ///         On Windows, this is an `HWND`
     ///         On Linux X11, this is a `Window`
     ///         On Linux Wayland, this is a `wl_surface *`
+    ///         With the headless platform it is ignored
     using NativeWindowHandle = void *;
 
     enum struct NativeWindowPlatform
@@ -71,6 +72,8 @@ namespace daxa
         WIN32_API,
         XLIB_API,
         WAYLAND_API,
+        // Presents into a ring of images owned by the swapchain, no window or surface needed.
+        HEADLESS,
         MAX_ENUM = 0x7fffffff,
     };
 } // namespace daxa
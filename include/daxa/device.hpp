@@ -13,6 +13,7 @@ namespace daxa
 {
     static constexpr inline u32 MAX_COMPUTE_QUEUE_COUNT = 8u;
     static constexpr inline u32 MAX_TRANSFER_QUEUE_COUNT = 2u;
+    static constexpr inline u32 MAX_MEMORY_HEAPS = 16u;
 
     enum struct DeviceType
     {
@@ -296,6 +297,10 @@ namespace daxa
         static inline constexpr ImplicitFeatureFlags DYNAMIC_STATE_3 = {0x1 << 10};
         static inline constexpr ImplicitFeatureFlags SHADER_ATOMIC_FLOAT = {0x1 << 11};
         static inline constexpr ImplicitFeatureFlags SWAPCHAIN = {0x1 << 12};
+        static inline constexpr ImplicitFeatureFlags PIPELINE_STATISTICS_QUERY = {0x1 << 13};
+        static inline constexpr ImplicitFeatureFlags PRECISE_OCCLUSION_QUERY = {0x1 << 14};
+        static inline constexpr ImplicitFeatureFlags MEMORY_PRIORITY = {0x1 << 15};
+        static inline constexpr ImplicitFeatureFlags PRESENT_WAIT = {0x1 << 16};
     };
 
     struct DeviceProperties
@@ -399,6 +404,99 @@ namespace daxa
         usize offset = {};
     };
 
+    struct MemoryPoolBufferInfo
+    {
+        // The allocate_info flags still apply, host access requires a host visible pool.
+        BufferInfo buffer_info = {};
+        MemoryPool & memory_pool;
+    };
+
+    struct MemoryPoolImageInfo
+    {
+        // The memory type of the pool must support the image.
+        ImageInfo image_info = {};
+        MemoryPool & memory_pool;
+    };
+
+    struct MemoryHeapReport
+    {
+        // Estimated memory the process can use from the heap, accurate when budget_from_driver.
+        u64 budget = {};
+        u64 usage = {};
+        // Memory allocated by daxa, blocks contain the allocations.
+        u64 block_bytes = {};
+        u64 allocation_bytes = {};
+        u32 block_count = {};
+        u32 allocation_count = {};
+        bool device_local = {};
+    };
+
+    struct ResourceMemoryReport
+    {
+        u64 count = {};
+        u64 bytes = {};
+    };
+
+    struct MemoryReport
+    {
+        std::array<MemoryHeapReport, MAX_MEMORY_HEAPS> heaps = {};
+        u32 heap_count = {};
+        // True when VK_EXT_memory_budget is supported.
+        bool budget_from_driver = {};
+        // Resources living in memory blocks are only counted by memory_blocks, this includes task graph transients.
+        ResourceMemoryReport buffers = {};
+        ResourceMemoryReport images = {};
+        ResourceMemoryReport acceleration_structures = {};
+        ResourceMemoryReport memory_blocks = {};
+    };
+
+    struct NamedMemoryReport
+    {
+        std::string name = {};
+        u64 count = {};
+        u64 bytes = {};
+    };
+
+    struct DefragmentationInfo
+    {
+        // 0 for no limit.
+        u64 max_bytes_per_pass = 64ull << 20ull;
+        u32 max_moves_per_pass = 256;
+        // Moved buffers get a new device address, shaders must access them via their id.
+        // Host mapped buffers and buffers backing acceleration structures are never moved.
+        bool move_buffers = true;
+        // All images must be in image_layout when a pass executes, moved images are left in it.
+        // Only images with TRANSFER_SRC and TRANSFER_DST usage are moved.
+        bool move_images = false;
+        ImageLayout image_layout = ImageLayout::GENERAL;
+    };
+
+    struct DefragmentationStatistics
+    {
+        u64 bytes_moved = {};
+        // Freed bytes and memory blocks are known once the defragmentation is no longer active.
+        u64 bytes_freed = {};
+        u32 allocations_moved = {};
+        u32 device_memory_blocks_freed = {};
+        u32 passes = {};
+        bool active = {};
+    };
+
+    // Cpu time spent in each phase of daxa_instance_create_device_2.
+    struct DeviceCreationTimings
+    {
+        // Zero when the physical device was already queried by an earlier call.
+        u64 physical_device_query_ns = {};
+        // Includes queue selection and loading of extension function pointers.
+        u64 vk_device_creation_ns = {};
+        u64 allocator_creation_ns = {};
+        u64 null_resource_creation_ns = {};
+        u64 resource_table_creation_ns = {};
+        // The device does not wait for the init commands to finish, the first submits on every queue wait for them on the gpu.
+        u64 init_submit_ns = {};
+        u64 total_ns = {};
+    };
+
     struct AccelerationStructureBuildSizesInfo
     {
         u64 acceleration_structure_size;
@@ -435,6 +533,7 @@ namespace daxa
         Device() = default;
 
         [[nodiscard]] auto create_memory(MemoryBlockInfo const & info) -> MemoryBlock;
+        [[nodiscard]] auto create_memory_pool(MemoryPoolInfo const & info) -> MemoryPool;
 
         [[nodiscard]] auto tlas_build_sizes(TlasBuildInfo const & info) -> AccelerationStructureBuildSizesInfo;
         [[nodiscard]] auto blas_build_sizes(BlasBuildInfo const & info) -> AccelerationStructureBuildSizesInfo;
@@ -450,6 +549,8 @@ namespace daxa
         [[nodiscard]] auto create_image(ImageInfo const & info) -> ImageId;
         [[nodiscard]] auto create_buffer_from_memory_block(MemoryBlockBufferInfo const & info) -> BufferId;
         [[nodiscard]] auto create_image_from_memory_block(MemoryBlockImageInfo const & info) -> ImageId;
+        [[nodiscard]] auto create_buffer_from_memory_pool(MemoryPoolBufferInfo const & info) -> BufferId;
+        [[nodiscard]] auto create_image_from_memory_pool(MemoryPoolImageInfo const & info) -> ImageId;
         [[nodiscard]] auto create_image_view(ImageViewInfo const & info) -> ImageViewId;
         [[nodiscard]] auto create_sampler(SamplerInfo const & info) -> SamplerId;
         [[nodiscard]] auto create_tlas(TlasInfo const & info) -> TlasId;
@@ -460,6 +561,8 @@ namespace daxa
         [[nodiscard]] auto create(ImageInfo const & info) { return create_image(info); }
         [[nodiscard]] auto create(MemoryBlockBufferInfo const & info) { return create_buffer_from_memory_block(info); }
         [[nodiscard]] auto create(MemoryBlockImageInfo const & info) { return create_image_from_memory_block(info); }
+        [[nodiscard]] auto create(MemoryPoolBufferInfo const & info) { return create_buffer_from_memory_pool(info); }
+        [[nodiscard]] auto create(MemoryPoolImageInfo const & info) { return create_image_from_memory_pool(info); }
         [[nodiscard]] auto create(ImageViewInfo const & info) { return create_image_view(info); }
         [[nodiscard]] auto create(SamplerInfo const & info) { return create_sampler(info); }
         [[nodiscard]] auto create(TlasInfo const & info) { return create_tlas(info); }
@@ -547,6 +650,7 @@ namespace daxa
         [[nodiscard]] auto create_timeline_semaphore(TimelineSemaphoreInfo const & info) -> TimelineSemaphore;
         [[nodiscard]] auto create_event(EventInfo const & info) -> Event;
         [[nodiscard]] auto create_timeline_query_pool(TimelineQueryPoolInfo const & info) -> TimelineQueryPool;
+        [[nodiscard]] auto create_query_pool(QueryPoolInfo const & info) -> QueryPool;
 
         void wait_idle();
 
@@ -567,6 +671,39 @@ namespace daxa
         ///   you can freely record those in parallel with collect_garbage
         void collect_garbage();
 
+        /// @brief  Index of the latest submit on any queue, each submit increments it by one.
+        [[nodiscard]] auto latest_submit_index() const -> u64;
+        /// @brief  Index of the oldest submit still pending on any queue, u64 max when all queues are idle.
+        ///         Work tagged with latest_submit_index() after it was submitted is finished once the tag is below this.
+        ///         Lets utilities recycle memory without a timeline semaphore of their own.
+        [[nodiscard]] auto oldest_pending_submit_index() const -> u64;
+
+        /// @brief  Reports heap budgets and the memory used by each resource type.
+        ///         Zombies still own their memory until collect_garbage destroys them.
+        [[nodiscard]] auto memory_report() const -> MemoryReport;
+        /// @brief  Aggregates the memory of buffers, images and acceleration structures by name, sorted by size.
+        ///         Resources living in memory blocks are not included.
+        /// NOTE:
+        /// * visits every resource slot, meant for debugging and tests rather than every frame
+        [[nodiscard]] auto memory_report_per_name() const -> std::vector<NamedMemoryReport>;
+
+        /// @brief  Starts an incremental defragmentation of all resources in the default memory pools.
+        ///         Each pass is recorded by CommandRecorder::record_defragmentation_pass and finished by collect_garbage.
+        ///         Ids stay valid, collect_garbage rewrites the descriptors and buffer device addresses of moved resources.
+        ///         Defragmentation ends by itself when no more resources can be moved.
+        /// NOTE:
+        /// * collect_garbage switches to the moved resources once the copies executed, the old ones are freed once all earlier submits finished
+        /// * the switch is delayed until all completed command lists were submitted, as they may reference the old resources
+        /// * a pass that can not switch within a few collect_garbage calls is canceled, zombie cleanup is suspended while a pass is in flight
+        /// WARNING:
+        /// * moved resources must not be written by the gpu after the pass executes, until collect_garbage finished the pass
+        /// * image views of moved images must not be created in parallel to the collect_garbage finishing the pass
+        /// * raw buffer device addresses of moved buffers become invalid, they must be queried again
+        void begin_defragmentation(DefragmentationInfo const & info);
+        /// @brief  Stops the defragmentation, a pass in flight is still finished by collect_garbage.
+        void end_defragmentation();
+        [[nodiscard]] auto defragmentation_statistics() const -> DefragmentationStatistics;
+
         /// THREADSAFETY:
         /// * reference MUST NOT be read after the device is destroyed.
         /// @return reference to info of object.
@@ -575,6 +712,7 @@ namespace daxa
         /// * reference MUST NOT be read after the device is destroyed.
         /// @return reference to device properties
         [[nodiscard]] auto properties() const -> DeviceProperties const &;
+        [[nodiscard]] auto creation_timings() const -> DeviceCreationTimings;
         [[nodiscard]] auto get_supported_present_modes(NativeWindowHandle native_handle, NativeWindowPlatform native_platform) const -> std::vector<PresentMode>;
 
         /// DEPRECATED:
@@ -89,12 +89,20 @@ namespace daxa
 
     DAXA_EXPORT_CXX auto to_string(GPUResourceId const & id) -> std::string;
 
+    enum struct SharingMode
+    {
+        EXCLUSIVE,
+        CONCURRENT,
+    };
+
     struct BufferInfo
     {
         usize size = {};
         // Ignored when allocating with a memory block.
         MemoryFlags allocate_info = {};
         SmallString name = {};
+        // Exclusive buffers must be transferred between queue families with buffer memory barriers.
+        SharingMode sharing_mode = SharingMode::CONCURRENT;
     };
 
     struct DAXA_EXPORT_CXX ImageCreateFlagsProperties
@@ -111,12 +119,6 @@ namespace daxa
         static inline constexpr ImageCreateFlags ALLOW_ALIAS = {0x00000400};
     };
 
-    enum struct SharingMode
-    {
-        EXCLUSIVE,
-        CONCURRENT,
-    };
-
     struct ImageInfo
     {
         ImageCreateFlags flags = ImageCreateFlagBits::NONE;
@@ -223,6 +225,8 @@ namespace daxa
     struct TlasBuildInfo
     {
         AccelerationStructureBuildFlags flags = daxa::AccelerationStructureBuildFlagBits::PREFER_FAST_TRACE;
+        // Refits src_tlas into dst_tlas instead of building it from scratch. Both builds must have ALLOW_UPDATE set.
+        // The instance count and flags must match the build of src_tlas. Without src_tlas, dst_tlas is refit in place.
         bool update = false;
         TlasId src_tlas = {};
         TlasId dst_tlas = {};
@@ -233,6 +237,8 @@ namespace daxa
     struct BlasBuildInfo
     {
         AccelerationStructureBuildFlags flags = daxa::AccelerationStructureBuildFlagBits::PREFER_FAST_TRACE;
+        // Refits src_blas into dst_blas, see TlasBuildInfo::update. Only vertex, aabb and transform data may change.
+        // Scratch memory must be at least update_scratch_size.
         bool update = false;
         BlasId src_blas = {};
         BlasId dst_blas = {};
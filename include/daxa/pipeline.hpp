@@ -4,6 +4,9 @@
 #include <daxa/core.hpp>
 #include <daxa/types.hpp>
 
+#include <cstring>
+#include <type_traits>
+
 namespace daxa
 {
     struct ShaderCreateFlagsProperties
@@ -18,6 +21,34 @@ namespace daxa
         static inline constexpr ShaderCreateFlags REQUIRE_FULL_SUBGROUPS  = {0x00000002};
     };
 
+    // Value of a shader specialization constant (layout(constant_id = X) const in glsl, [SpecializationConstant] in slang).
+    // Specializing one shader module at pipeline creation is far cheaper than compiling a variant per define combination.
+    struct SpecializationConstant
+    {
+        u32 constant_id = {};
+        // Size in bytes of the constant's type. Booleans are 4 bytes.
+        u32 size = 4;
+        // Raw bits of the constant, only the lowest size bytes are used.
+        u64 value = {};
+
+        template <typename T>
+            requires((sizeof(T) <= 8) && std::is_trivially_copyable_v<T>)
+        static auto make(u32 constant_id, T value) -> SpecializationConstant
+        {
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                // Shader booleans are 32 bit.
+                return {.constant_id = constant_id, .size = 4, .value = static_cast<u64>(value)};
+            }
+            else
+            {
+                auto ret = SpecializationConstant{.constant_id = constant_id, .size = static_cast<u32>(sizeof(T)), .value = {}};
+                std::memcpy(&ret.value, &value, sizeof(T));
+                return ret;
+            }
+        }
+    };
+
     struct ShaderInfo
     {
         u32 const * byte_code = {};
@@ -25,6 +56,7 @@ namespace daxa
         ShaderCreateFlags create_flags = {};
         Optional<u32> required_subgroup_size = {};
         SmallString entry_point = "main";
+        Span<SpecializationConstant const> specialization_constants = {};
     };
 
     // TODO: find a better way to link shader groups to shaders than by index
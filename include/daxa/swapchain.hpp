@@ -19,6 +19,43 @@ namespace daxa
         }
     }
 
+    enum struct FramePacingMode
+    {
+        // No instrumentation, pace_frame only marks the frame start.
+        DISABLED,
+        // Measures cpu, gpu and present timings of every frame.
+        MEASURE,
+        // Measures and makes pace_frame sleep until just before the gpu or display needs the next frame.
+        // This shortens the time between input sampling and display while keeping the gpu busy.
+        LOW_LATENCY,
+        MAX_ENUM = 0x7fffffff,
+    };
+
+    struct FramePacingStatistics
+    {
+        // Number of presented frames.
+        u64 frame_count = {};
+        // Time acquire_next_image blocked on frames in flight and the presentation engine.
+        u64 acquire_wait_ns = {};
+        // Time pace_frame blocked on the gpu and the presentation engine.
+        u64 pacing_wait_ns = {};
+        // Time pace_frame slept on purpose.
+        u64 pacing_sleep_ns = {};
+        // Time from the frame start (pace_frame, or acquire_next_image when pace_frame is not used) to present.
+        u64 cpu_frame_ns = {};
+        // Gpu time between acquire and present, excluding time the queue was busy with the previous frame.
+        u64 gpu_frame_ns = {};
+        // Time from the frame start until the presentation engine displayed the frame.
+        // Completion is only observed when the swapchain checks for it, in present_frame and pace_frame.
+        // A present is stamped at the first check after it completed, so the value is quantized to these points.
+        // With FramePacingMode::LOW_LATENCY, pace_frame blocks on the previous present, which keeps the error small.
+        u64 present_latency_ns = {};
+        // Requires timestamp support on the swapchains queue family.
+        bool gpu_frame_time_supported = {};
+        // Requires ImplicitFeatureFlagBits::PRESENT_WAIT and a window.
+        bool present_latency_supported = {};
+    };
+
     struct SwapchainInfo
     {
         NativeWindowHandle native_window;
@@ -30,6 +67,9 @@ namespace daxa
         usize max_allowed_frames_in_flight = 2;
         QueueFamily queue_family = {};
         SmallString name = {};
+        // Size of the images when native_window_platform is HEADLESS.
+        Extent2D headless_extent = {};
+        FramePacingMode frame_pacing_mode = FramePacingMode::DISABLED;
     };
 
     /**
@@ -38,6 +78,8 @@ namespace daxa
      * 
      * NOTE:
      * * functions that contain 'current' in their name might return different values between calling acquire_next_image
+     * * with NativeWindowPlatform::HEADLESS the swapchain owns max_allowed_frames_in_flight + 1 images and needs no display.
+     *   Acquire, present and the frames in flight throttling behave the same as with a window.
      *
      * THREADSAFETY:
      * * must be externally synchronized
@@ -77,6 +119,16 @@ namespace daxa
         ///         The difference between cpu and gpu timeline describes how many frames in flight the gpu is behind the cpu.
         /// @return Returns pair of a gpu timeline and cpu timeline value.
         [[nodiscard]] auto current_timeline_pair() const -> std::pair<TimelineSemaphore, u64>;
+        /// @brief  The image of the last present, stays untouched until it is acquired again.
+        ///         Meant for readback or encoding of headless swapchains, the image has TRANSFER_SRC usage.
+        /// @return An empty image id before the first present.
+        [[nodiscard]] auto presented_image() const -> ImageId;
+        /// @brief  Marks the start of the next frame, call it right before sampling input and acquire_next_image.
+        ///         With FramePacingMode::LOW_LATENCY it sleeps and waits until the gpu or presentation engine is about to need the frame.
+        ///         Without calling it, acquire_next_image marks the frame start.
+        void pace_frame();
+        /// @brief  Timings of the most recent frames, values stay zero with FramePacingMode::DISABLED.
+        [[nodiscard]] auto frame_pacing_statistics() const -> FramePacingStatistics;
 
         /// @brief  When the window size changes the swapchain is in an invalid state for new commands.
         ///         Calling resize will recreate the swapchain with the proper window size.
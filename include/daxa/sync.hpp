@@ -27,6 +27,23 @@ namespace daxa
 
     [[nodiscard]] DAXA_EXPORT_CXX auto to_string(ImageMemoryBarrierInfo const & info) -> std::string;
 
+    struct BufferMemoryBarrierInfo
+    {
+        Access src_access = AccessConsts::NONE;
+        Access dst_access = AccessConsts::NONE;
+        BufferId buffer_id = {};
+        u64 offset = {};
+        // The default covers the buffer from offset to its end.
+        u64 size = ~0ull;
+        // When both are set and differ, the barrier is a queue family ownership transfer.
+        // It must then be recorded as release on the src queue and again as acquire on the dst queue.
+        // Ignored for concurrent buffers, as they are owned by all queue families.
+        Optional<QueueFamily> src_queue_family = {};
+        Optional<QueueFamily> dst_queue_family = {};
+    };
+
+    [[nodiscard]] DAXA_EXPORT_CXX auto to_string(BufferMemoryBarrierInfo const & info) -> std::string;
+
     struct BinarySemaphoreInfo
     {
         SmallString name = {};
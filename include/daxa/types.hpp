@@ -269,7 +269,8 @@ namespace daxa
         }
         [[nodiscard]] auto at(usize i) const -> T const &
         {
-            return this->m_data.at(i);
+            DAXA_DBG_ASSERT_TRUE_M(i < m_size, "INDEX OUT OF RANGE");
+            return this->m_data[i];
         }
         [[nodiscard]] auto operator[](usize i) -> T &
         {
@@ -285,11 +286,11 @@ namespace daxa
         }
         [[nodiscard]] auto data() const -> T const *
         {
-            return this->m_data.data();
+            return this->m_data;
         }
         [[nodiscard]] auto data() -> T *
         {
-            return this->m_data.data();
+            return this->m_data;
         }
         [[nodiscard]] auto empty() const -> bool
         {
@@ -302,7 +303,7 @@ namespace daxa
         }
         [[nodiscard]] auto span() const -> std::span<T const>
         {
-            return {this->m_data.data(), static_cast<usize>(this->m_size)};
+            return {this->m_data, static_cast<usize>(this->m_size)};
         }
     };
 
@@ -1801,6 +1802,63 @@ namespace daxa
         static auto dec_refcnt(ImplHandle const * object) -> u64;
     };
 
+    enum struct MemoryPoolAlgorithm
+    {
+        // General purpose allocator, allocations may be freed in any order.
+        TLSF = 0,
+        // Allocations are placed one after another.
+        // Freeing in allocation order makes a pool with max_block_count 1 a ring buffer, suited for per frame scratch memory.
+        LINEAR = 1,
+        MAX_ENUM = 0x7fffffff,
+    };
+
+    struct MemoryPoolInfo
+    {
+        MemoryPoolAlgorithm algorithm = MemoryPoolAlgorithm::TLSF;
+        // Selects the memory type like the allocate_info of a buffer. Only host access flags are considered.
+        MemoryFlags memory_flags = {};
+        // Restricts the memory types the pool may use, zero allows all.
+        u32 memory_type_bits = {};
+        // Size of each device memory block, zero uses the allocators default.
+        u64 block_size = {};
+        u32 min_block_count = {};
+        // Zero means unlimited.
+        u32 max_block_count = {};
+        // Residency priority of the pools memory between 0 and 1, requires ImplicitFeatureFlagBits::MEMORY_PRIORITY.
+        // Drivers evict low priority memory first when the device memory is oversubscribed.
+        f32 priority = 0.5f;
+        SmallString name = {};
+    };
+
+    struct MemoryPoolStatistics
+    {
+        u64 block_bytes = {};
+        u64 allocation_bytes = {};
+        u32 block_count = {};
+        u32 allocation_count = {};
+    };
+
+    /// @brief  Custom pool of device memory blocks that buffers and images can be created from.
+    ///         Resources keep their pool alive until they are destroyed.
+    /// THREADSAFETY:
+    /// * is internally synchronized
+    struct DAXA_EXPORT_CXX MemoryPool : ManagedPtr<MemoryPool, daxa_MemoryPool>
+    {
+        MemoryPool() = default;
+
+        /// THREADSAFETY:
+        /// * reference MUST NOT be read after the object is destroyed.
+        /// @return reference to info of object.
+        [[nodiscard]] auto info() const -> MemoryPoolInfo const &;
+        [[nodiscard]] auto statistics() const -> MemoryPoolStatistics;
+
+      protected:
+        template <typename T, typename H_T>
+        friend struct ManagedPtr;
+        static auto inc_refcnt(ImplHandle const * object) -> u64;
+        static auto dec_refcnt(ImplHandle const * object) -> u64;
+    };
+
     struct TimelineQueryPoolInfo
     {
         u32 query_count = {};
@@ -1825,6 +1883,78 @@ namespace daxa
         static auto dec_refcnt(ImplHandle const * object) -> u64;
     };
 
+    enum struct QueryType
+    {
+        OCCLUSION = 0,
+        PIPELINE_STATISTICS = 1,
+        // Written with write_blas_compacted_sizes, requires ImplicitFeatureFlagBits::BASIC_RAY_TRACING.
+        ACCELERATION_STRUCTURE_COMPACTED_SIZE = 1000150000,
+        MAX_ENUM = 0x7fffffff,
+    };
+
+    struct PipelineStatisticFlagsProperties
+    {
+        using Data = u32;
+    };
+    using PipelineStatisticFlags = Flags<PipelineStatisticFlagsProperties>;
+    struct PipelineStatisticFlagBits
+    {
+        static inline constexpr PipelineStatisticFlags NONE = {0x00000000};
+        static inline constexpr PipelineStatisticFlags INPUT_ASSEMBLY_VERTICES = {0x00000001};
+        static inline constexpr PipelineStatisticFlags INPUT_ASSEMBLY_PRIMITIVES = {0x00000002};
+        static inline constexpr PipelineStatisticFlags VERTEX_SHADER_INVOCATIONS = {0x00000004};
+        static inline constexpr PipelineStatisticFlags GEOMETRY_SHADER_INVOCATIONS = {0x00000008};
+        static inline constexpr PipelineStatisticFlags GEOMETRY_SHADER_PRIMITIVES = {0x00000010};
+        static inline constexpr PipelineStatisticFlags CLIPPING_INVOCATIONS = {0x00000020};
+        static inline constexpr PipelineStatisticFlags CLIPPING_PRIMITIVES = {0x00000040};
+        static inline constexpr PipelineStatisticFlags FRAGMENT_SHADER_INVOCATIONS = {0x00000080};
+        static inline constexpr PipelineStatisticFlags TESSELLATION_CONTROL_SHADER_PATCHES = {0x00000100};
+        static inline constexpr PipelineStatisticFlags TESSELLATION_EVALUATION_SHADER_INVOCATIONS = {0x00000200};
+        static inline constexpr PipelineStatisticFlags COMPUTE_SHADER_INVOCATIONS = {0x00000400};
+        static inline constexpr PipelineStatisticFlags TASK_SHADER_INVOCATIONS = {0x00000800};
+        static inline constexpr PipelineStatisticFlags MESH_SHADER_INVOCATIONS = {0x00001000};
+    };
+
+    struct QueryPoolInfo
+    {
+        QueryType query_type = QueryType::OCCLUSION;
+        // Only used for pipeline statistics queries, requires ImplicitFeatureFlagBits::PIPELINE_STATISTICS_QUERY.
+        PipelineStatisticFlags pipeline_statistics = {};
+        u32 query_count = {};
+        SmallString name = {};
+    };
+
+    /// @brief  Pool of occlusion or pipeline statistics queries.
+    ///         Queries are recorded with begin_query and end_query,
+    ///         results can be read on the host or copied into a buffer with copy_query_pool_results.
+    struct DAXA_EXPORT_CXX QueryPool : ManagedPtr<QueryPool, daxa_QueryPool>
+    {
+        QueryPool() = default;
+
+        /// THREADSAFETY:
+        /// * reference MUST NOT be read after the object is destroyed.
+        /// @return reference to info of object.
+        [[nodiscard]] auto info() const -> QueryPoolInfo const &;
+
+        /// @brief  Occlusion queries have one value, pipeline statistics queries one per enabled statistic in bit order.
+        /// @return number of values of each query result.
+        [[nodiscard]] auto values_per_query() const -> u32;
+
+        /// @brief  Does not wait for the results.
+        /// @return values_per_query() values followed by the availability for each query.
+        [[nodiscard]] auto get_query_results(u32 start_index, u32 count) -> std::vector<u64>;
+
+        /// @brief  Resets queries on the host, makes them unavailable without recording reset_queries.
+        ///         The gpu must be done with the queries, for example because their results were available.
+        void reset(u32 start_index, u32 count);
+
+      protected:
+        template <typename T, typename H_T>
+        friend struct ManagedPtr;
+        static auto inc_refcnt(ImplHandle const * object) -> u64;
+        static auto dec_refcnt(ImplHandle const * object) -> u64;
+    };
+
     enum struct IndexType
     {
         uint16 = 0,
@@ -41,6 +41,7 @@ namespace daxa
 
         auto create_texture_id(ImGuiImageContext const & context) -> ImTextureID;
 
+        // The commands recorded by one call must be submitted before the next call, as the vertex memory is reused based on the submit timeline.
         void record_commands(ImDrawData * draw_data, CommandRecorder & recorder, ImageId target_image, u32 size_x, u32 size_y);
 #if DAXA_BUILT_WITH_UTILS_TASK_GRAPH
         void record_task(ImDrawData * draw_data, TaskGraph & task_graph, TaskImageView task_swapchain_image, u32 size_x, u32 size_y);
@@ -7,7 +7,17 @@
 #include <daxa/core.hpp>
 #include <daxa/device.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <deque>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace daxa
 {
@@ -86,4 +96,396 @@ namespace daxa
         u32 claimed_start = {};
         u32 claimed_size = {};
     };
+
+    struct ConcurrentTransferMemoryPoolInfo
+    {
+        Device device = {};
+        // Must be a multiple of the largest alignment requested from the pool.
+        u64 capacity = 1ull << 26;
+        bool use_bar_memory = {};
+        std::string name = {};
+    };
+
+    /// @brief  Thread safe ring buffer based transfer memory allocator.
+    ///         Any number of threads may allocate at the same time, allocations are lock free bump allocations.
+    ///         Instead of a timeline semaphore signaled by the user, memory is retired with the devices submit index, covering all queues:
+    ///         After submitting all commands that use allocations made so far, call mark_submitted.
+    ///         Everything allocated before that call is reclaimed at once, after the gpu finished these submits.
+    struct ConcurrentTransferMemoryPool
+    {
+        DAXA_EXPORT_CXX ConcurrentTransferMemoryPool(ConcurrentTransferMemoryPoolInfo a_info);
+        ConcurrentTransferMemoryPool(ConcurrentTransferMemoryPool const &) = delete;
+        ConcurrentTransferMemoryPool & operator=(ConcurrentTransferMemoryPool const &) = delete;
+        DAXA_EXPORT_CXX ~ConcurrentTransferMemoryPool();
+
+        struct Allocation
+        {
+            daxa::DeviceAddress device_address = {};
+            void * host_address = {};
+            u64 buffer_offset = {};
+            u64 size = {};
+        };
+        /// THREADSAFETY:
+        /// * may be called from any number of threads at the same time.
+        /// @return allocation or nullopt when the pool is full, even after reclaiming all memory the gpu is done with.
+        DAXA_EXPORT_CXX auto allocate(u64 size, u64 alignment_requirement = 16 /* 16 is a save default for most gpu data*/) -> std::optional<Allocation>;
+        template <typename T>
+        auto allocate_fill(T const & value, u64 alignment_requirement = alignof(T)) -> std::optional<Allocation>
+        {
+            auto allocation_o = allocate(sizeof(T), alignment_requirement);
+            if (allocation_o.has_value())
+            {
+                *reinterpret_cast<T *>(allocation_o->host_address) = value;
+            }
+            return allocation_o;
+        }
+        /// @brief  Call after submitting all commands that use allocations made before this call.
+        ///         Allocations racing with this call may be counted to either side, so call it only when no allocation made concurrently is used by already recorded submits.
+        DAXA_EXPORT_CXX void mark_submitted();
+        /// @brief  Frees all memory allocated before a mark_submitted call whose submits the gpu finished.
+        ///         Called automatically when an allocation does not fit.
+        DAXA_EXPORT_CXX void reclaim();
+        DAXA_EXPORT_CXX auto buffer() const -> daxa::BufferId;
+        /// THREADSAFETY:
+        /// * reference MUST NOT be read after the object is destroyed.
+        /// @return reference to info of object.
+        DAXA_EXPORT_CXX auto info() const -> ConcurrentTransferMemoryPoolInfo const &;
+
+      private:
+        struct SubmitMark
+        {
+            // Ring head at the time of the mark, everything before it was allocated before the mark.
+            u64 head = {};
+            u64 submit_timeline_value = {};
+        };
+
+        ConcurrentTransferMemoryPoolInfo m_info = {};
+        BufferId m_buffer = {};
+        daxa::DeviceAddress buffer_device_address = {};
+        void * buffer_host_address = {};
+        // Ring offsets grow monotonically, the physical offset is the ring offset modulo the capacity.
+        // Memory between tail and head is in use.
+        std::atomic_uint64_t head = {};
+        std::atomic_uint64_t tail = {};
+        std::mutex marks_mtx = {};
+        std::deque<SubmitMark> marks = {};
+    };
+
+    struct UploadQueueInfo
+    {
+        Device device = {};
+        // Falls back to QUEUE_MAIN when the device has no transfer queue.
+        Queue queue = QUEUE_TRANSFER_0;
+        u64 staging_capacity = 1ull << 26;
+        std::string name = {};
+    };
+
+    /// @brief  Completion token of an upload.
+    ///         The upload is complete, once the upload queues timeline semaphore reached the timeline_value.
+    struct UploadToken
+    {
+        u64 timeline_value = {};
+    };
+
+    struct BufferUploadInfo
+    {
+        BufferId dst_buffer = {};
+        u64 dst_offset = {};
+        std::span<std::byte const> data = {};
+    };
+
+    struct ImageUploadInfo
+    {
+        ImageId dst_image = {};
+        // The image must be in this layout when the upload executes.
+        ImageLayout image_layout = ImageLayout::TRANSFER_DST_OPTIMAL;
+        ImageArraySlice image_slice = {};
+        Offset3D image_offset = {};
+        Extent3D image_extent = {};
+        // Tightly packed texel data.
+        std::span<std::byte const> data = {};
+    };
+
+    /// @brief  Uploads data to buffers and images from any thread, copies are batched and executed on a transfer queue.
+    ///         Data is written into a staging ring, flush submits all uploads queued so far in a single submission.
+    ///         Destination resources used by other queue families must be created with SharingMode::CONCURRENT.
+    ///         Wait on an upload by waiting for the returned tokens value on the timeline_semaphore,
+    ///         for example by adding it to a TaskSubmitInfo::additional_wait_timeline_semaphores.
+    struct UploadQueue
+    {
+        DAXA_EXPORT_CXX UploadQueue(UploadQueueInfo a_info);
+        UploadQueue(UploadQueue const &) = delete;
+        UploadQueue & operator=(UploadQueue const &) = delete;
+        DAXA_EXPORT_CXX ~UploadQueue();
+
+        /// THREADSAFETY:
+        /// * may be called from any number of threads at the same time.
+        /// * the data is copied into staging memory before returning.
+        /// * flushes automatically when the staging memory runs out.
+        /// * throws std::runtime_error when the data is larger than half of the staging capacity.
+        DAXA_EXPORT_CXX auto upload(BufferUploadInfo const & info) -> UploadToken;
+        DAXA_EXPORT_CXX auto upload(ImageUploadInfo const & info) -> UploadToken;
+        /// @brief  Records and submits all queued uploads.
+        /// @return token that completes once all uploads queued so far are complete.
+        DAXA_EXPORT_CXX auto flush() -> UploadToken;
+        DAXA_EXPORT_CXX auto is_complete(UploadToken token) const -> bool;
+        DAXA_EXPORT_CXX void wait(UploadToken token);
+        DAXA_EXPORT_CXX auto timeline_semaphore() const -> TimelineSemaphore const &;
+        DAXA_EXPORT_CXX auto wait_pair(UploadToken token) const -> std::pair<TimelineSemaphore, u64>;
+        DAXA_EXPORT_CXX auto info() const -> UploadQueueInfo const &;
+
+      private:
+        struct PendingCopy
+        {
+            u64 staging_offset = {};
+            u64 size = {};
+            BufferId dst_buffer = {};
+            u64 dst_offset = {};
+            ImageId dst_image = {};
+            ImageLayout image_layout = {};
+            ImageArraySlice image_slice = {};
+            Offset3D image_offset = {};
+            Extent3D image_extent = {};
+        };
+
+        auto stage(std::span<std::byte const> data, u64 alignment, PendingCopy copy) -> UploadToken;
+
+        UploadQueueInfo m_info = {};
+        ConcurrentTransferMemoryPool staging_pool;
+        TimelineSemaphore gpu_timeline = {};
+        // Uploads hold the lock shared while staging, flush holds it exclusively.
+        // This guarantees that every staged allocation is part of the submit marked in the staging pool.
+        std::shared_mutex flush_mtx = {};
+        std::mutex pending_mtx = {};
+        std::vector<PendingCopy> pending_copies = {};
+        // Value the next flush will signal.
+        std::atomic_uint64_t next_timeline_value = 1;
+    };
+
+    struct ReadbackPoolInfo
+    {
+        Device device = {};
+        u64 capacity = 1ull << 24;
+        std::string name = {};
+    };
+
+    /// @brief  Identifies a readback, becomes ready once the pools timeline semaphore reached timeline_value.
+    struct ReadbackToken
+    {
+        u64 timeline_value = {};
+        u64 buffer_offset = {};
+        u64 size = {};
+    };
+
+    struct BufferReadbackInfo
+    {
+        BufferId src_buffer = {};
+        u64 src_offset = {};
+        u64 size = {};
+    };
+
+    struct ImageReadbackInfo
+    {
+        ImageId src_image = {};
+        ImageLayout image_layout = ImageLayout::TRANSFER_SRC_OPTIMAL;
+        ImageArraySlice image_slice = {};
+        Offset3D image_offset = {};
+        Extent3D image_extent = {};
+        // Size of the tightly packed texel data.
+        u64 size = {};
+    };
+
+    /// @brief  Pool of host cached memory for reading gpu results back to the cpu without stalling.
+    ///         Readbacks are recorded into a command recorder, the pools timeline semaphore must be signaled with timeline_value() by the submit containing them.
+    ///         Poll or wait on the returned token and release it once the data was read.
+    struct ReadbackPool
+    {
+        DAXA_EXPORT_CXX ReadbackPool(ReadbackPoolInfo a_info);
+        ReadbackPool(ReadbackPool const &) = delete;
+        ReadbackPool & operator=(ReadbackPool const &) = delete;
+        DAXA_EXPORT_CXX ~ReadbackPool();
+
+        // Returns nullopt when the pool is full.
+        DAXA_EXPORT_CXX auto record_readback(CommandRecorder & recorder, BufferReadbackInfo const & info) -> std::optional<ReadbackToken>;
+        DAXA_EXPORT_CXX auto record_readback(CommandRecorder & recorder, ImageReadbackInfo const & info) -> std::optional<ReadbackToken>;
+        DAXA_EXPORT_CXX auto is_ready(ReadbackToken const & token) const -> bool;
+        DAXA_EXPORT_CXX void wait(ReadbackToken const & token);
+        // Returns nullopt when the readback is not ready yet.
+        // The data stays valid until the token is released.
+        DAXA_EXPORT_CXX auto data(ReadbackToken const & token) const -> std::optional<std::span<std::byte const>>;
+        /// @brief  Reads the result as a T and releases the token when the readback is ready.
+        template <typename T>
+        auto try_read(ReadbackToken const & token) -> std::optional<T>
+        {
+            auto data_o = data(token);
+            if (!data_o.has_value())
+            {
+                return std::nullopt;
+            }
+            T value = {};
+            std::memcpy(&value, data_o->data(), std::min(sizeof(T), data_o->size()));
+            release(token);
+            return value;
+        }
+        // The memory of released readbacks is reused once the gpu is done with them.
+        // Tokens can be released in any order, a held token only keeps its own memory in use.
+        DAXA_EXPORT_CXX void release(ReadbackToken const & token);
+        // Returns current timeline index.
+        DAXA_EXPORT_CXX auto timeline_value() const -> u64;
+        // Returns timeline semaphore that needs to be signaled with the latest timeline value,
+        // on a queue that uses readbacks from this pool.
+        DAXA_EXPORT_CXX auto timeline_semaphore() const -> TimelineSemaphore const &;
+        DAXA_EXPORT_CXX auto buffer() const -> daxa::BufferId;
+        DAXA_EXPORT_CXX auto info() const -> ReadbackPoolInfo const &;
+
+      private:
+        auto allocate(u64 size, u64 alignment) -> std::optional<ReadbackToken>;
+        void reclaim_unused_memory();
+        void free_range(u64 offset, u64 size);
+
+        struct TrackedReadback
+        {
+            u64 timeline_value = {};
+            // Allocated range including the alignment padding in front of the readback.
+            u64 range_offset = {};
+            u64 range_size = {};
+        };
+
+        ReadbackPoolInfo m_info = {};
+        TimelineSemaphore gpu_timeline = {};
+        BufferId m_buffer = {};
+        std::byte const * buffer_host_address = {};
+        u64 current_timeline_value = {};
+        // Unused ranges of the buffer, maps offset to size, adjacent ranges are merged.
+        std::map<u64, u64> free_ranges = {};
+        // Unreleased readbacks by buffer offset.
+        std::map<u64, TrackedReadback> live_readbacks = {};
+        // Released readbacks that are freed once the gpu reached their timeline value.
+        std::vector<TrackedReadback> released_readbacks = {};
+    };
+
+    struct BlasCompactorInfo
+    {
+        Device device = {};
+        // Maximum number of blas waiting for their compacted size at once.
+        u32 max_pending_blas = 1024;
+        std::string name = {};
+    };
+
+    struct BlasCompaction
+    {
+        // Destroyed once the commands containing the compacting copy finished.
+        BlasId old_blas = {};
+        BlasId new_blas = {};
+        u64 old_size = {};
+        u64 new_size = {};
+    };
+
+    struct BlasCompactorStatistics
+    {
+        u64 compacted_blas = {};
+        u64 bytes_before = {};
+        u64 bytes_after = {};
+    };
+
+    /// @brief  Shrinks blas built with AccelerationStructureBuildFlagBits::ALLOW_COMPACTION to their compacted size.
+    ///         The compacted sizes are queried right after the build and read back without stalling.
+    ///         Once available, a right sized blas is created, the compacting copy is recorded and the old blas is destroyed after the copy.
+    ///         Tlas instances have to be rebuilt with the device addresses of the new blas.
+    /// THREADSAFETY:
+    /// * must be externally synchronized.
+    struct BlasCompactor
+    {
+        DAXA_EXPORT_CXX BlasCompactor(BlasCompactorInfo a_info);
+        BlasCompactor(BlasCompactor const &) = delete;
+        BlasCompactor & operator=(BlasCompactor const &) = delete;
+        DAXA_EXPORT_CXX ~BlasCompactor();
+
+        /// @brief  Records the compacted size queries, must be recorded after the builds of the blas.
+        /// @return number of queued blas, less than requested when max_pending_blas is exceeded.
+        DAXA_EXPORT_CXX auto record_size_queries(CommandRecorder & recorder, std::span<BlasId const> blas) -> u32;
+        /// @brief  Records the compaction of every queued blas whose compacted size is available, never waits.
+        ///         The new blas are usable by acceleration structure builds and ray tracing after the recorded commands.
+        DAXA_EXPORT_CXX auto record_compactions(CommandRecorder & recorder) -> std::vector<BlasCompaction>;
+        DAXA_EXPORT_CXX auto pending_blas() const -> u32;
+        DAXA_EXPORT_CXX auto statistics() const -> BlasCompactorStatistics const &;
+        DAXA_EXPORT_CXX auto info() const -> BlasCompactorInfo const &;
+
+      private:
+        struct PendingBlas
+        {
+            BlasId blas = {};
+            u32 query_index = {};
+        };
+
+        BlasCompactorInfo m_info = {};
+        QueryPool query_pool = {};
+        std::vector<u32> free_queries = {};
+        std::vector<PendingBlas> pending = {};
+        BlasCompactorStatistics m_statistics = {};
+    };
+
+    struct BlasBuildSchedulerInfo
+    {
+        Device device = {};
+        // Scratch ring shared by all builds. Builds needing more scratch get a dedicated scratch buffer.
+        u64 scratch_capacity = 1ull << 26;
+        // Maximum blas bytes built per record_builds call, spreads large queues over multiple frames.
+        u64 build_budget_per_frame = 1ull << 28;
+        std::string name = {};
+    };
+
+    struct BlasBuildSchedulerStatistics
+    {
+        u64 built_blas = {};
+        u64 built_bytes = {};
+        u64 batches = {};
+        // Highest used offset of the scratch ring.
+        u64 scratch_peak = {};
+        u64 dedicated_scratch_builds = {};
+    };
+
+    /// @brief  Builds queued blas in budget limited batches that share one scratch ring.
+    ///         Batches are separated by barriers only when the ring wraps around and scratch memory is reused.
+    ///         All recorded commands must be submitted to the same queue in recording order, as scratch memory is reused across frames.
+    /// THREADSAFETY:
+    /// * must be externally synchronized.
+    struct BlasBuildScheduler
+    {
+        DAXA_EXPORT_CXX BlasBuildScheduler(BlasBuildSchedulerInfo a_info);
+        BlasBuildScheduler(BlasBuildScheduler const &) = delete;
+        BlasBuildScheduler & operator=(BlasBuildScheduler const &) = delete;
+        DAXA_EXPORT_CXX ~BlasBuildScheduler();
+
+        /// @brief  Creates a blas of the required size and queues its build.
+        ///         dst_blas and scratch_data of the info are ignored, the geometry data must stay valid until the blas is built.
+        /// @return blas that is built by a later record_builds call.
+        DAXA_EXPORT_CXX auto enqueue(BlasBuildInfo const & info, std::string_view name = {}) -> BlasId;
+        /// @brief  Records queued builds until the per frame budget is reached.
+        /// @return blas built by the recorded commands, usable by later acceleration structure builds and ray tracing.
+        DAXA_EXPORT_CXX auto record_builds(CommandRecorder & recorder) -> std::vector<BlasId>;
+        DAXA_EXPORT_CXX auto queued_builds() const -> u32;
+        DAXA_EXPORT_CXX auto statistics() const -> BlasBuildSchedulerStatistics const &;
+        DAXA_EXPORT_CXX auto info() const -> BlasBuildSchedulerInfo const &;
+
+      private:
+        struct QueuedBuild
+        {
+            // Geometries point into the owned geometry vectors.
+            BlasBuildInfo build_info = {};
+            std::vector<BlasTriangleGeometryInfo> triangles = {};
+            std::vector<BlasAabbGeometryInfo> aabbs = {};
+            u64 scratch_size = {};
+            u64 blas_size = {};
+        };
+
+        BlasBuildSchedulerInfo m_info = {};
+        BufferId scratch_buffer = {};
+        DeviceAddress scratch_address = {};
+        u64 scratch_alignment = {};
+        std::deque<QueuedBuild> queue = {};
+        std::vector<QueuedBuild> recorded = {};
+        std::vector<BlasBuildInfo> batch = {};
+        BlasBuildSchedulerStatistics m_statistics = {};
+    };
 } // namespace daxa
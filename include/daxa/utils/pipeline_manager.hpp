@@ -62,6 +62,9 @@ namespace daxa
     {
         ShaderSource source = Monostate{};
         ShaderCompileOptions compile_options = {};
+        // Applied when creating the pipeline, not when compiling. All pipelines that only differ in their
+        // specialization constants share a single compilation of the shader.
+        std::vector<SpecializationConstant> specialization_constants = {};
     };
 
     struct RayTracingPipelineCompileInfo
@@ -106,6 +109,10 @@ namespace daxa
         Device device;
         ShaderCompileOptions shader_compile_options = {};
         bool register_null_pipelines_when_first_compile_fails = false;
+        // When enabled, file change detection (inotify on linux, polling elsewhere) and recompilation run on a background thread.
+        // reload_all then no longer compiles anything. It becomes the sync point that swaps in all pipelines finished since the last call.
+        // The replaced pipelines are destroyed as usual, meaning they are kept alive until the device timeline passed them.
+        bool enable_background_hot_reload = false;
         std::function<void(std::string &, std::filesystem::path const & path)> custom_preprocessor = {};
         std::string name = {};
     };
@@ -0,0 +1,125 @@
+#pragma once
+
+#if !DAXA_BUILT_WITH_UTILS_PROFILER
+#error "[package management error] You must build Daxa with the DAXA_ENABLE_UTILS_PROFILER CMake option enabled, or request the utils-profiler feature in vcpkg"
+#endif
+
+#include <daxa/core.hpp>
+#include <daxa/device.hpp>
+
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace daxa
+{
+    struct GpuProfilerInfo
+    {
+        Device device = {};
+        // Number of frames recorded before the queries of a frame are reused.
+        // Must be at least the number of frames the cpu records ahead of the gpu.
+        u32 frames_in_flight = 3;
+        u32 max_zones_per_frame = 256;
+        // Number of resolved zones kept for write_trace.
+        u32 trace_capacity = 1 << 16;
+        std::string name = {};
+    };
+
+    struct GpuZoneStatistics
+    {
+        std::string name = {};
+        u64 sample_count = {};
+        f64 last_ns = {};
+        f64 min_ns = {};
+        f64 avg_ns = {};
+        f64 max_ns = {};
+    };
+
+    struct GpuZoneEvent
+    {
+        u32 statistics_index = {};
+        u32 depth = {};
+        u64 frame_index = {};
+        f64 begin_ns = {};
+        f64 end_ns = {};
+    };
+
+    /// @brief  Measures gpu time of named zones within command recorders.
+    ///         Owns one timestamp query pool per frame in flight, handles resets and reads results back without stalling.
+    ///         Zones with the same name are aggregated into GpuZoneStatistics.
+    /// THREADSAFETY:
+    /// * must be externally synchronized.
+    struct GpuProfiler
+    {
+        struct ScopedZone
+        {
+            DAXA_EXPORT_CXX ScopedZone(GpuProfiler & a_profiler, CommandRecorder & a_recorder, u32 a_zone);
+            ScopedZone(ScopedZone const &) = delete;
+            ScopedZone & operator=(ScopedZone const &) = delete;
+            DAXA_EXPORT_CXX ~ScopedZone();
+
+          private:
+            GpuProfiler * profiler = {};
+            CommandRecorder * recorder = {};
+            u32 zone = {};
+        };
+
+        DAXA_EXPORT_CXX GpuProfiler(GpuProfilerInfo a_info);
+        GpuProfiler(GpuProfiler const &) = delete;
+        GpuProfiler & operator=(GpuProfiler const &) = delete;
+        DAXA_EXPORT_CXX ~GpuProfiler();
+
+        /// @brief  Starts a new frame and records the reset of its queries.
+        ///         Must be recorded before any zone of the frame, on the first command recorder of the frame.
+        DAXA_EXPORT_CXX void begin_frame(CommandRecorder & recorder);
+        /// @brief  Writes the begin timestamp of a zone. Zones may be nested.
+        /// @return zone to end, zones exceeding max_zones_per_frame are ignored.
+        DAXA_EXPORT_CXX auto begin_zone(CommandRecorder & recorder, std::string_view name) -> u32;
+        DAXA_EXPORT_CXX void end_zone(CommandRecorder & recorder, u32 zone);
+        /// @brief  Begins a zone that ends when the returned object is destroyed.
+        ///         The recorder must outlive the returned zone.
+        DAXA_EXPORT_CXX auto scoped_zone(CommandRecorder & recorder, std::string_view name) -> ScopedZone;
+        /// @brief  Reads back all frames the gpu finished, never waits.
+        ///         Also called by begin_frame.
+        DAXA_EXPORT_CXX void resolve();
+        DAXA_EXPORT_CXX auto statistics() const -> std::vector<GpuZoneStatistics> const &;
+        DAXA_EXPORT_CXX void reset_statistics();
+        // Number of frames whose results were not available before their queries were reused.
+        DAXA_EXPORT_CXX auto dropped_frames() const -> u64;
+        /// @brief  Writes the last trace_capacity resolved zones in the chrome trace event format.
+        ///         Open the file in chrome://tracing or https://ui.perfetto.dev.
+        /// @return false when the file could not be written.
+        DAXA_EXPORT_CXX auto write_trace(std::filesystem::path const & path) const -> bool;
+        DAXA_EXPORT_CXX auto info() const -> GpuProfilerInfo const &;
+
+      private:
+        struct RecordedZone
+        {
+            u32 statistics_index = {};
+            u32 depth = {};
+        };
+        struct FrameQueries
+        {
+            TimelineQueryPool query_pool = {};
+            // Zone i uses the queries 2*i and 2*i+1.
+            std::vector<RecordedZone> zones = {};
+            u64 frame_index = {};
+            bool pending = {};
+        };
+
+        auto try_resolve(FrameQueries & frame) -> bool;
+
+        GpuProfilerInfo m_info = {};
+        f64 timestamp_period = {};
+        std::vector<FrameQueries> frames = {};
+        u64 frame_index = {};
+        u32 current_depth = {};
+        u64 m_dropped_frames = {};
+        std::vector<GpuZoneStatistics> zone_statistics = {};
+        std::unordered_map<std::string, u32> statistics_indices = {};
+        std::deque<GpuZoneEvent> trace = {};
+    };
+} // namespace daxa
@@ -62,6 +62,10 @@ namespace daxa
         ///         If that is the case for you, you can turn off all use of split barriers.
         ///         Daxa will use pipeline barriers instead if this is set.
         bool use_split_barriers = true;
+        /// @brief  By default buffer dependencies are synchronized with global memory barriers, which are merged into one per batch.
+        ///         When set, pipeline barriers on buffers are recorded as buffer memory barriers over the whole buffer instead.
+        ///         Blas and tlas dependencies and split barriers still use memory barriers.
+        bool use_buffer_memory_barriers = {};
         /// @brief  Each condition doubled the number of permutations.
         ///         For a low number of permutations its is preferable to precompile all permutations.
         ///         For a large number of permutations it might be preferable to only create the permutations actually used on the fly just before they are needed.
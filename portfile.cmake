@@ -8,6 +8,7 @@ vcpkg_check_features(OUT_FEATURE_OPTIONS FEATURE_OPTIONS
     FEATURES
     utils-imgui WITH_UTILS_IMGUI
     utils-mem WITH_UTILS_MEM
+    utils-profiler WITH_UTILS_PROFILER
     utils-pipeline-manager-glslang WITH_UTILS_PIPELINE_MANAGER_GLSLANG
     utils-pipeline-manager-slang WITH_UTILS_PIPELINE_MANAGER_SLANG
     utils-pipeline-manager-spirv-validation WITH_UTILS_PIPELINE_MANAGER_SPIRV_VALIDATION
@@ -22,6 +23,9 @@ endif()
 if(WITH_UTILS_MEM)
     list(APPEND DAXA_DEFINES "-DDAXA_ENABLE_UTILS_MEM=true")
 endif()
+if(WITH_UTILS_PROFILER)
+    list(APPEND DAXA_DEFINES "-DDAXA_ENABLE_UTILS_PROFILER=true")
+endif()
 if(WITH_UTILS_PIPELINE_MANAGER_GLSLANG)
     list(APPEND DAXA_DEFINES "-DDAXA_ENABLE_UTILS_PIPELINE_MANAGER_GLSLANG=true")
 endif()
@@ -14,6 +14,40 @@
 
 static_assert(sizeof(daxa::Queue) == sizeof(daxa_Queue));
 static_assert(alignof(daxa::Queue) == alignof(daxa_Queue));
+static_assert(sizeof(daxa::ShaderInfo) == sizeof(daxa_ShaderInfo));
+static_assert(offsetof(daxa::ShaderInfo, specialization_constants) == offsetof(daxa_ShaderInfo, specialization_constants));
+static_assert(sizeof(daxa::SpecializationConstant) == sizeof(daxa_SpecializationConstant));
+static_assert(sizeof(daxa::CommandRecorderStatistics) == sizeof(daxa_CommandRecorderStatistics));
+static_assert(sizeof(daxa::BufferInfo) == sizeof(daxa_BufferInfo));
+static_assert(sizeof(daxa::BufferMemoryBarrierInfo) == sizeof(daxa_BufferMemoryBarrierInfo));
+static_assert(offsetof(daxa::BufferMemoryBarrierInfo, dst_queue_family) == offsetof(daxa_BufferMemoryBarrierInfo, dst_queue_family));
+static_assert(sizeof(daxa::QueryPoolInfo) == sizeof(daxa_QueryPoolInfo));
+static_assert(sizeof(daxa::DispatchIndirectBatchInfo) == sizeof(daxa_DispatchIndirectBatchInfo));
+static_assert(offsetof(daxa::DispatchIndirectBatchInfo, chained) == offsetof(daxa_DispatchIndirectBatchInfo, chained));
+static_assert(sizeof(daxa::BeginQueryInfo) == sizeof(daxa_BeginQueryInfo));
+static_assert(sizeof(daxa::CopyQueryPoolResultsInfo) == sizeof(daxa_CopyQueryPoolResultsInfo));
+static_assert(offsetof(daxa::CopyQueryPoolResultsInfo, with_availability) == offsetof(daxa_CopyQueryPoolResultsInfo, with_availability));
+static_assert(sizeof(daxa::WriteBlasCompactedSizesInfo) == sizeof(daxa_WriteBlasCompactedSizesInfo));
+static_assert(sizeof(daxa::CopyBlasInfo) == sizeof(daxa_CopyBlasInfo));
+static_assert(sizeof(daxa::MemoryHeapReport) == sizeof(daxa_MemoryHeapReport));
+static_assert(sizeof(daxa::MemoryReport) == sizeof(daxa_MemoryReport));
+static_assert(offsetof(daxa::MemoryReport, memory_blocks) == offsetof(daxa_MemoryReport, memory_blocks));
+static_assert(sizeof(daxa::DefragmentationInfo) == sizeof(daxa_DefragmentationInfo));
+static_assert(offsetof(daxa::DefragmentationInfo, image_layout) == offsetof(daxa_DefragmentationInfo, image_layout));
+static_assert(sizeof(daxa::DefragmentationStatistics) == sizeof(daxa_DefragmentationStatistics));
+static_assert(offsetof(daxa::DefragmentationStatistics, active) == offsetof(daxa_DefragmentationStatistics, active));
+static_assert(sizeof(daxa::SwapchainInfo) == sizeof(daxa_SwapchainInfo));
+static_assert(offsetof(daxa::SwapchainInfo, headless_extent) == offsetof(daxa_SwapchainInfo, headless_extent));
+static_assert(offsetof(daxa::SwapchainInfo, frame_pacing_mode) == offsetof(daxa_SwapchainInfo, frame_pacing_mode));
+static_assert(sizeof(daxa::FramePacingStatistics) == sizeof(daxa_FramePacingStatistics));
+static_assert(offsetof(daxa::FramePacingStatistics, present_latency_supported) == offsetof(daxa_FramePacingStatistics, present_latency_supported));
+static_assert(sizeof(daxa::DeviceCreationTimings) == sizeof(daxa_DeviceCreationTimings));
+static_assert(offsetof(daxa::DeviceCreationTimings, total_ns) == offsetof(daxa_DeviceCreationTimings, total_ns));
+static_assert(sizeof(daxa::MemoryPoolInfo) == sizeof(daxa_MemoryPoolInfo));
+static_assert(offsetof(daxa::MemoryPoolInfo, name) == offsetof(daxa_MemoryPoolInfo, name));
+static_assert(sizeof(daxa::MemoryPoolStatistics) == sizeof(daxa_MemoryPoolStatistics));
+static_assert(sizeof(daxa::MemoryPoolBufferInfo) == sizeof(daxa_MemoryPoolBufferInfo));
+static_assert(sizeof(daxa::MemoryPoolImageInfo) == sizeof(daxa_MemoryPoolImageInfo));
 
 // --- Begin Helpers ---
 
@@ -136,6 +170,13 @@ auto daxa_result_to_string(daxa_Result result) -> std::string_view
     case daxa_Result::DAXA_RESULT_ERROR_DEVICE_NOT_SUPPORTED: return "DAXA_RESULT_ERROR_DEVICE_NOT_SUPPORTED";
     case daxa_Result::DAXA_RESULT_DEVICE_DOES_NOT_SUPPORT_ACCELERATION_STRUCTURE_COUNT: return "DAXA_RESULT_DEVICE_DOES_NOT_SUPPORT_ACCELERATION_STRUCTURE_COUNT";
     case daxa_Result::DAXA_RESULT_ERROR_NO_SUITABLE_DEVICE_FOUND: return "DAXA_RESULT_ERROR_NO_SUITABLE_DEVICE_FOUND";
+    case daxa_Result::DAXA_RESULT_ERROR_ACCELERATION_STRUCTURE_UPDATE_WITHOUT_ALLOW_UPDATE: return "DAXA_RESULT_ERROR_ACCELERATION_STRUCTURE_UPDATE_WITHOUT_ALLOW_UPDATE";
+    case daxa_Result::DAXA_RESULT_ERROR_DEFRAGMENTATION_ALREADY_ACTIVE: return "DAXA_RESULT_ERROR_DEFRAGMENTATION_ALREADY_ACTIVE";
+    case daxa_Result::DAXA_RESULT_INVALID_DEFRAGMENTATION_INFO: return "DAXA_RESULT_INVALID_DEFRAGMENTATION_INFO";
+    case daxa_Result::DAXA_RESULT_INVALID_MEMORY_POOL_INFO: return "DAXA_RESULT_INVALID_MEMORY_POOL_INFO";
+    case daxa_Result::DAXA_RESULT_INVALID_HEADLESS_EXTENT: return "DAXA_RESULT_INVALID_HEADLESS_EXTENT";
+    case daxa_Result::DAXA_RESULT_INVALID_QUERY_TYPE: return "DAXA_RESULT_INVALID_QUERY_TYPE";
+    case daxa_Result::DAXA_RESULT_PRECISE_OCCLUSION_QUERY_NOT_DEVICE_ENABLED: return "DAXA_RESULT_PRECISE_OCCLUSION_QUERY_NOT_DEVICE_ENABLED";
     case daxa_Result::DAXA_RESULT_MAX_ENUM: return "DAXA_RESULT_MAX_ENUM";
     default: return "UNIMPLEMENTED";
     }
@@ -255,6 +296,17 @@ namespace daxa
         return ret;
     }
 
+    auto Device::create_memory_pool(MemoryPoolInfo const & info) -> MemoryPool
+    {
+        MemoryPool ret = {};
+        check_result(daxa_dvc_create_memory_pool(
+                         r_cast<daxa_Device>(this->object),
+                         r_cast<daxa_MemoryPoolInfo const *>(&info),
+                         r_cast<daxa_MemoryPool *>(&ret)),
+                     "failed to create memory pool");
+        return ret;
+    }
+
     auto Device::buffer_memory_requirements(BufferInfo const & info) const -> MemoryRequirements
     {
         return std::bit_cast<MemoryRequirements>(
@@ -356,6 +408,28 @@ namespace daxa
             "failed to create image from memory block");
         return id;
     }
+    auto Device::create_buffer_from_memory_pool(MemoryPoolBufferInfo const & info) -> BufferId
+    {
+        BufferId id = {};
+        check_result(
+            daxa_dvc_create_buffer_from_memory_pool(
+                r_cast<daxa_Device>(this->object),
+                r_cast<daxa_MemoryPoolBufferInfo const *>(&info),
+                r_cast<daxa_BufferId *>(&id)),
+            "failed to create buffer from memory pool");
+        return id;
+    }
+    auto Device::create_image_from_memory_pool(MemoryPoolImageInfo const & info) -> ImageId
+    {
+        ImageId id = {};
+        check_result(
+            daxa_dvc_create_image_from_memory_pool(
+                r_cast<daxa_Device>(this->object),
+                r_cast<daxa_MemoryPoolImageInfo const *>(&info),
+                r_cast<daxa_ImageId *>(&id)),
+            "failed to create image from memory pool");
+        return id;
+    }
     auto Device::create_tlas_from_buffer(BufferTlasInfo const & info) -> TlasId
     {
         TlasId id = {};
@@ -510,6 +584,7 @@ namespace daxa
     DAXA_DECL_DVC_CREATE_FN(TimelineSemaphore, timeline_semaphore)
     DAXA_DECL_DVC_CREATE_FN(Event, event)
     DAXA_DECL_DVC_CREATE_FN(TimelineQueryPool, timeline_query_pool)
+    DAXA_DECL_DVC_CREATE_FN(QueryPool, query_pool)
 
     auto Device::info() const -> DeviceInfo2 const &
     {
@@ -576,11 +651,83 @@ namespace daxa
             "failed to collect garbage");
     }
 
+    auto Device::latest_submit_index() const -> u64
+    {
+        return daxa_dvc_latest_submit_index(rc_cast<daxa_Device>(object));
+    }
+
+    auto Device::oldest_pending_submit_index() const -> u64
+    {
+        u64 ret = {};
+        check_result(daxa_dvc_oldest_pending_submit_index(rc_cast<daxa_Device>(object), &ret), "failed to query the oldest pending submit");
+        return ret;
+    }
+
     auto Device::properties() const -> DeviceProperties const &
     {
         return *r_cast<DeviceProperties const *>(daxa_dvc_properties(rc_cast<daxa_Device>(object)));
     }
 
+    auto Device::creation_timings() const -> DeviceCreationTimings
+    {
+        DeviceCreationTimings ret = {};
+        daxa_dvc_creation_timings(rc_cast<daxa_Device>(this->object), r_cast<daxa_DeviceCreationTimings *>(&ret));
+        return ret;
+    }
+
+    auto Device::memory_report() const -> MemoryReport
+    {
+        MemoryReport ret = {};
+        check_result(daxa_dvc_memory_report(rc_cast<daxa_Device>(object), r_cast<daxa_MemoryReport *>(&ret)), "failed to create memory report");
+        return ret;
+    }
+
+    auto Device::memory_report_per_name() const -> std::vector<NamedMemoryReport>
+    {
+        std::vector<daxa_NamedMemoryReport> reports = {};
+        daxa_Result result = DAXA_RESULT_INCOMPLETE;
+        // Resources named in between the two calls make the report incomplete, in that case it is queried again.
+        while (result == DAXA_RESULT_INCOMPLETE)
+        {
+            u32 report_count = 0;
+            check_result(daxa_dvc_memory_report_per_name(rc_cast<daxa_Device>(object), nullptr, &report_count), "failed to create memory report per name");
+            reports.resize(report_count);
+            result = daxa_dvc_memory_report_per_name(rc_cast<daxa_Device>(object), reports.data(), &report_count);
+            check_result(result, "failed to create memory report per name", std::array{DAXA_RESULT_SUCCESS, DAXA_RESULT_INCOMPLETE});
+            reports.resize(report_count);
+        }
+        std::vector<NamedMemoryReport> ret = {};
+        ret.reserve(reports.size());
+        for (auto const & report : reports)
+        {
+            ret.push_back(NamedMemoryReport{
+                .name = std::string{report.name.data, report.name.size},
+                .count = report.count,
+                .bytes = report.bytes,
+            });
+        }
+        return ret;
+    }
+
+    void Device::begin_defragmentation(DefragmentationInfo const & info)
+    {
+        check_result(
+            daxa_dvc_begin_defragmentation(r_cast<daxa_Device>(this->object), r_cast<daxa_DefragmentationInfo const *>(&info)),
+            "failed to begin defragmentation");
+    }
+
+    void Device::end_defragmentation()
+    {
+        daxa_dvc_end_defragmentation(r_cast<daxa_Device>(this->object));
+    }
+
+    auto Device::defragmentation_statistics() const -> DefragmentationStatistics
+    {
+        DefragmentationStatistics ret = {};
+        daxa_dvc_defragmentation_statistics(rc_cast<daxa_Device>(this->object), r_cast<daxa_DefragmentationStatistics *>(&ret));
+        return ret;
+    }
+
     auto Device::get_supported_present_modes(NativeWindowHandle native_handle, NativeWindowPlatform native_platform) const -> std::vector<PresentMode>
     {
         auto * c_device = rc_cast<daxa_Device>(object);
@@ -730,6 +877,32 @@ namespace daxa
 
     /// --- End MemoryBlock
 
+    /// --- Begin MemoryPool
+
+    auto MemoryPool::info() const -> MemoryPoolInfo const &
+    {
+        return *r_cast<MemoryPoolInfo const *>(daxa_memory_pool_info(rc_cast<daxa_MemoryPool>(this->object)));
+    }
+
+    auto MemoryPool::statistics() const -> MemoryPoolStatistics
+    {
+        MemoryPoolStatistics ret = {};
+        daxa_memory_pool_statistics(rc_cast<daxa_MemoryPool>(this->object), r_cast<daxa_MemoryPoolStatistics *>(&ret));
+        return ret;
+    }
+
+    auto MemoryPool::inc_refcnt(ImplHandle const * object) -> u64
+    {
+        return daxa_memory_pool_inc_refcnt(rc_cast<daxa_MemoryPool>(object));
+    }
+
+    auto MemoryPool::dec_refcnt(ImplHandle const * object) -> u64
+    {
+        return daxa_memory_pool_dec_refcnt(rc_cast<daxa_MemoryPool>(object));
+    }
+
+    /// --- End MemoryPool
+
     /// --- Begin TimelineQueryPool ---
 
     auto TimelineQueryPool::info() const -> TimelineQueryPoolInfo const &
@@ -758,6 +931,47 @@ namespace daxa
 
     /// --- End TimelineQueryPool ---
 
+    /// --- Begin QueryPool ---
+
+    auto QueryPool::info() const -> QueryPoolInfo const &
+    {
+        return *r_cast<QueryPoolInfo const *>(daxa_query_pool_info(rc_cast<daxa_QueryPool>(this->object)));
+    }
+
+    auto QueryPool::values_per_query() const -> u32
+    {
+        return daxa_query_pool_values_per_query(rc_cast<daxa_QueryPool>(this->object));
+    }
+
+    auto QueryPool::get_query_results(u32 start_index, u32 count) -> std::vector<u64>
+    {
+        std::vector<u64> ret = {};
+        ret.resize(count * (this->values_per_query() + 1));
+        check_result(
+            daxa_query_pool_query_results(rc_cast<daxa_QueryPool>(this->object), start_index, count, ret.data()),
+            "failed to query results of query pool", std::array{DAXA_RESULT_SUCCESS, DAXA_RESULT_NOT_READY});
+        return ret;
+    }
+
+    void QueryPool::reset(u32 start_index, u32 count)
+    {
+        check_result(
+            daxa_query_pool_reset(rc_cast<daxa_QueryPool>(this->object), start_index, count),
+            "failed to reset queries of query pool");
+    }
+
+    auto QueryPool::inc_refcnt(ImplHandle const * object) -> u64
+    {
+        return daxa_query_pool_inc_refcnt(rc_cast<daxa_QueryPool>(object));
+    }
+
+    auto QueryPool::dec_refcnt(ImplHandle const * object) -> u64
+    {
+        return daxa_query_pool_dec_refcnt(rc_cast<daxa_QueryPool>(object));
+    }
+
+    /// --- End QueryPool ---
+
     /// --- Begin Swapchain ---
 
     void Swapchain::resize()
@@ -822,6 +1036,25 @@ namespace daxa
         return std::pair{gpu_value, cpu_value};
     }
 
+    auto Swapchain::presented_image() const -> ImageId
+    {
+        return std::bit_cast<ImageId>(daxa_swp_presented_image(rc_cast<daxa_Swapchain>(this->object)));
+    }
+
+    void Swapchain::pace_frame()
+    {
+        check_result(
+            daxa_swp_pace_frame(r_cast<daxa_Swapchain>(this->object)),
+            "failed to pace frame");
+    }
+
+    auto Swapchain::frame_pacing_statistics() const -> FramePacingStatistics
+    {
+        FramePacingStatistics ret = {};
+        daxa_swp_frame_pacing_statistics(rc_cast<daxa_Swapchain>(this->object), r_cast<daxa_FramePacingStatistics *>(&ret));
+        return ret;
+    }
+
     auto Swapchain::info() const -> SwapchainInfo const &
     {
         return *r_cast<SwapchainInfo const *>(daxa_swp_info(rc_cast<daxa_Swapchain>(this->object)));
@@ -1033,6 +1266,9 @@ namespace daxa
         check_result(result, "failed in push_constant_vptr");
     }
 
+    DAXA_DECL_RENDER_COMMAND_LIST_WRAPPER_CHECK_RESULT(begin_query, BeginQueryInfo)
+    DAXA_DECL_RENDER_COMMAND_LIST_WRAPPER(end_query, EndQueryInfo)
+
     /// --- End RenderCommandBuffer
 
     /// --- Begin CommandRecorder ---
@@ -1069,6 +1305,7 @@ namespace daxa
     }
     DAXA_DECL_COMMAND_LIST_WRAPPER(TransferCommandRecorder, pipeline_barrier, MemoryBarrierInfo)
     DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(TransferCommandRecorder, pipeline_barrier_image_transition, ImageMemoryBarrierInfo)
+    DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(TransferCommandRecorder, pipeline_buffer_barrier, BufferMemoryBarrierInfo)
     DAXA_DECL_COMMAND_LIST_WRAPPER(TransferCommandRecorder, signal_event, EventSignalInfo)
 
     void TransferCommandRecorder::wait_events(std::span<EventWaitInfo const> const & infos)
@@ -1092,6 +1329,8 @@ namespace daxa
     DAXA_DECL_COMMAND_LIST_DESTROY_DEFERRED_FN(image, Image)
     DAXA_DECL_COMMAND_LIST_DESTROY_DEFERRED_FN(image_view, ImageView)
     DAXA_DECL_COMMAND_LIST_DESTROY_DEFERRED_FN(sampler, Sampler)
+    DAXA_DECL_COMMAND_LIST_DESTROY_DEFERRED_FN(tlas, Tlas)
+    DAXA_DECL_COMMAND_LIST_DESTROY_DEFERRED_FN(blas, Blas)
 
     void ComputeCommandRecorder::push_constant_vptr(PushConstantInfo const & info)
     {
@@ -1117,8 +1356,15 @@ namespace daxa
     }
 
     DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(ComputeCommandRecorder, dispatch_indirect, DispatchIndirectInfo)
+    DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(ComputeCommandRecorder, dispatch_indirect_batch, DispatchIndirectBatchInfo)
     DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(ComputeCommandRecorder, trace_rays, TraceRaysInfo)
     DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(ComputeCommandRecorder, trace_rays_indirect, TraceRaysIndirectInfo)
+    DAXA_DECL_COMMAND_LIST_WRAPPER(ComputeCommandRecorder, reset_queries, ResetQueriesInfo)
+    DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(ComputeCommandRecorder, begin_query, BeginQueryInfo)
+    DAXA_DECL_COMMAND_LIST_WRAPPER(ComputeCommandRecorder, end_query, EndQueryInfo)
+    DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(ComputeCommandRecorder, copy_query_pool_results, CopyQueryPoolResultsInfo)
+    DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(ComputeCommandRecorder, write_blas_compacted_sizes, WriteBlasCompactedSizesInfo)
+    DAXA_DECL_COMMAND_LIST_WRAPPER_CHECK_RESULT(ComputeCommandRecorder, copy_blas, CopyBlasInfo)
 
     void ComputeCommandRecorder::set_pipeline(RayTracingPipeline const & pipeline)
     {
@@ -1147,6 +1393,14 @@ namespace daxa
         daxa_cmd_end_label(this->internal);
     }
 
+    auto TransferCommandRecorder::record_defragmentation_pass() -> u32
+    {
+        u32 ret = {};
+        auto result = daxa_cmd_record_defragmentation_pass(this->internal, &ret);
+        check_result(result, "failed to record defragmentation pass");
+        return ret;
+    }
+
     auto TransferCommandRecorder::complete_current_commands() -> ExecutableCommandList
     {
         ExecutableCommandList ret = {};
@@ -1160,6 +1414,11 @@ namespace daxa
         return *r_cast<CommandRecorderInfo const *>(daxa_cmd_info(*rc_cast<daxa_CommandRecorder *>(this)));
     }
 
+    auto TransferCommandRecorder::statistics() const -> CommandRecorderStatistics const &
+    {
+        return *r_cast<CommandRecorderStatistics const *>(daxa_cmd_statistics(*rc_cast<daxa_CommandRecorder *>(this)));
+    }
+
     TransferCommandRecorder::~TransferCommandRecorder()
     {
         if (this->internal != nullptr)
@@ -1205,6 +1464,22 @@ namespace daxa
                            to_string(info.image_id));
     }
 
+    auto to_string(BufferMemoryBarrierInfo const & info) -> std::string
+    {
+        auto queue_family_string = [](Optional<QueueFamily> const & family) -> std::string_view
+        {
+            return family.has_value() ? to_string(family.value()) : "IGNORED";
+        };
+        return fmt::format("access: ({}) -> ({}), queue family: ({}) -> ({}), offset: {}, size: {}, id: {}",
+                           to_string(info.src_access),
+                           to_string(info.dst_access),
+                           queue_family_string(info.src_queue_family),
+                           queue_family_string(info.dst_queue_family),
+                           info.offset,
+                           info.size,
+                           to_string(info.buffer_id));
+    }
+
     auto to_string(AccessTypeFlags flags) -> std::string
     {
         if (flags == AccessTypeFlagBits::NONE)
@@ -1,6 +1,7 @@
 #include "impl_command_recorder.hpp"
 
 #include <daxa/c/types.h>
+#include <cstring>
 #include <utility>
 
 #include "impl_sync.hpp"
@@ -375,6 +376,18 @@ auto daxa_cmd_blit_image_to_image(daxa_CommandRecorder self, daxa_ImageBlitInfo
     return DAXA_RESULT_SUCCESS;
 }
 
+// Reused between builds, so that recording many small builds does not allocate.
+struct AccelerationStructureBuildBuffers
+{
+    std::vector<VkAccelerationStructureBuildGeometryInfoKHR> vk_build_geometry_infos = {};
+    std::vector<VkAccelerationStructureGeometryKHR> vk_geometry_infos = {};
+    std::vector<u32> primitive_counts = {};
+    std::vector<u32 const *> primitive_counts_ptrs = {};
+    std::vector<VkAccelerationStructureBuildRangeInfoKHR> vk_build_ranges = {};
+    std::vector<VkAccelerationStructureBuildRangeInfoKHR const *> vk_build_ranges_ptrs = {};
+};
+inline static thread_local AccelerationStructureBuildBuffers tl_as_build_buffers = {}; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
 auto daxa_cmd_build_acceleration_structures(daxa_CommandRecorder self, daxa_BuildAccelerationStucturesInfo const * info) -> daxa_Result
 {
     daxa_Result result = DAXA_RESULT_SUCCESS;
@@ -387,24 +400,63 @@ auto daxa_cmd_build_acceleration_structures(daxa_CommandRecorder self, daxa_Buil
     for (auto const & tb_info : std::span{info->tlas_build_infos, info->tlas_build_info_count})
     {
         _DAXA_CHECK_IDS(self, tb_info.dst_tlas)
+        if (tb_info.update)
+        {
+            // Updates must use the same flags as the build of the source, which must allow updates.
+            if ((tb_info.flags & DAXA_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE) == 0)
+            {
+                return DAXA_RESULT_ERROR_ACCELERATION_STRUCTURE_UPDATE_WITHOUT_ALLOW_UPDATE;
+            }
+            if (tb_info.src_tlas.value != 0)
+            {
+                _DAXA_CHECK_IDS(self, tb_info.src_tlas)
+            }
+        }
     }
     for (auto const & bb_info : std::span{info->blas_build_infos, info->blas_build_info_count})
     {
         _DAXA_CHECK_IDS(self, bb_info.dst_blas)
+        if (bb_info.update)
+        {
+            if ((bb_info.flags & DAXA_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE) == 0)
+            {
+                return DAXA_RESULT_ERROR_ACCELERATION_STRUCTURE_UPDATE_WITHOUT_ALLOW_UPDATE;
+            }
+            if (bb_info.src_blas.value != 0)
+            {
+                _DAXA_CHECK_IDS(self, bb_info.src_blas)
+            }
+        }
     }
     for (auto const & tb_info : std::span{info->tlas_build_infos, info->tlas_build_info_count})
     {
         _DAXA_REMEMBER_IDS(self, tb_info.dst_tlas)
+        if (tb_info.update && tb_info.src_tlas.value != 0)
+        {
+            _DAXA_REMEMBER_IDS(self, tb_info.src_tlas)
+        }
     }
     for (auto const & bb_info : std::span{info->blas_build_infos, info->blas_build_info_count})
     {
         _DAXA_REMEMBER_IDS(self, bb_info.dst_blas)
+        if (bb_info.update && bb_info.src_blas.value != 0)
+        {
+            _DAXA_REMEMBER_IDS(self, bb_info.src_blas)
+        }
     }
     // TODO(Raytracing): properties validation!
-    std::vector<VkAccelerationStructureBuildGeometryInfoKHR> vk_build_geometry_infos;
-    std::vector<VkAccelerationStructureGeometryKHR> vk_geometry_infos;
-    std::vector<u32> primitive_counts;
-    std::vector<u32 const *> primitive_counts_ptrs;
+    auto & vk_build_geometry_infos = tl_as_build_buffers.vk_build_geometry_infos;
+    auto & vk_geometry_infos = tl_as_build_buffers.vk_geometry_infos;
+    auto & primitive_counts = tl_as_build_buffers.primitive_counts;
+    auto & primitive_counts_ptrs = tl_as_build_buffers.primitive_counts_ptrs;
+    auto & vk_build_ranges = tl_as_build_buffers.vk_build_ranges;
+    auto & vk_build_ranges_ptrs = tl_as_build_buffers.vk_build_ranges_ptrs;
+    vk_build_geometry_infos.clear();
+    vk_geometry_infos.clear();
+    primitive_counts.clear();
+    primitive_counts_ptrs.clear();
+    vk_build_ranges.clear();
+    vk_build_ranges_ptrs.clear();
     daxa_as_build_info_to_vk(
         self->device,
         info->tlas_build_infos,
@@ -416,7 +468,6 @@ auto daxa_cmd_build_acceleration_structures(daxa_CommandRecorder self, daxa_Buil
         primitive_counts,
         primitive_counts_ptrs);
     // Convert the primitive count arrays to build range arrays:
-    std::vector<VkAccelerationStructureBuildRangeInfoKHR> vk_build_ranges;
     vk_build_ranges.reserve(primitive_counts.size());
     for (auto prim_count : primitive_counts)
     {
@@ -427,7 +478,6 @@ auto daxa_cmd_build_acceleration_structures(daxa_CommandRecorder self, daxa_Buil
             .transformOffset = {},
         });
     }
-    std::vector<VkAccelerationStructureBuildRangeInfoKHR const *> vk_build_ranges_ptrs;
     vk_build_ranges_ptrs.reserve(primitive_counts_ptrs.size());
     for (auto const * prim_counts_ptr : primitive_counts_ptrs)
     {
@@ -502,18 +552,92 @@ auto daxa_cmd_clear_image(daxa_CommandRecorder self, daxa_ImageClearInfo const *
 /// @param info parameters.
 void daxa_cmd_pipeline_barrier(daxa_CommandRecorder self, daxa_MemoryBarrierInfo const * info)
 {
-    if (self->memory_barrier_batch_count == COMMAND_LIST_BARRIER_MAX_BATCH_SIZE)
+    // Global memory barriers within one vkCmdPipelineBarrier2 all apply to the same point in the command stream.
+    // Merging them into one barrier over the union of their masks is equivalent or slightly more conservative.
+    if (!self->memory_barrier_batch.has_value())
     {
-        daxa_cmd_flush_barriers(self);
+        self->memory_barrier_batch = VkMemoryBarrier2{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+            .pNext = nullptr,
+        };
     }
-    self->memory_barrier_batch.at(self->memory_barrier_batch_count++) = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
-        .pNext = nullptr,
-        .srcStageMask = info->src_access.stages,
-        .srcAccessMask = info->src_access.access_type,
-        .dstStageMask = info->dst_access.stages,
-        .dstAccessMask = info->dst_access.access_type,
+    auto & barrier = self->memory_barrier_batch.value();
+    barrier.srcStageMask |= info->src_access.stages;
+    barrier.srcAccessMask |= info->src_access.access_type;
+    barrier.dstStageMask |= info->dst_access.stages;
+    barrier.dstAccessMask |= info->dst_access.access_type;
+}
+
+// Returns true and writes the union to a when the two ranges form one range.
+// This is the case when they cover the same mips and touching or overlapping layers, or the other way around.
+static auto try_merge_subresource_ranges(VkImageSubresourceRange & a, VkImageSubresourceRange const & b) -> bool
+{
+    if (a.aspectMask != b.aspectMask ||
+        a.levelCount == VK_REMAINING_MIP_LEVELS || b.levelCount == VK_REMAINING_MIP_LEVELS ||
+        a.layerCount == VK_REMAINING_ARRAY_LAYERS || b.layerCount == VK_REMAINING_ARRAY_LAYERS)
+    {
+        return false;
+    }
+    auto touching = [](u32 a_base, u32 a_count, u32 b_base, u32 b_count)
+    {
+        return a_base <= b_base + b_count && b_base <= a_base + a_count;
     };
+    if (a.baseMipLevel == b.baseMipLevel && a.levelCount == b.levelCount &&
+        touching(a.baseArrayLayer, a.layerCount, b.baseArrayLayer, b.layerCount))
+    {
+        u32 const end = std::max(a.baseArrayLayer + a.layerCount, b.baseArrayLayer + b.layerCount);
+        a.baseArrayLayer = std::min(a.baseArrayLayer, b.baseArrayLayer);
+        a.layerCount = end - a.baseArrayLayer;
+        return true;
+    }
+    if (a.baseArrayLayer == b.baseArrayLayer && a.layerCount == b.layerCount &&
+        touching(a.baseMipLevel, a.levelCount, b.baseMipLevel, b.levelCount))
+    {
+        u32 const end = std::max(a.baseMipLevel + a.levelCount, b.baseMipLevel + b.levelCount);
+        a.baseMipLevel = std::min(a.baseMipLevel, b.baseMipLevel);
+        a.levelCount = end - a.baseMipLevel;
+        return true;
+    }
+    return false;
+}
+
+// Two image barriers can be merged when they transition the same image between the same layouts.
+// Their stage and access masks are united, the subresource ranges must form one range.
+static auto try_merge_image_barriers(VkImageMemoryBarrier2 & a, VkImageMemoryBarrier2 const & b) -> bool
+{
+    if (a.image != b.image || a.oldLayout != b.oldLayout || a.newLayout != b.newLayout ||
+        a.srcQueueFamilyIndex != b.srcQueueFamilyIndex || a.dstQueueFamilyIndex != b.dstQueueFamilyIndex ||
+        !try_merge_subresource_ranges(a.subresourceRange, b.subresourceRange))
+    {
+        return false;
+    }
+    a.srcStageMask |= b.srcStageMask;
+    a.srcAccessMask |= b.srcAccessMask;
+    a.dstStageMask |= b.dstStageMask;
+    a.dstAccessMask |= b.dstAccessMask;
+    return true;
+}
+
+static void add_image_barrier_to_batch(daxa_CommandRecorder self, VkImageMemoryBarrier2 barrier)
+{
+    auto & batch = self->image_barrier_batch;
+    // A merge can make the grown range adjacent to another barrier in the batch, so keep merging until nothing changes.
+    // Barriers of one image are usually recorded close together, searching from the back finds them first.
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (usize i = batch.size(); i > 0; --i)
+        {
+            if (try_merge_image_barriers(barrier, batch[i - 1]))
+            {
+                batch.erase(batch.begin() + static_cast<isize>(i - 1));
+                merged = true;
+                break;
+            }
+        }
+    }
+    batch.push_back(barrier);
 }
 
 /// @brief  Successive pipeline barrier calls are combined.
@@ -522,12 +646,8 @@ void daxa_cmd_pipeline_barrier(daxa_CommandRecorder self, daxa_MemoryBarrierInfo
 auto daxa_cmd_pipeline_barrier_image_transition(daxa_CommandRecorder self, daxa_ImageMemoryBarrierInfo const * info) -> daxa_Result
 {
     DAXA_CHECK_AND_REMEMBER_IDS(self, info->image_id)
-    if (self->image_barrier_batch_count == COMMAND_LIST_BARRIER_MAX_BATCH_SIZE)
-    {
-        daxa_cmd_flush_barriers(self);
-    }
     auto const & img_slot = self->device->slot(info->image_id);
-    self->image_barrier_batch.at(self->image_barrier_batch_count++) = {
+    add_image_barrier_to_batch(self, VkImageMemoryBarrier2{
         .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
         .pNext = nullptr,
         .srcStageMask = info->src_access.stages,
@@ -540,9 +660,85 @@ auto daxa_cmd_pipeline_barrier_image_transition(daxa_CommandRecorder self, daxa_
         .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
         .image = img_slot.vk_image,
         .subresourceRange = make_subresource_range(info->image_slice, img_slot.aspect_flags),
+    });
+    return DAXA_RESULT_SUCCESS;
+}
+
+// Two buffer barriers can be merged when they cover touching ranges of the same buffer with the same queue family transfer.
+static auto try_merge_buffer_barriers(VkBufferMemoryBarrier2 & a, VkBufferMemoryBarrier2 const & b) -> bool
+{
+    auto range_end = [](VkBufferMemoryBarrier2 const & barrier)
+    {
+        return barrier.size == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : barrier.offset + barrier.size;
+    };
+    VkDeviceSize const a_end = range_end(a);
+    VkDeviceSize const b_end = range_end(b);
+    if (a.buffer != b.buffer ||
+        a.srcQueueFamilyIndex != b.srcQueueFamilyIndex || a.dstQueueFamilyIndex != b.dstQueueFamilyIndex ||
+        a.offset > b_end || b.offset > a_end)
+    {
+        return false;
+    }
+    VkDeviceSize const end = std::max(a_end, b_end);
+    a.offset = std::min(a.offset, b.offset);
+    a.size = end == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : end - a.offset;
+    a.srcStageMask |= b.srcStageMask;
+    a.srcAccessMask |= b.srcAccessMask;
+    a.dstStageMask |= b.dstStageMask;
+    a.dstAccessMask |= b.dstAccessMask;
+    return true;
+}
+
+auto daxa_cmd_pipeline_buffer_barrier(daxa_CommandRecorder self, daxa_BufferMemoryBarrierInfo const * info) -> daxa_Result
+{
+    DAXA_CHECK_AND_REMEMBER_IDS(self, info->buffer_id)
+    auto const & buffer_slot = self->device->slot(info->buffer_id);
+    u32 src_queue_family_index = VK_QUEUE_FAMILY_IGNORED;
+    u32 dst_queue_family_index = VK_QUEUE_FAMILY_IGNORED;
+    if (buffer_slot.info.sharing_mode == DAXA_SHARING_MODE_EXCLUSIVE &&
+        info->src_queue_family.has_value && info->dst_queue_family.has_value)
+    {
+        src_queue_family_index = self->device->queue_families[info->src_queue_family.value].vk_index;
+        dst_queue_family_index = self->device->queue_families[info->dst_queue_family.value].vk_index;
+        // Families without queues can not own anything, treat these like same family barriers.
+        if (src_queue_family_index == dst_queue_family_index || src_queue_family_index == ~0u || dst_queue_family_index == ~0u)
+        {
+            src_queue_family_index = VK_QUEUE_FAMILY_IGNORED;
+            dst_queue_family_index = VK_QUEUE_FAMILY_IGNORED;
+        }
+    }
+    VkBufferMemoryBarrier2 barrier{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+        .pNext = nullptr,
+        .srcStageMask = info->src_access.stages,
+        .srcAccessMask = info->src_access.access_type,
+        .dstStageMask = info->dst_access.stages,
+        .dstAccessMask = info->dst_access.access_type,
+        .srcQueueFamilyIndex = src_queue_family_index,
+        .dstQueueFamilyIndex = dst_queue_family_index,
+        .buffer = buffer_slot.vk_buffer,
+        .offset = info->offset,
+        .size = info->size,
     };
+    auto & batch = self->buffer_barrier_batch;
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (usize i = batch.size(); i > 0; --i)
+        {
+            if (try_merge_buffer_barriers(barrier, batch[i - 1]))
+            {
+                batch.erase(batch.begin() + static_cast<isize>(i - 1));
+                merged = true;
+                break;
+            }
+        }
+    }
+    batch.push_back(barrier);
     return DAXA_RESULT_SUCCESS;
 }
+
 struct SplitBarrierDependencyInfoBuffer
 {
     std::vector<VkImageMemoryBarrier2> vk_image_memory_barriers = {};
@@ -633,57 +829,119 @@ void daxa_cmd_reset_event(daxa_CommandRecorder self, daxa_ResetEventInfo const *
 auto daxa_cmd_push_constant(daxa_CommandRecorder self, daxa_PushConstantInfo const * info) -> daxa_Result
 {
     daxa_cmd_flush_barriers(self);
-    if (daxa::holds_alternative<daxa_ImplCommandRecorder::NoPipeline>(self->current_pipeline))
+    if (self->current_vk_pipeline_layout == VK_NULL_HANDLE)
     {
         return DAXA_RESULT_NO_PIPELINE_BOUND;
     }
-    VkPipelineLayout vk_pipeline_layout = {};
-    u32 current_pipeline_push_constant_size = {};
-    if (auto * pipeline = daxa::get_if<daxa_ComputePipeline>(&self->current_pipeline))
+    if (self->current_push_constant_size < (info->offset + info->size))
     {
-        current_pipeline_push_constant_size = (**pipeline).info.push_constant_size;
-        vk_pipeline_layout = (**pipeline).vk_pipeline_layout;
+        return DAXA_RESULT_PUSHCONSTANT_RANGE_EXCEEDED;
     }
-    if (auto * pipeline = daxa::get_if<daxa_RasterPipeline>(&self->current_pipeline))
+    auto & state = self->push_constant_state;
+    auto const * src = static_cast<std::byte const *>(info->data);
+    auto * dst = state.shadow.data() + info->offset;
+    u32 const size = static_cast<u32>(info->size);
+    // Only the range between the first and last changed byte needs to be uploaded.
+    // Bytes that were never pushed are always changed, the gpu has not seen them yet.
+    u32 const unwritten_begin = std::max(state.written_end, info->offset) - info->offset;
+    u32 changed_begin = 0;
+    while (changed_begin < std::min(size, unwritten_begin) && src[changed_begin] == dst[changed_begin])
     {
-        current_pipeline_push_constant_size = (**pipeline).info.push_constant_size;
-        vk_pipeline_layout = (**pipeline).vk_pipeline_layout;
+        ++changed_begin;
     }
-    if (auto * pipeline = daxa::get_if<daxa_RayTracingPipeline>(&self->current_pipeline))
+    u32 changed_end = size;
+    while (changed_end > changed_begin && changed_end <= unwritten_begin && src[changed_end - 1] == dst[changed_end - 1])
     {
-        current_pipeline_push_constant_size = (**pipeline).info.push_constant_size;
-        vk_pipeline_layout = (**pipeline).vk_pipeline_layout;
+        --changed_end;
     }
-    if (current_pipeline_push_constant_size < (info->offset + info->size))
+    if (changed_begin == changed_end)
     {
-        return DAXA_RESULT_PUSHCONSTANT_RANGE_EXCEEDED;
+        self->statistics.elided_push_constants += 1;
+        return DAXA_RESULT_SUCCESS;
     }
-    vkCmdPushConstants(self->current_command_data.vk_cmd_buffer, vk_pipeline_layout, VK_SHADER_STAGE_ALL, info->offset, static_cast<u32>(info->size), info->data);
+    std::memcpy(dst + changed_begin, src + changed_begin, changed_end - changed_begin);
+    state.written_end = std::max(state.written_end, info->offset + size);
+    state.dirty_begin = std::min(state.dirty_begin, info->offset + changed_begin);
+    state.dirty_end = std::max(state.dirty_end, info->offset + changed_end);
     return DAXA_RESULT_SUCCESS;
 }
 
+// Called before every draw, dispatch and trace rays call.
+static void flush_push_constants(daxa_CommandRecorder self)
+{
+    auto & state = self->push_constant_state;
+    if (state.vk_uploaded_pipeline_layout != self->current_vk_pipeline_layout)
+    {
+        state.dirty_begin = 0;
+        state.dirty_end = state.written_end;
+        state.vk_uploaded_pipeline_layout = self->current_vk_pipeline_layout;
+    }
+    // Pipelines share a layout when their push constant sizes round up to the same word count.
+    u32 const layout_push_constant_size = (self->current_push_constant_size + 3) & ~3u;
+    u32 const begin = state.dirty_begin & ~3u;
+    u32 const end = std::min((state.dirty_end + 3) & ~3u, layout_push_constant_size);
+    if (begin < end)
+    {
+        vkCmdPushConstants(self->current_command_data.vk_cmd_buffer, self->current_vk_pipeline_layout, VK_SHADER_STAGE_ALL, begin, end - begin, state.shadow.data() + begin);
+        self->statistics.push_constant_uploads += 1;
+        self->statistics.push_constant_bytes_uploaded += end - begin;
+    }
+    state.dirty_begin = MAX_PUSH_CONSTANT_BYTE_SIZE;
+    state.dirty_end = 0;
+}
+
+static void bind_pipeline_and_descriptor_set(daxa_CommandRecorder self, usize bind_point_index, VkPipelineBindPoint vk_bind_point, VkPipeline vk_pipeline, VkPipelineLayout vk_pipeline_layout)
+{
+    auto & state = self->bind_point_states.at(bind_point_index);
+    if (state.vk_pipeline_layout != vk_pipeline_layout)
+    {
+        vkCmdBindDescriptorSets(self->current_command_data.vk_cmd_buffer, vk_bind_point, vk_pipeline_layout, 0, 1, &self->device->gpu_sro_table.vk_descriptor_set, 0, nullptr);
+        state.vk_pipeline_layout = vk_pipeline_layout;
+        self->statistics.descriptor_set_binds += 1;
+    }
+    else
+    {
+        self->statistics.elided_descriptor_set_binds += 1;
+    }
+    if (state.vk_pipeline != vk_pipeline)
+    {
+        vkCmdBindPipeline(self->current_command_data.vk_cmd_buffer, vk_bind_point, vk_pipeline);
+        state.vk_pipeline = vk_pipeline;
+        self->statistics.pipeline_binds += 1;
+    }
+    else
+    {
+        self->statistics.elided_pipeline_binds += 1;
+    }
+}
+
+// Barriers are still flushed here, as dispatches and trace rays calls do not flush them on their own.
+// This is free when no barriers are pending.
 void daxa_cmd_set_ray_tracing_pipeline(daxa_CommandRecorder self, daxa_RayTracingPipeline pipeline)
 {
     daxa_cmd_flush_barriers(self);
     self->current_pipeline = pipeline;
-    vkCmdBindDescriptorSets(self->current_command_data.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipeline->vk_pipeline_layout, 0, 1, &self->device->gpu_sro_table.vk_descriptor_set, 0, nullptr);
-    vkCmdBindPipeline(self->current_command_data.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipeline->vk_pipeline);
+    self->current_vk_pipeline_layout = pipeline->vk_pipeline_layout;
+    self->current_push_constant_size = pipeline->info.push_constant_size;
+    bind_pipeline_and_descriptor_set(self, 2, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipeline->vk_pipeline, pipeline->vk_pipeline_layout);
 }
 
 void daxa_cmd_set_compute_pipeline(daxa_CommandRecorder self, daxa_ComputePipeline pipeline)
 {
     daxa_cmd_flush_barriers(self);
     self->current_pipeline = pipeline;
-    vkCmdBindDescriptorSets(self->current_command_data.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->vk_pipeline_layout, 0, 1, &self->device->gpu_sro_table.vk_descriptor_set, 0, nullptr);
-    vkCmdBindPipeline(self->current_command_data.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->vk_pipeline);
+    self->current_vk_pipeline_layout = pipeline->vk_pipeline_layout;
+    self->current_push_constant_size = pipeline->info.push_constant_size;
+    bind_pipeline_and_descriptor_set(self, 1, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->vk_pipeline, pipeline->vk_pipeline_layout);
 }
 
 void daxa_cmd_set_raster_pipeline(daxa_CommandRecorder self, daxa_RasterPipeline pipeline)
 {
     daxa_cmd_flush_barriers(self);
     self->current_pipeline = pipeline;
-    vkCmdBindDescriptorSets(self->current_command_data.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->vk_pipeline_layout, 0, 1, &self->device->gpu_sro_table.vk_descriptor_set, 0, nullptr);
-    vkCmdBindPipeline(self->current_command_data.vk_cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->vk_pipeline);
+    self->current_vk_pipeline_layout = pipeline->vk_pipeline_layout;
+    self->current_push_constant_size = pipeline->info.push_constant_size;
+    bind_pipeline_and_descriptor_set(self, 0, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->vk_pipeline, pipeline->vk_pipeline_layout);
 }
 
 auto daxa_cmd_trace_rays(daxa_CommandRecorder self, daxa_TraceRaysInfo const * info) -> daxa_Result
@@ -693,6 +951,7 @@ auto daxa_cmd_trace_rays(daxa_CommandRecorder self, daxa_TraceRaysInfo const * i
     {
         return DAXA_RESULT_NO_RAYTRACING_PIPELINE_BOUND;
     }
+    flush_push_constants(self);
     auto const & binding_table = info->shader_binding_table;
     auto raygen_handle = binding_table.raygen_region;
     raygen_handle.deviceAddress += binding_table.raygen_region.stride * info->raygen_handle_offset;
@@ -719,6 +978,7 @@ auto daxa_cmd_trace_rays_indirect(daxa_CommandRecorder self, daxa_TraceRaysIndir
     {
         return DAXA_RESULT_NO_RAYTRACING_PIPELINE_BOUND;
     }
+    flush_push_constants(self);
     auto const & binding_table = info->shader_binding_table;
     auto raygen_handle = binding_table.raygen_region;
     raygen_handle.deviceAddress += binding_table.raygen_region.stride * info->raygen_handle_offset;
@@ -745,6 +1005,7 @@ auto daxa_cmd_dispatch(daxa_CommandRecorder self, daxa_DispatchInfo const * info
     {
         return DAXA_RESULT_NO_COMPUTE_PIPELINE_BOUND;
     }
+    flush_push_constants(self);
     vkCmdDispatch(self->current_command_data.vk_cmd_buffer, info->x, info->y, info->z);
     return DAXA_RESULT_SUCCESS;
 }
@@ -756,10 +1017,70 @@ auto daxa_cmd_dispatch_indirect(daxa_CommandRecorder self, daxa_DispatchIndirect
     {
         return DAXA_RESULT_NO_COMPUTE_PIPELINE_BOUND;
     }
+    flush_push_constants(self);
     vkCmdDispatchIndirect(self->current_command_data.vk_cmd_buffer, self->device->slot(info->indirect_buffer).vk_buffer, info->offset);
     return DAXA_RESULT_SUCCESS;
 }
 
+auto daxa_cmd_dispatch_indirect_batch(daxa_CommandRecorder self, daxa_DispatchIndirectBatchInfo const * info) -> daxa_Result
+{
+    DAXA_CHECK_AND_REMEMBER_IDS(self, info->indirect_buffer)
+    if (!daxa::holds_alternative<daxa_ComputePipeline>(self->current_pipeline))
+    {
+        return DAXA_RESULT_NO_COMPUTE_PIPELINE_BOUND;
+    }
+    // Indirect dispatch commands are three tightly packed u32, read from 4 byte aligned offsets.
+    if (info->stride < sizeof(VkDispatchIndirectCommand) || info->stride % 4 != 0)
+    {
+        return DAXA_RESULT_INVALID_BUFFER_RANGE;
+    }
+    if (info->offset % 4 != 0)
+    {
+        return DAXA_RESULT_INVALID_BUFFER_OFFSET;
+    }
+    if (info->dispatch_count == 0)
+    {
+        return DAXA_RESULT_SUCCESS;
+    }
+    ImplBufferSlot const & indirect_slot = self->device->slot(info->indirect_buffer);
+    u64 const batch_end = static_cast<u64>(info->offset) + static_cast<u64>(info->dispatch_count - 1) * info->stride + sizeof(VkDispatchIndirectCommand);
+    if (batch_end > static_cast<u64>(indirect_slot.info.size))
+    {
+        return DAXA_RESULT_ERROR_COPY_OUT_OF_BOUNDS;
+    }
+    daxa_cmd_flush_barriers(self);
+    flush_push_constants(self);
+    VkBuffer const vk_buffer = indirect_slot.vk_buffer;
+    VkMemoryBarrier2 const vk_chain_barrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .pNext = nullptr,
+        .srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        .srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+        .dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+    };
+    VkDependencyInfo const vk_chain_dependency_info{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .pNext = nullptr,
+        .dependencyFlags = {},
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &vk_chain_barrier,
+        .bufferMemoryBarrierCount = 0,
+        .pBufferMemoryBarriers = nullptr,
+        .imageMemoryBarrierCount = 0,
+        .pImageMemoryBarriers = nullptr,
+    };
+    for (u32 i = 0; i < info->dispatch_count; ++i)
+    {
+        if (info->chained != 0 && i > 0)
+        {
+            vkCmdPipelineBarrier2(self->current_command_data.vk_cmd_buffer, &vk_chain_dependency_info);
+        }
+        vkCmdDispatchIndirect(self->current_command_data.vk_cmd_buffer, vk_buffer, info->offset + static_cast<VkDeviceSize>(i) * info->stride);
+    }
+    return DAXA_RESULT_SUCCESS;
+}
+
 auto daxa_cmd_destroy_buffer_deferred(daxa_CommandRecorder self, daxa_BufferId id) -> daxa_Result
 {
     DAXA_CHECK_AND_REMEMBER_IDS(self, id)
@@ -788,6 +1109,20 @@ auto daxa_cmd_destroy_sampler_deferred(daxa_CommandRecorder self, daxa_SamplerId
     return DAXA_RESULT_SUCCESS;
 }
 
+auto daxa_cmd_destroy_tlas_deferred(daxa_CommandRecorder self, daxa_TlasId id) -> daxa_Result
+{
+    DAXA_CHECK_AND_REMEMBER_IDS(self, id)
+    self->current_command_data.deferred_destructions.emplace_back(std::bit_cast<GPUResourceId>(id), DEFERRED_DESTRUCTION_TLAS_INDEX);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_cmd_destroy_blas_deferred(daxa_CommandRecorder self, daxa_BlasId id) -> daxa_Result
+{
+    DAXA_CHECK_AND_REMEMBER_IDS(self, id)
+    self->current_command_data.deferred_destructions.emplace_back(std::bit_cast<GPUResourceId>(id), DEFERRED_DESTRUCTION_BLAS_INDEX);
+    return DAXA_RESULT_SUCCESS;
+}
+
 auto daxa_cmd_begin_renderpass(daxa_CommandRecorder self, daxa_RenderPassBeginInfo const * info) -> daxa_Result
 {
     daxa_cmd_flush_barriers(self);
@@ -934,17 +1269,20 @@ auto daxa_cmd_set_index_buffer(daxa_CommandRecorder self, daxa_SetIndexBufferInf
 
 void daxa_cmd_draw(daxa_CommandRecorder self, daxa_DrawInfo const * info)
 {
+    flush_push_constants(self);
     vkCmdDraw(self->current_command_data.vk_cmd_buffer, info->vertex_count, info->instance_count, info->first_vertex, info->first_instance);
 }
 
 void daxa_cmd_draw_indexed(daxa_CommandRecorder self, daxa_DrawIndexedInfo const * info)
 {
+    flush_push_constants(self);
     vkCmdDrawIndexed(self->current_command_data.vk_cmd_buffer, info->index_count, info->instance_count, info->first_index, info->vertex_offset, info->first_instance);
 }
 
 auto daxa_cmd_draw_indirect(daxa_CommandRecorder self, daxa_DrawIndirectInfo const * info) -> daxa_Result
 {
     DAXA_CHECK_AND_REMEMBER_IDS(self, info->indirect_buffer)
+    flush_push_constants(self);
     if (info->is_indexed != 0)
     {
         vkCmdDrawIndexedIndirect(
@@ -969,6 +1307,7 @@ auto daxa_cmd_draw_indirect(daxa_CommandRecorder self, daxa_DrawIndirectInfo con
 auto daxa_cmd_draw_indirect_count(daxa_CommandRecorder self, daxa_DrawIndirectCountInfo const * info) -> daxa_Result
 {
     DAXA_CHECK_AND_REMEMBER_IDS(self, info->indirect_buffer, info->count_buffer)
+    flush_push_constants(self);
     if (info->is_indexed != 0)
     {
         vkCmdDrawIndexedIndirectCount(
@@ -998,6 +1337,7 @@ void daxa_cmd_draw_mesh_tasks(daxa_CommandRecorder self, uint32_t x, uint32_t y,
 {
     if (self->device->properties.implicit_features & DAXA_IMPLICIT_FEATURE_FLAG_MESH_SHADER)
     {
+        flush_push_constants(self);
         self->device->vkCmdDrawMeshTasksEXT(self->current_command_data.vk_cmd_buffer, x, y, z);
     }
 }
@@ -1007,6 +1347,7 @@ auto daxa_cmd_draw_mesh_tasks_indirect(daxa_CommandRecorder self, daxa_DrawMeshT
     DAXA_CHECK_AND_REMEMBER_IDS(self, info->indirect_buffer)
     if (self->device->properties.implicit_features & DAXA_IMPLICIT_FEATURE_FLAG_MESH_SHADER)
     {
+        flush_push_constants(self);
         self->device->vkCmdDrawMeshTasksIndirectEXT(
             self->current_command_data.vk_cmd_buffer,
             self->device->slot(info->indirect_buffer).vk_buffer,
@@ -1024,6 +1365,7 @@ auto daxa_cmd_draw_mesh_tasks_indirect_count(
     DAXA_CHECK_AND_REMEMBER_IDS(self, info->indirect_buffer, info->count_buffer)
     if (self->device->properties.implicit_features & DAXA_IMPLICIT_FEATURE_FLAG_MESH_SHADER)
     {
+        flush_push_constants(self);
         self->device->vkCmdDrawMeshTasksIndirectCountEXT(
             self->current_command_data.vk_cmd_buffer,
             self->device->slot(info->indirect_buffer).vk_buffer,
@@ -1056,6 +1398,151 @@ void daxa_cmd_reset_timestamps(daxa_CommandRecorder self, daxa_ResetTimestampsIn
         info->count);
 }
 
+auto daxa_cmd_begin_query(daxa_CommandRecorder self, daxa_BeginQueryInfo const * info) -> daxa_Result
+{
+    auto const & query_pool = **info->query_pool;
+    if (info->precise)
+    {
+        if (query_pool.info.query_type != QueryType::OCCLUSION)
+        {
+            return DAXA_RESULT_INVALID_QUERY_TYPE;
+        }
+        if ((self->device->properties.implicit_features & DAXA_IMPLICIT_FEATURE_FLAG_PRECISE_OCCLUSION_QUERY) == 0)
+        {
+            return DAXA_RESULT_PRECISE_OCCLUSION_QUERY_NOT_DEVICE_ENABLED;
+        }
+    }
+    daxa_cmd_flush_barriers(self);
+    vkCmdBeginQuery(
+        self->current_command_data.vk_cmd_buffer,
+        query_pool.vk_query_pool,
+        info->query_index,
+        info->precise ? VK_QUERY_CONTROL_PRECISE_BIT : VkQueryControlFlags{});
+    return DAXA_RESULT_SUCCESS;
+}
+
+void daxa_cmd_end_query(daxa_CommandRecorder self, daxa_EndQueryInfo const * info)
+{
+    daxa_cmd_flush_barriers(self);
+    vkCmdEndQuery(
+        self->current_command_data.vk_cmd_buffer,
+        (**info->query_pool).vk_query_pool,
+        info->query_index);
+}
+
+void daxa_cmd_reset_queries(daxa_CommandRecorder self, daxa_ResetQueriesInfo const * info)
+{
+    daxa_cmd_flush_barriers(self);
+    vkCmdResetQueryPool(
+        self->current_command_data.vk_cmd_buffer,
+        (**info->query_pool).vk_query_pool,
+        info->start_index,
+        info->count);
+}
+
+auto daxa_cmd_copy_query_pool_results(daxa_CommandRecorder self, daxa_CopyQueryPoolResultsInfo const * info) -> daxa_Result
+{
+    daxa_cmd_flush_barriers(self);
+    DAXA_CHECK_AND_REMEMBER_IDS(self, info->dst_buffer)
+    auto const & query_pool = **info->query_pool;
+    if (info->start_index + info->count > query_pool.info.query_count)
+    {
+        return DAXA_RESULT_RANGE_OUT_OF_BOUNDS;
+    }
+    // Results are copied as 64 bit values, which requires an 8 byte aligned destination.
+    if (info->dst_offset % sizeof(u64) != 0)
+    {
+        return DAXA_RESULT_INVALID_BUFFER_OFFSET;
+    }
+    u64 const stride = (query_pool.values_per_query + (info->with_availability ? 1ull : 0ull)) * sizeof(u64);
+    ImplBufferSlot const & dst_slot = self->device->slot(info->dst_buffer);
+    if (static_cast<u64>(info->dst_offset) + stride * info->count > static_cast<u64>(dst_slot.info.size))
+    {
+        return DAXA_RESULT_ERROR_COPY_OUT_OF_BOUNDS;
+    }
+    VkQueryResultFlags vk_flags = VK_QUERY_RESULT_64_BIT;
+    vk_flags |= info->wait ? VK_QUERY_RESULT_WAIT_BIT : 0u;
+    vk_flags |= info->with_availability ? VK_QUERY_RESULT_WITH_AVAILABILITY_BIT : 0u;
+    vkCmdCopyQueryPoolResults(
+        self->current_command_data.vk_cmd_buffer,
+        query_pool.vk_query_pool,
+        info->start_index,
+        info->count,
+        dst_slot.vk_buffer,
+        info->dst_offset,
+        stride,
+        vk_flags);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_cmd_write_blas_compacted_sizes(daxa_CommandRecorder self, daxa_WriteBlasCompactedSizesInfo const * info) -> daxa_Result
+{
+    if ((self->device->properties.implicit_features & DAXA_IMPLICIT_FEATURE_FLAG_BASIC_RAY_TRACING) == 0)
+    {
+        return DAXA_RESULT_INVALID_WITHOUT_ENABLING_RAY_TRACING;
+    }
+    daxa_cmd_flush_barriers(self);
+    auto const & query_pool = **info->query_pool;
+    if (query_pool.info.query_type != QueryType::ACCELERATION_STRUCTURE_COMPACTED_SIZE)
+    {
+        return DAXA_RESULT_INVALID_QUERY_TYPE;
+    }
+    if (info->first_query + info->blas_count > query_pool.info.query_count)
+    {
+        return DAXA_RESULT_RANGE_OUT_OF_BOUNDS;
+    }
+    auto const blas_ids = std::span{info->blas, info->blas_count};
+    for (auto const & blas : blas_ids)
+    {
+        _DAXA_CHECK_IDS(self, blas)
+    }
+    std::vector<VkAccelerationStructureKHR> vk_acceleration_structures = {};
+    vk_acceleration_structures.reserve(blas_ids.size());
+    for (auto const & blas : blas_ids)
+    {
+        _DAXA_REMEMBER_IDS(self, blas)
+        vk_acceleration_structures.push_back(self->device->slot(blas).vk_acceleration_structure);
+    }
+    self->device->vkCmdWriteAccelerationStructuresPropertiesKHR(
+        self->current_command_data.vk_cmd_buffer,
+        static_cast<u32>(vk_acceleration_structures.size()),
+        vk_acceleration_structures.data(),
+        VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR,
+        query_pool.vk_query_pool,
+        info->first_query);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_cmd_copy_blas(daxa_CommandRecorder self, daxa_CopyBlasInfo const * info) -> daxa_Result
+{
+    if ((self->device->properties.implicit_features & DAXA_IMPLICIT_FEATURE_FLAG_BASIC_RAY_TRACING) == 0)
+    {
+        return DAXA_RESULT_INVALID_WITHOUT_ENABLING_RAY_TRACING;
+    }
+    daxa_cmd_flush_barriers(self);
+    DAXA_CHECK_AND_REMEMBER_IDS(self, info->src_blas, info->dst_blas)
+    VkCopyAccelerationStructureInfoKHR const vk_copy_info{
+        .sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR,
+        .pNext = nullptr,
+        .src = self->device->slot(info->src_blas).vk_acceleration_structure,
+        .dst = self->device->slot(info->dst_blas).vk_acceleration_structure,
+        .mode = static_cast<VkCopyAccelerationStructureModeKHR>(info->mode),
+    };
+    self->device->vkCmdCopyAccelerationStructureKHR(self->current_command_data.vk_cmd_buffer, &vk_copy_info);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_cmd_record_defragmentation_pass(daxa_CommandRecorder self, uint32_t * out_move_count) -> daxa_Result
+{
+    daxa_cmd_flush_barriers(self);
+    auto result = self->device->record_defragmentation_pass(self->info.queue_family, self->current_command_data.vk_cmd_buffer, *out_move_count);
+    if (*out_move_count > 0)
+    {
+        self->current_command_data.records_defragmentation_pass = true;
+    }
+    return result;
+}
+
 void daxa_cmd_begin_label(daxa_CommandRecorder self, daxa_CommandLabelInfo const * info)
 {
     daxa_cmd_flush_barriers(self);
@@ -1087,24 +1574,29 @@ void daxa_cmd_end_label(daxa_CommandRecorder self)
 
 void daxa_cmd_flush_barriers(daxa_CommandRecorder self)
 {
-    if (self->memory_barrier_batch_count > 0 || self->image_barrier_batch_count > 0)
+    if (self->memory_barrier_batch.has_value() || !self->buffer_barrier_batch.empty() || !self->image_barrier_batch.empty())
     {
         VkDependencyInfo const vk_dependency_info{
             .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
             .pNext = nullptr,
             .dependencyFlags = {},
-            .memoryBarrierCount = static_cast<u32>(self->memory_barrier_batch_count),
-            .pMemoryBarriers = self->memory_barrier_batch.data(),
-            .bufferMemoryBarrierCount = 0,
-            .pBufferMemoryBarriers = nullptr,
-            .imageMemoryBarrierCount = static_cast<u32>(self->image_barrier_batch_count),
+            .memoryBarrierCount = self->memory_barrier_batch.has_value() ? 1u : 0u,
+            .pMemoryBarriers = self->memory_barrier_batch.has_value() ? &self->memory_barrier_batch.value() : nullptr,
+            .bufferMemoryBarrierCount = static_cast<u32>(self->buffer_barrier_batch.size()),
+            .pBufferMemoryBarriers = self->buffer_barrier_batch.data(),
+            .imageMemoryBarrierCount = static_cast<u32>(self->image_barrier_batch.size()),
             .pImageMemoryBarriers = self->image_barrier_batch.data(),
         };
 
         vkCmdPipelineBarrier2(self->current_command_data.vk_cmd_buffer, &vk_dependency_info);
+        self->statistics.pipeline_barrier_batches += 1;
+        self->statistics.memory_barriers += vk_dependency_info.memoryBarrierCount;
+        self->statistics.buffer_barriers += vk_dependency_info.bufferMemoryBarrierCount;
+        self->statistics.image_barriers += vk_dependency_info.imageMemoryBarrierCount;
 
-        self->memory_barrier_batch_count = 0;
-        self->image_barrier_batch_count = 0;
+        self->memory_barrier_batch.reset();
+        self->buffer_barrier_batch.clear();
+        self->image_barrier_batch.clear();
     }
 }
 
@@ -1119,6 +1611,8 @@ auto daxa_cmd_complete_current_commands(
         return std::bit_cast<daxa_Result>(vk_result);
     }
     auto cmd_data = std::move(self->current_command_data);
+    self->current_command_data.records_defragmentation_pass = false;
+    cmd_data.unsubmitted = true;
     auto result = self->generate_new_current_command_data();
     if (result != DAXA_RESULT_SUCCESS)
     {
@@ -1129,7 +1623,10 @@ auto daxa_cmd_complete_current_commands(
         .cmd_recorder = self,
         .data = std::move(cmd_data),
     };
+    self->device->unsubmitted_command_list_count.fetch_add(1, std::memory_order::relaxed);
     self->current_pipeline = daxa_ImplCommandRecorder::NoPipeline{};
+    self->current_vk_pipeline_layout = {};
+    self->current_push_constant_size = {};
     self->inc_refcnt();
     return DAXA_RESULT_SUCCESS;
 }
@@ -1139,8 +1636,16 @@ auto daxa_cmd_info(daxa_CommandRecorder self) -> daxa_CommandRecorderInfo const
     return &self->info;
 }
 
+auto daxa_cmd_statistics(daxa_CommandRecorder self) -> daxa_CommandRecorderStatistics const *
+{
+    return &self->statistics;
+}
+
 auto daxa_cmd_get_vk_command_buffer(daxa_CommandRecorder self) -> VkCommandBuffer
 {
+    self->bind_point_states = {};
+    // Raw commands may push constants or bind pipelines, so everything is uploaded again before the next draw.
+    self->push_constant_state.vk_uploaded_pipeline_layout = {};
     return self->current_command_data.vk_cmd_buffer;
 }
 
@@ -1226,6 +1731,12 @@ void executable_cmd_list_execute_deferred_destructions(daxa_Device device, Execu
         case DEFERRED_DESTRUCTION_SAMPLER_INDEX:
             _ignore = daxa_dvc_destroy_sampler(device, std::bit_cast<daxa_SamplerId>(id));
             break;
+        case DEFERRED_DESTRUCTION_TLAS_INDEX:
+            _ignore = daxa_dvc_destroy_tlas(device, std::bit_cast<daxa_TlasId>(id));
+            break;
+        case DEFERRED_DESTRUCTION_BLAS_INDEX:
+            _ignore = daxa_dvc_destroy_blas(device, std::bit_cast<daxa_BlasId>(id));
+            break;
             // TODO(capi): DO NOT THROW FROM A C FUNCTION
             // default: DAXA_DBG_ASSERT_TRUE_M(false, "unreachable");
         }
@@ -1259,6 +1770,8 @@ auto daxa_ImplCommandRecorder::generate_new_current_command_data() -> daxa_Resul
         return std::bit_cast<daxa_Result>(vk_result);
     }
     this->allocated_command_buffers.push_back(this->current_command_data.vk_cmd_buffer);
+    this->bind_point_states = {};
+    this->push_constant_state = {};
     this->current_command_data.used_buffers.reserve(12);
     this->current_command_data.used_images.reserve(12);
     this->current_command_data.used_image_views.reserve(12);
@@ -1272,6 +1785,10 @@ void daxa_ImplCommandRecorder::zero_ref_callback(ImplHandle const * handle)
     u64 const submit_timeline = self->device->global_submit_timeline.load(std::memory_order::relaxed);
     std::unique_lock const lock{self->device->zombies_mtx};
     executable_cmd_list_execute_deferred_destructions(self->device, self->current_command_data);
+    if (self->current_command_data.records_defragmentation_pass)
+    {
+        self->device->cancel_defragmentation_pass();
+    }
     self->device->command_list_zombies.emplace_front(
         submit_timeline,
         CommandRecorderZombie{
@@ -1288,6 +1805,14 @@ void daxa_ImplExecutableCommandList::zero_ref_callback(ImplHandle const * handle
 {
     auto * self = rc_cast<daxa_ExecutableCommandList>(handle);
     executable_cmd_list_execute_deferred_destructions(self->cmd_recorder->device, self->data);
+    if (self->data.unsubmitted)
+    {
+        self->cmd_recorder->device->unsubmitted_command_list_count.fetch_sub(1, std::memory_order::relaxed);
+    }
+    if (self->data.records_defragmentation_pass)
+    {
+        self->cmd_recorder->device->cancel_defragmentation_pass();
+    }
     self->cmd_recorder->dec_refcnt(
         daxa_ImplCommandRecorder::zero_ref_callback,
         self->cmd_recorder->device->instance);
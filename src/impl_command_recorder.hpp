@@ -16,10 +16,11 @@ static inline constexpr u8 DEFERRED_DESTRUCTION_IMAGE_INDEX = 1;
 static inline constexpr u8 DEFERRED_DESTRUCTION_IMAGE_VIEW_INDEX = 2;
 static inline constexpr u8 DEFERRED_DESTRUCTION_SAMPLER_INDEX = 3;
 static inline constexpr u8 DEFERRED_DESTRUCTION_TIMELINE_QUERY_POOL_INDEX = 4;
+static inline constexpr u8 DEFERRED_DESTRUCTION_TLAS_INDEX = 5;
+static inline constexpr u8 DEFERRED_DESTRUCTION_BLAS_INDEX = 6;
 // TODO: maybe reintroduce this in some fashion?
 // static inline constexpr usize DEFERRED_DESTRUCTION_COUNT_MAX = 32;
 
-static inline constexpr usize COMMAND_LIST_BARRIER_MAX_BATCH_SIZE = 16;
 static inline constexpr usize COMMAND_LIST_COLOR_ATTACHMENT_MAX = 16;
 
 struct CommandPoolPool
@@ -46,6 +47,11 @@ struct ExecutableCommandListData
 {
     VkCommandBuffer vk_cmd_buffer = {};
     std::vector<std::pair<GPUResourceId, u8>> deferred_destructions = {};
+    // The devices defragmentation pass waits for these commands to be submitted.
+    // Destroying them unsubmitted cancels the pass.
+    bool records_defragmentation_pass = {};
+    // Counted in the devices unsubmitted_command_list_count until the first submit or destruction.
+    bool unsubmitted = {};
     // TODO:    These vectors seem to be fast enough. overhead is around 1-4% in cmd recording.
     //          It might be cool to have some slab allocator for these.
     // If there is demand, we could make an instance or cmd list flag to disable the submit checks.
@@ -65,13 +71,40 @@ struct daxa_ImplCommandRecorder final : ImplHandle
     daxa_CommandRecorderInfo info = {};
     VkCommandPool vk_cmd_pool = {};
     std::vector<VkCommandBuffer> allocated_command_buffers = {};
-    std::array<VkMemoryBarrier2, COMMAND_LIST_BARRIER_MAX_BATCH_SIZE> memory_barrier_batch = {};
-    std::array<VkImageMemoryBarrier2, COMMAND_LIST_BARRIER_MAX_BATCH_SIZE> image_barrier_batch = {};
-    usize image_barrier_batch_count = {};
-    usize memory_barrier_batch_count = {};
+    // Barriers recorded since the last flush. Grows as needed and keeps its capacity between flushes.
+    // All memory barriers are merged into one, image barriers are coalesced per image and layout transition.
+    // Buffer barriers are coalesced per buffer and queue family transfer.
+    std::optional<VkMemoryBarrier2> memory_barrier_batch = {};
+    std::vector<VkBufferMemoryBarrier2> buffer_barrier_batch = {};
+    std::vector<VkImageMemoryBarrier2> image_barrier_batch = {};
     usize split_barrier_batch_count = {};
     struct NoPipeline {};
     Variant<NoPipeline, daxa_ComputePipeline, daxa_RasterPipeline, daxa_RayTracingPipeline> current_pipeline = NoPipeline{};
+    // What is bound in the current command buffer, per bind point (graphics, compute, ray tracing).
+    // All pipeline layouts share the bindless set 0. It only needs a rebind when the layout changes,
+    // as layouts with different push constant ranges are not compatible for set 0.
+    struct BindPointState
+    {
+        VkPipeline vk_pipeline = {};
+        VkPipelineLayout vk_pipeline_layout = {};
+    };
+    std::array<BindPointState, 3> bind_point_states = {};
+    // Cached on pipeline bind, so that push constants do not need to inspect the current pipeline.
+    VkPipelineLayout current_vk_pipeline_layout = {};
+    u32 current_push_constant_size = {};
+    // Pushed constants are shadowed and only the changed bytes are uploaded before the next draw, dispatch or trace rays call.
+    struct PushConstantState
+    {
+        std::array<std::byte, MAX_PUSH_CONSTANT_BYTE_SIZE> shadow = {};
+        // End of all bytes pushed in the current command buffer.
+        u32 written_end = {};
+        u32 dirty_begin = MAX_PUSH_CONSTANT_BYTE_SIZE;
+        u32 dirty_end = {};
+        // Push constants are undefined after binding a pipeline with a different layout, all written bytes are uploaded again then.
+        VkPipelineLayout vk_uploaded_pipeline_layout = {};
+    };
+    PushConstantState push_constant_state = {};
+    daxa_CommandRecorderStatistics statistics = {};
 
     ExecutableCommandListData current_command_data = {};
 
@@ -275,6 +275,27 @@ auto mask_from_bit_count(u64 bits) -> u64
     return (1ull << bits) - 1;
 }
 
+// Updates without a source refit the destination in place.
+static auto daxa_tlas_update_source(daxa_Device device, daxa_TlasBuildInfo const & info) -> VkAccelerationStructureKHR
+{
+    if (!info.update)
+    {
+        return nullptr;
+    }
+    daxa_TlasId const src = info.src_tlas.value != 0 ? info.src_tlas : info.dst_tlas;
+    return src.value != 0 ? device->slot(src).vk_acceleration_structure : nullptr;
+}
+
+static auto daxa_blas_update_source(daxa_Device device, daxa_BlasBuildInfo const & info) -> VkAccelerationStructureKHR
+{
+    if (!info.update)
+    {
+        return nullptr;
+    }
+    daxa_BlasId const src = info.src_blas.value != 0 ? info.src_blas : info.dst_blas;
+    return src.value != 0 ? device->slot(src).vk_acceleration_structure : nullptr;
+}
+
 void daxa_as_build_info_to_vk(
     daxa_Device device,
     daxa_TlasBuildInfo const * tlas_infos,
@@ -330,10 +351,8 @@ void daxa_as_build_info_to_vk(
             .pNext = nullptr,
             .type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
             .flags = static_cast<VkBuildAccelerationStructureFlagsKHR>(info.flags),
-            .mode = info.update ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR  : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
-            .srcAccelerationStructure = info.src_tlas.value != 0
-                    ? device->slot(info.src_tlas).vk_acceleration_structure
-                    : nullptr,
+            .mode = info.update ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+            .srcAccelerationStructure = daxa_tlas_update_source(device, info),
             .dstAccelerationStructure =
                 info.dst_tlas.value != 0
                     ? device->slot(info.dst_tlas).vk_acceleration_structure
@@ -394,10 +413,8 @@ void daxa_as_build_info_to_vk(
             .pNext = nullptr,
             .type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
             .flags = static_cast<VkBuildAccelerationStructureFlagsKHR>(info.flags),
-            .mode = info.update ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR  : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
-            .srcAccelerationStructure = info.src_blas.value != 0
-                    ? device->slot(info.src_blas).vk_acceleration_structure
-                    : nullptr,
+            .mode = info.update ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+            .srcAccelerationStructure = daxa_blas_update_source(device, info),
             .dstAccelerationStructure =
                 info.dst_blas.value != 0
                     ? device->slot(info.dst_blas).vk_acceleration_structure
@@ -555,6 +572,9 @@ auto daxa_dvc_create_memory(daxa_Device self, daxa_MemoryBlockInfo const * info,
         return std::bit_cast<daxa_Result>(result);
     }
 
+    self->memory_block_count.fetch_add(1, std::memory_order_relaxed);
+    self->memory_block_bytes.fetch_add(ret.alloc_info.size, std::memory_order_relaxed);
+
     ret.strong_count = 1;
     self->inc_weak_refcnt();
     *out_memory_block = new daxa_ImplMemoryBlock{};
@@ -597,3 +617,52 @@ void daxa_ImplMemoryBlock::zero_ref_callback(ImplHandle const * handle)
 }
 
 // --- End daxa_ImplMemoryBlock ---
+
+// --- Begin daxa_ImplMemoryPool ---
+
+auto daxa_memory_pool_info(daxa_MemoryPool self) -> daxa_MemoryPoolInfo const *
+{
+    return r_cast<daxa_MemoryPoolInfo const *>(&self->info);
+}
+
+void daxa_memory_pool_statistics(daxa_MemoryPool self, daxa_MemoryPoolStatistics * out_statistics)
+{
+    VmaStatistics statistics = {};
+    vmaGetPoolStatistics(self->device->vma_allocator, self->pool, &statistics);
+    *out_statistics = daxa_MemoryPoolStatistics{
+        .block_bytes = statistics.blockBytes,
+        .allocation_bytes = statistics.allocationBytes,
+        .block_count = statistics.blockCount,
+        .allocation_count = statistics.allocationCount,
+    };
+}
+
+auto daxa_memory_pool_inc_refcnt(daxa_MemoryPool self) -> u64
+{
+    return self->inc_refcnt();
+}
+
+auto daxa_memory_pool_dec_refcnt(daxa_MemoryPool self) -> u64
+{
+    return self->dec_refcnt(
+        &daxa_ImplMemoryPool::zero_ref_callback,
+        self->device->instance);
+}
+
+void daxa_ImplMemoryPool::zero_ref_callback(ImplHandle const * handle)
+{
+    auto * self = rc_cast<daxa_ImplMemoryPool *>(handle);
+    std::unique_lock const lock{self->device->zombies_mtx};
+    u64 const submit_timeline_value = self->device->global_submit_timeline.load(std::memory_order::relaxed);
+    self->device->memory_pool_zombies.emplace_front(
+        submit_timeline_value,
+        MemoryPoolZombie{
+            .pool = self->pool,
+        });
+    self->device->dec_weak_refcnt(
+        daxa_ImplDevice::zero_ref_callback,
+        self->device->instance);
+    delete self;
+}
+
+// --- End daxa_ImplMemoryPool ---
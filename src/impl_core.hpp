@@ -154,6 +154,20 @@ struct daxa_ImplMemoryBlock final : ImplHandle
     static void zero_ref_callback(ImplHandle const * handle);
 };
 
+struct MemoryPoolZombie
+{
+    VmaPool pool = {};
+};
+
+struct daxa_ImplMemoryPool final : ImplHandle
+{
+    daxa_Device device = {};
+    MemoryPoolInfo info = {};
+    VmaPool pool = {};
+
+    static void zero_ref_callback(ImplHandle const * handle);
+};
+
 #ifndef defer
 struct defer_dummy
 {
@@ -2,6 +2,9 @@
 
 #include <utility>
 #include <functional>
+#include <algorithm>
+#include <unordered_map>
+#include <chrono>
 #include "impl_features.hpp"
 
 #include "impl_device.hpp"
@@ -68,6 +71,61 @@ namespace
         }
         return result;
     }
+
+    auto initialize_buffer_create_info_from_buffer_info(daxa_Device self, daxa_BufferInfo const & buffer_info) -> VkBufferCreateInfo
+    {
+        VkBufferCreateInfo vk_buffer_create_info{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .size = static_cast<VkDeviceSize>(buffer_info.size),
+            .usage = create_buffer_use_flags(self),
+            .sharingMode = VK_SHARING_MODE_CONCURRENT,                  // Buffers are shared by default.
+            .queueFamilyIndexCount = self->valid_vk_queue_family_count, // Shared buffers are shared across all queues.
+            .pQueueFamilyIndices = self->valid_vk_queue_families.data(),
+        };
+        if (buffer_info.sharing_mode == DAXA_SHARING_MODE_EXCLUSIVE)
+        {
+            vk_buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            vk_buffer_create_info.queueFamilyIndexCount = 0;
+            vk_buffer_create_info.pQueueFamilyIndices = nullptr;
+        }
+        return vk_buffer_create_info;
+    }
+
+    auto initialize_default_image_view_create_info(daxa_ImageInfo const & image_info, VkImageAspectFlags aspect_flags, VkImage vk_image) -> VkImageViewCreateInfo
+    {
+        VkImageViewType vk_image_view_type = {};
+        if (image_info.array_layer_count > 1)
+        {
+            vk_image_view_type = static_cast<VkImageViewType>(image_info.dimensions + 3);
+        }
+        else
+        {
+            vk_image_view_type = static_cast<VkImageViewType>(image_info.dimensions - 1);
+        }
+        return VkImageViewCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .image = vk_image,
+            .viewType = vk_image_view_type,
+            .format = static_cast<VkFormat>(image_info.format),
+            .components = VkComponentMapping{
+                .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+                .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+                .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+                .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+            },
+            .subresourceRange = {
+                .aspectMask = aspect_flags,
+                .baseMipLevel = 0,
+                .levelCount = image_info.mip_level_count,
+                .baseArrayLayer = 0,
+                .layerCount = image_info.array_layer_count,
+            },
+        };
+    }
 } // namespace
 
 auto daxa_ImplDevice::ImplQueue::initialize(VkDevice vk_device, u32 queue_family_index, u32 queue_index) -> daxa_Result
@@ -127,7 +185,7 @@ auto daxa_ImplDevice::ImplQueue::get_oldest_pending_submit(VkDevice vk_device, s
     return DAXA_RESULT_SUCCESS;
 }
 
-auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_BufferId * out_id, daxa_MemoryBlock opt_memory_block, usize opt_offset) -> daxa_Result
+auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_BufferId * out_id, daxa_MemoryBlock opt_memory_block, usize opt_offset, daxa_MemoryPool opt_memory_pool) -> daxa_Result
 {
     daxa_Result result = DAXA_RESULT_SUCCESS;
     // --- Begin Parameter Validation ---
@@ -166,16 +224,7 @@ auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_B
 
     ret.info = *info;
 
-    VkBufferCreateInfo const vk_buffer_create_info{
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .pNext = nullptr,
-        .flags = {},
-        .size = static_cast<VkDeviceSize>(ret.info.size),
-        .usage = create_buffer_use_flags(self),
-        .sharingMode = VK_SHARING_MODE_CONCURRENT,                  // Buffers are always shared.
-        .queueFamilyIndexCount = self->valid_vk_queue_family_count, // Buffers are always shared across all queues.
-        .pQueueFamilyIndices = self->valid_vk_queue_families.data(),
-    };
+    VkBufferCreateInfo const vk_buffer_create_info = initialize_buffer_create_info_from_buffer_info(self, ret.info);
 
     bool host_accessible = false;
     VmaAllocationInfo vma_allocation_info = {};
@@ -196,8 +245,10 @@ auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_B
             .requiredFlags = {},
             .preferredFlags = {},
             .memoryTypeBits = std::numeric_limits<u32>::max(),
-            .pool = nullptr,
-            .pUserData = nullptr,
+            .pool = opt_memory_pool != nullptr ? opt_memory_pool->pool : nullptr,
+            // Defragmentation finds the slot of a moved allocation by its user data.
+            // Mapped buffers are never moved, as that would change their host address.
+            .pUserData = host_accessible ? nullptr : std::bit_cast<void *>(id),
             .priority = 0.5f,
         };
 
@@ -209,6 +260,11 @@ auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_B
             &ret.vma_allocation,
             &vma_allocation_info));
         _DAXA_RETURN_IF_ERROR(result, result)
+        if (opt_memory_pool != nullptr)
+        {
+            ret.opt_memory_pool = opt_memory_pool;
+            opt_memory_pool->inc_weak_refcnt();
+        }
     }
     else
     {
@@ -265,11 +321,12 @@ auto create_buffer_helper(daxa_Device self, daxa_BufferInfo const * info, daxa_B
             id.index);
     }
 
+    self->gpu_sro_table.buffer_slots.publish_slot(id);
     *out_id = std::bit_cast<daxa_BufferId>(id);
     return result;
 }
 
-auto create_image_helper(daxa_Device self, daxa_ImageInfo const * info, daxa_ImageId * out_id, daxa_MemoryBlock opt_memory_block, usize opt_offset) -> daxa_Result
+auto create_image_helper(daxa_Device self, daxa_ImageInfo const * info, daxa_ImageId * out_id, daxa_MemoryBlock opt_memory_block, usize opt_offset, daxa_MemoryPool opt_memory_pool) -> daxa_Result
 {
     daxa_Result result = DAXA_RESULT_SUCCESS;
     /// --- Begin Validation ---
@@ -318,38 +375,9 @@ auto create_image_helper(daxa_Device self, daxa_ImageInfo const * info, daxa_Ima
         .name = info->name.data,
     });
 
-    VkImageViewType vk_image_view_type = {};
-    if (info->array_layer_count > 1)
-    {
-        vk_image_view_type = static_cast<VkImageViewType>(info->dimensions + 3);
-    }
-    else
-    {
-        vk_image_view_type = static_cast<VkImageViewType>(info->dimensions - 1);
-    }
-
     ret.aspect_flags = infer_aspect_from_format(info->format);
-    VkImageViewCreateInfo vk_image_view_create_info{
-        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-        .pNext = nullptr,
-        .flags = {},
-        // .image = ret.vk_image, // FILL THIS LATER!
-        .viewType = vk_image_view_type,
-        .format = *r_cast<VkFormat const *>(&info->format),
-        .components = VkComponentMapping{
-            .r = VK_COMPONENT_SWIZZLE_IDENTITY,
-            .g = VK_COMPONENT_SWIZZLE_IDENTITY,
-            .b = VK_COMPONENT_SWIZZLE_IDENTITY,
-            .a = VK_COMPONENT_SWIZZLE_IDENTITY,
-        },
-        .subresourceRange = {
-            .aspectMask = ret.aspect_flags,
-            .baseMipLevel = 0,
-            .levelCount = info->mip_level_count,
-            .baseArrayLayer = 0,
-            .layerCount = info->array_layer_count,
-        },
-    };
+    // .image is filled in once the image is created.
+    VkImageViewCreateInfo vk_image_view_create_info = initialize_default_image_view_create_info(*info, ret.aspect_flags, VK_NULL_HANDLE);
     VkImageCreateInfo const vk_image_create_info = initialize_image_create_info_from_image_info(self, *info);
     if (opt_memory_block == nullptr)
     {
@@ -359,13 +387,19 @@ auto create_image_helper(daxa_Device self, daxa_ImageInfo const * info, daxa_Ima
             .requiredFlags = {},
             .preferredFlags = {},
             .memoryTypeBits = std::numeric_limits<u32>::max(),
-            .pool = nullptr,
-            .pUserData = nullptr,
+            .pool = opt_memory_pool != nullptr ? opt_memory_pool->pool : nullptr,
+            // Defragmentation finds the slot of a moved allocation by its user data.
+            .pUserData = std::bit_cast<void *>(id),
             .priority = 0.5f,
         };
 
         result = static_cast<daxa_Result>(vmaCreateImage(self->vma_allocator, &vk_image_create_info, &vma_allocation_create_info, &ret.vk_image, &ret.vma_allocation, nullptr));
         _DAXA_RETURN_IF_ERROR(result, DAXA_RESULT_FAILED_TO_CREATE_IMAGE);
+        if (opt_memory_pool != nullptr)
+        {
+            ret.opt_memory_pool = opt_memory_pool;
+            opt_memory_pool->inc_weak_refcnt();
+        }
 
         vk_image_view_create_info.image = ret.vk_image;
         result = static_cast<daxa_Result>(vkCreateImageView(self->vk_device, &vk_image_view_create_info, nullptr, &ret.view_slot.vk_image_view));
@@ -425,6 +459,7 @@ auto create_image_helper(daxa_Device self, daxa_ImageInfo const * info, daxa_Ima
             std::bit_cast<ImageUsageFlags>(ret.info.usage),
             id.index);
     }
+    self->gpu_sro_table.image_slots.publish_slot(id);
     *out_id = std::bit_cast<daxa_ImageId>(id);
     return result;
 }
@@ -491,6 +526,7 @@ auto create_acceleration_structure_helper(
         auto cinfo = daxa_BufferInfo{
             .size = ret.info.size,
             .name = std::bit_cast<daxa_SmallString>(buffer_name),
+            .sharing_mode = DAXA_SHARING_MODE_CONCURRENT,
         };
         result = daxa_dvc_create_buffer(self, &cinfo, r_cast<daxa_BufferId *>(&ret.buffer_id));
         _DAXA_RETURN_IF_ERROR(result, result);
@@ -498,6 +534,12 @@ auto create_acceleration_structure_helper(
         ret.owns_buffer = true;
     }
     ret.vk_buffer = self->slot(ret.buffer_id).vk_buffer;
+    if (self->slot(ret.buffer_id).vma_allocation != nullptr)
+    {
+        // Acceleration structures can not be moved by defragmentation, neither can their buffers.
+        std::unique_lock const lock{self->zombies_mtx};
+        vmaSetAllocationUserData(self->vma_allocator, self->slot(ret.buffer_id).vma_allocation, nullptr);
+    }
 
     VkAccelerationStructureCreateInfoKHR vk_create_info = {
         .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR,
@@ -545,6 +587,7 @@ auto create_acceleration_structure_helper(
             id.index);
     }
 
+    table.publish_slot(id);
     *out_id = std::bit_cast<typename std::remove_pointer<decltype(out_id)>::type>(id);
     return result;
 }
@@ -572,16 +615,22 @@ auto daxa_default_device_score(daxa_DeviceProperties const * c_properties) -> i3
 
 auto daxa_dvc_buffer_memory_requirements(daxa_Device self, daxa_BufferInfo const * info) -> VkMemoryRequirements
 {
-    VkBufferCreateInfo const vk_buffer_create_info{
+    VkBufferCreateInfo vk_buffer_create_info{
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .pNext = nullptr,
         .flags = {},
         .size = static_cast<VkDeviceSize>(info->size),
         .usage = create_buffer_use_flags(self),
-        .sharingMode = VK_SHARING_MODE_CONCURRENT,                  // Buffers are always shared.
-        .queueFamilyIndexCount = self->valid_vk_queue_family_count, // Buffers are always shared across all queues.
+        .sharingMode = VK_SHARING_MODE_CONCURRENT,                  // Buffers are shared by default.
+        .queueFamilyIndexCount = self->valid_vk_queue_family_count, // Shared buffers are shared across all queues.
         .pQueueFamilyIndices = self->valid_vk_queue_families.data(),
     };
+    if (info->sharing_mode == DAXA_SHARING_MODE_EXCLUSIVE)
+    {
+        vk_buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        vk_buffer_create_info.queueFamilyIndexCount = 0;
+        vk_buffer_create_info.pQueueFamilyIndices = nullptr;
+    }
     VkDeviceBufferMemoryRequirements buffer_requirement_info{
         .sType = VK_STRUCTURE_TYPE_DEVICE_BUFFER_MEMORY_REQUIREMENTS,
         .pNext = {},
@@ -697,22 +746,103 @@ auto daxa_dvc_get_blas_build_sizes(
 
 auto daxa_dvc_create_buffer(daxa_Device self, daxa_BufferInfo const * info, daxa_BufferId * out_id) -> daxa_Result
 {
-    return create_buffer_helper(self, info, out_id, nullptr, 0);
+    return create_buffer_helper(self, info, out_id, nullptr, 0, nullptr);
 }
 
 auto daxa_dvc_create_image(daxa_Device self, daxa_ImageInfo const * info, daxa_ImageId * out_id) -> daxa_Result
 {
-    return create_image_helper(self, info, out_id, nullptr, 0);
+    return create_image_helper(self, info, out_id, nullptr, 0, nullptr);
 }
 
 auto daxa_dvc_create_buffer_from_memory_block(daxa_Device self, daxa_MemoryBlockBufferInfo const * info, daxa_BufferId * out_id) -> daxa_Result
 {
-    return create_buffer_helper(self, &info->buffer_info, out_id, *info->memory_block, info->offset);
+    return create_buffer_helper(self, &info->buffer_info, out_id, *info->memory_block, info->offset, nullptr);
 }
 
 auto daxa_dvc_create_image_from_block(daxa_Device self, daxa_MemoryBlockImageInfo const * info, daxa_ImageId * out_id) -> daxa_Result
 {
-    return create_image_helper(self, &info->image_info, out_id, *info->memory_block, info->offset);
+    return create_image_helper(self, &info->image_info, out_id, *info->memory_block, info->offset, nullptr);
+}
+
+auto daxa_dvc_create_memory_pool(daxa_Device self, daxa_MemoryPoolInfo const * info, daxa_MemoryPool * out_memory_pool) -> daxa_Result
+{
+    daxa_ImplMemoryPool ret = {};
+    ret.device = self;
+    ret.info = std::bit_cast<daxa::MemoryPoolInfo>(*info);
+
+    bool const info_valid =
+        (info->algorithm == DAXA_MEMORY_POOL_ALGORITHM_TLSF || info->algorithm == DAXA_MEMORY_POOL_ALGORITHM_LINEAR) &&
+        info->priority >= 0.0f && info->priority <= 1.0f &&
+        (info->max_block_count == 0 || info->min_block_count <= info->max_block_count);
+    if (!info_valid)
+    {
+        return DAXA_RESULT_INVALID_MEMORY_POOL_INFO;
+    }
+
+    // The memory type is chosen like for a buffer, the default image memory types are compatible on common hardware.
+    daxa_BufferInfo buffer_info = DAXA_DEFAULT_BUFFER_INFO;
+    buffer_info.size = 0x1000;
+    VkBufferCreateInfo const vk_buffer_create_info = initialize_buffer_create_info_from_buffer_info(self, buffer_info);
+    auto const host_access_flags = static_cast<VmaAllocationCreateFlags>(info->memory_flags) &
+                                   (VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT);
+    VmaAllocationCreateInfo const vma_allocation_create_info{
+        .flags = host_access_flags,
+        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+        .requiredFlags = {},
+        .preferredFlags = {},
+        .memoryTypeBits = info->memory_type_bits != 0 ? info->memory_type_bits : std::numeric_limits<u32>::max(),
+        .pool = nullptr,
+        .pUserData = {},
+        .priority = 0.5f,
+    };
+    u32 memory_type_index = {};
+    auto result = vmaFindMemoryTypeIndexForBufferInfo(self->vma_allocator, &vk_buffer_create_info, &vma_allocation_create_info, &memory_type_index);
+    if (result == VK_ERROR_FEATURE_NOT_PRESENT)
+    {
+        return DAXA_RESULT_INVALID_MEMORY_POOL_INFO;
+    }
+    if (result != VK_SUCCESS)
+    {
+        return std::bit_cast<daxa_Result>(result);
+    }
+
+    VmaPoolCreateInfo const vma_pool_create_info{
+        .memoryTypeIndex = memory_type_index,
+        .flags = info->algorithm == DAXA_MEMORY_POOL_ALGORITHM_LINEAR ? VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT : VmaPoolCreateFlags{},
+        .blockSize = info->block_size,
+        .minBlockCount = info->min_block_count,
+        .maxBlockCount = info->max_block_count,
+        // Ignored by vma when memory priorities are not enabled.
+        .priority = info->priority,
+        .minAllocationAlignment = 0,
+        .pMemoryAllocateNext = nullptr,
+    };
+    result = vmaCreatePool(self->vma_allocator, &vma_pool_create_info, &ret.pool);
+    if (result != VK_SUCCESS)
+    {
+        return std::bit_cast<daxa_Result>(result);
+    }
+    if (info->name.size != 0)
+    {
+        auto c_str_arr = r_cast<SmallString const *>(&info->name)->c_str();
+        vmaSetPoolName(self->vma_allocator, ret.pool, c_str_arr.data());
+    }
+
+    ret.strong_count = 1;
+    self->inc_weak_refcnt();
+    *out_memory_pool = new daxa_ImplMemoryPool{};
+    **out_memory_pool = ret;
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_dvc_create_buffer_from_memory_pool(daxa_Device self, daxa_MemoryPoolBufferInfo const * info, daxa_BufferId * out_id) -> daxa_Result
+{
+    return create_buffer_helper(self, &info->buffer_info, out_id, nullptr, 0, *info->memory_pool);
+}
+
+auto daxa_dvc_create_image_from_memory_pool(daxa_Device self, daxa_MemoryPoolImageInfo const * info, daxa_ImageId * out_id) -> daxa_Result
+{
+    return create_image_helper(self, &info->image_info, out_id, nullptr, 0, *info->memory_pool);
 }
 
 auto daxa_dvc_create_tlas(daxa_Device self, daxa_TlasInfo const * info, daxa_TlasId * out_id) -> daxa_Result
@@ -833,6 +963,7 @@ auto daxa_dvc_create_image_view(daxa_Device self, daxa_ImageViewInfo const * inf
             ret.vk_image_view,
             std::bit_cast<ImageUsageFlags>(parent_image_slot.info.usage),
             id.index);
+        self->gpu_sro_table.image_slots.publish_slot(id);
         *out_id = std::bit_cast<daxa_ImageViewId>(id);
     }
     return result;
@@ -917,6 +1048,7 @@ auto daxa_dvc_create_sampler(daxa_Device self, daxa_SamplerInfo const * info, da
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDescriptorBindingFlagBits.html
         write_descriptor_set_sampler(self->vk_device, self->gpu_sro_table.vk_descriptor_set, ret.vk_sampler, id.index);
     }
+    self->gpu_sro_table.sampler_slots.publish_slot(id);
     *out_id = std::bit_cast<daxa_SamplerId>(id);
     return result;
 }
@@ -1053,6 +1185,16 @@ auto daxa_dvc_queue_count(daxa_Device self, daxa_QueueFamily queue_family, u32 *
     return DAXA_RESULT_SUCCESS;
 }
 
+auto daxa_dvc_latest_submit_index(daxa_Device self) -> u64
+{
+    return self->global_submit_timeline.load(std::memory_order::relaxed);
+}
+
+auto daxa_dvc_oldest_pending_submit_index(daxa_Device self, u64 * out_submit_index) -> daxa_Result
+{
+    return self->get_min_pending_device_timeline_value_of_all_queues(*out_submit_index);
+}
+
 auto daxa_dvc_submit(daxa_Device self, daxa_CommandSubmitInfo const * info) -> daxa_Result
 {
     if (!self->valid_queue(info->queue))
@@ -1110,6 +1252,16 @@ auto daxa_dvc_submit(daxa_Device self, daxa_CommandSubmitInfo const * info) -> d
     for (auto const & commands : std::span{info->command_lists, info->command_list_count})
     {
         executable_cmd_list_execute_deferred_destructions(self, commands->data);
+        if (commands->data.unsubmitted)
+        {
+            commands->data.unsubmitted = false;
+            self->unsubmitted_command_list_count.fetch_sub(1, std::memory_order::relaxed);
+        }
+        if (commands->data.records_defragmentation_pass)
+        {
+            self->submit_defragmentation_pass(current_timeline_value);
+            commands->data.records_defragmentation_pass = false;
+        }
     }
 
     std::vector<VkCommandBuffer> submit_vk_command_buffers = {};
@@ -1142,6 +1294,15 @@ auto daxa_dvc_submit(daxa_Device self, daxa_CommandSubmitInfo const * info) -> d
     std::vector<VkPipelineStageFlags> submit_semaphore_wait_stage_masks = {};
     std::vector<u64> submit_semaphore_wait_values = {}; // Used for timeline semaphores. Ignored (push dummy value) for binary semaphores.
 
+    // Until collect_garbage released the init commands, the null resource upload may still be in flight.
+    // The lifetime lock keeps collect_garbage from destroying the init timeline during the submit.
+    if (self->init_timeline != VK_NULL_HANDLE)
+    {
+        submit_semaphore_waits.push_back(self->init_timeline);
+        submit_semaphore_wait_stage_masks.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        submit_semaphore_wait_values.push_back(1);
+    }
+
     for (auto const & pair : std::span{info->wait_timeline_semaphores, info->wait_timeline_semaphore_count})
     {
         submit_semaphore_waits.push_back(pair.semaphore->vk_semaphore);
@@ -1202,9 +1363,27 @@ auto daxa_dvc_present(daxa_Device self, daxa_PresentInfo const * info) -> daxa_R
         submit_semaphore_waits.push_back(binary_semaphore->vk_semaphore);
     }
 
+    {
+        auto const result = info->swapchain->end_frame_timing(self->get_queue(info->queue).vk_queue);
+        _DAXA_RETURN_IF_ERROR(result, result)
+    }
+
+    if (info->swapchain->headless())
+    {
+        return info->swapchain->present_headless(self->get_queue(info->queue).vk_queue, submit_semaphore_waits);
+    }
+
+    // The cpu frame value identifies the present for vkWaitForPresentKHR.
+    u64 const present_id = info->swapchain->present_wait_enabled() ? info->swapchain->cpu_frame_timeline : 0;
+    VkPresentIdKHR const vk_present_id{
+        .sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+        .pNext = nullptr,
+        .swapchainCount = 1,
+        .pPresentIds = &present_id,
+    };
     VkPresentInfoKHR const present_info{
         .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-        .pNext = nullptr,
+        .pNext = present_id != 0 ? &vk_present_id : nullptr,
         .waitSemaphoreCount = static_cast<u32>(submit_semaphore_waits.size()),
         .pWaitSemaphores = submit_semaphore_waits.data(),
         .swapchainCount = static_cast<u32>(1),
@@ -1215,6 +1394,7 @@ auto daxa_dvc_present(daxa_Device self, daxa_PresentInfo const * info) -> daxa_R
 
     auto result = static_cast<daxa_Result>(vkQueuePresentKHR(self->get_queue(info->queue).vk_queue, &present_info));
     _DAXA_RETURN_IF_ERROR(result, result)
+    info->swapchain->frame_presented(present_id);
 
     return std::bit_cast<daxa_Result>(result);
 }
@@ -1224,18 +1404,21 @@ auto daxa_dvc_collect_garbage(daxa_Device self) -> daxa_Result
     std::unique_lock lifetime_lock{self->gpu_sro_table.lifetime_lock};
     std::unique_lock lock{self->zombies_mtx};
 
-    u64 min_pending_device_timeline_value_of_all_queues = std::numeric_limits<u64>::max();
-    for (auto & queue : self->queues)
+    self->release_init_commands(false);
+
+    u64 min_pending_device_timeline_value_of_all_queues = {};
     {
-        std::optional<u64> latest_pending_submit = {};
-        auto result = queue.get_oldest_pending_submit(self->vk_device, latest_pending_submit);
+        auto result = self->get_min_pending_device_timeline_value_of_all_queues(min_pending_device_timeline_value_of_all_queues);
         _DAXA_RETURN_IF_ERROR(result, result)
+    }
 
-        if (latest_pending_submit.has_value())
-        {
-            min_pending_device_timeline_value_of_all_queues = std::min(min_pending_device_timeline_value_of_all_queues, latest_pending_submit.value());
-        }
+    {
+        auto result = self->advance_defragmentation(min_pending_device_timeline_value_of_all_queues);
+        _DAXA_RETURN_IF_ERROR(result, result)
     }
+    bool const defragmentation_pass_in_flight =
+        self->defragmentation.state != ImplDefragmentation::State::INACTIVE &&
+        self->defragmentation.state != ImplDefragmentation::State::IDLE;
 
     auto check_and_cleanup_gpu_resources = [&](auto & zombies, auto const & cleanup_fn)
     {
@@ -1252,41 +1435,55 @@ auto daxa_dvc_collect_garbage(daxa_Device self) -> daxa_Result
             zombies.pop_back();
         }
     };
-    check_and_cleanup_gpu_resources(
-        self->buffer_zombies,
-        [&](auto id)
-        {
-            self->cleanup_buffer(id);
-        });
-    check_and_cleanup_gpu_resources(
-        self->image_view_zombies,
-        [&](auto id)
-        {
-            self->cleanup_image_view(id);
-        });
-    check_and_cleanup_gpu_resources(
-        self->image_zombies,
-        [&](auto id)
+    // Take over all gpu resource zombies staged since the last collect.
+    auto & table = self->gpu_sro_table;
+    self->buffer_zombies.merge_staged(table.buffer_slots);
+    self->image_view_zombies.merge_staged(table.image_slots);
+    self->image_zombies.merge_staged(table.image_slots);
+    self->sampler_zombies.merge_staged(table.sampler_slots);
+    self->tlas_zombies.merge_staged(table.tlas_slots);
+    self->blas_zombies.merge_staged(table.blas_slots);
+    if (!defragmentation_pass_in_flight)
+    {
+        self->buffer_zombies.cleanup(
+            table.buffer_slots, min_pending_device_timeline_value_of_all_queues,
+            [&](GPUResourceId id)
+            {
+                self->cleanup_buffer(std::bit_cast<BufferId>(id));
+            });
+    }
+    self->image_view_zombies.cleanup(
+        table.image_slots, min_pending_device_timeline_value_of_all_queues,
+        [&](GPUResourceId id)
         {
-            self->cleanup_image(id);
+            self->cleanup_image_view(std::bit_cast<ImageViewId>(id));
         });
-    check_and_cleanup_gpu_resources(
-        self->sampler_zombies,
-        [&](auto id)
+    if (!defragmentation_pass_in_flight)
+    {
+        self->image_zombies.cleanup(
+            table.image_slots, min_pending_device_timeline_value_of_all_queues,
+            [&](GPUResourceId id)
+            {
+                self->cleanup_image(std::bit_cast<ImageId>(id));
+            });
+    }
+    self->sampler_zombies.cleanup(
+        table.sampler_slots, min_pending_device_timeline_value_of_all_queues,
+        [&](GPUResourceId id)
         {
-            self->cleanup_sampler(id);
+            self->cleanup_sampler(std::bit_cast<SamplerId>(id));
         });
-    check_and_cleanup_gpu_resources(
-        self->tlas_zombies,
-        [&](auto id)
+    self->tlas_zombies.cleanup(
+        table.tlas_slots, min_pending_device_timeline_value_of_all_queues,
+        [&](GPUResourceId id)
         {
-            self->cleanup_tlas(id);
+            self->cleanup_tlas(std::bit_cast<TlasId>(id));
         });
-    check_and_cleanup_gpu_resources(
-        self->blas_zombies,
-        [&](auto id)
+    self->blas_zombies.cleanup(
+        table.blas_slots, min_pending_device_timeline_value_of_all_queues,
+        [&](GPUResourceId id)
         {
-            self->cleanup_blas(id);
+            self->cleanup_blas(std::bit_cast<BlasId>(id));
         });
     check_and_cleanup_gpu_resources(
         self->pipeline_zombies,
@@ -1316,8 +1513,36 @@ auto daxa_dvc_collect_garbage(daxa_Device self) -> daxa_Result
         self->memory_block_zombies,
         [&](auto & memory_block_zombie)
         {
+            VmaAllocationInfo allocation_info = {};
+            vmaGetAllocationInfo(self->vma_allocator, memory_block_zombie.allocation, &allocation_info);
+            self->memory_block_count.fetch_sub(1, std::memory_order_relaxed);
+            self->memory_block_bytes.fetch_sub(allocation_info.size, std::memory_order_relaxed);
             vmaFreeMemory(self->vma_allocator, memory_block_zombie.allocation);
         });
+    // Pools must outlive the buffer and image zombies allocated from them.
+    // Zombies staged by other threads can be merged out of timeline order, so the tag alone does not prove that.
+    // A pool is only destroyed once it has no allocations left.
+    if (!defragmentation_pass_in_flight)
+    {
+        std::erase_if(
+            self->memory_pool_zombies,
+            [&](auto const & timeline_and_zombie)
+            {
+                auto const & [timeline_value, memory_pool_zombie] = timeline_and_zombie;
+                if (timeline_value >= min_pending_device_timeline_value_of_all_queues)
+                {
+                    return false;
+                }
+                VmaStatistics statistics = {};
+                vmaGetPoolStatistics(self->vma_allocator, memory_pool_zombie.pool, &statistics);
+                if (statistics.allocationCount != 0)
+                {
+                    return false;
+                }
+                vmaDestroyPool(self->vma_allocator, memory_pool_zombie.pool);
+                return true;
+            });
+    }
     {
         std::unique_lock const main_queue_lock{self->command_pool_pools[DAXA_QUEUE_FAMILY_MAIN].mtx};
         std::unique_lock const compute_queue_lock{self->command_pool_pools[DAXA_QUEUE_FAMILY_COMPUTE].mtx};
@@ -1348,6 +1573,189 @@ auto daxa_dvc_properties(daxa_Device device) -> daxa_DeviceProperties const *
     return &device->properties;
 }
 
+void daxa_dvc_creation_timings(daxa_Device device, daxa_DeviceCreationTimings * out_timings)
+{
+    *out_timings = device->creation_timings;
+}
+
+enum struct ResourceMemoryKind
+{
+    BUFFER,
+    IMAGE,
+    ACCELERATION_STRUCTURE,
+};
+
+// Calls fn(name, kind, bytes) for every buffer, image and acceleration structure, including zombies.
+// The caller must hold the zombies_mtx, as resources are only destroyed by collect_garbage while holding it.
+// Slots are only read once their creator published them, resources created in parallel are skipped.
+template <typename FnT>
+void visit_resource_memory(daxa_Device self, FnT const & fn)
+{
+    auto allocation_size = [&](VmaAllocation allocation) -> u64
+    {
+        VmaAllocationInfo allocation_info = {};
+        vmaGetAllocationInfo(self->vma_allocator, allocation, &allocation_info);
+        return allocation_info.size;
+    };
+    auto visit_slots = [](auto const & pool, auto const & slot_fn)
+    {
+        u32 const page_count = pool.valid_page_count.load(std::memory_order_acquire);
+        for (u32 index = 0; index < (page_count << pool.PAGE_BITS); ++index)
+        {
+            if (auto const * slot = pool.try_get_published(index))
+            {
+                slot_fn(index, *slot);
+            }
+        }
+    };
+    auto & table = self->gpu_sro_table;
+    // Buffers created by acceleration structures are reported as acceleration structure memory.
+    std::vector<bool> acceleration_structure_buffers = {};
+    auto visit_acceleration_structure = [&](u32, auto const & slot)
+    {
+        if (slot.vk_acceleration_structure == VK_NULL_HANDLE)
+        {
+            return;
+        }
+        u64 bytes = 0;
+        // Acceleration structures placed in user buffers do not own memory.
+        if (slot.owns_buffer)
+        {
+            auto const & buffer_slot = table.buffer_slots.unsafe_get(slot.buffer_id);
+            if (buffer_slot.vma_allocation != nullptr)
+            {
+                bytes = allocation_size(buffer_slot.vma_allocation);
+            }
+            acceleration_structure_buffers.resize(std::max(acceleration_structure_buffers.size(), static_cast<usize>(slot.buffer_id.index) + 1));
+            acceleration_structure_buffers[slot.buffer_id.index] = true;
+        }
+        fn(slot.info.name, ResourceMemoryKind::ACCELERATION_STRUCTURE, bytes);
+    };
+    visit_slots(table.tlas_slots, visit_acceleration_structure);
+    visit_slots(table.blas_slots, visit_acceleration_structure);
+    visit_slots(table.buffer_slots, [&](u32 index, ImplBufferSlot const & slot)
+    {
+        bool const owned_by_acceleration_structure = index < acceleration_structure_buffers.size() && acceleration_structure_buffers[index];
+        // Buffers in memory blocks are part of the memory block memory.
+        if (slot.vk_buffer != VK_NULL_HANDLE && slot.vma_allocation != nullptr && !owned_by_acceleration_structure)
+        {
+            fn(slot.info.name, ResourceMemoryKind::BUFFER, allocation_size(slot.vma_allocation));
+        }
+    });
+    visit_slots(table.image_slots, [&](u32, ImplImageSlot const & slot)
+    {
+        if (slot.vk_image != VK_NULL_HANDLE && slot.vma_allocation != nullptr && slot.swapchain_image_index == NOT_OWNED_BY_SWAPCHAIN)
+        {
+            fn(slot.info.name, ResourceMemoryKind::IMAGE, allocation_size(slot.vma_allocation));
+        }
+    });
+}
+
+auto daxa_dvc_memory_report(daxa_Device self, daxa_MemoryReport * out_report) -> daxa_Result
+{
+    *out_report = {};
+    VkPhysicalDeviceMemoryProperties const * memory_properties = {};
+    vmaGetMemoryProperties(self->vma_allocator, &memory_properties);
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets = {};
+    vmaGetHeapBudgets(self->vma_allocator, budgets.data());
+    out_report->heap_count = std::min(memory_properties->memoryHeapCount, DAXA_MAX_MEMORY_HEAPS);
+    for (u32 heap = 0; heap < out_report->heap_count; ++heap)
+    {
+        out_report->heaps[heap] = daxa_MemoryHeapReport{
+            .budget = budgets[heap].budget,
+            .usage = budgets[heap].usage,
+            .block_bytes = budgets[heap].statistics.blockBytes,
+            .allocation_bytes = budgets[heap].statistics.allocationBytes,
+            .block_count = budgets[heap].statistics.blockCount,
+            .allocation_count = budgets[heap].statistics.allocationCount,
+            .device_local = static_cast<daxa_Bool8>((memory_properties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0),
+        };
+    }
+    out_report->budget_from_driver = static_cast<daxa_Bool8>(self->memory_budget_enabled);
+    {
+        std::unique_lock const lock{self->zombies_mtx};
+        visit_resource_memory(self, [&](daxa_SmallString const &, ResourceMemoryKind kind, u64 bytes)
+        {
+            daxa_ResourceMemoryReport * total = &out_report->buffers;
+            switch (kind)
+            {
+            case ResourceMemoryKind::BUFFER: total = &out_report->buffers; break;
+            case ResourceMemoryKind::IMAGE: total = &out_report->images; break;
+            case ResourceMemoryKind::ACCELERATION_STRUCTURE: total = &out_report->acceleration_structures; break;
+            }
+            total->count += 1;
+            total->bytes += bytes;
+        });
+    }
+    out_report->memory_blocks = daxa_ResourceMemoryReport{
+        .count = self->memory_block_count.load(std::memory_order_relaxed),
+        .bytes = self->memory_block_bytes.load(std::memory_order_relaxed),
+    };
+    return DAXA_RESULT_SUCCESS;
+}
+
+// The caller must hold the zombies_mtx and no pass may be in flight.
+static void finish_defragmentation(daxa_Device self)
+{
+    auto & defragmentation = self->defragmentation;
+    VmaDefragmentationStats vma_statistics = {};
+    vmaEndDefragmentation(self->vma_allocator, defragmentation.vma_context, &vma_statistics);
+    defragmentation.statistics.bytes_freed = vma_statistics.bytesFreed;
+    defragmentation.statistics.device_memory_blocks_freed = vma_statistics.deviceMemoryBlocksFreed;
+    defragmentation.statistics.active = false;
+    defragmentation.vma_context = {};
+    defragmentation.end_requested = false;
+    defragmentation.state = ImplDefragmentation::State::INACTIVE;
+}
+
+auto daxa_dvc_begin_defragmentation(daxa_Device self, daxa_DefragmentationInfo const * info) -> daxa_Result
+{
+    if (info->move_images && (info->image_layout == DAXA_IMAGE_LAYOUT_UNDEFINED || info->image_layout == DAXA_IMAGE_LAYOUT_PRESENT_SRC))
+    {
+        return DAXA_RESULT_INVALID_DEFRAGMENTATION_INFO;
+    }
+    std::unique_lock const lock{self->zombies_mtx};
+    auto & defragmentation = self->defragmentation;
+    if (defragmentation.state != ImplDefragmentation::State::INACTIVE)
+    {
+        return DAXA_RESULT_ERROR_DEFRAGMENTATION_ALREADY_ACTIVE;
+    }
+    VmaDefragmentationInfo const vma_defragmentation_info{
+        .flags = {},
+        .pool = nullptr,
+        .maxBytesPerPass = info->max_bytes_per_pass,
+        .maxAllocationsPerPass = info->max_moves_per_pass,
+    };
+    auto result = static_cast<daxa_Result>(vmaBeginDefragmentation(self->vma_allocator, &vma_defragmentation_info, &defragmentation.vma_context));
+    _DAXA_RETURN_IF_ERROR(result, result)
+    defragmentation.info = *info;
+    defragmentation.statistics = {.active = true};
+    defragmentation.end_requested = false;
+    defragmentation.state = ImplDefragmentation::State::IDLE;
+    return DAXA_RESULT_SUCCESS;
+}
+
+void daxa_dvc_end_defragmentation(daxa_Device self)
+{
+    std::unique_lock const lock{self->zombies_mtx};
+    auto & defragmentation = self->defragmentation;
+    if (defragmentation.state == ImplDefragmentation::State::INACTIVE)
+    {
+        return;
+    }
+    defragmentation.end_requested = true;
+    if (defragmentation.state == ImplDefragmentation::State::IDLE)
+    {
+        finish_defragmentation(self);
+    }
+}
+
+void daxa_dvc_defragmentation_statistics(daxa_Device self, daxa_DefragmentationStatistics * out_statistics)
+{
+    std::unique_lock const lock{self->zombies_mtx};
+    *out_statistics = self->defragmentation.statistics;
+}
+
 auto daxa_dvc_inc_refcnt(daxa_Device self) -> u64
 {
     _DAXA_TEST_PRINT("device inc refcnt from %u to %u\n", self->strong_count, self->strong_count + 1);
@@ -1370,6 +1778,13 @@ auto daxa_ImplDevice::create_2(daxa_Instance instance, daxa_DeviceInfo2 const &
 {
     using namespace daxa;
     daxa_Result result = {};
+    auto phase_begin = std::chrono::steady_clock::now();
+    auto end_phase = [&](u64 & out_ns)
+    {
+        auto const now = std::chrono::steady_clock::now();
+        out_ns = static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - phase_begin).count());
+        phase_begin = now;
+    };
 
     // Set properties and feature variables:
     auto self = out_device;
@@ -1548,6 +1963,11 @@ auto daxa_ImplDevice::create_2(daxa_Instance instance, daxa_DeviceInfo2 const &
             self->vkCmdDrawMeshTasksIndirectCountEXT = r_cast<PFN_vkCmdDrawMeshTasksIndirectCountEXT>(vkGetDeviceProcAddr(self->vk_device, "vkCmdDrawMeshTasksIndirectCountEXT"));
         }
 
+        if (properties.implicit_features & DAXA_IMPLICIT_FEATURE_FLAG_PRESENT_WAIT)
+        {
+            self->vkWaitForPresentKHR = r_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(self->vk_device, "vkWaitForPresentKHR"));
+        }
+
         if (properties.implicit_features & DAXA_IMPLICIT_FEATURE_FLAG_BASIC_RAY_TRACING)
         {
             self->vkGetAccelerationStructureBuildSizesKHR = r_cast<PFN_vkGetAccelerationStructureBuildSizesKHR>(vkGetDeviceProcAddr(self->vk_device, "vkGetAccelerationStructureBuildSizesKHR"));
@@ -1555,6 +1975,7 @@ auto daxa_ImplDevice::create_2(daxa_Instance instance, daxa_DeviceInfo2 const &
             self->vkDestroyAccelerationStructureKHR = r_cast<PFN_vkDestroyAccelerationStructureKHR>(vkGetDeviceProcAddr(self->vk_device, "vkDestroyAccelerationStructureKHR"));
             self->vkCmdWriteAccelerationStructuresPropertiesKHR = r_cast<PFN_vkCmdWriteAccelerationStructuresPropertiesKHR>(vkGetDeviceProcAddr(self->vk_device, "vkCmdWriteAccelerationStructuresPropertiesKHR"));
             self->vkCmdBuildAccelerationStructuresKHR = r_cast<PFN_vkCmdBuildAccelerationStructuresKHR>(vkGetDeviceProcAddr(self->vk_device, "vkCmdBuildAccelerationStructuresKHR"));
+            self->vkCmdCopyAccelerationStructureKHR = r_cast<PFN_vkCmdCopyAccelerationStructureKHR>(vkGetDeviceProcAddr(self->vk_device, "vkCmdCopyAccelerationStructureKHR"));
             self->vkGetAccelerationStructureDeviceAddressKHR = r_cast<PFN_vkGetAccelerationStructureDeviceAddressKHR>(vkGetDeviceProcAddr(self->vk_device, "vkGetAccelerationStructureDeviceAddressKHR"));
         }
 
@@ -1566,9 +1987,11 @@ auto daxa_ImplDevice::create_2(daxa_Instance instance, daxa_DeviceInfo2 const &
             self->vkGetRayTracingShaderGroupHandlesKHR = r_cast<PFN_vkGetRayTracingShaderGroupHandlesKHR>(vkGetDeviceProcAddr(self->vk_device, "vkGetRayTracingShaderGroupHandlesKHR"));
         }
     }
+    end_phase(self->creation_timings.vk_device_creation_ns);
 
     VkCommandPool init_cmd_pool = {};
     VkCommandBuffer init_cmd_buffer = {};
+    VkSemaphore init_timeline = {};
     VkCommandPoolCreateInfo const vk_command_pool_create_info{
         .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
         .pNext = nullptr,
@@ -1580,10 +2003,17 @@ auto daxa_ImplDevice::create_2(daxa_Instance instance, daxa_DeviceInfo2 const &
     _DAXA_RETURN_IF_ERROR(result, result)
     defer
     {
-        // Should always be destroyed at end of function!
-        if (init_cmd_pool)
+        // On success the device owns the pool until the init commands finished, see release_init_commands.
+        if (result != DAXA_RESULT_SUCCESS)
         {
-            vkDestroyCommandPool(self->vk_device, init_cmd_pool, nullptr);
+            if (init_timeline)
+            {
+                vkDestroySemaphore(self->vk_device, init_timeline, nullptr);
+            }
+            if (init_cmd_pool)
+            {
+                vkDestroyCommandPool(self->vk_device, init_cmd_pool, nullptr);
+            }
         }
     };
 
@@ -1645,8 +2075,12 @@ auto daxa_ImplDevice::create_2(daxa_Instance instance, daxa_DeviceInfo2 const &
 #endif
     };
 
+    self->memory_budget_enabled = physical_device.extensions.extensions_present[PhysicalDeviceExtensionsStruct::physical_device_memory_budget_ext];
+    bool const memory_priority_enabled = (self->properties.implicit_features & DAXA_IMPLICIT_FEATURE_FLAG_MEMORY_PRIORITY) != 0;
     VmaAllocatorCreateInfo const vma_allocator_create_info{
-        .flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT,
+        .flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT |
+                 (self->memory_budget_enabled ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT : VmaAllocatorCreateFlags{}) |
+                 (memory_priority_enabled ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_PRIORITY_BIT : VmaAllocatorCreateFlags{}),
         .physicalDevice = self->vk_physical_device,
         .device = self->vk_device,
         .preferredLargeHeapBlockSize = 0, // Sets it to lib internal default (256MiB).
@@ -1661,6 +2095,7 @@ auto daxa_ImplDevice::create_2(daxa_Instance instance, daxa_DeviceInfo2 const &
 
     result = static_cast<daxa_Result>(vmaCreateAllocator(&vma_allocator_create_info, &self->vma_allocator));
     _DAXA_RETURN_IF_ERROR(result, result)
+    end_phase(self->creation_timings.allocator_creation_ns);
 
     // Bulk on-error defer for coming initializations:
     defer
@@ -1860,7 +2295,8 @@ auto daxa_ImplDevice::create_2(daxa_Instance instance, daxa_DeviceInfo2 const &
         vk_image_mem_barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL,
         vk_image_mem_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
         vk_image_mem_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        vkCmdPipelineBarrier(init_cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, {}, {}, {}, {}, {}, 1, &vk_image_mem_barrier);
+        // Orders all later commands on the main queue after the upload, other queues wait on the init timeline.
+        vkCmdPipelineBarrier(init_cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, {}, {}, {}, {}, {}, 1, &vk_image_mem_barrier);
 
         VkSamplerCreateInfo const vk_sampler_create_info{
             .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
@@ -1929,6 +2365,7 @@ auto daxa_ImplDevice::create_2(daxa_Instance instance, daxa_DeviceInfo2 const &
         result = static_cast<daxa_Result>(vmaMapMemory(self->vma_allocator, self->buffer_device_address_buffer_allocation, r_cast<void **>(&self->buffer_device_address_buffer_host_ptr)));
         _DAXA_RETURN_IF_ERROR(result, DAXA_RESULT_FAILED_TO_CREATE_BDA_BUFFER)
     }
+    end_phase(self->creation_timings.null_resource_creation_ns);
 
     // Set debug names:
     if ((self->instance->info.flags & InstanceFlagBits::DEBUG_UTILS) != InstanceFlagBits::NONE && !self->info.name.view().empty())
@@ -1993,33 +2430,92 @@ auto daxa_ImplDevice::create_2(daxa_Instance instance, daxa_DeviceInfo2 const &
         self->buffer_device_address_buffer,
         self->vkSetDebugUtilsObjectNameEXT);
     _DAXA_RETURN_IF_ERROR(result, DAXA_RESULT_FAILED_TO_SUBMIT_DEVICE_INIT_COMMANDS)
+    end_phase(self->creation_timings.resource_table_creation_ns);
 
     result = static_cast<daxa_Result>(vkEndCommandBuffer(init_cmd_buffer));
     _DAXA_RETURN_IF_ERROR(result, DAXA_RESULT_FAILED_TO_SUBMIT_DEVICE_INIT_COMMANDS)
 
+    VkSemaphoreTypeCreateInfo const init_timeline_type_info{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .pNext = nullptr,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0,
+    };
+    VkSemaphoreCreateInfo const init_timeline_create_info{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &init_timeline_type_info,
+        .flags = {},
+    };
+    result = static_cast<daxa_Result>(vkCreateSemaphore(self->vk_device, &init_timeline_create_info, nullptr, &init_timeline));
+    _DAXA_RETURN_IF_ERROR(result, DAXA_RESULT_FAILED_TO_SUBMIT_DEVICE_INIT_COMMANDS)
+
     // Submit initial commands to set up the daxa device.
     VkPipelineStageFlags wait_stage_mask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    u64 const init_timeline_value = 1;
+    VkTimelineSemaphoreSubmitInfo const init_timeline_info{
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreValueCount = {},
+        .pWaitSemaphoreValues = {},
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &init_timeline_value,
+    };
     VkSubmitInfo init_submit{
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .pNext = {},
+        .pNext = &init_timeline_info,
         .waitSemaphoreCount = {},
         .pWaitSemaphores = {},
         .pWaitDstStageMask = &wait_stage_mask,
         .commandBufferCount = 1,
         .pCommandBuffers = &init_cmd_buffer,
-        .signalSemaphoreCount = {},
-        .pSignalSemaphores = {},
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &init_timeline,
     };
     result = static_cast<daxa_Result>(vkQueueSubmit(self->get_queue(DAXA_QUEUE_MAIN).vk_queue, 1, &init_submit, {}));
     _DAXA_RETURN_IF_ERROR(result, DAXA_RESULT_FAILED_TO_SUBMIT_DEVICE_INIT_COMMANDS)
 
-    // Wait for commands in from the init cmd list to complete.
-    result = static_cast<daxa_Result>(vkDeviceWaitIdle(self->vk_device));
-    _DAXA_RETURN_IF_ERROR(result, DAXA_RESULT_FAILED_TO_SUBMIT_DEVICE_INIT_COMMANDS)
+    // The init commands are not waited on here, submits on all queues wait on the init timeline instead.
+    self->init_cmd_pool = init_cmd_pool;
+    self->init_timeline = init_timeline;
+    end_phase(self->creation_timings.init_submit_ns);
 
     return DAXA_RESULT_SUCCESS;
 }
 
+void daxa_ImplDevice::release_init_commands(bool wait)
+{
+    if (this->init_timeline == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    if (wait)
+    {
+        u64 const init_timeline_value = 1;
+        VkSemaphoreWaitInfo const vk_semaphore_wait_info{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .semaphoreCount = 1,
+            .pSemaphores = &this->init_timeline,
+            .pValues = &init_timeline_value,
+        };
+        vkWaitSemaphores(this->vk_device, &vk_semaphore_wait_info, std::numeric_limits<u64>::max());
+    }
+    else
+    {
+        u64 init_timeline_value = {};
+        if (vkGetSemaphoreCounterValue(this->vk_device, this->init_timeline, &init_timeline_value) != VK_SUCCESS || init_timeline_value < 1)
+        {
+            return;
+        }
+    }
+    // Submits hold the lifetime lock shared, none of them can be about to wait on the init timeline.
+    vkDestroySemaphore(this->vk_device, this->init_timeline, nullptr);
+    vkDestroyCommandPool(this->vk_device, this->init_cmd_pool, nullptr);
+    this->init_timeline = {};
+    this->init_cmd_pool = {};
+}
+
 auto daxa_ImplDevice::get_queue(daxa_Queue queue) -> daxa_ImplDevice::ImplQueue &
 {
     u32 offsets[3] = {
@@ -2030,6 +2526,23 @@ auto daxa_ImplDevice::get_queue(daxa_Queue queue) -> daxa_ImplDevice::ImplQueue
     return this->queues[offsets[queue.family] + queue.index];
 }
 
+auto daxa_ImplDevice::get_min_pending_device_timeline_value_of_all_queues(u64 & out) -> daxa_Result
+{
+    out = std::numeric_limits<u64>::max();
+    for (auto & queue : this->queues)
+    {
+        std::optional<u64> latest_pending_submit = {};
+        auto result = queue.get_oldest_pending_submit(this->vk_device, latest_pending_submit);
+        _DAXA_RETURN_IF_ERROR(result, result)
+
+        if (latest_pending_submit.has_value())
+        {
+            out = std::min(out, latest_pending_submit.value());
+        }
+    }
+    return DAXA_RESULT_SUCCESS;
+}
+
 auto daxa_ImplDevice::valid_queue(daxa_Queue queue) -> bool
 {
     return queue.family < DAXA_QUEUE_FAMILY_MAX_ENUM && queue.index < this->queue_families[queue.family].queue_count;
@@ -2150,6 +2663,7 @@ auto daxa_ImplDevice::new_swapchain_image(VkImage swapchain_image, VkFormat form
         write_descriptor_set_image(this->vk_device, this->gpu_sro_table.vk_descriptor_set, ret.view_slot.vk_image_view, usage, id.index);
     }
 
+    this->gpu_sro_table.image_slots.publish_slot(id);
     *out = ImageId{id};
 
     return result;
@@ -2247,6 +2761,536 @@ void daxa_ImplDevice::cleanup_blas(BlasId id)
     gpu_sro_table.blas_slots.unsafe_destroy_zombie_slot(std::bit_cast<GPUResourceId>(id));
 }
 
+auto daxa_ImplDevice::memory_report_per_name() -> std::vector<daxa_NamedMemoryReport>
+{
+    std::vector<daxa_NamedMemoryReport> ret = {};
+    std::unordered_map<std::string, usize> name_indices = {};
+    {
+        std::unique_lock const lock{this->zombies_mtx};
+        visit_resource_memory(this, [&](daxa_SmallString const & name, ResourceMemoryKind, u64 bytes)
+        {
+            auto name_index_iter = name_indices.find(std::string{name.data, name.size});
+            if (name_index_iter == name_indices.end())
+            {
+                name_index_iter = name_indices.emplace(std::string{name.data, name.size}, ret.size()).first;
+                ret.push_back(daxa_NamedMemoryReport{.name = name});
+            }
+            ret[name_index_iter->second].count += 1;
+            ret[name_index_iter->second].bytes += bytes;
+        });
+    }
+    std::sort(ret.begin(), ret.end(), [](daxa_NamedMemoryReport const & a, daxa_NamedMemoryReport const & b)
+              { return a.bytes > b.bytes; });
+    return ret;
+}
+
+auto daxa_dvc_memory_report_per_name(daxa_Device self, daxa_NamedMemoryReport * out_reports, u32 * inout_report_count) -> daxa_Result
+{
+    auto const reports = self->memory_report_per_name();
+    if (out_reports == nullptr)
+    {
+        *inout_report_count = static_cast<u32>(reports.size());
+        return DAXA_RESULT_SUCCESS;
+    }
+    u32 const count = std::min(*inout_report_count, static_cast<u32>(reports.size()));
+    std::copy_n(reports.begin(), count, out_reports);
+    *inout_report_count = count;
+    return count < reports.size() ? DAXA_RESULT_INCOMPLETE : DAXA_RESULT_SUCCESS;
+}
+
+static void set_defragmentation_debug_name(daxa_Device self, VkObjectType vk_object_type, u64 vk_handle, daxa_SmallString const & name)
+{
+    if ((self->instance->info.flags & InstanceFlagBits::DEBUG_UTILS) != InstanceFlagBits::NONE && name.size != 0)
+    {
+        auto c_str_arr = r_cast<SmallString const *>(&name)->c_str();
+        VkDebugUtilsObjectNameInfoEXT const name_info{
+            .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+            .pNext = nullptr,
+            .objectType = vk_object_type,
+            .objectHandle = vk_handle,
+            .pObjectName = c_str_arr.data(),
+        };
+        self->vkSetDebugUtilsObjectNameEXT(self->vk_device, &name_info);
+    }
+}
+
+auto daxa_ImplDevice::record_defragmentation_pass(daxa_QueueFamily queue_family, VkCommandBuffer vk_cmd_buffer, u32 & out_move_count) -> daxa_Result
+{
+    out_move_count = 0;
+    std::unique_lock const lock{this->zombies_mtx};
+    auto & defragmentation = this->defragmentation;
+    if (defragmentation.state != ImplDefragmentation::State::IDLE)
+    {
+        return DAXA_RESULT_SUCCESS;
+    }
+    auto const vk_result = vmaBeginDefragmentationPass(this->vma_allocator, defragmentation.vma_context, &defragmentation.vma_pass);
+    if (vk_result != VK_INCOMPLETE)
+    {
+        // VK_SUCCESS means there is nothing left to move.
+        finish_defragmentation(this);
+        return std::bit_cast<daxa_Result>(vk_result);
+    }
+
+    auto const & info = defragmentation.info;
+    auto const image_layout = static_cast<VkImageLayout>(info.image_layout);
+    auto const src_copy_layout = image_layout == VK_IMAGE_LAYOUT_GENERAL ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    // Exclusive resources are expected to be owned by the main queue family.
+    auto const movable_on_queue_family = [&](bool concurrent)
+    {
+        return concurrent || queue_family == DAXA_QUEUE_FAMILY_MAIN;
+    };
+    auto & buffer_slots = this->gpu_sro_table.buffer_slots;
+    auto & image_slots = this->gpu_sro_table.image_slots;
+    std::vector<VkImageMemoryBarrier2> pre_copy_image_barriers = {};
+    std::vector<VkImageMemoryBarrier2> post_copy_image_barriers = {};
+    auto const image_barrier = [&](VkImage vk_image, VkImageSubresourceRange const & range, VkImageLayout old_layout, VkImageLayout new_layout, bool pre_copy)
+    {
+        return VkImageMemoryBarrier2{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .pNext = nullptr,
+            .srcStageMask = pre_copy ? VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            .srcAccessMask = pre_copy ? VK_ACCESS_2_MEMORY_WRITE_BIT : VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .dstStageMask = pre_copy ? VK_PIPELINE_STAGE_2_TRANSFER_BIT : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .dstAccessMask = pre_copy ? (VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT) : (VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT),
+            .oldLayout = old_layout,
+            .newLayout = new_layout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = vk_image,
+            .subresourceRange = range,
+        };
+    };
+
+    defragmentation.moves.assign(defragmentation.vma_pass.moveCount, ImplDefragmentationMove{});
+    u32 move_count = 0;
+    for (u32 i = 0; i < defragmentation.vma_pass.moveCount; ++i)
+    {
+        auto & vma_move = defragmentation.vma_pass.pMoves[i];
+        auto & move = defragmentation.moves[i];
+        // Allocations that can not be moved stay in place, vma frees the memory reserved for them.
+        vma_move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+        VmaAllocationInfo allocation_info = {};
+        vmaGetAllocationInfo(this->vma_allocator, vma_move.srcAllocation, &allocation_info);
+        if (allocation_info.pUserData == nullptr)
+        {
+            continue;
+        }
+        move.id = std::bit_cast<GPUResourceId>(allocation_info.pUserData);
+        if (buffer_slots.is_id_valid(move.id) && buffer_slots.unsafe_get(move.id).vma_allocation == vma_move.srcAllocation)
+        {
+            auto const & slot = buffer_slots.unsafe_get(move.id);
+            if (!info.move_buffers || !movable_on_queue_family(slot.info.sharing_mode == DAXA_SHARING_MODE_CONCURRENT))
+            {
+                continue;
+            }
+            VkBufferCreateInfo const vk_buffer_create_info = initialize_buffer_create_info_from_buffer_info(this, slot.info);
+            if (vkCreateBuffer(this->vk_device, &vk_buffer_create_info, nullptr, &move.vk_buffer) != VK_SUCCESS)
+            {
+                move.vk_buffer = {};
+                continue;
+            }
+            if (vmaBindBufferMemory(this->vma_allocator, vma_move.dstTmpAllocation, move.vk_buffer) != VK_SUCCESS)
+            {
+                vkDestroyBuffer(this->vk_device, move.vk_buffer, nullptr);
+                move.vk_buffer = {};
+                continue;
+            }
+            set_defragmentation_debug_name(this, VK_OBJECT_TYPE_BUFFER, std::bit_cast<u64>(move.vk_buffer), slot.info.name);
+        }
+        else if (image_slots.is_id_valid(move.id) && image_slots.unsafe_get(move.id).vma_allocation == vma_move.srcAllocation)
+        {
+            auto const & slot = image_slots.unsafe_get(move.id);
+            bool const transfer_usage =
+                (slot.info.usage & DAXA_IMAGE_USE_FLAG_TRANSFER_SRC) != 0 &&
+                (slot.info.usage & DAXA_IMAGE_USE_FLAG_TRANSFER_DST) != 0;
+            if (!info.move_images || !transfer_usage || !movable_on_queue_family(slot.info.sharing_mode == DAXA_SHARING_MODE_CONCURRENT))
+            {
+                continue;
+            }
+            VkImageCreateInfo const vk_image_create_info = initialize_image_create_info_from_image_info(this, slot.info);
+            if (vkCreateImage(this->vk_device, &vk_image_create_info, nullptr, &move.vk_image) != VK_SUCCESS)
+            {
+                move.vk_image = {};
+                continue;
+            }
+            if (vmaBindImageMemory(this->vma_allocator, vma_move.dstTmpAllocation, move.vk_image) != VK_SUCCESS)
+            {
+                vkDestroyImage(this->vk_device, move.vk_image, nullptr);
+                move.vk_image = {};
+                continue;
+            }
+            set_defragmentation_debug_name(this, VK_OBJECT_TYPE_IMAGE, std::bit_cast<u64>(move.vk_image), slot.info.name);
+            move.is_image = true;
+            VkImageSubresourceRange const range{
+                .aspectMask = slot.aspect_flags,
+                .baseMipLevel = 0,
+                .levelCount = slot.info.mip_level_count,
+                .baseArrayLayer = 0,
+                .layerCount = slot.info.array_layer_count,
+            };
+            pre_copy_image_barriers.push_back(image_barrier(move.vk_image, range, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true));
+            post_copy_image_barriers.push_back(image_barrier(move.vk_image, range, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, image_layout, false));
+            if (image_layout != src_copy_layout)
+            {
+                pre_copy_image_barriers.push_back(image_barrier(slot.vk_image, range, image_layout, src_copy_layout, true));
+                post_copy_image_barriers.push_back(image_barrier(slot.vk_image, range, src_copy_layout, image_layout, false));
+            }
+        }
+        else
+        {
+            continue;
+        }
+        vma_move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY;
+        move_count += 1;
+    }
+    if (move_count == 0)
+    {
+        return this->end_defragmentation_pass(false);
+    }
+
+    VkMemoryBarrier2 const pre_copy_memory_barrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .pNext = nullptr,
+        .srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        .srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        .dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT,
+    };
+    VkDependencyInfo const pre_copy_dependency_info{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .pNext = nullptr,
+        .dependencyFlags = {},
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &pre_copy_memory_barrier,
+        .bufferMemoryBarrierCount = 0,
+        .pBufferMemoryBarriers = nullptr,
+        .imageMemoryBarrierCount = static_cast<u32>(pre_copy_image_barriers.size()),
+        .pImageMemoryBarriers = pre_copy_image_barriers.data(),
+    };
+    vkCmdPipelineBarrier2(vk_cmd_buffer, &pre_copy_dependency_info);
+
+    std::vector<VkImageCopy> image_copies = {};
+    for (u32 i = 0; i < defragmentation.vma_pass.moveCount; ++i)
+    {
+        auto const & move = defragmentation.moves[i];
+        if (defragmentation.vma_pass.pMoves[i].operation != VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY)
+        {
+            continue;
+        }
+        if (!move.is_image)
+        {
+            auto const & slot = buffer_slots.unsafe_get(move.id);
+            VkBufferCopy const region{
+                .srcOffset = 0,
+                .dstOffset = 0,
+                .size = static_cast<VkDeviceSize>(slot.info.size),
+            };
+            vkCmdCopyBuffer(vk_cmd_buffer, slot.vk_buffer, move.vk_buffer, 1, &region);
+        }
+        else
+        {
+            auto const & slot = image_slots.unsafe_get(move.id);
+            image_copies.clear();
+            for (u32 mip = 0; mip < slot.info.mip_level_count; ++mip)
+            {
+                VkImageSubresourceLayers const subresource{
+                    .aspectMask = slot.aspect_flags,
+                    .mipLevel = mip,
+                    .baseArrayLayer = 0,
+                    .layerCount = slot.info.array_layer_count,
+                };
+                image_copies.push_back(VkImageCopy{
+                    .srcSubresource = subresource,
+                    .srcOffset = {},
+                    .dstSubresource = subresource,
+                    .dstOffset = {},
+                    .extent = {
+                        .width = std::max(slot.info.size.width >> mip, 1u),
+                        .height = std::max(slot.info.size.height >> mip, 1u),
+                        .depth = std::max(slot.info.size.depth >> mip, 1u),
+                    },
+                });
+            }
+            vkCmdCopyImage(
+                vk_cmd_buffer,
+                slot.vk_image, src_copy_layout,
+                move.vk_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                static_cast<u32>(image_copies.size()), image_copies.data());
+        }
+    }
+
+    // Commands submitted after the pass finished access the resources through their new handles.
+    VkMemoryBarrier2 const post_copy_memory_barrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .pNext = nullptr,
+        .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+    };
+    VkDependencyInfo const post_copy_dependency_info{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .pNext = nullptr,
+        .dependencyFlags = {},
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &post_copy_memory_barrier,
+        .bufferMemoryBarrierCount = 0,
+        .pBufferMemoryBarriers = nullptr,
+        .imageMemoryBarrierCount = static_cast<u32>(post_copy_image_barriers.size()),
+        .pImageMemoryBarriers = post_copy_image_barriers.data(),
+    };
+    vkCmdPipelineBarrier2(vk_cmd_buffer, &post_copy_dependency_info);
+
+    defragmentation.state = ImplDefragmentation::State::RECORDED;
+    out_move_count = move_count;
+    return DAXA_RESULT_SUCCESS;
+}
+
+void daxa_ImplDevice::submit_defragmentation_pass(u64 submit_timeline_value)
+{
+    std::unique_lock const lock{this->zombies_mtx};
+    if (this->defragmentation.state == ImplDefragmentation::State::RECORDED)
+    {
+        this->defragmentation.timeline_value = submit_timeline_value;
+        this->defragmentation.state = ImplDefragmentation::State::SUBMITTED;
+    }
+}
+
+void daxa_ImplDevice::cancel_defragmentation_pass()
+{
+    std::unique_lock const lock{this->zombies_mtx};
+    if (this->defragmentation.state == ImplDefragmentation::State::RECORDED)
+    {
+        [[maybe_unused]] auto const result = this->end_defragmentation_pass(true);
+    }
+}
+
+auto daxa_ImplDevice::advance_defragmentation(u64 min_pending_device_timeline_value_of_all_queues) -> daxa_Result
+{
+    auto & defragmentation = this->defragmentation;
+    // Command recorders hold the lifetime lock shared, so none exist while collect_garbage swaps the slots.
+    // Completed command lists may still reference the old handles, the swap waits until all of them were submitted.
+    if (defragmentation.state == ImplDefragmentation::State::SUBMITTED &&
+        defragmentation.timeline_value < min_pending_device_timeline_value_of_all_queues &&
+        this->unsubmitted_command_list_count.load(std::memory_order::relaxed) != 0)
+    {
+        // A command list that is never submitted must not suspend the zombie cleanup forever.
+        // Nothing references the new handles yet, canceling only drops the executed copies.
+        defragmentation.blocked_collect_count += 1;
+        if (defragmentation.blocked_collect_count >= MAX_DEFRAGMENTATION_PASS_BLOCKED_COLLECTS)
+        {
+            return this->end_defragmentation_pass(true);
+        }
+        return DAXA_RESULT_SUCCESS;
+    }
+    if (defragmentation.state == ImplDefragmentation::State::SUBMITTED &&
+        defragmentation.timeline_value < min_pending_device_timeline_value_of_all_queues)
+    {
+        // The copies executed, the moved resources switch to their new handles.
+        auto & buffer_slots = this->gpu_sro_table.buffer_slots;
+        auto & image_slots = this->gpu_sro_table.image_slots;
+        auto const mutable_slot = [](auto & pool, u32 index) -> auto &
+        {
+            return pool.pages[index >> pool.PAGE_BITS]->at(index & pool.PAGE_MASK).first;
+        };
+        // Maps moved image ids to their move index.
+        std::unordered_map<u64, usize> image_moves = {};
+        for (usize i = 0; i < defragmentation.moves.size(); ++i)
+        {
+            auto & vma_move = defragmentation.vma_pass.pMoves[i];
+            auto & move = defragmentation.moves[i];
+            if (vma_move.operation != VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY)
+            {
+                continue;
+            }
+            VmaAllocationInfo allocation_info = {};
+            vmaGetAllocationInfo(this->vma_allocator, vma_move.srcAllocation, &allocation_info);
+            bool const alive = move.is_image ? image_slots.is_id_valid(move.id) : buffer_slots.is_id_valid(move.id);
+            // Resources destroyed since the pass was recorded and buffers that back acceleration structures by now stay in place.
+            if (!alive || allocation_info.pUserData == nullptr)
+            {
+                vma_move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                continue;
+            }
+            if (!move.is_image)
+            {
+                auto & slot = mutable_slot(buffer_slots, static_cast<u32>(move.id.index));
+                std::swap(slot.vk_buffer, move.vk_buffer);
+                VkBufferDeviceAddressInfo const vk_buffer_device_address_info{
+                    .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+                    .pNext = nullptr,
+                    .buffer = slot.vk_buffer,
+                };
+                slot.device_address = vkGetBufferDeviceAddress(this->vk_device, &vk_buffer_device_address_info);
+                this->buffer_device_address_buffer_host_ptr[move.id.index] = slot.device_address;
+                write_descriptor_set_buffer(
+                    this->vk_device,
+                    this->gpu_sro_table.vk_descriptor_set, slot.vk_buffer,
+                    0,
+                    static_cast<VkDeviceSize>(slot.info.size),
+                    static_cast<u32>(move.id.index));
+            }
+            else
+            {
+                auto const & slot = image_slots.unsafe_get(move.id);
+                VkImageViewCreateInfo const vk_image_view_create_info = initialize_default_image_view_create_info(slot.info, slot.aspect_flags, move.vk_image);
+                if (vkCreateImageView(this->vk_device, &vk_image_view_create_info, nullptr, &move.vk_image_view) != VK_SUCCESS)
+                {
+                    move.vk_image_view = {};
+                    vma_move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                    continue;
+                }
+                set_defragmentation_debug_name(this, VK_OBJECT_TYPE_IMAGE_VIEW, std::bit_cast<u64>(move.vk_image_view), slot.info.name);
+                image_moves[std::bit_cast<u64>(move.id)] = i;
+            }
+        }
+        if (!image_moves.empty())
+        {
+            // Image views of moved images are recreated for the new image.
+            u32 const page_count = image_slots.valid_page_count.load(std::memory_order_acquire);
+            for (u32 index = 0; index < (page_count << image_slots.PAGE_BITS); ++index)
+            {
+                // Image views created in parallel are not published yet, they are skipped.
+                if (image_slots.try_get_published(index) == nullptr)
+                {
+                    continue;
+                }
+                auto const & view_slot = mutable_slot(image_slots, index);
+                if (view_slot.vk_image != VK_NULL_HANDLE || view_slot.view_slot.vk_image_view == VK_NULL_HANDLE)
+                {
+                    continue;
+                }
+                auto const iter = image_moves.find(std::bit_cast<u64>(view_slot.view_slot.info.image));
+                if (iter == image_moves.end() || defragmentation.vma_pass.pMoves[iter->second].operation != VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY)
+                {
+                    continue;
+                }
+                auto & move = defragmentation.moves[iter->second];
+                VkImageViewCreateInfo const vk_image_view_create_info{
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = {},
+                    .image = move.vk_image,
+                    .viewType = static_cast<VkImageViewType>(view_slot.view_slot.info.type),
+                    .format = static_cast<VkFormat>(view_slot.view_slot.info.format),
+                    .components = VkComponentMapping{
+                        .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+                        .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+                        .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+                        .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+                    },
+                    .subresourceRange = make_subresource_range(view_slot.view_slot.info.slice, image_slots.unsafe_get(move.id).aspect_flags),
+                };
+                VkImageView vk_image_view = {};
+                if (vkCreateImageView(this->vk_device, &vk_image_view_create_info, nullptr, &vk_image_view) != VK_SUCCESS)
+                {
+                    // The image can not switch without all of its views.
+                    defragmentation.vma_pass.pMoves[iter->second].operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                    continue;
+                }
+                set_defragmentation_debug_name(this, VK_OBJECT_TYPE_IMAGE_VIEW, std::bit_cast<u64>(vk_image_view), view_slot.view_slot.info.name);
+                move.image_views.push_back({index, vk_image_view});
+            }
+        }
+        for (auto const & [id, move_index] : image_moves)
+        {
+            if (defragmentation.vma_pass.pMoves[move_index].operation != VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY)
+            {
+                continue;
+            }
+            auto & move = defragmentation.moves[move_index];
+            auto & slot = mutable_slot(image_slots, static_cast<u32>(move.id.index));
+            std::swap(slot.vk_image, move.vk_image);
+            std::swap(slot.view_slot.vk_image_view, move.vk_image_view);
+            write_descriptor_set_image(
+                this->vk_device,
+                this->gpu_sro_table.vk_descriptor_set,
+                slot.view_slot.vk_image_view,
+                std::bit_cast<ImageUsageFlags>(slot.info.usage),
+                static_cast<u32>(move.id.index));
+            for (auto & [view_index, vk_image_view] : move.image_views)
+            {
+                auto & view_slot = mutable_slot(image_slots, view_index).view_slot;
+                std::swap(view_slot.vk_image_view, vk_image_view);
+                write_descriptor_set_image(
+                    this->vk_device,
+                    this->gpu_sro_table.vk_descriptor_set,
+                    view_slot.vk_image_view,
+                    std::bit_cast<ImageUsageFlags>(slot.info.usage),
+                    view_index);
+            }
+        }
+        // Submits up to now may still use the old handles and read the old descriptors or device addresses.
+        // The old handles and memory stay valid until these submits finished, the pass ends once they did.
+        defragmentation.timeline_value = this->global_submit_timeline.load(std::memory_order::relaxed);
+        defragmentation.state = ImplDefragmentation::State::SWAPPED;
+    }
+    if (defragmentation.state == ImplDefragmentation::State::SWAPPED &&
+        defragmentation.timeline_value < min_pending_device_timeline_value_of_all_queues)
+    {
+        return this->end_defragmentation_pass(false);
+    }
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_ImplDevice::end_defragmentation_pass(bool cancel) -> daxa_Result
+{
+    auto & defragmentation = this->defragmentation;
+    for (usize i = 0; i < defragmentation.moves.size(); ++i)
+    {
+        auto & vma_move = defragmentation.vma_pass.pMoves[i];
+        auto & move = defragmentation.moves[i];
+        if (cancel)
+        {
+            vma_move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+        }
+        if (vma_move.operation == VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY)
+        {
+            VmaAllocationInfo allocation_info = {};
+            vmaGetAllocationInfo(this->vma_allocator, vma_move.srcAllocation, &allocation_info);
+            defragmentation.statistics.bytes_moved += allocation_info.size;
+            defragmentation.statistics.allocations_moved += 1;
+        }
+        // Moves that switched hold the old handles, all others the unused new ones.
+        for (auto const & [view_index, vk_image_view] : move.image_views)
+        {
+            vkDestroyImageView(this->vk_device, vk_image_view, nullptr);
+        }
+        if (move.vk_image_view != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(this->vk_device, move.vk_image_view, nullptr);
+        }
+        if (move.vk_image != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(this->vk_device, move.vk_image, nullptr);
+        }
+        if (move.vk_buffer != VK_NULL_HANDLE)
+        {
+            vkDestroyBuffer(this->vk_device, move.vk_buffer, nullptr);
+        }
+    }
+    // Frees the old memory of moved allocations and the reserved memory of all others.
+    auto const vk_result = vmaEndDefragmentationPass(this->vma_allocator, defragmentation.vma_context, &defragmentation.vma_pass);
+    defragmentation.moves.clear();
+    defragmentation.vma_pass = {};
+    defragmentation.blocked_collect_count = 0;
+    defragmentation.state = ImplDefragmentation::State::IDLE;
+    if (!cancel)
+    {
+        defragmentation.statistics.passes += 1;
+    }
+    // VK_SUCCESS means there is nothing left to move.
+    if (vk_result != VK_INCOMPLETE || defragmentation.end_requested)
+    {
+        finish_defragmentation(this);
+    }
+    if (vk_result != VK_SUCCESS && vk_result != VK_INCOMPLETE)
+    {
+        return std::bit_cast<daxa_Result>(vk_result);
+    }
+    return DAXA_RESULT_SUCCESS;
+}
+
 auto daxa_ImplDevice::slot(daxa_BufferId id) const -> ImplBufferSlot const &
 {
     return gpu_sro_table.buffer_slots.unsafe_get(std::bit_cast<daxa::GPUResourceId>(id));
@@ -2281,10 +3325,13 @@ void daxa_ImplDevice::zero_ref_callback(ImplHandle const * handle)
 {
     _DAXA_TEST_PRINT("daxa_ImplDevice::zero_ref_callback\n");
     auto self = rc_cast<daxa_Device>(handle);
+    // The pass in flight is finished by the collect_garbage below.
+    daxa_dvc_end_defragmentation(self);
     auto result = daxa_dvc_wait_idle(self);
     DAXA_DBG_ASSERT_TRUE_M(result == DAXA_RESULT_SUCCESS, "failed to wait idle");
     result = daxa_dvc_collect_garbage(self);
     DAXA_DBG_ASSERT_TRUE_M(result == DAXA_RESULT_SUCCESS, "failed to wait idle");
+    self->release_init_commands(true);
     for (auto & pool_pool : self->command_pool_pools)
     {
         pool_pool.cleanup(self);
@@ -2312,6 +3359,7 @@ template <typename T>
 void zombiefy(daxa_Device self, T id, auto & slots, auto & zombies)
 {
     [[maybe_unused]] auto & slot = slots.unsafe_get(std::bit_cast<GPUResourceId>(id));
+    [[maybe_unused]] daxa_MemoryPool opt_memory_pool = nullptr;
     if constexpr (std::is_same_v<T, BufferId> || std::is_same_v<T, ImageId>)
     {
         if (slot.opt_memory_block != nullptr)
@@ -2320,6 +3368,7 @@ void zombiefy(daxa_Device self, T id, auto & slots, auto & zombies)
                 daxa_ImplMemoryBlock::zero_ref_callback,
                 self->instance);
         }
+        opt_memory_pool = slot.opt_memory_pool;
     }
     if constexpr (std::is_same_v<T, TlasId> || std::is_same_v<T, BlasId>)
     {
@@ -2329,9 +3378,14 @@ void zombiefy(daxa_Device self, T id, auto & slots, auto & zombies)
         }
     }
     u64 const submit_timeline_value = self->global_submit_timeline.load(std::memory_order::relaxed);
-    {
-        std::unique_lock const lock{self->zombies_mtx};
-        zombies.push_front(std::pair{submit_timeline_value, id});
+    zombies.stage(slots, std::bit_cast<GPUResourceId>(id), submit_timeline_value);
+    // Released after staging, so that the pool zombie is never tagged older than its last resource.
+    // collect_garbage additionally keeps pool zombies alive until all their allocations are freed.
+    if (opt_memory_pool != nullptr)
+    {
+        opt_memory_pool->dec_weak_refcnt(
+            daxa_ImplMemoryPool::zero_ref_callback,
+            self->instance);
     }
 }
 
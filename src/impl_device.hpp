@@ -22,7 +22,48 @@ struct SubmitZombie
     std::vector<daxa_TimelineSemaphore> timeline_semaphores = {};
 };
 
+struct ImplDefragmentationMove
+{
+    // Id of the moved resource when the pass was recorded.
+    GPUResourceId id = {};
+    bool is_image = {};
+    // Handles bound to the new memory, swapped with the slot handles once the copies executed.
+    // After the swap these hold the old handles, which are destroyed once the submits that may use them finished.
+    VkBuffer vk_buffer = {};
+    VkImage vk_image = {};
+    VkImageView vk_image_view = {};
+    // Image views of the moved image, pairs of view slot index and view.
+    std::vector<std::pair<u32, VkImageView>> image_views = {};
+};
+
+struct ImplDefragmentation
+{
+    enum struct State
+    {
+        INACTIVE,
+        IDLE,
+        RECORDED,
+        SUBMITTED,
+        SWAPPED,
+    };
+    State state = State::INACTIVE;
+    daxa_DefragmentationInfo info = {};
+    VmaDefragmentationContext vma_context = {};
+    VmaDefragmentationPassMoveInfo vma_pass = {};
+    // Parallel to vma_pass.pMoves.
+    std::vector<ImplDefragmentationMove> moves = {};
+    // SUBMITTED: global submit timeline value of the submit containing the copies.
+    // SWAPPED: global submit timeline value when the slots switched to the new handles.
+    u64 timeline_value = {};
+    // Number of collect_garbage calls the executed copies waited for unsubmitted command lists.
+    u32 blocked_collect_count = {};
+    bool end_requested = {};
+    daxa_DefragmentationStatistics statistics = {};
+};
+
 static inline constexpr u64 MAX_PENDING_SUBMISSIONS_PER_QUEUE = 64;
+// A pass that can not switch to the new handles within this many collect_garbage calls is canceled.
+static inline constexpr u32 MAX_DEFRAGMENTATION_PASS_BLOCKED_COLLECTS = 8;
 static inline constexpr u64 MAIN_QUEUE_INDEX = 0;
 static inline constexpr u64 FIRST_COMPUTE_QUEUE_IDX = 1;
 static inline constexpr u64 FIRST_TRANSFER_QUEUE_IDX = FIRST_COMPUTE_QUEUE_IDX + DAXA_MAX_COMPUTE_QUEUE_COUNT;
@@ -37,6 +78,10 @@ struct daxa_ImplDevice final : public ImplHandle
     PhysicalDeviceFeaturesStruct physical_device_features = {};
     VkDevice vk_device = {};
     VmaAllocator vma_allocator = {};
+    bool memory_budget_enabled = {};
+    // Memory blocks are not stored in a slot pool, they are counted for memory reports instead.
+    std::atomic_uint64_t memory_block_count = {};
+    std::atomic_uint64_t memory_block_bytes = {};
 
     // Dynamic State:
     PFN_vkCmdSetRasterizationSamplesEXT vkCmdSetRasterizationSamplesEXT = {};
@@ -52,12 +97,16 @@ struct daxa_ImplDevice final : public ImplHandle
     PFN_vkCmdDrawMeshTasksIndirectCountEXT vkCmdDrawMeshTasksIndirectCountEXT = {};
     VkPhysicalDeviceMeshShaderPropertiesEXT mesh_shader_properties = {};
 
+    // Present wait:
+    PFN_vkWaitForPresentKHR vkWaitForPresentKHR = {};
+
     // Ray tracing:
     PFN_vkGetAccelerationStructureBuildSizesKHR vkGetAccelerationStructureBuildSizesKHR = {};
     PFN_vkCreateAccelerationStructureKHR vkCreateAccelerationStructureKHR = {};
     PFN_vkDestroyAccelerationStructureKHR vkDestroyAccelerationStructureKHR = {};
     PFN_vkCmdWriteAccelerationStructuresPropertiesKHR vkCmdWriteAccelerationStructuresPropertiesKHR = {};
     PFN_vkCmdBuildAccelerationStructuresKHR vkCmdBuildAccelerationStructuresKHR = {};
+    PFN_vkCmdCopyAccelerationStructureKHR vkCmdCopyAccelerationStructureKHR = {};
     PFN_vkGetAccelerationStructureDeviceAddressKHR vkGetAccelerationStructureDeviceAddressKHR = {};
     PFN_vkCreateRayTracingPipelinesKHR vkCreateRayTracingPipelinesKHR = {};
     PFN_vkGetRayTracingShaderGroupHandlesKHR vkGetRayTracingShaderGroupHandlesKHR = {};
@@ -80,6 +129,13 @@ struct daxa_ImplDevice final : public ImplHandle
     VmaAllocation vk_null_buffer_vma_allocation = {};
     VmaAllocation vk_null_image_vma_allocation = {};
 
+    // The commands uploading the null resources are not waited on during device creation.
+    // They signal the init timeline to 1, every submit waits on it until collect_garbage released the init commands.
+    VkCommandPool init_cmd_pool = {};
+    VkSemaphore init_timeline = {};
+
+    daxa_DeviceCreationTimings creation_timings = {};
+
     // Command Buffer/Pool recycling:
     // Index with daxa_QueueFamily.
     std::array<CommandPoolPool, 3> command_pool_pools = {};
@@ -95,17 +151,24 @@ struct daxa_ImplDevice final : public ImplHandle
     std::atomic_uint64_t global_submit_timeline = {};
     std::recursive_mutex zombies_mtx = {};
     std::deque<std::pair<u64, CommandRecorderZombie>> command_list_zombies = {};
-    std::deque<std::pair<u64, BufferId>> buffer_zombies = {};
-    std::deque<std::pair<u64, ImageId>> image_zombies = {};
-    std::deque<std::pair<u64, ImageViewId>> image_view_zombies = {};
-    std::deque<std::pair<u64, SamplerId>> sampler_zombies = {};
-    std::deque<std::pair<u64, TlasId>> tlas_zombies = {};
-    std::deque<std::pair<u64, BlasId>> blas_zombies = {};
+    // Gpu resource zombies are staged without taking the zombies_mtx, collect_garbage merges them.
+    GpuResourceZombieList buffer_zombies = {};
+    GpuResourceZombieList image_zombies = {};
+    GpuResourceZombieList image_view_zombies = {};
+    GpuResourceZombieList sampler_zombies = {};
+    GpuResourceZombieList tlas_zombies = {};
+    GpuResourceZombieList blas_zombies = {};
     std::deque<std::pair<u64, SemaphoreZombie>> semaphore_zombies = {};
     std::deque<std::pair<u64, EventZombie>> split_barrier_zombies = {};
     std::deque<std::pair<u64, PipelineZombie>> pipeline_zombies = {};
     std::deque<std::pair<u64, TimelineQueryPoolZombie>> timeline_query_pool_zombies = {};
     std::deque<std::pair<u64, MemoryBlockZombie>> memory_block_zombies = {};
+    std::deque<std::pair<u64, MemoryPoolZombie>> memory_pool_zombies = {};
+    // Synchronized by the zombies_mtx.
+    // Buffer and image zombies are not cleaned up while a pass is in flight, as vma forbids freeing allocations of a pass.
+    ImplDefragmentation defragmentation = {};
+    // Completed command lists that were not submitted yet, they may reference handles a defragmentation swap replaces.
+    std::atomic_uint64_t unsubmitted_command_list_count = {};
 
     // Queues
     struct ImplQueue
@@ -139,6 +202,9 @@ struct daxa_ImplDevice final : public ImplHandle
 
     auto get_queue(daxa_Queue queue) -> ImplQueue&;
     auto valid_queue(daxa_Queue queue) -> bool;
+    // Smallest gpu timeline value of all queues that still have pending submits, u64 max when all queues are idle.
+    // Anything last used before the global_submit_timeline had a value below this is no longer used by the gpu.
+    auto get_min_pending_device_timeline_value_of_all_queues(u64 & out) -> daxa_Result;
 
     struct ImplQueueFamily
     {
@@ -161,6 +227,16 @@ struct daxa_ImplDevice final : public ImplHandle
     auto slot(daxa_TlasId id) const -> ImplTlasSlot const &;
     auto slot(daxa_BlasId id) const -> ImplBlasSlot const &;
 
+    auto memory_report_per_name() -> std::vector<daxa_NamedMemoryReport>;
+
+    auto record_defragmentation_pass(daxa_QueueFamily queue_family, VkCommandBuffer vk_cmd_buffer, u32 & out_move_count) -> daxa_Result;
+    void submit_defragmentation_pass(u64 submit_timeline_value);
+    void cancel_defragmentation_pass();
+    // Once the copies executed and all completed command lists were submitted,
+    // waits for the device to idle, swaps the slots of the moved resources and ends the pass.
+    auto advance_defragmentation(u64 min_pending_device_timeline_value_of_all_queues) -> daxa_Result;
+    auto end_defragmentation_pass(bool cancel) -> daxa_Result;
+
     void cleanup_buffer(BufferId id);
     void cleanup_image(ImageId id);
     void cleanup_image_view(ImageViewId id);
@@ -175,6 +251,8 @@ struct daxa_ImplDevice final : public ImplHandle
     void zombify_tlas(TlasId id);
     void zombify_blas(BlasId id);
 
+    void release_init_commands(bool wait);
+
     static auto create_2(daxa_Instance instance, daxa_DeviceInfo2 const& info, ImplPhysicalDevice const & physical_device, daxa_DeviceProperties const & properties, daxa_Device device) -> daxa_Result;
     static auto create(daxa_Instance instance, daxa_DeviceInfo const & info, VkPhysicalDevice physical_device, daxa_Device device) -> daxa_Result;
     static void zero_ref_callback(ImplHandle const * handle);
@@ -150,6 +150,27 @@ namespace daxa
             chain = static_cast<void *>(&physical_device_shader_atomic_float_features_ext);
         }
 
+        if (extensions.extensions_present[extensions.physical_device_memory_priority_ext])
+        {
+            physical_device_memory_priority_features_ext.pNext = chain;
+            physical_device_memory_priority_features_ext.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PRIORITY_FEATURES_EXT;
+            chain = static_cast<void *>(&physical_device_memory_priority_features_ext);
+        }
+
+        if (extensions.extensions_present[extensions.physical_device_present_id_khr])
+        {
+            physical_device_present_id_features_khr.pNext = chain;
+            physical_device_present_id_features_khr.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+            chain = static_cast<void *>(&physical_device_present_id_features_khr);
+        }
+
+        if (extensions.extensions_present[extensions.physical_device_present_wait_khr])
+        {
+            physical_device_present_wait_features_khr.pNext = chain;
+            physical_device_present_wait_features_khr.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+            chain = static_cast<void *>(&physical_device_present_wait_features_khr);
+        }
+
         conservative_rasterization = extensions.extensions_present[extensions.physical_device_conservative_rasterization_ext];
         swapchain = extensions.extensions_present[extensions.physical_device_swapchain_khr];
 
@@ -285,6 +306,23 @@ namespace daxa
         offsetof(PhysicalDeviceFeaturesStruct, physical_device_shader_atomic_float_features_ext.shaderImageFloat32AtomicAdd),
     };
 
+    constexpr static std::array DAXA_IMPLICIT_FEATURE_FLAG_PIPELINE_STATISTICS_QUERY_VK_FEATURES = std::array{
+        offsetof(PhysicalDeviceFeaturesStruct, physical_device_features_2.features.pipelineStatisticsQuery),
+    };
+
+    constexpr static std::array DAXA_IMPLICIT_FEATURE_FLAG_PRECISE_OCCLUSION_QUERY_VK_FEATURES = std::array{
+        offsetof(PhysicalDeviceFeaturesStruct, physical_device_features_2.features.occlusionQueryPrecise),
+    };
+
+    constexpr static std::array DAXA_IMPLICIT_FEATURE_FLAG_MEMORY_PRIORITY_VK_FEATURES = std::array{
+        offsetof(PhysicalDeviceFeaturesStruct, physical_device_memory_priority_features_ext.memoryPriority),
+    };
+
+    constexpr static std::array DAXA_IMPLICIT_FEATURE_FLAG_PRESENT_WAIT_VK_FEATURES = std::array{
+        offsetof(PhysicalDeviceFeaturesStruct, physical_device_present_id_features_khr.presentId),
+        offsetof(PhysicalDeviceFeaturesStruct, physical_device_present_wait_features_khr.presentWait),
+    };
+
     constexpr static std::array IMPLICIT_FEATURES = std::array{
         ImplicitFeature{DAXA_IMPLICIT_FEATURE_FLAG_MESH_SHADER_VK_FEATURES, DAXA_IMPLICIT_FEATURE_FLAG_MESH_SHADER},
         ImplicitFeature{DAXA_IMPLICIT_FEATURE_FLAG_BASIC_RAY_TRACING_VK_FEATURES, DAXA_IMPLICIT_FEATURE_FLAG_BASIC_RAY_TRACING},
@@ -299,6 +337,10 @@ namespace daxa
         ImplicitFeature{DAXA_IMPLICIT_FEATURE_FLAG_DYNAMIC_STATE_3_VK_FEATURES, DAXA_IMPLICIT_FEATURE_FLAG_DYNAMIC_STATE_3},
         ImplicitFeature{DAXA_IMPLICIT_FEATURE_FLAG_SHADER_ATOMIC_FLOAT_VK_FEATURES, DAXA_IMPLICIT_FEATURE_FLAG_SHADER_ATOMIC_FLOAT},
         ImplicitFeature{DAXA_IMPLICIT_FEATURE_FLAG_SWAPCHAIN_VK_FEATURES, DAXA_IMPLICIT_FEATURE_FLAG_SWAPCHAIN},
+        ImplicitFeature{DAXA_IMPLICIT_FEATURE_FLAG_PIPELINE_STATISTICS_QUERY_VK_FEATURES, DAXA_IMPLICIT_FEATURE_FLAG_PIPELINE_STATISTICS_QUERY},
+        ImplicitFeature{DAXA_IMPLICIT_FEATURE_FLAG_PRECISE_OCCLUSION_QUERY_VK_FEATURES, DAXA_IMPLICIT_FEATURE_FLAG_PRECISE_OCCLUSION_QUERY},
+        ImplicitFeature{DAXA_IMPLICIT_FEATURE_FLAG_MEMORY_PRIORITY_VK_FEATURES, DAXA_IMPLICIT_FEATURE_FLAG_MEMORY_PRIORITY},
+        ImplicitFeature{DAXA_IMPLICIT_FEATURE_FLAG_PRESENT_WAIT_VK_FEATURES, DAXA_IMPLICIT_FEATURE_FLAG_PRESENT_WAIT},
     };
 
     // === Explicit Features ===
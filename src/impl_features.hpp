@@ -58,6 +58,10 @@ namespace daxa
             physical_device_mesh_shader_ext,
             physical_device_ray_tracing_invocation_reorder_nv,
             physical_device_shader_atomic_float_ext,
+            physical_device_memory_budget_ext,
+            physical_device_memory_priority_ext,
+            physical_device_present_id_khr,
+            physical_device_present_wait_khr,
             COUNT
         };
         constexpr static std::array<char const *, COUNT> extension_names = {
@@ -76,6 +80,10 @@ namespace daxa
             VK_EXT_MESH_SHADER_EXTENSION_NAME,
             VK_NV_RAY_TRACING_INVOCATION_REORDER_EXTENSION_NAME,
             VK_EXT_SHADER_ATOMIC_FLOAT_EXTENSION_NAME,
+            VK_EXT_MEMORY_BUDGET_EXTENSION_NAME,
+            VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME,
+            VK_KHR_PRESENT_ID_EXTENSION_NAME,
+            VK_KHR_PRESENT_WAIT_EXTENSION_NAME,
         };
         char const * extension_name_list[COUNT] = {};
         u32 extension_name_list_size = {};
@@ -109,6 +117,9 @@ namespace daxa
         VkPhysicalDeviceRayTracingPositionFetchFeaturesKHR physical_device_ray_tracing_position_fetch_features_khr = {};
         VkPhysicalDeviceRayTracingInvocationReorderFeaturesNV physical_device_ray_tracing_invocation_reorder_features_nv = {};
         VkPhysicalDeviceShaderAtomicFloatFeaturesEXT physical_device_shader_atomic_float_features_ext = {};
+        VkPhysicalDeviceMemoryPriorityFeaturesEXT physical_device_memory_priority_features_ext = {};
+        VkPhysicalDevicePresentIdFeaturesKHR physical_device_present_id_features_khr = {};
+        VkPhysicalDevicePresentWaitFeaturesKHR physical_device_present_wait_features_khr = {};
         VkPhysicalDeviceFeatures2 physical_device_features_2 = {};
         bool conservative_rasterization = {};
         bool swapchain = {};
@@ -252,59 +252,6 @@ namespace daxa
             vkSetDebugUtilsObjectNameEXT(device, &name_info);
         }
 
-        auto vk_descriptor_set_layouts = std::array{this->vk_descriptor_set_layout};
-        VkPipelineLayoutCreateInfo vk_pipeline_create_info{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = {},
-            .setLayoutCount = static_cast<u32>(vk_descriptor_set_layouts.size()),
-            .pSetLayouts = vk_descriptor_set_layouts.data(),
-            .pushConstantRangeCount = 0,
-            .pPushConstantRanges = nullptr,
-        };
-
-        result = static_cast<daxa_Result>(vkCreatePipelineLayout(device, &vk_pipeline_create_info, nullptr, pipeline_layouts.data()));
-        _DAXA_RETURN_IF_ERROR(result, result)
-
-        if (vkSetDebugUtilsObjectNameEXT != nullptr)
-        {
-            auto const * name = "pipeline layout (push constant size 0)";
-            VkDebugUtilsObjectNameInfoEXT const name_info{
-                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
-                .pNext = nullptr,
-                .objectType = VK_OBJECT_TYPE_PIPELINE_LAYOUT,
-                .objectHandle = std::bit_cast<uint64_t>(*pipeline_layouts.data()),
-                .pObjectName = name,
-            };
-            vkSetDebugUtilsObjectNameEXT(device, &name_info);
-        }
-
-        for (usize i = 1; i < PIPELINE_LAYOUT_COUNT; ++i)
-        {
-            VkPushConstantRange const vk_push_constant_range{
-                .stageFlags = VK_SHADER_STAGE_ALL,
-                .offset = 0,
-                .size = static_cast<u32>(i * 4),
-            };
-            vk_pipeline_create_info.pushConstantRangeCount = 1;
-            vk_pipeline_create_info.pPushConstantRanges = &vk_push_constant_range;
-            result = static_cast<daxa_Result>(vkCreatePipelineLayout(device, &vk_pipeline_create_info, nullptr, &pipeline_layouts.at(i)));
-            _DAXA_RETURN_IF_ERROR(result, result)
-
-            if (vkSetDebugUtilsObjectNameEXT != nullptr)
-            {
-                auto name = fmt::format("pipeline layout (push constant size {})", i * 4);
-                VkDebugUtilsObjectNameInfoEXT const name_info{
-                    .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
-                    .pNext = nullptr,
-                    .objectType = VK_OBJECT_TYPE_PIPELINE_LAYOUT,
-                    .objectHandle = std::bit_cast<uint64_t>(pipeline_layouts.at(i)),
-                    .pObjectName = name.c_str(),
-                };
-                vkSetDebugUtilsObjectNameEXT(device, &name_info);
-            }
-        }
-
         VkDescriptorBufferInfo const write_buffer{
             .buffer = device_address_buffer,
             .offset = 0,
@@ -329,6 +276,58 @@ namespace daxa
         return result;
     }
 
+    auto GPUShaderResourceTable::get_pipeline_layout(
+        VkDevice device,
+        u32 push_constant_size,
+        PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectNameEXT,
+        VkPipelineLayout & out_pipeline_layout) -> daxa_Result
+    {
+        auto const word_size = (push_constant_size + 3) / 4;
+        if (word_size >= PIPELINE_LAYOUT_COUNT)
+        {
+            return DAXA_RESULT_PUSHCONSTANT_RANGE_EXCEEDED;
+        }
+        std::unique_lock const lock{this->pipeline_layouts_mtx};
+        auto & pipeline_layout = this->pipeline_layouts.at(word_size);
+        if (pipeline_layout != VK_NULL_HANDLE)
+        {
+            out_pipeline_layout = pipeline_layout;
+            return DAXA_RESULT_SUCCESS;
+        }
+
+        VkPushConstantRange const vk_push_constant_range{
+            .stageFlags = VK_SHADER_STAGE_ALL,
+            .offset = 0,
+            .size = word_size * 4,
+        };
+        VkPipelineLayoutCreateInfo const vk_pipeline_create_info{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .setLayoutCount = 1,
+            .pSetLayouts = &this->vk_descriptor_set_layout,
+            .pushConstantRangeCount = word_size > 0 ? 1u : 0u,
+            .pPushConstantRanges = word_size > 0 ? &vk_push_constant_range : nullptr,
+        };
+        auto result = static_cast<daxa_Result>(vkCreatePipelineLayout(device, &vk_pipeline_create_info, nullptr, &pipeline_layout));
+        _DAXA_RETURN_IF_ERROR(result, result)
+
+        if (vkSetDebugUtilsObjectNameEXT != nullptr)
+        {
+            auto name = fmt::format("pipeline layout (push constant size {})", word_size * 4);
+            VkDebugUtilsObjectNameInfoEXT const name_info{
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+                .pNext = nullptr,
+                .objectType = VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                .objectHandle = std::bit_cast<uint64_t>(pipeline_layout),
+                .pObjectName = name.c_str(),
+            };
+            vkSetDebugUtilsObjectNameEXT(device, &name_info);
+        }
+        out_pipeline_layout = pipeline_layout;
+        return DAXA_RESULT_SUCCESS;
+    }
+
     void GPUShaderResourceTable::cleanup(VkDevice device)
     {
         [[maybe_unused]] auto print_remaining = [&](std::string prefix, auto & pages)
@@ -368,7 +367,10 @@ namespace daxa
         DAXA_DBG_ASSERT_TRUE_M(sampler_slots.free_index_stack.size() == sampler_slots.next_index, print_remaining("Detected leaked samplers; not all samplers have been destroyed before destroying the device;", sampler_slots.pages));
         for (usize i = 0; i < PIPELINE_LAYOUT_COUNT; ++i)
         {
-            vkDestroyPipelineLayout(device, pipeline_layouts.at(i), nullptr);
+            if (pipeline_layouts.at(i) != VK_NULL_HANDLE)
+            {
+                vkDestroyPipelineLayout(device, pipeline_layouts.at(i), nullptr);
+            }
         }
         vkDestroyDescriptorSetLayout(device, this->vk_descriptor_set_layout, nullptr);
         vkResetDescriptorPool(device, this->vk_descriptor_pool, {});
@@ -14,6 +14,7 @@ namespace daxa
         VkBuffer vk_buffer = {};
         VmaAllocation vma_allocation = {};
         daxa_MemoryBlock opt_memory_block = {};
+        daxa_MemoryPool opt_memory_pool = {};
         VkDeviceAddress device_address = {};
         void * host_address = {};
     };
@@ -33,6 +34,7 @@ namespace daxa
         VkImage vk_image = {};
         VmaAllocation vma_allocation = {};
         daxa_MemoryBlock opt_memory_block = {};
+        daxa_MemoryPool opt_memory_pool = {};
         i32 swapchain_image_index = NOT_OWNED_BY_SWAPCHAIN;
         VkImageAspectFlags aspect_flags = {}; // Inferred from format.
     };
@@ -65,6 +67,14 @@ namespace daxa
         bool owns_buffer = {};
     };
 
+    struct GpuResourceZombieLink
+    {
+        GPUResourceId id = {};
+        u64 timeline_value = {};
+        // Slot index + 1 of the next zombie in the list, 0 ends the list.
+        u32 next = {};
+    };
+
     /**
      * @brief GpuResourcePool is intended to be used akin to a specialized memory allocator, specific to gpu resource types (like image views).
      *
@@ -87,6 +97,10 @@ namespace daxa
         using VersionAndRefcntT = std::atomic_uint64_t;
         // TODO: split up slots into hot and cold data.
         using PageT = std::array<std::pair<ResourceT, VersionAndRefcntT>, PAGE_SIZE>;
+        // Kept apart from the slots, only destruction and garbage collection touch them.
+        using ZombieLinkPageT = std::array<GpuResourceZombieLink, PAGE_SIZE>;
+        // Version of the id whose creator finished writing the slot, 0 while the slot is created or free.
+        using PublishedVersionPageT = std::array<std::atomic_uint64_t, PAGE_SIZE>;
 
         // TODO: replace with lockless queue.
         std::vector<u32> free_index_stack = {};
@@ -96,6 +110,8 @@ namespace daxa
         mutable std::mutex mut = {};
         std::mutex page_alloc_mtx = {};
         std::array<std::unique_ptr<PageT>, PAGE_COUNT> pages = {};
+        std::array<std::unique_ptr<ZombieLinkPageT>, PAGE_COUNT> zombie_link_pages = {};
+        std::array<std::unique_ptr<PublishedVersionPageT>, PAGE_COUNT> published_version_pages = {};
         std::atomic_uint32_t valid_page_count = {};
 
         /**
@@ -112,6 +128,7 @@ namespace daxa
             auto const page = static_cast<usize>(id.index) >> PAGE_BITS;
             auto const offset = static_cast<usize>(id.index) & PAGE_MASK;
             auto const version = this->pages[page]->at(offset).second.load(std::memory_order_relaxed);
+            this->published_version_pages[page]->at(offset).store(0, std::memory_order_relaxed);
             // Slots that reached max version CAN NOT be recycled.
             // That is because we can not guarantee uniqueness of ids when the version wraps back to 0.
             // Clear slot MUST HAPPEN before pushing into free list.
@@ -161,6 +178,8 @@ namespace daxa
                 if (page >= this->valid_page_count.load(std::memory_order_relaxed))
                 {
                     this->pages[page] = std::make_unique<PageT>();
+                    this->zombie_link_pages[page] = std::make_unique<ZombieLinkPageT>();
+                    this->published_version_pages[page] = std::make_unique<PublishedVersionPageT>();
                     for (u32 i = 0; i < PAGE_SIZE; ++i)
                     {
                         this->pages[page]->at(i).second.store(1ull, std::memory_order_relaxed);
@@ -175,6 +194,43 @@ namespace daxa
             return std::optional{std::pair<GPUResourceId, ResourceT &>(id, this->pages[page]->at(offset).first)};
         }
 
+        /**
+         * @brief   Marks the slot as fully written, after this it may be read by try_get_published.
+         *
+         * Must be called by the creator of the slot once it wrote all of its fields.
+         */
+        void publish_slot(GPUResourceId id)
+        {
+            auto const page = static_cast<usize>(id.index) >> PAGE_BITS;
+            auto const offset = static_cast<usize>(id.index) & PAGE_MASK;
+            this->published_version_pages[page]->at(offset).store(id.version, std::memory_order_release);
+        }
+
+        /**
+         * @brief   Returns the slot at index if it holds a published resource or its zombie.
+         *          Slots that are being created or were destroyed return nullptr.
+         *
+         * Only threadsafe when:
+         * * zombies are not destroyed in parallel (the caller holds the zombies_mtx).
+         */
+        auto try_get_published(u32 index) const -> ResourceT const *
+        {
+            auto const page = static_cast<usize>(index) >> PAGE_BITS;
+            auto const offset = static_cast<usize>(index) & PAGE_MASK;
+            u64 const published_version = this->published_version_pages[page]->at(offset).load(std::memory_order_acquire);
+            if (published_version == 0)
+            {
+                return nullptr;
+            }
+            // Zombification increments the version, the slot stays published until it is destroyed.
+            u64 const version = this->pages[page]->at(offset).second.load(std::memory_order_relaxed);
+            if (version != published_version && version != published_version + 1)
+            {
+                return nullptr;
+            }
+            return &this->pages[page]->at(offset).first;
+        }
+
         auto try_zombify(GPUResourceId id) -> bool
         {
             auto const page = static_cast<usize>(id.index) >> PAGE_BITS;
@@ -227,6 +283,102 @@ namespace daxa
             auto const offset = static_cast<usize>(id.index) & PAGE_MASK;
             return pages[page]->at(offset).first;
         }
+
+        /**
+         * Only Threadsafe when:
+         * * the slot is a zombie owned by the caller, see GpuResourceZombieList.
+         */
+        auto zombie_link(usize index) -> GpuResourceZombieLink &
+        {
+            return this->zombie_link_pages[index >> PAGE_BITS]->at(index & PAGE_MASK);
+        }
+    };
+
+    /**
+     * @brief   Zombies of one resource kind, linked through the zombie links of their slots.
+     *
+     * Destroying threads stage zombies with a single compare exchange, they never lock or allocate.
+     * The collector takes all staged zombies at once and appends them to its pending list, oldest first.
+     * A slot is in at most one list, as it is only recycled after the collector cleaned it up.
+     *
+     * Only threadsafe when:
+     * * merge_staged and cleanup are externally synchronized (collect_garbage holds the zombies_mtx).
+     */
+    struct GpuResourceZombieList
+    {
+        // Slot index + 1 of the youngest staged zombie, 0 when empty.
+        std::atomic_uint32_t staged_head = {};
+        // Slot index + 1 of the oldest and youngest pending zombie, owned by the collector.
+        u32 pending_head = {};
+        u32 pending_tail = {};
+
+        template <typename ResourceT>
+        void stage(GpuResourcePool<ResourceT> & pool, GPUResourceId id, u64 timeline_value)
+        {
+            auto & link = pool.zombie_link(id.index);
+            link.id = id;
+            link.timeline_value = timeline_value;
+            u32 head = this->staged_head.load(std::memory_order_relaxed);
+            do
+            {
+                link.next = head;
+            } while (!this->staged_head.compare_exchange_weak(
+                head, static_cast<u32>(id.index) + 1,
+                std::memory_order_release,
+                std::memory_order_relaxed));
+        }
+
+        template <typename ResourceT>
+        void merge_staged(GpuResourcePool<ResourceT> & pool)
+        {
+            u32 staged = this->staged_head.exchange(0, std::memory_order_acquire);
+            u32 const youngest = staged;
+            // Staged zombies are linked youngest first, reverse them to get destruction order.
+            u32 oldest = 0;
+            while (staged != 0)
+            {
+                auto & link = pool.zombie_link(staged - 1);
+                u32 const next = link.next;
+                link.next = oldest;
+                oldest = staged;
+                staged = next;
+            }
+            if (oldest == 0)
+            {
+                return;
+            }
+            if (this->pending_tail != 0)
+            {
+                pool.zombie_link(this->pending_tail - 1).next = oldest;
+            }
+            else
+            {
+                this->pending_head = oldest;
+            }
+            this->pending_tail = youngest;
+        }
+
+        // Calls cleanup_fn(id) for pending zombies, oldest first, until one is not older than min_pending_timeline_value.
+        template <typename ResourceT, typename FnT>
+        void cleanup(GpuResourcePool<ResourceT> & pool, u64 min_pending_timeline_value, FnT const & cleanup_fn)
+        {
+            while (this->pending_head != 0)
+            {
+                auto const & link = pool.zombie_link(this->pending_head - 1);
+                if (link.timeline_value >= min_pending_timeline_value)
+                {
+                    break;
+                }
+                GPUResourceId const id = link.id;
+                // Advance before the cleanup, as it recycles the slot.
+                this->pending_head = link.next;
+                if (this->pending_head == 0)
+                {
+                    this->pending_tail = 0;
+                }
+                cleanup_fn(id);
+            }
+        }
     };
 
     struct GPUShaderResourceTable
@@ -244,6 +396,8 @@ namespace daxa
 
         // Contains pipeline layouts with varying push constant range size.
         // The first size is 0 word, second is 1 word, all others are a power of two (maximum is MAX_PUSH_CONSTANT_BYTE_SIZE).
+        // Layouts are created on first use by get_pipeline_layout, most programs only use a few push constant sizes.
+        std::mutex pipeline_layouts_mtx = {};
         std::array<VkPipelineLayout, PIPELINE_LAYOUT_COUNT> pipeline_layouts = {};
 
         auto initialize(
@@ -254,6 +408,11 @@ namespace daxa
             VkDevice device, 
             VkBuffer device_address_buffer, 
             PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectNameEXT) -> daxa_Result;
+        auto get_pipeline_layout(
+            VkDevice device,
+            u32 push_constant_size,
+            PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectNameEXT,
+            VkPipelineLayout & out_pipeline_layout) -> daxa_Result;
         void cleanup(VkDevice device);
     };
 
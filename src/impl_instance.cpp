@@ -4,13 +4,29 @@
 #include "impl_features.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <vector>
 
 // --- Begin API Functions ---
 
 auto daxa_create_instance(daxa_InstanceInfo const * info, daxa_Instance * out_instance) -> daxa_Result
 {
-    auto ret = daxa_ImplInstance{};
+    daxa_Result result = DAXA_RESULT_SUCCESS;
+    // Created in place, the instance is not movable.
+    *out_instance = new daxa_ImplInstance{};
+    auto & ret = **out_instance;
+    defer
+    {
+        if (result != DAXA_RESULT_SUCCESS)
+        {
+            if (ret.vk_instance)
+            {
+                vkDestroyInstance(ret.vk_instance, nullptr);
+            }
+            delete *out_instance;
+            *out_instance = {};
+        }
+    };
     ret.info = *reinterpret_cast<InstanceInfo const *>(info);
     ret.engine_name = {ret.info.engine_name.data(), ret.info.engine_name.size()};
     ret.info.engine_name = ret.engine_name;
@@ -33,7 +49,7 @@ auto daxa_create_instance(daxa_InstanceInfo const * info, daxa_Instance * out_in
     // Check existence of extensions:
     std::vector<VkExtensionProperties> instance_extensions = {};
     uint32_t instance_extension_count = {};
-    daxa_Result result = static_cast<daxa_Result>(vkEnumerateInstanceExtensionProperties(nullptr, &instance_extension_count, nullptr));
+    result = static_cast<daxa_Result>(vkEnumerateInstanceExtensionProperties(nullptr, &instance_extension_count, nullptr));
     _DAXA_RETURN_IF_ERROR(result, result);
 
     instance_extensions.resize(instance_extension_count);
@@ -53,7 +69,8 @@ auto daxa_create_instance(daxa_InstanceInfo const * info, daxa_Instance * out_in
         }
         if (!found)
         {
-            return DAXA_RESULT_ERROR_EXTENSION_NOT_PRESENT;
+            result = DAXA_RESULT_ERROR_EXTENSION_NOT_PRESENT;
+            return result;
         }
     }
     VkApplicationInfo const app_info = {
@@ -82,8 +99,6 @@ auto daxa_create_instance(daxa_InstanceInfo const * info, daxa_Instance * out_in
     _DAXA_RETURN_IF_ERROR(result, result);
 
     ret.strong_count = 1;
-    *out_instance = new daxa_ImplInstance{};
-    **out_instance = std::move(ret);
     return DAXA_RESULT_SUCCESS;
 }
 
@@ -102,25 +117,49 @@ auto daxa_ImplInstance::initialize_physical_devices() -> daxa_Result
 
     for (u32 i = 0; i < device_count; ++i)
     {
-        auto & internals = this->device_internals[i];
-        auto & properties = this->device_properties[i];
-        internals.vk_handle = vk_physical_devices[i];
-
-        // Init extensions:
-        result = internals.extensions.initialize(internals.vk_handle);
-        _DAXA_RETURN_IF_ERROR(result, result);
+        this->device_internals[i].vk_handle = vk_physical_devices[i];
+    }
 
-        // Init features:
-        internals.features.initialize(internals.extensions);
-        vkGetPhysicalDeviceFeatures2(internals.vk_handle, &internals.features.physical_device_features_2);
+    return DAXA_RESULT_SUCCESS;
+}
 
-        // Init properties:
-        fill_daxa_device_properties(internals.extensions, internals.features, internals.vk_handle, &properties);
+auto daxa_ImplInstance::initialize_physical_device(u32 index) -> daxa_Result
+{
+    std::unique_lock const lock{this->physical_devices_mtx};
+    auto & internals = this->device_internals[index];
+    if (internals.initialized)
+    {
+        return DAXA_RESULT_SUCCESS;
     }
+    auto & properties = this->device_properties[index];
 
+    // Init extensions:
+    auto result = internals.extensions.initialize(internals.vk_handle);
+    _DAXA_RETURN_IF_ERROR(result, result);
+
+    // Init features:
+    internals.features.initialize(internals.extensions);
+    vkGetPhysicalDeviceFeatures2(internals.vk_handle, &internals.features.physical_device_features_2);
+
+    // Init properties:
+    fill_daxa_device_properties(internals.extensions, internals.features, internals.vk_handle, &properties);
+
+    internals.initialized = true;
     return DAXA_RESULT_SUCCESS;
 }
 
+auto daxa_ImplInstance::initialize_all_physical_devices() -> u32
+{
+    for (u32 i = 0; i < this->device_internals.size(); ++i)
+    {
+        if (this->initialize_physical_device(i) != DAXA_RESULT_SUCCESS)
+        {
+            return i;
+        }
+    }
+    return static_cast<u32>(this->device_internals.size());
+}
+
 auto daxa_instance_create_device(daxa_Instance self, daxa_DeviceInfo const * legacy_info, daxa_Device * out_device) -> daxa_Result
 {
     daxa_DeviceInfo2 info = {};
@@ -149,7 +188,8 @@ auto daxa_instance_create_device(daxa_Instance self, daxa_DeviceInfo const * leg
         i32 rating = {};
     };
     std::vector<RatedDevice> rated_devices = {};
-    for (u32 i = 0; i < self->device_properties.size(); ++i)
+    u32 const device_count = self->initialize_all_physical_devices();
+    for (u32 i = 0; i < device_count; ++i)
     {
         auto & props = self->device_properties[i];
 
@@ -203,7 +243,7 @@ auto daxa_instance_create_device(daxa_Instance self, daxa_DeviceInfo const * leg
 void daxa_instance_list_devices_properties(daxa_Instance self, daxa_DeviceProperties const ** properties, daxa_u32 * property_count)
 {
     *properties = self->device_properties.data();
-    *property_count = static_cast<u32>(self->device_properties.size());
+    *property_count = self->initialize_all_physical_devices();
 }
 
 auto daxa_instance_choose_device(daxa_Instance self, daxa_ImplicitFeatureFlags desired_implicit_features, daxa_DeviceInfo2 * info) -> daxa_Result
@@ -211,6 +251,9 @@ auto daxa_instance_choose_device(daxa_Instance self, daxa_ImplicitFeatureFlags d
     info->physical_device_index = ~0u;
     for (u32 i = 0; i < self->device_properties.size(); ++i)
     {
+        // Devices after the first suitable one are never queried.
+        auto const result = self->initialize_physical_device(i);
+        _DAXA_RETURN_IF_ERROR(result, result);
         auto & props = self->device_properties[i];
 
         bool const no_support_problems = props.missing_required_feature == DAXA_MISSING_REQUIRED_VK_FEATURE_NONE;
@@ -242,6 +285,7 @@ auto daxa_instance_choose_device(daxa_Instance self, daxa_ImplicitFeatureFlags d
 auto daxa_instance_create_device_2(daxa_Instance self, daxa_DeviceInfo2 const * info, daxa_Device * out_device) -> daxa_Result
 {
     daxa_Result result = {};
+    auto const creation_begin = std::chrono::steady_clock::now();
     *out_device = new daxa_ImplDevice{};
     defer
     {
@@ -259,6 +303,10 @@ auto daxa_instance_create_device_2(daxa_Instance self, daxa_DeviceInfo2 const *
     }
     _DAXA_RETURN_IF_ERROR(result, result);
 
+    result = self->initialize_physical_device(device_i);
+    _DAXA_RETURN_IF_ERROR(result, result);
+    auto const query_end = std::chrono::steady_clock::now();
+
     if (self->device_properties[device_i].missing_required_feature != DAXA_MISSING_REQUIRED_VK_FEATURE_NONE)
     {
         result = DAXA_RESULT_ERROR_DEVICE_NOT_SUPPORTED;
@@ -279,6 +327,9 @@ auto daxa_instance_create_device_2(daxa_Instance self, daxa_DeviceInfo2 const *
         *out_device);
     _DAXA_RETURN_IF_ERROR(result, result);
 
+    (*out_device)->creation_timings.physical_device_query_ns = static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(query_end - creation_begin).count());
+    (*out_device)->creation_timings.total_ns = static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - creation_begin).count());
+
     self->inc_weak_refcnt();
     return result;
 }
@@ -10,6 +10,8 @@ struct ImplPhysicalDevice
     PhysicalDeviceExtensionsStruct extensions = {};
     PhysicalDeviceFeaturesStruct features = {};
     VkPhysicalDevice vk_handle = {};
+    // Extensions, features and properties are queried on first use.
+    bool initialized = {};
 };
 
 struct daxa_ImplInstance final : ImplHandle
@@ -19,10 +21,16 @@ struct daxa_ImplInstance final : ImplHandle
     std::string app_name = {};
     VkInstance vk_instance = {};
 
+    // Guards the lazy initialization of physical devices.
+    std::mutex physical_devices_mtx = {};
     std::vector<ImplPhysicalDevice> device_internals = {};
     std::vector<daxa_DeviceProperties> device_properties = {};
 
     static void zero_ref_callback(ImplHandle const * handle);
 
+    // Only enumerates the physical devices, see initialize_physical_device.
     auto initialize_physical_devices() -> daxa_Result;
+    auto initialize_physical_device(u32 index) -> daxa_Result;
+    // Returns the number of devices initialized before the first failure.
+    auto initialize_all_physical_devices() -> u32;
 };
\ No newline at end of file
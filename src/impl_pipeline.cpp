@@ -1,6 +1,27 @@
 #include "impl_device.hpp"
 #include "impl_pipeline.hpp"
 
+// The specialization data blob is the array of SpecializationConstants itself, each map entry points at the value of its constant.
+static auto make_vk_specialization_info(ShaderInfo const & shader_info, std::vector<VkSpecializationMapEntry> & map_entries) -> VkSpecializationInfo
+{
+    map_entries.clear();
+    for (usize i = 0; i < shader_info.specialization_constants.size(); ++i)
+    {
+        auto const & constant = shader_info.specialization_constants[i];
+        map_entries.push_back(VkSpecializationMapEntry{
+            .constantID = constant.constant_id,
+            .offset = static_cast<u32>(i * sizeof(SpecializationConstant) + offsetof(SpecializationConstant, value)),
+            .size = constant.size,
+        });
+    }
+    return VkSpecializationInfo{
+        .mapEntryCount = static_cast<u32>(map_entries.size()),
+        .pMapEntries = map_entries.data(),
+        .dataSize = shader_info.specialization_constants.size() * sizeof(SpecializationConstant),
+        .pData = shader_info.specialization_constants.empty() ? nullptr : &shader_info.specialization_constants[0],
+    };
+}
+
 // --- Begin API Functions ---
 
 auto daxa_dvc_create_raster_pipeline(daxa_Device device, daxa_RasterPipelineInfo const * info, daxa_RasterPipeline * out_pipeline) -> daxa_Result
@@ -9,15 +30,21 @@ auto daxa_dvc_create_raster_pipeline(daxa_Device device, daxa_RasterPipelineInfo
     daxa_ImplRasterPipeline ret = {};
     ret.device = device;
     ret.info = *reinterpret_cast<RasterPipelineInfo const *>(info);
+    auto const layout_result = ret.device->gpu_sro_table.get_pipeline_layout(ret.device->vk_device, ret.info.push_constant_size, ret.device->vkSetDebugUtilsObjectNameEXT, ret.vk_pipeline_layout);
+    _DAXA_RETURN_IF_ERROR(layout_result, layout_result)
     std::vector<VkShaderModule> vk_shader_modules = {};
     // NOTE: Temporarily holds 0 terminated strings, incoming strings are data + size, not null terminated!
     std::vector<std::unique_ptr<std::string>> entry_point_names = {};
     std::vector<VkPipelineShaderStageCreateInfo> vk_pipeline_shader_stage_create_infos = {};
 
     std::vector<VkPipelineShaderStageRequiredSubgroupSizeCreateInfo> require_subgroup_size_vkstructs = {};
+    std::vector<std::vector<VkSpecializationMapEntry>> specialization_map_entries = {};
+    std::vector<VkSpecializationInfo> specialization_vkstructs = {};
     // Necessary to prevent re-allocation
     auto const MAXIMUM_GRAPHICS_STAGES = 6;
     require_subgroup_size_vkstructs.reserve(MAXIMUM_GRAPHICS_STAGES);
+    specialization_map_entries.reserve(MAXIMUM_GRAPHICS_STAGES);
+    specialization_vkstructs.reserve(MAXIMUM_GRAPHICS_STAGES);
 
     auto create_shader_module = [&](ShaderInfo const & shader_info, VkShaderStageFlagBits shader_stage) -> VkResult
     {
@@ -41,6 +68,8 @@ auto daxa_dvc_create_raster_pipeline(daxa_Device device, daxa_RasterPipelineInfo
             .pNext = nullptr,
             .requiredSubgroupSize = shader_info.required_subgroup_size.value_or(0),
         });
+        specialization_map_entries.emplace_back();
+        specialization_vkstructs.push_back(make_vk_specialization_info(shader_info, specialization_map_entries.back()));
         VkPipelineShaderStageCreateInfo const vk_pipeline_shader_stage_create_info{
             .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
             .pNext = shader_info.required_subgroup_size.has_value() ? &require_subgroup_size_vkstructs.back() : nullptr,
@@ -48,7 +77,7 @@ auto daxa_dvc_create_raster_pipeline(daxa_Device device, daxa_RasterPipelineInfo
             .stage = shader_stage,
             .module = vk_shader_module,
             .pName = entry_point_names.back()->c_str(),
-            .pSpecializationInfo = nullptr,
+            .pSpecializationInfo = shader_info.specialization_constants.empty() ? nullptr : &specialization_vkstructs.back(),
         };
         vk_pipeline_shader_stage_create_infos.push_back(vk_pipeline_shader_stage_create_info);
         return result;
@@ -88,7 +117,6 @@ auto daxa_dvc_create_raster_pipeline(daxa_Device device, daxa_RasterPipelineInfo
         }
     }
 
-    ret.vk_pipeline_layout = ret.device->gpu_sro_table.pipeline_layouts.at((ret.info.push_constant_size + 3) / 4);
     constexpr VkPipelineVertexInputStateCreateInfo vk_vertex_input_state{
         .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
         .pNext = nullptr,
@@ -335,6 +363,8 @@ auto daxa_dvc_create_compute_pipeline(daxa_Device device, daxa_ComputePipelineIn
     daxa_ImplComputePipeline ret = {};
     ret.device = device;
     ret.info = *reinterpret_cast<ComputePipelineInfo const *>(info);
+    auto const layout_result = ret.device->gpu_sro_table.get_pipeline_layout(ret.device->vk_device, ret.info.push_constant_size, ret.device->vkSetDebugUtilsObjectNameEXT, ret.vk_pipeline_layout);
+    _DAXA_RETURN_IF_ERROR(layout_result, layout_result)
     VkShaderModule vk_shader_module = {};
     VkShaderModuleCreateInfo const shader_module_ci{
         .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
@@ -348,12 +378,13 @@ auto daxa_dvc_create_compute_pipeline(daxa_Device device, daxa_ComputePipelineIn
     {
         return std::bit_cast<daxa_Result>(module_result);
     }
-    ret.vk_pipeline_layout = ret.device->gpu_sro_table.pipeline_layouts.at((ret.info.push_constant_size + 3) / 4);
     VkPipelineShaderStageRequiredSubgroupSizeCreateInfo require_subgroup_size_vkstruct{
         .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_REQUIRED_SUBGROUP_SIZE_CREATE_INFO,
         .pNext = nullptr,
         .requiredSubgroupSize = ret.info.shader_info.required_subgroup_size.value_or(0),
     };
+    std::vector<VkSpecializationMapEntry> specialization_map_entries = {};
+    VkSpecializationInfo const specialization_vkstruct = make_vk_specialization_info(ret.info.shader_info, specialization_map_entries);
     VkComputePipelineCreateInfo const vk_compute_pipeline_create_info{
         .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
         .pNext = nullptr,
@@ -365,7 +396,7 @@ auto daxa_dvc_create_compute_pipeline(daxa_Device device, daxa_ComputePipelineIn
             .stage = VkShaderStageFlagBits::VK_SHADER_STAGE_COMPUTE_BIT,
             .module = vk_shader_module,
             .pName = ret.info.shader_info.entry_point.data(),
-            .pSpecializationInfo = nullptr,
+            .pSpecializationInfo = ret.info.shader_info.specialization_constants.empty() ? nullptr : &specialization_vkstruct,
         },
         .layout = ret.vk_pipeline_layout,
         .basePipelineHandle = VK_NULL_HANDLE,
@@ -437,6 +468,8 @@ auto daxa_dvc_create_ray_tracing_pipeline(daxa_Device device, daxa_RayTracingPip
     {
         return DAXA_RESULT_INVALID_WITHOUT_ENABLING_RAY_TRACING;
     }
+    auto const layout_result = ret.device->gpu_sro_table.get_pipeline_layout(ret.device->vk_device, ret.info.push_constant_size, ret.device->vkSetDebugUtilsObjectNameEXT, ret.vk_pipeline_layout);
+    _DAXA_RETURN_IF_ERROR(layout_result, layout_result)
 
     // Stages are the shader modules
     std::vector<VkPipelineShaderStageCreateInfo> stages = {};
@@ -467,8 +500,12 @@ auto daxa_dvc_create_ray_tracing_pipeline(daxa_Device device, daxa_RayTracingPip
     u32 const first_miss_index = raygen_count + intersection_count + any_hit_count + callable_count + closest_hit_count;
 
     std::vector<VkPipelineShaderStageRequiredSubgroupSizeCreateInfo> require_subgroup_size_vkstructs = {};
+    std::vector<std::vector<VkSpecializationMapEntry>> specialization_map_entries = {};
+    std::vector<VkSpecializationInfo> specialization_vkstructs = {};
     // Necessary to prevent re-allocation
     require_subgroup_size_vkstructs.reserve(all_stages_count);
+    specialization_map_entries.reserve(all_stages_count);
+    specialization_vkstructs.reserve(all_stages_count);
 
     auto create_shader_module = [&](ShaderInfo const & shader_info, VkShaderStageFlagBits shader_stage) -> VkResult
     {
@@ -492,6 +529,8 @@ auto daxa_dvc_create_ray_tracing_pipeline(daxa_Device device, daxa_RayTracingPip
             .pNext = nullptr,
             .requiredSubgroupSize = shader_info.required_subgroup_size.value_or(0),
         });
+        specialization_map_entries.emplace_back();
+        specialization_vkstructs.push_back(make_vk_specialization_info(shader_info, specialization_map_entries.back()));
         VkPipelineShaderStageCreateInfo const vk_pipeline_shader_stage_create_info{
             .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
             .pNext = shader_info.required_subgroup_size.has_value() ? &require_subgroup_size_vkstructs.back() : nullptr,
@@ -499,7 +538,7 @@ auto daxa_dvc_create_ray_tracing_pipeline(daxa_Device device, daxa_RayTracingPip
             .stage = shader_stage,
             .module = vk_shader_module,
             .pName = entry_point_names.back()->c_str(),
-            .pSpecializationInfo = nullptr,
+            .pSpecializationInfo = shader_info.specialization_constants.empty() ? nullptr : &specialization_vkstructs.back(),
         };
         stages.push_back(vk_pipeline_shader_stage_create_info);
         return result;
@@ -567,7 +606,6 @@ auto daxa_dvc_create_ray_tracing_pipeline(daxa_Device device, daxa_RayTracingPip
     u32 const group_count = static_cast<u32>(groups.size());
     u32 const stages_count = static_cast<u32>(stages.size());
 
-    ret.vk_pipeline_layout = ret.device->gpu_sro_table.pipeline_layouts.at((ret.info.push_constant_size + 3) / 4);
     VkRayTracingPipelineCreateInfoKHR const vk_ray_tracing_pipeline_create_info{
         .sType = VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR,
         .pNext = nullptr,
@@ -734,6 +772,7 @@ auto daxa_ray_tracing_pipeline_create_default_sbt(daxa_RayTracingPipeline pipeli
         .size = sbt_size,
         .allocate_info = DAXA_MEMORY_FLAG_HOST_ACCESS_SEQUENTIAL_WRITE,
         .name = std::bit_cast<daxa_SmallString>(name_cstr),
+        .sharing_mode = DAXA_SHARING_MODE_CONCURRENT,
     };
     // TODO: We need to store the buffer id somewhere, so we can destroy after the pipeline is destroyed
     auto & sbt_buffer_id = *out_buffer;
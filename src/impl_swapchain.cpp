@@ -3,7 +3,26 @@
 #include "impl_device.hpp"
 
 #include <utility>
+#include <array>
 #include <bit>
+#include <chrono>
+#include <span>
+#include <string>
+#include <thread>
+
+namespace
+{
+    auto now_ns() -> u64
+    {
+        return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // LOW_LATENCY wakes up this much earlier than predicted, so the gpu does not run dry on a slow frame.
+    constexpr f64 PACING_MARGIN_NS = 500'000.0;
+    constexpr f64 PACING_SMOOTHING = 0.1;
+    // Bounded, so a hidden window can not stall the frame loop.
+    constexpr u64 PRESENT_WAIT_TIMEOUT_NS = 100'000'000;
+} // namespace
 
 // --- Begin API Functions ---
 
@@ -25,7 +44,11 @@ auto daxa_dvc_create_swapchain(daxa_Device device, daxa_SwapchainInfo const * in
     auto ret = daxa_ImplSwapchain{};
     ret.device = device;
     ret.info = *reinterpret_cast<SwapchainInfo const *>(info);
-    auto result = ret.recreate_surface();
+    auto result = ret.headless() ? DAXA_RESULT_SUCCESS : ret.recreate_surface();
+    if (ret.headless() && (ret.info.headless_extent.x == 0 || ret.info.headless_extent.y == 0))
+    {
+        result = DAXA_RESULT_INVALID_HEADLESS_EXTENT;
+    }
     if (result != DAXA_RESULT_SUCCESS)
     {
         ret.full_cleanup();
@@ -38,63 +61,12 @@ auto daxa_dvc_create_swapchain(daxa_Device device, daxa_SwapchainInfo const * in
         return DAXA_RESULT_ERROR_INVALID_QUEUE_FAMILY;
     }
 
-    // Save supported present modes.
-    u32 present_mode_count = {};
-    auto vk_result = vkGetPhysicalDeviceSurfacePresentModesKHR(
-        ret.device->vk_physical_device,
-        ret.vk_surface,
-        &present_mode_count,
-        nullptr);
-    if (vk_result != VK_SUCCESS)
-    {
-        ret.full_cleanup();
-        return std::bit_cast<daxa_Result>(vk_result);
-    }
-    ret.supported_present_modes.resize(present_mode_count);
-    vk_result = vkGetPhysicalDeviceSurfacePresentModesKHR(
-        device->vk_physical_device,
-        ret.vk_surface,
-        &present_mode_count,
-        r_cast<VkPresentModeKHR *>(ret.supported_present_modes.data()));
-    if (vk_result != VK_SUCCESS)
-    {
-        ret.full_cleanup();
-        return std::bit_cast<daxa_Result>(vk_result);
-    }
-
-    // Format Selection:
-    u32 format_count = 0;
-    vk_result = vkGetPhysicalDeviceSurfaceFormatsKHR(ret.device->vk_physical_device, ret.vk_surface, &format_count, nullptr);
-    if (vk_result != VK_SUCCESS)
-    {
-        ret.full_cleanup();
-        return std::bit_cast<daxa_Result>(vk_result);
-    }
-    std::vector<VkSurfaceFormatKHR> surface_formats;
-    surface_formats.resize(format_count);
-    vk_result = vkGetPhysicalDeviceSurfaceFormatsKHR(ret.device->vk_physical_device, ret.vk_surface, &format_count, surface_formats.data());
-    if (vk_result != VK_SUCCESS)
-    {
-        ret.full_cleanup();
-        return std::bit_cast<daxa_Result>(vk_result);
-    }
-    if (format_count == 0)
-    {
-        ret.full_cleanup();
-        return DAXA_RESULT_NO_SUITABLE_FORMAT_FOUND;
-    }
-    auto format_comparator = [&](auto const & a, auto const & b) -> bool
-    {
-        return ret.info.surface_format_selector(std::bit_cast<Format>(a.format)) <
-               ret.info.surface_format_selector(std::bit_cast<Format>(b.format));
-    };
-    auto best_format = std::max_element(surface_formats.begin(), surface_formats.end(), format_comparator);
-    if (best_format == surface_formats.end())
+    result = ret.headless() ? ret.select_headless_format() : ret.select_surface_format();
+    if (result != DAXA_RESULT_SUCCESS)
     {
         ret.full_cleanup();
-        return DAXA_RESULT_NO_SUITABLE_FORMAT_FOUND;
+        return result;
     }
-    ret.vk_surface_format = *best_format;
 
     result = ret.recreate();
     if (result != DAXA_RESULT_SUCCESS)
@@ -141,6 +113,13 @@ auto daxa_dvc_create_swapchain(daxa_Device device, daxa_SwapchainInfo const * in
         return result;
     }
 
+    result = ret.create_frame_pacing_resources();
+    if (result != DAXA_RESULT_SUCCESS)
+    {
+        ret.full_cleanup();
+        return result;
+    }
+
     ret.strong_count = 1;
     *out_swapchain = new daxa_ImplSwapchain{};
     **out_swapchain = std::move(ret);
@@ -182,12 +161,26 @@ auto daxa_swp_set_present_mode(daxa_Swapchain self, VkPresentModeKHR present_mod
 
 auto daxa_swp_acquire_next_image(daxa_Swapchain self, daxa_ImageId * out_image_id) -> daxa_Result
 {
+    u64 const acquire_start_ns = now_ns();
     [[maybe_unused]] auto _ignored = self->gpu_frame_timeline.wait_for_value(
         static_cast<u64>(
             std::max<i64>(
                 0,
                 static_cast<i64>(self->cpu_frame_timeline) - static_cast<i64>(self->info.max_allowed_frames_in_flight))));
     self->acquire_semaphore_index = (self->cpu_frame_timeline + 1) % (self->info.max_allowed_frames_in_flight + 1);
+    {
+        auto const result = self->begin_frame_timing();
+        _DAXA_RETURN_IF_ERROR(result, result)
+    }
+    if (self->headless())
+    {
+        auto const result = self->acquire_headless_image();
+        _DAXA_RETURN_IF_ERROR(result, result)
+        self->cpu_frame_timeline += 1;
+        self->frame_acquired(acquire_start_ns);
+        *out_image_id = static_cast<daxa_ImageId>(self->images[self->current_image_index]);
+        return DAXA_RESULT_SUCCESS;
+    }
     BinarySemaphore & acquire_semaphore = self->acquire_semaphores[self->acquire_semaphore_index];
     auto result = vkAcquireNextImageKHR(
         self->device->vk_device,
@@ -198,6 +191,7 @@ auto daxa_swp_acquire_next_image(daxa_Swapchain self, daxa_ImageId * out_image_i
 
     // We only bump the cpu timeline, when the acquire succeeds.
     self->cpu_frame_timeline += 1;
+    self->frame_acquired(acquire_start_ns);
     *out_image_id = static_cast<daxa_ImageId>(self->images[self->current_image_index]);
     return std::bit_cast<daxa_Result>(result);
 }
@@ -222,6 +216,25 @@ auto daxa_swp_current_cpu_timeline_value(daxa_Swapchain self) -> u64
     return self->cpu_frame_timeline;
 }
 
+auto daxa_swp_presented_image(daxa_Swapchain self) -> daxa_ImageId
+{
+    if (self->presented_image_index >= self->images.size())
+    {
+        return {};
+    }
+    return static_cast<daxa_ImageId>(self->images[self->presented_image_index]);
+}
+
+auto daxa_swp_pace_frame(daxa_Swapchain self) -> daxa_Result
+{
+    return self->pace_frame();
+}
+
+void daxa_swp_frame_pacing_statistics(daxa_Swapchain self, daxa_FramePacingStatistics * out_statistics)
+{
+    *out_statistics = std::bit_cast<daxa_FramePacingStatistics>(self->frame_pacing_statistics);
+}
+
 auto daxa_swp_info(daxa_Swapchain self) -> daxa_SwapchainInfo const *
 {
     return reinterpret_cast<daxa_SwapchainInfo const *>(&self->info);
@@ -253,8 +266,505 @@ auto daxa_swp_dec_refcnt(daxa_Swapchain self) -> u64
 
 // --- Begin Internals ---
 
+auto daxa_ImplSwapchain::select_surface_format() -> daxa_Result
+{
+    // Save supported present modes.
+    u32 present_mode_count = {};
+    auto vk_result = vkGetPhysicalDeviceSurfacePresentModesKHR(
+        this->device->vk_physical_device,
+        this->vk_surface,
+        &present_mode_count,
+        nullptr);
+    if (vk_result != VK_SUCCESS)
+    {
+        return std::bit_cast<daxa_Result>(vk_result);
+    }
+    this->supported_present_modes.resize(present_mode_count);
+    vk_result = vkGetPhysicalDeviceSurfacePresentModesKHR(
+        this->device->vk_physical_device,
+        this->vk_surface,
+        &present_mode_count,
+        r_cast<VkPresentModeKHR *>(this->supported_present_modes.data()));
+    if (vk_result != VK_SUCCESS)
+    {
+        return std::bit_cast<daxa_Result>(vk_result);
+    }
+
+    // Format Selection:
+    u32 format_count = 0;
+    vk_result = vkGetPhysicalDeviceSurfaceFormatsKHR(this->device->vk_physical_device, this->vk_surface, &format_count, nullptr);
+    if (vk_result != VK_SUCCESS)
+    {
+        return std::bit_cast<daxa_Result>(vk_result);
+    }
+    std::vector<VkSurfaceFormatKHR> surface_formats;
+    surface_formats.resize(format_count);
+    vk_result = vkGetPhysicalDeviceSurfaceFormatsKHR(this->device->vk_physical_device, this->vk_surface, &format_count, surface_formats.data());
+    if (vk_result != VK_SUCCESS)
+    {
+        return std::bit_cast<daxa_Result>(vk_result);
+    }
+    if (format_count == 0)
+    {
+        return DAXA_RESULT_NO_SUITABLE_FORMAT_FOUND;
+    }
+    auto format_comparator = [&](auto const & a, auto const & b) -> bool
+    {
+        return this->info.surface_format_selector(std::bit_cast<Format>(a.format)) <
+               this->info.surface_format_selector(std::bit_cast<Format>(b.format));
+    };
+    auto best_format = std::max_element(surface_formats.begin(), surface_formats.end(), format_comparator);
+    if (best_format == surface_formats.end())
+    {
+        return DAXA_RESULT_NO_SUITABLE_FORMAT_FOUND;
+    }
+    this->vk_surface_format = *best_format;
+
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_ImplSwapchain::headless() const -> bool
+{
+    return this->info.native_window_platform == NativeWindowPlatform::HEADLESS;
+}
+
+auto daxa_ImplSwapchain::select_headless_format() -> daxa_Result
+{
+    // There is no surface to ask, the selector chooses between the common presentable formats.
+    static constexpr auto CANDIDATE_FORMATS = std::array{
+        VK_FORMAT_B8G8R8A8_UNORM,
+        VK_FORMAT_R8G8B8A8_UNORM,
+        VK_FORMAT_B8G8R8A8_SRGB,
+        VK_FORMAT_R8G8B8A8_SRGB,
+    };
+    auto best_format = std::max_element(
+        CANDIDATE_FORMATS.begin(), CANDIDATE_FORMATS.end(),
+        [&](VkFormat a, VkFormat b)
+        {
+            return this->info.surface_format_selector(std::bit_cast<Format>(a)) <
+                   this->info.surface_format_selector(std::bit_cast<Format>(b));
+        });
+    this->vk_surface_format = VkSurfaceFormatKHR{
+        .format = *best_format,
+        .colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
+    };
+    // Images are never shown, every present mode behaves the same.
+    this->supported_present_modes = {this->info.present_mode};
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_ImplSwapchain::recreate_headless() -> daxa_Result
+{
+    daxa_Result result = DAXA_RESULT_SUCCESS;
+    // Destruction of the old images is deferred by the device, no wait idle needed.
+    this->partial_cleanup();
+    this->surface_extent = VkExtent2D{this->info.headless_extent.x, this->info.headless_extent.y};
+
+    ImageUsageFlags const usage = std::bit_cast<ImageUsageFlags>(info.image_usage) | ImageUsageFlagBits::COLOR_ATTACHMENT | ImageUsageFlagBits::TRANSFER_SRC;
+    for (usize i = 0; i < this->info.max_allowed_frames_in_flight + 1; ++i)
+    {
+        auto const name = std::string{this->info.name.view()} + " image " + std::to_string(i);
+        ImageInfo const image_info = {
+            .format = static_cast<Format>(this->vk_surface_format.format),
+            .size = {this->surface_extent.width, this->surface_extent.height, 1},
+            .usage = usage,
+            .name = SmallString{name},
+        };
+        ImageId id = {};
+        result = daxa_dvc_create_image(this->device, r_cast<daxa_ImageInfo const *>(&image_info), r_cast<daxa_ImageId *>(&id));
+        _DAXA_RETURN_IF_ERROR(result, result)
+        this->images.push_back(id);
+    }
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_ImplSwapchain::acquire_headless_image() -> daxa_Result
+{
+    // Images are handed out in order, the frames in flight wait already made sure the gpu is done with the image.
+    this->current_image_index = static_cast<u32>(this->cpu_frame_timeline % this->images.size());
+    VkSemaphore const acquire_semaphore = (**r_cast<daxa_BinarySemaphore *>(&this->acquire_semaphores[this->acquire_semaphore_index])).vk_semaphore;
+    VkSubmitInfo const signal_submit{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = nullptr,
+        .pWaitDstStageMask = nullptr,
+        .commandBufferCount = 0,
+        .pCommandBuffers = nullptr,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &acquire_semaphore,
+    };
+    auto const queue = daxa_Queue{.family = std::bit_cast<daxa_QueueFamily>(this->info.queue_family), .index = 0};
+    return static_cast<daxa_Result>(vkQueueSubmit(this->device->get_queue(queue).vk_queue, 1, &signal_submit, VK_NULL_HANDLE));
+}
+
+auto daxa_ImplSwapchain::present_headless(VkQueue queue, std::span<VkSemaphore const> wait_semaphores) -> daxa_Result
+{
+    // Waiting un-signals the present semaphores, just like a real present would.
+    std::vector<VkPipelineStageFlags> wait_stages(wait_semaphores.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    VkSubmitInfo const wait_submit{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreCount = static_cast<u32>(wait_semaphores.size()),
+        .pWaitSemaphores = wait_semaphores.data(),
+        .pWaitDstStageMask = wait_stages.data(),
+        .commandBufferCount = 0,
+        .pCommandBuffers = nullptr,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = nullptr,
+    };
+    auto const result = static_cast<daxa_Result>(vkQueueSubmit(queue, 1, &wait_submit, VK_NULL_HANDLE));
+    _DAXA_RETURN_IF_ERROR(result, result)
+    this->frame_presented(0);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_ImplSwapchain::frame_pacing_enabled() const -> bool
+{
+    return this->info.frame_pacing_mode != FramePacingMode::DISABLED;
+}
+
+auto daxa_ImplSwapchain::present_wait_enabled() const -> bool
+{
+    return this->frame_pacing_enabled() && !this->headless() && this->device->vkWaitForPresentKHR != nullptr;
+}
+
+auto daxa_ImplSwapchain::create_frame_pacing_resources() -> daxa_Result
+{
+    if (!this->frame_pacing_enabled())
+    {
+        return DAXA_RESULT_SUCCESS;
+    }
+    this->frame_pacing_slots.resize(this->info.max_allowed_frames_in_flight + 1);
+    this->frame_pacing_statistics.present_latency_supported = this->present_wait_enabled();
+    // Transfer queues are not guaranteed to support timestamps.
+    if (this->device->properties.limits.timestamp_compute_and_graphics == 0 || this->info.queue_family == QueueFamily::TRANSFER)
+    {
+        return DAXA_RESULT_SUCCESS;
+    }
+
+    VkDevice const vk_device = this->device->vk_device;
+    auto const slot_count = static_cast<u32>(this->frame_pacing_slots.size());
+    auto const queue = daxa_Queue{.family = std::bit_cast<daxa_QueueFamily>(this->info.queue_family), .index = 0};
+    VkCommandPoolCreateInfo const cmd_pool_info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = {},
+        .queueFamilyIndex = this->device->get_queue(queue).vk_queue_family_index,
+    };
+    auto result = static_cast<daxa_Result>(vkCreateCommandPool(vk_device, &cmd_pool_info, nullptr, &this->frame_pacing_cmd_pool));
+    _DAXA_RETURN_IF_ERROR(result, result)
+
+    VkQueryPoolCreateInfo const query_pool_info{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = {},
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = slot_count * 2,
+        .pipelineStatistics = {},
+    };
+    result = static_cast<daxa_Result>(vkCreateQueryPool(vk_device, &query_pool_info, nullptr, &this->frame_pacing_query_pool));
+    _DAXA_RETURN_IF_ERROR(result, result)
+    vkResetQueryPool(vk_device, this->frame_pacing_query_pool, 0, slot_count * 2);
+
+    std::vector<VkCommandBuffer> cmd_buffers(slot_count * 2);
+    VkCommandBufferAllocateInfo const cmd_buffer_allocate_info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .commandPool = this->frame_pacing_cmd_pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = slot_count * 2,
+    };
+    result = static_cast<daxa_Result>(vkAllocateCommandBuffers(vk_device, &cmd_buffer_allocate_info, cmd_buffers.data()));
+    _DAXA_RETURN_IF_ERROR(result, result)
+
+    VkFenceCreateInfo const fence_info{
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = {},
+    };
+    for (u32 slot_index = 0; slot_index < slot_count; ++slot_index)
+    {
+        auto & slot = this->frame_pacing_slots[slot_index];
+        slot.begin_cmd_buffer = cmd_buffers[slot_index * 2 + 0];
+        slot.end_cmd_buffer = cmd_buffers[slot_index * 2 + 1];
+        result = static_cast<daxa_Result>(vkCreateFence(vk_device, &fence_info, nullptr, &slot.begin_fence));
+        _DAXA_RETURN_IF_ERROR(result, result)
+        result = static_cast<daxa_Result>(vkCreateFence(vk_device, &fence_info, nullptr, &slot.end_fence));
+        _DAXA_RETURN_IF_ERROR(result, result)
+        // Recorded once and resubmitted every frame, the queries are reset on the host before reuse.
+        for (u32 query = 0; query < 2; ++query)
+        {
+            VkCommandBuffer const cmd_buffer = cmd_buffers[slot_index * 2 + query];
+            VkCommandBufferBeginInfo const begin_info{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .pNext = nullptr,
+                .flags = {},
+                .pInheritanceInfo = nullptr,
+            };
+            result = static_cast<daxa_Result>(vkBeginCommandBuffer(cmd_buffer, &begin_info));
+            _DAXA_RETURN_IF_ERROR(result, result)
+            vkCmdWriteTimestamp(
+                cmd_buffer,
+                query == 0 ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                this->frame_pacing_query_pool,
+                slot_index * 2 + query);
+            result = static_cast<daxa_Result>(vkEndCommandBuffer(cmd_buffer));
+            _DAXA_RETURN_IF_ERROR(result, result)
+        }
+    }
+    this->frame_pacing_statistics.gpu_frame_time_supported = true;
+    return DAXA_RESULT_SUCCESS;
+}
+
+void daxa_ImplSwapchain::destroy_frame_pacing_resources()
+{
+    if (this->device == nullptr)
+    {
+        return;
+    }
+    VkDevice const vk_device = this->device->vk_device;
+    for (auto & slot : this->frame_pacing_slots)
+    {
+        // Command buffers must not be pending when their pool is destroyed.
+        if (slot.begin_pending)
+        {
+            [[maybe_unused]] auto _ignored = vkWaitForFences(vk_device, 1, &slot.begin_fence, VK_TRUE, UINT64_MAX);
+        }
+        if (slot.end_pending)
+        {
+            [[maybe_unused]] auto _ignored = vkWaitForFences(vk_device, 1, &slot.end_fence, VK_TRUE, UINT64_MAX);
+        }
+        if (slot.begin_fence != VK_NULL_HANDLE)
+        {
+            vkDestroyFence(vk_device, slot.begin_fence, nullptr);
+        }
+        if (slot.end_fence != VK_NULL_HANDLE)
+        {
+            vkDestroyFence(vk_device, slot.end_fence, nullptr);
+        }
+    }
+    this->frame_pacing_slots.clear();
+    if (this->frame_pacing_cmd_pool != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(vk_device, this->frame_pacing_cmd_pool, nullptr);
+        this->frame_pacing_cmd_pool = VK_NULL_HANDLE;
+    }
+    if (this->frame_pacing_query_pool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(vk_device, this->frame_pacing_query_pool, nullptr);
+        this->frame_pacing_query_pool = VK_NULL_HANDLE;
+    }
+}
+
+auto daxa_ImplSwapchain::frame_pacing_slot(u64 frame) -> FramePacingSlot &
+{
+    return this->frame_pacing_slots[frame % this->frame_pacing_slots.size()];
+}
+
+auto daxa_ImplSwapchain::begin_frame_timing() -> daxa_Result
+{
+    if (this->frame_pacing_query_pool == VK_NULL_HANDLE)
+    {
+        return DAXA_RESULT_SUCCESS;
+    }
+    VkDevice const vk_device = this->device->vk_device;
+    auto const slot_index = static_cast<u32>((this->cpu_frame_timeline + 1) % this->frame_pacing_slots.size());
+    auto & slot = this->frame_pacing_slots[slot_index];
+
+    // The slot was last used max_allowed_frames_in_flight + 1 frames ago, its fences are almost always signaled already.
+    std::array<VkFence, 2> wait_fences = {};
+    u32 wait_fence_count = 0;
+    if (slot.begin_pending)
+    {
+        wait_fences[wait_fence_count++] = slot.begin_fence;
+    }
+    if (slot.end_pending)
+    {
+        wait_fences[wait_fence_count++] = slot.end_fence;
+    }
+    if (wait_fence_count > 0)
+    {
+        auto result = static_cast<daxa_Result>(vkWaitForFences(vk_device, wait_fence_count, wait_fences.data(), VK_TRUE, UINT64_MAX));
+        _DAXA_RETURN_IF_ERROR(result, result)
+        result = static_cast<daxa_Result>(vkResetFences(vk_device, wait_fence_count, wait_fences.data()));
+        _DAXA_RETURN_IF_ERROR(result, result)
+    }
+    // Frames that were acquired but never presented have no end timestamp.
+    if (slot.begin_pending && slot.end_pending)
+    {
+        std::array<u64, 2> timestamps = {};
+        auto const result = static_cast<daxa_Result>(vkGetQueryPoolResults(
+            vk_device, this->frame_pacing_query_pool, slot_index * 2, 2,
+            sizeof(timestamps), timestamps.data(), sizeof(u64), VK_QUERY_RESULT_64_BIT));
+        _DAXA_RETURN_IF_ERROR(result, result)
+        // The begin timestamp may execute while the queue still works on the previous frame.
+        u64 const gpu_begin = std::max(timestamps[0], this->last_gpu_frame_end);
+        u64 const gpu_ticks = timestamps[1] > gpu_begin ? timestamps[1] - gpu_begin : 0;
+        this->frame_pacing_statistics.gpu_frame_ns = static_cast<u64>(static_cast<f64>(gpu_ticks) * static_cast<f64>(this->device->properties.limits.timestamp_period));
+        this->last_gpu_frame_end = timestamps[1];
+    }
+    slot.begin_pending = false;
+    slot.end_pending = false;
+    vkResetQueryPool(vk_device, this->frame_pacing_query_pool, slot_index * 2, 2);
+
+    VkSubmitInfo const begin_submit{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = nullptr,
+        .pWaitDstStageMask = nullptr,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &slot.begin_cmd_buffer,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = nullptr,
+    };
+    auto const queue = daxa_Queue{.family = std::bit_cast<daxa_QueueFamily>(this->info.queue_family), .index = 0};
+    auto const result = static_cast<daxa_Result>(vkQueueSubmit(this->device->get_queue(queue).vk_queue, 1, &begin_submit, slot.begin_fence));
+    _DAXA_RETURN_IF_ERROR(result, result)
+    slot.begin_pending = true;
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_ImplSwapchain::end_frame_timing(VkQueue queue) -> daxa_Result
+{
+    if (this->frame_pacing_query_pool == VK_NULL_HANDLE)
+    {
+        return DAXA_RESULT_SUCCESS;
+    }
+    auto & slot = this->frame_pacing_slot(this->cpu_frame_timeline);
+    // Nothing to measure without a matching acquire.
+    if (!slot.begin_pending || slot.end_pending)
+    {
+        return DAXA_RESULT_SUCCESS;
+    }
+    // Timestamps wait for all previously submitted commands, so this measures the users last submission as well.
+    VkSubmitInfo const end_submit{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = nullptr,
+        .pWaitDstStageMask = nullptr,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &slot.end_cmd_buffer,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = nullptr,
+    };
+    auto const result = static_cast<daxa_Result>(vkQueueSubmit(queue, 1, &end_submit, slot.end_fence));
+    _DAXA_RETURN_IF_ERROR(result, result)
+    slot.end_pending = true;
+    return DAXA_RESULT_SUCCESS;
+}
+
+void daxa_ImplSwapchain::frame_acquired(u64 acquire_start_ns)
+{
+    if (!this->frame_pacing_enabled())
+    {
+        return;
+    }
+    u64 const now = now_ns();
+    this->frame_pacing_statistics.acquire_wait_ns = now - acquire_start_ns;
+    if (!this->frame_started_by_pacing)
+    {
+        this->frame_start_ns = now;
+    }
+    this->frame_started_by_pacing = false;
+}
+
+void daxa_ImplSwapchain::frame_presented(u64 present_id)
+{
+    this->presented_image_index = this->current_image_index;
+    if (!this->frame_pacing_enabled())
+    {
+        return;
+    }
+    this->frame_pacing_statistics.frame_count += 1;
+    this->frame_pacing_statistics.cpu_frame_ns = now_ns() - this->frame_start_ns;
+    auto & slot = this->frame_pacing_slot(this->cpu_frame_timeline);
+    slot.present_id = present_id;
+    slot.frame_start_ns = this->frame_start_ns;
+    if (this->present_wait_enabled())
+    {
+        this->resolve_presents(0);
+    }
+}
+
+void daxa_ImplSwapchain::resolve_presents(u64 wait_for_id)
+{
+    u64 const slot_count = this->frame_pacing_slots.size();
+    // Presents older than the slot ring were overwritten and can no longer be resolved.
+    u64 const oldest_slot_id = this->cpu_frame_timeline >= slot_count ? this->cpu_frame_timeline - slot_count + 1 : 1;
+    for (u64 id = std::max(this->oldest_pending_present_id, oldest_slot_id); id <= this->cpu_frame_timeline; ++id)
+    {
+        auto & slot = this->frame_pacing_slot(id);
+        if (slot.present_id != id)
+        {
+            // The current frame may still be presented.
+            if (id == this->cpu_frame_timeline)
+            {
+                break;
+            }
+            this->oldest_pending_present_id = id + 1;
+            continue;
+        }
+        u64 const timeout = id <= wait_for_id ? PRESENT_WAIT_TIMEOUT_NS : 0;
+        auto const vk_result = this->device->vkWaitForPresentKHR(this->device->vk_device, this->vk_swapchain, id, timeout);
+        if (vk_result == VK_TIMEOUT)
+        {
+            break;
+        }
+        // Errors, like an out of date swapchain, drop the present.
+        // Polled presents may have completed any time since the last call, the latency is an upper bound.
+        if (vk_result == VK_SUCCESS)
+        {
+            this->frame_pacing_statistics.present_latency_ns = now_ns() - slot.frame_start_ns;
+        }
+        slot.present_id = 0;
+        this->oldest_pending_present_id = id + 1;
+    }
+}
+
+auto daxa_ImplSwapchain::pace_frame() -> daxa_Result
+{
+    if (this->info.frame_pacing_mode == FramePacingMode::LOW_LATENCY && this->cpu_frame_timeline >= 2)
+    {
+        // Sleep through the predictable part of the wait, input sampled afterwards is more recent.
+        u64 const sleep_start_ns = now_ns();
+        f64 const sleep_ns = this->smoothed_pacing_slack_ns - PACING_MARGIN_NS;
+        if (sleep_ns > 0.0)
+        {
+            std::this_thread::sleep_for(std::chrono::nanoseconds{static_cast<i64>(sleep_ns)});
+        }
+        u64 const wait_start_ns = now_ns();
+        // One frame stays queued on the gpu or presentation engine while the next one is recorded.
+        u64 const previous_frame = this->cpu_frame_timeline - 1;
+        if (this->present_wait_enabled())
+        {
+            this->resolve_presents(previous_frame);
+        }
+        [[maybe_unused]] auto _ignored = this->gpu_frame_timeline.wait_for_value(previous_frame);
+        u64 const wait_end_ns = now_ns();
+        this->frame_pacing_statistics.pacing_sleep_ns = wait_start_ns - sleep_start_ns;
+        this->frame_pacing_statistics.pacing_wait_ns = wait_end_ns - wait_start_ns;
+        // Converges to sleeping all of the idle time except the margin.
+        f64 const slack_ns = static_cast<f64>(wait_end_ns - sleep_start_ns);
+        this->smoothed_pacing_slack_ns = this->smoothed_pacing_slack_ns * (1.0 - PACING_SMOOTHING) + slack_ns * PACING_SMOOTHING;
+    }
+    else if (this->present_wait_enabled())
+    {
+        this->resolve_presents(0);
+    }
+    this->frame_start_ns = now_ns();
+    this->frame_started_by_pacing = true;
+    return DAXA_RESULT_SUCCESS;
+}
+
 auto daxa_ImplSwapchain::recreate() -> daxa_Result
 {
+    if (this->headless())
+    {
+        return this->recreate_headless();
+    }
     daxa_Result result = DAXA_RESULT_SUCCESS;
     // Check present mode:
     auto iter = std::find(this->supported_present_modes.begin(), this->supported_present_modes.end(), this->info.present_mode);
@@ -391,11 +901,19 @@ void daxa_ImplSwapchain::partial_cleanup()
         [[maybe_unused]] auto _ignore = daxa_dvc_destroy_image(this->device, static_cast<daxa_ImageId>(image));
     }
     this->images.clear();
+    this->presented_image_index = ~0u;
+    // Present ids restart with a new VkSwapchainKHR, pending presents of the old one can not be waited on.
+    for (auto & slot : this->frame_pacing_slots)
+    {
+        slot.present_id = 0;
+    }
+    this->oldest_pending_present_id = this->cpu_frame_timeline + 1;
 }
 
 void daxa_ImplSwapchain::full_cleanup()
 {
     this->partial_cleanup();
+    this->destroy_frame_pacing_resources();
     if (this->vk_swapchain != VK_NULL_HANDLE)
     {
         // Due to wsi limitations we need to wait idle before destroying the swapchain.
@@ -34,6 +34,17 @@
 ///
 /// WARNING: The swapchain only works on the main queue! It is directly tied to it.
 ///
+/// Headless swapchains have no surface or VkSwapchainKHR. They own a ring of max_allowed_frames_in_flight + 1 images, acquired in order.
+/// The frames in flight wait guarantees that an image is no longer used by the gpu when it is acquired again.
+/// Acquire signals the acquire semaphore with an empty submit, present waits on the present semaphores with an empty submit.
+/// This keeps the semaphore usage of the frame loop identical to the wsi path.
+///
+/// Frame pacing owns one slot per acquire semaphore, indexed by the cpu frame value.
+/// Each slot has a pre-recorded begin and end timestamp command buffer, submitted at acquire and at present with a fence each.
+/// The fences make slot reuse safe independent of the gpu timeline, as the end timestamp is submitted after the users last submission.
+/// Results of a slot are read back when it is reused, so gpu timings lag max_allowed_frames_in_flight + 1 frames behind.
+/// Presents carry the cpu frame value as present id, which is waited on with VK_KHR_present_wait to measure present latency.
+///
 /// TODO: investigate if wsi is improved enough to use zombies for swapchain.
 struct daxa_ImplSwapchain final : ImplHandle
 {
@@ -59,11 +70,64 @@ struct daxa_ImplSwapchain final : ImplHandle
     // This is the swapchain image index that acquire returns. THis is not necessarily linear.
     // This index must be used for present semaphores as they are paired to the images.
     u32 current_image_index = {};
+    // Image index of the last present, ~0u before the first present.
+    u32 presented_image_index = ~0u;
+
+    struct FramePacingSlot
+    {
+        VkCommandBuffer begin_cmd_buffer = {};
+        VkCommandBuffer end_cmd_buffer = {};
+        VkFence begin_fence = {};
+        VkFence end_fence = {};
+        bool begin_pending = {};
+        bool end_pending = {};
+        // Cpu frame value used as present id, 0 when there is no present to wait for.
+        u64 present_id = {};
+        u64 frame_start_ns = {};
+    };
+    FramePacingStatistics frame_pacing_statistics = {};
+    std::vector<FramePacingSlot> frame_pacing_slots = {};
+    VkCommandPool frame_pacing_cmd_pool = {};
+    // Two timestamps per slot.
+    VkQueryPool frame_pacing_query_pool = {};
+    // End timestamp of the last resolved frame, in ticks.
+    u64 last_gpu_frame_end = {};
+    // Oldest present id that may still be waited on.
+    u64 oldest_pending_present_id = 1;
+    // Frame start, set by pace_frame or acquire.
+    u64 frame_start_ns = {};
+    bool frame_started_by_pacing = {};
+    // Smoothed time pace_frame would idle, the sleep target of LOW_LATENCY.
+    f64 smoothed_pacing_slack_ns = {};
+
+    auto headless() const -> bool;
 
     void partial_cleanup();
     void full_cleanup();
     auto recreate_surface() -> daxa_Result;
+    auto select_surface_format() -> daxa_Result;
+    auto select_headless_format() -> daxa_Result;
     auto recreate() -> daxa_Result;
+    auto recreate_headless() -> daxa_Result;
+    auto acquire_headless_image() -> daxa_Result;
+    auto present_headless(VkQueue queue, std::span<VkSemaphore const> wait_semaphores) -> daxa_Result;
+
+    auto frame_pacing_enabled() const -> bool;
+    auto present_wait_enabled() const -> bool;
+    auto create_frame_pacing_resources() -> daxa_Result;
+    void destroy_frame_pacing_resources();
+    auto frame_pacing_slot(u64 frame) -> FramePacingSlot &;
+    // Called after the frames in flight wait of acquire, reads back the reused slot and submits the begin timestamp.
+    auto begin_frame_timing() -> daxa_Result;
+    // Called before the present, submits the end timestamp.
+    auto end_frame_timing(VkQueue queue) -> daxa_Result;
+    // Records the acquire wait and starts the frame, unless pace_frame started it.
+    void frame_acquired(u64 acquire_start_ns);
+    // Sets the presented image and records the present for latency measurement, present_id 0 has no present wait.
+    void frame_presented(u64 present_id);
+    // Waits for presents up to wait_for_id and polls the newer ones.
+    void resolve_presents(u64 wait_for_id);
+    auto pace_frame() -> daxa_Result;
 
     static auto create(daxa_Device device, daxa_SwapchainInfo const * info, daxa_Swapchain swapchain) -> daxa_Result;
     static void zero_ref_callback(ImplHandle const * handle);
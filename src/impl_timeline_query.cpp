@@ -1,5 +1,6 @@
 #include "impl_timeline_query.hpp"
 
+#include <bit>
 #include <utility>
 
 #include "impl_device.hpp"
@@ -80,6 +81,104 @@ auto daxa_timeline_query_pool_dec_refcnt(daxa_TimelineQueryPool self) -> u64
         self->device->instance);
 }
 
+auto daxa_dvc_create_query_pool(daxa_Device device, daxa_QueryPoolInfo const * info, daxa_QueryPool * out_query_pool) -> daxa_Result
+{
+    auto ret = daxa_ImplQueryPool{};
+    ret.device = device;
+    ret.info = *reinterpret_cast<QueryPoolInfo const *>(info);
+    if (ret.info.query_type == QueryType::PIPELINE_STATISTICS && (device->properties.implicit_features & DAXA_IMPLICIT_FEATURE_FLAG_PIPELINE_STATISTICS_QUERY) == 0)
+    {
+        return DAXA_RESULT_ERROR_FEATURE_NOT_PRESENT;
+    }
+    if (ret.info.query_type == QueryType::ACCELERATION_STRUCTURE_COMPACTED_SIZE && (device->properties.implicit_features & DAXA_IMPLICIT_FEATURE_FLAG_BASIC_RAY_TRACING) == 0)
+    {
+        return DAXA_RESULT_INVALID_WITHOUT_ENABLING_RAY_TRACING;
+    }
+    ret.values_per_query = ret.info.query_type == QueryType::PIPELINE_STATISTICS ? static_cast<u32>(std::popcount(ret.info.pipeline_statistics.data)) : 1u;
+    VkQueryPoolCreateInfo const vk_query_pool_create_info{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .queryType = static_cast<VkQueryType>(ret.info.query_type),
+        .queryCount = ret.info.query_count,
+        .pipelineStatistics = ret.info.query_type == QueryType::PIPELINE_STATISTICS ? static_cast<VkQueryPipelineStatisticFlags>(ret.info.pipeline_statistics.data) : 0u,
+    };
+    auto vk_result = vkCreateQueryPool(ret.device->vk_device, &vk_query_pool_create_info, nullptr, &ret.vk_query_pool);
+    if (vk_result != VK_SUCCESS)
+    {
+        return std::bit_cast<daxa_Result>(vk_result);
+    }
+    vkResetQueryPool(ret.device->vk_device, ret.vk_query_pool, 0, ret.info.query_count);
+    if ((ret.device->instance->info.flags & InstanceFlagBits::DEBUG_UTILS) != InstanceFlagBits::NONE && !ret.info.name.empty())
+    {
+        auto c_str_arr = ret.info.name.c_str();
+        VkDebugUtilsObjectNameInfoEXT const query_pool_name_info{
+            .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+            .pNext = nullptr,
+            .objectType = VK_OBJECT_TYPE_QUERY_POOL,
+            .objectHandle = std::bit_cast<uint64_t>(ret.vk_query_pool),
+            .pObjectName = c_str_arr.data(),
+        };
+        ret.device->vkSetDebugUtilsObjectNameEXT(ret.device->vk_device, &query_pool_name_info);
+    }
+    ret.strong_count = 1;
+    device->inc_weak_refcnt();
+    *out_query_pool = new daxa_ImplQueryPool{};
+    **out_query_pool = std::move(ret);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_query_pool_info(daxa_QueryPool self) -> daxa_QueryPoolInfo const *
+{
+    return reinterpret_cast<daxa_QueryPoolInfo const *>(&self->info);
+}
+
+auto daxa_query_pool_values_per_query(daxa_QueryPool self) -> u32
+{
+    return self->values_per_query;
+}
+
+auto daxa_query_pool_query_results(daxa_QueryPool self, u32 start, u32 count, u64 * out_results) -> daxa_Result
+{
+    if (!(start + count - 1 < self->info.query_count))
+    {
+        return DAXA_RESULT_RANGE_OUT_OF_BOUNDS;
+    }
+    u64 const stride = (self->values_per_query + 1ull) * sizeof(u64);
+    auto vk_result = vkGetQueryPoolResults(
+        self->device->vk_device,
+        self->vk_query_pool,
+        start,
+        count,
+        count * stride,
+        out_results,
+        stride,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    return std::bit_cast<daxa_Result>(vk_result);
+}
+
+auto daxa_query_pool_reset(daxa_QueryPool self, u32 start, u32 count) -> daxa_Result
+{
+    if (start + count > self->info.query_count)
+    {
+        return DAXA_RESULT_RANGE_OUT_OF_BOUNDS;
+    }
+    vkResetQueryPool(self->device->vk_device, self->vk_query_pool, start, count);
+    return DAXA_RESULT_SUCCESS;
+}
+
+auto daxa_query_pool_inc_refcnt(daxa_QueryPool self) -> u64
+{
+    return self->inc_refcnt();
+}
+
+auto daxa_query_pool_dec_refcnt(daxa_QueryPool self) -> u64
+{
+    return self->dec_refcnt(
+        &daxa_ImplQueryPool::zero_ref_callback,
+        self->device->instance);
+}
+
 // --- End API Functions ---
 
 // --- Begin Internals ---
@@ -100,4 +199,21 @@ void daxa_ImplTimelineQueryPool::zero_ref_callback(ImplHandle const * handle)
     delete self;
 }
 
+void daxa_ImplQueryPool::zero_ref_callback(ImplHandle const * handle)
+{
+    auto * self = rc_cast<daxa_QueryPool>(handle);
+    std::unique_lock const lock{self->device->zombies_mtx};
+    u64 const submit_timeline = self->device->global_submit_timeline.load(std::memory_order::relaxed);
+    // Destroying a query pool does not depend on its query type, all query pools share the zombie list.
+    self->device->timeline_query_pool_zombies.emplace_back(
+        submit_timeline,
+        TimelineQueryPoolZombie{
+            .vk_timeline_query_pool = self->vk_query_pool,
+        });
+    self->device->dec_weak_refcnt(
+        daxa_ImplDevice::zero_ref_callback,
+        self->device->instance);
+    delete self;
+}
+
 // --- End Internals ---
\ No newline at end of file
@@ -23,3 +23,14 @@ struct daxa_ImplTimelineQueryPool final : ImplHandle
 
     static void zero_ref_callback(ImplHandle const * handle);
 };
+
+struct daxa_ImplQueryPool final : ImplHandle
+{
+    daxa_Device device = {};
+    QueryPoolInfo info = {};
+    // Number of 64 bit values of a single query result, excluding availability.
+    u32 values_per_query = {};
+    VkQueryPool vk_query_pool = {};
+
+    static void zero_ref_callback(ImplHandle const * handle);
+};
@@ -141,90 +141,125 @@ namespace daxa
     }
 #endif
 
-    void ImplImGuiRenderer::recreate_vbuffer(usize vbuffer_new_size)
+    void ImplImGuiRenderer::recreate_ring_buffer(usize new_capacity, CommandRecorder * recorder)
     {
-        vbuffer = info.device.create_buffer({
-            .size = static_cast<u32>(vbuffer_new_size),
-            .name = std::string("dear ImGui vertex buffer"),
+        if (!ring_buffer.is_empty())
+        {
+            // Frames still in flight may read the old buffer.
+            if (recorder != nullptr)
+            {
+                recorder->destroy_buffer_deferred(ring_buffer);
+            }
+            else
+            {
+                info.device.destroy_buffer(ring_buffer);
+            }
+        }
+        ring_buffer = info.device.create_buffer({
+            .size = new_capacity,
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_SEQUENTIAL_WRITE,
+            .name = std::string("dear ImGui vertex and index ring buffer"),
         });
+        ring_capacity = new_capacity;
+        ring_host_address = info.device.buffer_host_address_as<u8>(ring_buffer).value();
+        ring_device_address = info.device.device_address(ring_buffer).value();
+        ring_claimed_start = {};
+        ring_claimed_size = {};
+        ring_frames.clear();
     }
-    void ImplImGuiRenderer::recreate_ibuffer(usize ibuffer_new_size)
+
+    void ImplImGuiRenderer::reclaim_ring_frames()
     {
-        ibuffer = info.device.create_buffer({
-            .size = static_cast<u32>(ibuffer_new_size),
-            .name = std::string("dear ImGui index buffer"),
-        });
+        // Commands recorded by the previous call are expected to be submitted by now.
+        // Their submit has an index at most the latest one, so tagging them with it is conservative.
+        u64 const current_submit_timeline_value = info.device.latest_submit_index();
+        for (auto & frame : ring_frames)
+        {
+            if (frame.submit_timeline_value == std::numeric_limits<u64>::max())
+            {
+                frame.submit_timeline_value = current_submit_timeline_value;
+            }
+        }
+        u64 const min_pending_device_timeline_value_of_all_queues = info.device.oldest_pending_submit_index();
+        while (!ring_frames.empty() && ring_frames.front().submit_timeline_value < min_pending_device_timeline_value_of_all_queues)
+        {
+            ring_claimed_start = (ring_claimed_start + ring_frames.front().size) % ring_capacity;
+            ring_claimed_size -= ring_frames.front().size;
+            ring_frames.pop_front();
+        }
+        if (ring_claimed_size == 0)
+        {
+            ring_claimed_start = {};
+        }
+    }
+
+    auto ImplImGuiRenderer::allocate_ring_frame(usize size) -> std::optional<usize>
+    {
+        usize const claimed_end = ring_claimed_start + ring_claimed_size;
+        bool const wrapped = claimed_end > ring_capacity;
+        usize offset = {};
+        usize claimed = size;
+        if (!wrapped && claimed_end + size <= ring_capacity)
+        {
+            offset = claimed_end;
+        }
+        else if (!wrapped && size <= ring_claimed_start)
+        {
+            // Not enough space left at the end, the unused tail is claimed together with the frame.
+            offset = {};
+            claimed = (ring_capacity - claimed_end) + size;
+        }
+        else if (wrapped && (claimed_end - ring_capacity) + size <= ring_claimed_start)
+        {
+            offset = claimed_end - ring_capacity;
+        }
+        else
+        {
+            return std::nullopt;
+        }
+        ring_claimed_size += claimed;
+        ring_frames.push_back(RingFrame{.size = claimed});
+        return offset;
     }
 
     void ImplImGuiRenderer::record_commands(ImDrawData * draw_data, CommandRecorder & recorder, ImageId target_image, u32 size_x, u32 size_y)
     {
         ++frame_count;
+        reclaim_ring_frames();
         if ((draw_data != nullptr) && draw_data->TotalIdxCount > 0)
         {
-            auto vbuffer_current_size = info.device.buffer_info(vbuffer).value().size;
-            auto vbuffer_needed_size = static_cast<usize>(draw_data->TotalVtxCount) * sizeof(ImDrawVert);
-            auto ibuffer_current_size = info.device.buffer_info(ibuffer).value().size;
-            auto ibuffer_needed_size = static_cast<usize>(draw_data->TotalIdxCount) * sizeof(ImDrawIdx);
-
-            if (vbuffer_needed_size > vbuffer_current_size)
+            // Vertices are read through a buffer pointer, indices are bound as index buffer.
+            static constexpr usize VERTEX_ALIGNMENT = 16;
+            auto up_align = [](usize value, usize alignment)
             {
-                auto vbuffer_new_size = vbuffer_needed_size + 4096;
-                info.device.destroy_buffer(vbuffer);
-                recreate_vbuffer(vbuffer_new_size);
-            }
-            if (ibuffer_needed_size > ibuffer_current_size)
+                return (value + alignment - 1) / alignment * alignment;
+            };
+            auto const vertex_size = static_cast<usize>(draw_data->TotalVtxCount) * sizeof(ImDrawVert);
+            auto const index_size = static_cast<usize>(draw_data->TotalIdxCount) * sizeof(ImDrawIdx);
+            auto const index_region_offset = up_align(vertex_size, sizeof(u32));
+            auto const frame_size = up_align(index_region_offset + index_size, VERTEX_ALIGNMENT);
+
+            auto frame_offset = allocate_ring_frame(frame_size);
+            if (!frame_offset.has_value())
             {
-                auto ibuffer_new_size = ibuffer_needed_size + 4096;
-                info.device.destroy_buffer(ibuffer);
-                recreate_ibuffer(ibuffer_new_size);
+                // Room for a few frames in flight, so that steady state frames never grow the ring.
+                recreate_ring_buffer(std::max(ring_capacity * 2, frame_size * 4), &recorder);
+                frame_offset = allocate_ring_frame(frame_size);
             }
+            auto const vertex_offset = frame_offset.value();
+            auto const index_offset = frame_offset.value() + index_region_offset;
 
-            constexpr usize IMGUI_RESOURCE_NAME_MAX_NUMBER = 8;
-
-            auto staging_vbuffer = info.device.create_buffer({
-                .size = static_cast<u32>(vbuffer_needed_size),
-                .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
-                .name = std::string("dear ImGui vertex staging buffer ") + std::to_string(frame_count % IMGUI_RESOURCE_NAME_MAX_NUMBER),
-            });
-            auto * vtx_dst = info.device.buffer_host_address_as<ImDrawVert>(staging_vbuffer).value();
+            auto * vtx_dst = r_cast<ImDrawVert *>(ring_host_address + vertex_offset);
+            auto * idx_dst = r_cast<ImDrawIdx *>(ring_host_address + index_offset);
             for (i32 n = 0; n < draw_data->CmdListsCount; n++)
             {
                 ImDrawList const * draws = draw_data->CmdLists[n];
                 std::memcpy(vtx_dst, draws->VtxBuffer.Data, static_cast<usize>(draws->VtxBuffer.Size) * sizeof(ImDrawVert));
-                vtx_dst += draws->VtxBuffer.Size;
-            }
-            recorder.destroy_buffer_deferred(staging_vbuffer);
-            auto staging_ibuffer = info.device.create_buffer({
-                .size = static_cast<u32>(ibuffer_needed_size),
-                .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
-                .name = std::string("dear ImGui index staging buffer ") + std::to_string(frame_count % IMGUI_RESOURCE_NAME_MAX_NUMBER),
-            });
-            auto * idx_dst = info.device.buffer_host_address_as<ImDrawIdx>(staging_ibuffer).value();
-            for (i32 n = 0; n < draw_data->CmdListsCount; n++)
-            {
-                ImDrawList const * draws = draw_data->CmdLists[n];
                 std::memcpy(idx_dst, draws->IdxBuffer.Data, static_cast<usize>(draws->IdxBuffer.Size) * sizeof(ImDrawIdx));
+                vtx_dst += draws->VtxBuffer.Size;
                 idx_dst += draws->IdxBuffer.Size;
             }
-            recorder.destroy_buffer_deferred(staging_ibuffer);
-            recorder.pipeline_barrier({
-                .src_access = daxa::AccessConsts::HOST_WRITE,
-                .dst_access = daxa::AccessConsts::TRANSFER_READ,
-            });
-            recorder.copy_buffer_to_buffer({
-                .src_buffer = staging_ibuffer,
-                .dst_buffer = ibuffer,
-                .size = ibuffer_needed_size,
-            });
-            recorder.copy_buffer_to_buffer({
-                .src_buffer = staging_vbuffer,
-                .dst_buffer = vbuffer,
-                .size = vbuffer_needed_size,
-            });
-            recorder.pipeline_barrier({
-                .src_access = daxa::AccessConsts::TRANSFER_WRITE,
-                .dst_access = daxa::AccessConsts::VERTEX_SHADER_READ | daxa::AccessConsts::INDEX_INPUT_READ,
-            });
+            // Host writes before the submit are made visible to the device by the submit itself, no barrier needed.
 
             auto render_recorder = std::move(recorder).begin_renderpass({
                 .color_attachments = std::array{RenderAttachmentInfo{.image_view = target_image.default_view(), .load_op = AttachmentLoadOp::LOAD}},
@@ -234,8 +269,8 @@ namespace daxa
             render_recorder.set_pipeline(raster_pipeline);
 
             render_recorder.set_index_buffer({
-                .id = ibuffer,
-                .offset = 0,
+                .id = ring_buffer,
+                .offset = index_offset,
                 .index_type = IndexType::uint16,
             });
 
@@ -246,8 +281,8 @@ namespace daxa
             ImVec2 const clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
             i32 global_vtx_offset = 0;
             i32 global_idx_offset = 0;
-            push.vbuffer_ptr = this->info.device.device_address(vbuffer).value();
-            push.ibuffer_ptr = this->info.device.device_address(ibuffer).value();
+            push.vbuffer_ptr = ring_device_address + vertex_offset;
+            push.ibuffer_ptr = ring_device_address + index_offset;
 
             for (i32 n = 0; n < draw_data->CmdListsCount; n++)
             {
@@ -346,8 +381,7 @@ namespace daxa
         {
             set_imgui_style();
         }
-        recreate_vbuffer(4096);
-        recreate_ibuffer(4096);
+        recreate_ring_buffer(1 << 20, nullptr);
 
         ImGuiIO & io = ImGui::GetIO();
         io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
@@ -423,8 +457,7 @@ namespace daxa
 
     ImplImGuiRenderer::~ImplImGuiRenderer()
     {
-        this->info.device.destroy_buffer(this->vbuffer);
-        this->info.device.destroy_buffer(this->ibuffer);
+        this->info.device.destroy_buffer(this->ring_buffer);
         this->info.device.destroy_image(this->font_sheet);
         this->info.device.destroy_sampler(this->font_sampler);
     }
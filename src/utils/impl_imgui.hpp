@@ -4,6 +4,8 @@
 
 #include <daxa/utils/imgui.hpp>
 #include <deque>
+#include <limits>
+#include <optional>
 
 namespace daxa
 {
@@ -11,16 +13,32 @@ namespace daxa
     {
         ImGuiRendererInfo info = {};
         RasterPipeline raster_pipeline = {};
-        BufferId vbuffer = {};
-        BufferId ibuffer = {};
         ImageId font_sheet = {};
         SamplerId font_sampler = {};
         usize frame_count = {};
 
+        // Vertices and indices are written to and drawn directly from one persistent host visible ring buffer.
+        // This avoids creating staging buffers, copies and barriers every frame.
+        // The region of a frame is reused once the gpu finished all submits that could have read it.
+        struct RingFrame
+        {
+            // Value of the devices global submit timeline once the frame was submitted, u64 max until then.
+            u64 submit_timeline_value = std::numeric_limits<u64>::max();
+            usize size = {};
+        };
+        BufferId ring_buffer = {};
+        usize ring_capacity = {};
+        u8 * ring_host_address = {};
+        DeviceAddress ring_device_address = {};
+        usize ring_claimed_start = {};
+        usize ring_claimed_size = {};
+        std::deque<RingFrame> ring_frames = {};
+
         std::vector<ImGuiImageContext> image_sampler_pairs = {};
 
-        void recreate_vbuffer(usize vbuffer_new_size);
-        void recreate_ibuffer(usize ibuffer_new_size);
+        void recreate_ring_buffer(usize new_capacity, CommandRecorder * recorder);
+        void reclaim_ring_frames();
+        auto allocate_ring_frame(usize size) -> std::optional<usize>;
         void record_commands(ImDrawData * draw_data, CommandRecorder & recorder, ImageId target_image, u32 size_x, u32 size_y);
 
         ImplImGuiRenderer(ImGuiRendererInfo a_info);
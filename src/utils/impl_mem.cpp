@@ -1,6 +1,10 @@
 #if DAXA_BUILT_WITH_UTILS_MEM
 
 #include <daxa/utils/mem.hpp>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
 #include <utility>
 
 namespace daxa
@@ -165,6 +169,850 @@ namespace daxa
     {
         return this->m_buffer;
     }
+
+    ConcurrentTransferMemoryPool::ConcurrentTransferMemoryPool(ConcurrentTransferMemoryPoolInfo a_info)
+        : m_info{std::move(a_info)},
+          m_buffer{this->m_info.device.create_buffer({
+              .size = this->m_info.capacity,
+              .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_SEQUENTIAL_WRITE | (this->m_info.use_bar_memory ? daxa::MemoryFlagBits::DEDICATED_MEMORY : daxa::MemoryFlagBits::NONE),
+              .name = this->m_info.name,
+          })},
+          buffer_device_address{this->m_info.device.device_address(this->m_buffer).value()},
+          buffer_host_address{this->m_info.device.buffer_host_address(this->m_buffer).value()}
+    {
+    }
+
+    ConcurrentTransferMemoryPool::~ConcurrentTransferMemoryPool()
+    {
+        if (!this->m_buffer.is_empty())
+        {
+            this->m_info.device.destroy_buffer(this->m_buffer);
+        }
+    }
+
+    auto ConcurrentTransferMemoryPool::allocate(u64 allocation_size, u64 alignment_requirement) -> std::optional<Allocation>
+    {
+        DAXA_DBG_ASSERT_TRUE_M(alignment_requirement != 0, "alignment must not be zero");
+        u64 const capacity = this->m_info.capacity;
+        allocation_size = std::max(allocation_size, u64{1});
+        if (allocation_size > capacity)
+        {
+            return std::nullopt;
+        }
+        bool reclaimed = false;
+        u64 current_head = this->head.load(std::memory_order_relaxed);
+        u64 start = {};
+        while (true)
+        {
+            // Aligned within the lap, alignments do not need to divide the capacity (texel blocks of 3, 6, 12 or 24 bytes).
+            u64 const lap_start = current_head / capacity * capacity;
+            start = lap_start + (current_head - lap_start + alignment_requirement - 1) / alignment_requirement * alignment_requirement;
+            // Allocations never wrap around the end of the buffer, the rest of the lap is skipped instead.
+            if (start % capacity + allocation_size > capacity)
+            {
+                start = (start / capacity + 1) * capacity;
+            }
+            u64 const end = start + allocation_size;
+            if (end - this->tail.load(std::memory_order_acquire) > capacity)
+            {
+                if (reclaimed)
+                {
+                    return std::nullopt;
+                }
+                this->reclaim();
+                reclaimed = true;
+                current_head = this->head.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (this->head.compare_exchange_weak(current_head, end, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        u64 const offset = start % capacity;
+        return Allocation{
+            .device_address = this->buffer_device_address + offset,
+            .host_address = reinterpret_cast<void *>(reinterpret_cast<u8 *>(this->buffer_host_address) + offset),
+            .buffer_offset = offset,
+            .size = allocation_size,
+        };
+    }
+
+    void ConcurrentTransferMemoryPool::mark_submitted()
+    {
+        u64 const submit_index = this->m_info.device.latest_submit_index();
+        std::unique_lock lock{this->marks_mtx};
+        u64 const current_head = this->head.load(std::memory_order_acquire);
+        if (!this->marks.empty() && this->marks.back().head == current_head)
+        {
+            this->marks.back().submit_timeline_value = submit_index;
+            return;
+        }
+        this->marks.push_back(SubmitMark{
+            .head = current_head,
+            .submit_timeline_value = submit_index,
+        });
+    }
+
+    void ConcurrentTransferMemoryPool::reclaim()
+    {
+        u64 const min_pending_device_timeline_value_of_all_queues = this->m_info.device.oldest_pending_submit_index();
+        std::unique_lock lock{this->marks_mtx};
+        std::optional<u64> new_tail = {};
+        while (!this->marks.empty() && this->marks.front().submit_timeline_value < min_pending_device_timeline_value_of_all_queues)
+        {
+            new_tail = this->marks.front().head;
+            this->marks.pop_front();
+        }
+        if (new_tail.has_value())
+        {
+            this->tail.store(new_tail.value(), std::memory_order_release);
+        }
+    }
+
+    auto ConcurrentTransferMemoryPool::buffer() const -> daxa::BufferId
+    {
+        return this->m_buffer;
+    }
+
+    auto ConcurrentTransferMemoryPool::info() const -> ConcurrentTransferMemoryPoolInfo const &
+    {
+        return this->m_info;
+    }
+
+    UploadQueue::UploadQueue(UploadQueueInfo a_info)
+        : m_info{std::move(a_info)},
+          staging_pool{ConcurrentTransferMemoryPoolInfo{
+              .device = this->m_info.device,
+              .capacity = this->m_info.staging_capacity,
+              .name = this->m_info.name,
+          }},
+          gpu_timeline{this->m_info.device.create_timeline_semaphore({
+              .initial_value = {},
+              .name = this->m_info.name,
+          })}
+    {
+        if (this->m_info.queue.family != QueueFamily::MAIN && this->m_info.device.queue_count(this->m_info.queue.family) <= this->m_info.queue.index)
+        {
+            this->m_info.queue = QUEUE_MAIN;
+        }
+    }
+
+    // Bytes per texel block of the format, as used in buffer image copies.
+    // Depth stencil formats are copied per aspect and only need 4 byte aligned offsets.
+    static auto texel_block_size(Format format) -> u64
+    {
+        switch (format)
+        {
+        case Format::R4G4_UNORM_PACK8:
+        case Format::R8_UNORM:
+        case Format::R8_SNORM:
+        case Format::R8_USCALED:
+        case Format::R8_SSCALED:
+        case Format::R8_UINT:
+        case Format::R8_SINT:
+        case Format::R8_SRGB:
+            return 1;
+        case Format::R4G4B4A4_UNORM_PACK16:
+        case Format::B4G4R4A4_UNORM_PACK16:
+        case Format::R5G6B5_UNORM_PACK16:
+        case Format::B5G6R5_UNORM_PACK16:
+        case Format::R5G5B5A1_UNORM_PACK16:
+        case Format::B5G5R5A1_UNORM_PACK16:
+        case Format::A1R5G5B5_UNORM_PACK16:
+        case Format::R8G8_UNORM:
+        case Format::R8G8_SNORM:
+        case Format::R8G8_USCALED:
+        case Format::R8G8_SSCALED:
+        case Format::R8G8_UINT:
+        case Format::R8G8_SINT:
+        case Format::R8G8_SRGB:
+        case Format::R16_UNORM:
+        case Format::R16_SNORM:
+        case Format::R16_USCALED:
+        case Format::R16_SSCALED:
+        case Format::R16_UINT:
+        case Format::R16_SINT:
+        case Format::R16_SFLOAT:
+        case Format::R10X6_UNORM_PACK16:
+        case Format::R12X4_UNORM_PACK16:
+        case Format::A4R4G4B4_UNORM_PACK16:
+        case Format::A4B4G4R4_UNORM_PACK16:
+            return 2;
+        case Format::R8G8B8_UNORM:
+        case Format::R8G8B8_SNORM:
+        case Format::R8G8B8_USCALED:
+        case Format::R8G8B8_SSCALED:
+        case Format::R8G8B8_UINT:
+        case Format::R8G8B8_SINT:
+        case Format::R8G8B8_SRGB:
+        case Format::B8G8R8_UNORM:
+        case Format::B8G8R8_SNORM:
+        case Format::B8G8R8_USCALED:
+        case Format::B8G8R8_SSCALED:
+        case Format::B8G8R8_UINT:
+        case Format::B8G8R8_SINT:
+        case Format::B8G8R8_SRGB:
+            return 3;
+        case Format::R16G16B16_UNORM:
+        case Format::R16G16B16_SNORM:
+        case Format::R16G16B16_USCALED:
+        case Format::R16G16B16_SSCALED:
+        case Format::R16G16B16_UINT:
+        case Format::R16G16B16_SINT:
+        case Format::R16G16B16_SFLOAT:
+            return 6;
+        case Format::R16G16B16A16_UNORM:
+        case Format::R16G16B16A16_SNORM:
+        case Format::R16G16B16A16_USCALED:
+        case Format::R16G16B16A16_SSCALED:
+        case Format::R16G16B16A16_UINT:
+        case Format::R16G16B16A16_SINT:
+        case Format::R16G16B16A16_SFLOAT:
+        case Format::R32G32_UINT:
+        case Format::R32G32_SINT:
+        case Format::R32G32_SFLOAT:
+        case Format::R64_UINT:
+        case Format::R64_SINT:
+        case Format::R64_SFLOAT:
+        case Format::BC1_RGB_UNORM_BLOCK:
+        case Format::BC1_RGB_SRGB_BLOCK:
+        case Format::BC1_RGBA_UNORM_BLOCK:
+        case Format::BC1_RGBA_SRGB_BLOCK:
+        case Format::BC4_UNORM_BLOCK:
+        case Format::BC4_SNORM_BLOCK:
+        case Format::ETC2_R8G8B8_UNORM_BLOCK:
+        case Format::ETC2_R8G8B8_SRGB_BLOCK:
+        case Format::ETC2_R8G8B8A1_UNORM_BLOCK:
+        case Format::ETC2_R8G8B8A1_SRGB_BLOCK:
+        case Format::EAC_R11_UNORM_BLOCK:
+        case Format::EAC_R11_SNORM_BLOCK:
+            return 8;
+        case Format::R32G32B32_UINT:
+        case Format::R32G32B32_SINT:
+        case Format::R32G32B32_SFLOAT:
+            return 12;
+        case Format::R64G64B64_UINT:
+        case Format::R64G64B64_SINT:
+        case Format::R64G64B64_SFLOAT:
+            return 24;
+        case Format::R64G64B64A64_UINT:
+        case Format::R64G64B64A64_SINT:
+        case Format::R64G64B64A64_SFLOAT:
+            return 32;
+        case Format::R32G32B32A32_UINT:
+        case Format::R32G32B32A32_SINT:
+        case Format::R32G32B32A32_SFLOAT:
+        case Format::R64G64_UINT:
+        case Format::R64G64_SINT:
+        case Format::R64G64_SFLOAT:
+            return 16;
+        default:
+            // Everything else is 4 bytes (packed 32 bit, 32 bit single channel, depth stencil),
+            // 8 bytes (4PACK16 and 422 formats, the remaining 64 bit blocks) or 16 bytes (remaining compressed blocks).
+            // 16 is a multiple of all of these.
+            return 16;
+        }
+    }
+
+    UploadQueue::~UploadQueue()
+    {
+        // Uploads queued since the last flush are still submitted, their tokens were handed out already.
+        this->wait(this->flush());
+    }
+
+    auto UploadQueue::upload(BufferUploadInfo const & upload_info) -> UploadToken
+    {
+        DAXA_DBG_ASSERT_TRUE_M(
+            this->m_info.queue.family == QueueFamily::MAIN ||
+                this->m_info.device.buffer_info(upload_info.dst_buffer).value().sharing_mode == SharingMode::CONCURRENT,
+            "buffers uploaded on a transfer queue must be created with SharingMode::CONCURRENT");
+        return this->stage(upload_info.data, 4, PendingCopy{
+                                                    .dst_buffer = upload_info.dst_buffer,
+                                                    .dst_offset = upload_info.dst_offset,
+                                                });
+    }
+
+    auto UploadQueue::upload(ImageUploadInfo const & upload_info) -> UploadToken
+    {
+        DAXA_DBG_ASSERT_TRUE_M(
+            this->m_info.queue.family == QueueFamily::MAIN ||
+                this->m_info.device.image_info(upload_info.dst_image).value().sharing_mode == SharingMode::CONCURRENT,
+            "images uploaded on a transfer queue must be created with SharingMode::CONCURRENT");
+        // bufferOffset must be a multiple of the texel block size and of 4.
+        u64 const alignment = std::lcm(texel_block_size(this->m_info.device.image_info(upload_info.dst_image).value().format), u64{4});
+        return this->stage(upload_info.data, alignment, PendingCopy{
+                                                     .dst_image = upload_info.dst_image,
+                                                     .image_layout = upload_info.image_layout,
+                                                     .image_slice = upload_info.image_slice,
+                                                     .image_offset = upload_info.image_offset,
+                                                     .image_extent = upload_info.image_extent,
+                                                 });
+    }
+
+    auto UploadQueue::stage(std::span<std::byte const> data, u64 alignment, PendingCopy copy) -> UploadToken
+    {
+        // Allocations never wrap around the end of the staging ring.
+        // Only uploads of at most half its capacity are guaranteed to fit once all older uploads completed, larger ones would retry forever.
+        if (data.size() * 2 + alignment > this->m_info.staging_capacity)
+        {
+            throw std::runtime_error{"upload is larger than half of the upload queues staging memory"};
+        }
+        while (true)
+        {
+            {
+                std::shared_lock lock{this->flush_mtx};
+                auto allocation = this->staging_pool.allocate(data.size(), alignment);
+                if (allocation.has_value())
+                {
+                    std::memcpy(allocation->host_address, data.data(), data.size());
+                    copy.staging_offset = allocation->buffer_offset;
+                    copy.size = data.size();
+                    {
+                        std::unique_lock pending_lock{this->pending_mtx};
+                        this->pending_copies.push_back(copy);
+                    }
+                    return UploadToken{this->next_timeline_value.load()};
+                }
+            }
+            // Out of staging memory, submit everything queued and wait for it to free the memory.
+            // Staging memory may still be held back by older work on other queues, in that case we retry.
+            this->wait(this->flush());
+            std::this_thread::yield();
+        }
+    }
+
+    auto UploadQueue::flush() -> UploadToken
+    {
+        std::unique_lock lock{this->flush_mtx};
+        u64 const timeline_value = this->next_timeline_value.load();
+        if (this->pending_copies.empty())
+        {
+            return UploadToken{timeline_value - 1};
+        }
+        auto & device = this->m_info.device;
+        CommandRecorder recorder = device.create_command_recorder({
+            .queue_family = this->m_info.queue.family,
+            .name = this->m_info.name,
+        });
+        for (auto const & copy : this->pending_copies)
+        {
+            if (!copy.dst_buffer.is_empty())
+            {
+                recorder.copy_buffer_to_buffer({
+                    .src_buffer = this->staging_pool.buffer(),
+                    .dst_buffer = copy.dst_buffer,
+                    .src_offset = copy.staging_offset,
+                    .dst_offset = copy.dst_offset,
+                    .size = copy.size,
+                });
+            }
+            else
+            {
+                recorder.copy_buffer_to_image({
+                    .buffer = this->staging_pool.buffer(),
+                    .buffer_offset = copy.staging_offset,
+                    .image = copy.dst_image,
+                    .image_layout = copy.image_layout,
+                    .image_slice = copy.image_slice,
+                    .image_offset = copy.image_offset,
+                    .image_extent = copy.image_extent,
+                });
+            }
+        }
+        device.submit_commands({
+            .queue = this->m_info.queue,
+            .command_lists = std::array{recorder.complete_current_commands()},
+            .signal_timeline_semaphores = std::array{std::pair{this->gpu_timeline, timeline_value}},
+        });
+        this->staging_pool.mark_submitted();
+        this->pending_copies.clear();
+        this->next_timeline_value.store(timeline_value + 1);
+        return UploadToken{timeline_value};
+    }
+
+    auto UploadQueue::is_complete(UploadToken token) const -> bool
+    {
+        return this->gpu_timeline.value() >= token.timeline_value;
+    }
+
+    void UploadQueue::wait(UploadToken token)
+    {
+        [[maybe_unused]] auto _timeout = this->gpu_timeline.wait_for_value(token.timeline_value);
+    }
+
+    auto UploadQueue::timeline_semaphore() const -> TimelineSemaphore const &
+    {
+        return this->gpu_timeline;
+    }
+
+    auto UploadQueue::wait_pair(UploadToken token) const -> std::pair<TimelineSemaphore, u64>
+    {
+        return {this->gpu_timeline, token.timeline_value};
+    }
+
+    auto UploadQueue::info() const -> UploadQueueInfo const &
+    {
+        return this->m_info;
+    }
+
+    ReadbackPool::ReadbackPool(ReadbackPoolInfo a_info)
+        : m_info{std::move(a_info)},
+          gpu_timeline{this->m_info.device.create_timeline_semaphore({
+              .initial_value = {},
+              .name = this->m_info.name,
+          })},
+          // Random host access places the buffer in host cached memory.
+          m_buffer{this->m_info.device.create_buffer({
+              .size = this->m_info.capacity,
+              .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+              .name = this->m_info.name,
+          })},
+          buffer_host_address{this->m_info.device.buffer_host_address_as<std::byte>(this->m_buffer).value()},
+          free_ranges{{u64{0}, this->m_info.capacity}}
+    {
+    }
+
+    ReadbackPool::~ReadbackPool()
+    {
+        if (!this->m_buffer.is_empty())
+        {
+            this->m_info.device.destroy_buffer(this->m_buffer);
+        }
+    }
+
+    auto ReadbackPool::allocate(u64 allocation_size, u64 alignment_requirement) -> std::optional<ReadbackToken>
+    {
+        allocation_size = std::max(allocation_size, u64{1});
+        if (allocation_size > this->m_info.capacity)
+        {
+            return std::nullopt;
+        }
+        // First fit, the padding in front of the aligned start stays part of the allocated range.
+        auto find_range = [&]()
+        {
+            return std::find_if(this->free_ranges.begin(), this->free_ranges.end(), [&](auto const & range)
+            {
+                u64 const start = (range.first + alignment_requirement - 1) / alignment_requirement * alignment_requirement;
+                return start + allocation_size <= range.first + range.second;
+            });
+        };
+        auto iter = find_range();
+        if (iter == this->free_ranges.end())
+        {
+            this->reclaim_unused_memory();
+            iter = find_range();
+            if (iter == this->free_ranges.end())
+            {
+                return std::nullopt;
+            }
+        }
+        auto const [range_offset, range_size] = *iter;
+        u64 const start = (range_offset + alignment_requirement - 1) / alignment_requirement * alignment_requirement;
+        u64 const end = start + allocation_size;
+        this->free_ranges.erase(iter);
+        if (end < range_offset + range_size)
+        {
+            this->free_ranges.emplace(end, range_offset + range_size - end);
+        }
+        this->current_timeline_value += 1;
+        this->live_readbacks.emplace(start, TrackedReadback{
+                                                .timeline_value = this->current_timeline_value,
+                                                .range_offset = range_offset,
+                                                .range_size = end - range_offset,
+                                            });
+        return ReadbackToken{
+            .timeline_value = this->current_timeline_value,
+            .buffer_offset = start,
+            .size = allocation_size,
+        };
+    }
+
+    void ReadbackPool::free_range(u64 offset, u64 size)
+    {
+        auto next = this->free_ranges.lower_bound(offset);
+        if (next != this->free_ranges.end() && offset + size == next->first)
+        {
+            size += next->second;
+            next = this->free_ranges.erase(next);
+        }
+        if (next != this->free_ranges.begin())
+        {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset)
+            {
+                prev->second += size;
+                return;
+            }
+        }
+        this->free_ranges.emplace_hint(next, offset, size);
+    }
+
+    void ReadbackPool::reclaim_unused_memory()
+    {
+        auto const current_gpu_timeline_value = this->gpu_timeline.value();
+        std::erase_if(this->released_readbacks, [&](TrackedReadback const & readback)
+        {
+            if (readback.timeline_value > current_gpu_timeline_value)
+            {
+                return false;
+            }
+            this->free_range(readback.range_offset, readback.range_size);
+            return true;
+        });
+    }
+
+    auto ReadbackPool::record_readback(CommandRecorder & recorder, BufferReadbackInfo const & readback_info) -> std::optional<ReadbackToken>
+    {
+        auto token = this->allocate(readback_info.size, 16);
+        if (token.has_value())
+        {
+            recorder.copy_buffer_to_buffer({
+                .src_buffer = readback_info.src_buffer,
+                .dst_buffer = this->m_buffer,
+                .src_offset = readback_info.src_offset,
+                .dst_offset = token->buffer_offset,
+                .size = readback_info.size,
+            });
+            // Barriers are merged by the recorder, many readbacks in a row only cost a single barrier.
+            recorder.pipeline_barrier({
+                .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+                .dst_access = daxa::AccessConsts::HOST_READ,
+            });
+        }
+        return token;
+    }
+
+    auto ReadbackPool::record_readback(CommandRecorder & recorder, ImageReadbackInfo const & readback_info) -> std::optional<ReadbackToken>
+    {
+        auto token = this->allocate(readback_info.size, 16);
+        if (token.has_value())
+        {
+            recorder.copy_image_to_buffer({
+                .image = readback_info.src_image,
+                .image_layout = readback_info.image_layout,
+                .image_slice = readback_info.image_slice,
+                .image_offset = readback_info.image_offset,
+                .image_extent = readback_info.image_extent,
+                .buffer = this->m_buffer,
+                .buffer_offset = token->buffer_offset,
+            });
+            recorder.pipeline_barrier({
+                .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+                .dst_access = daxa::AccessConsts::HOST_READ,
+            });
+        }
+        return token;
+    }
+
+    auto ReadbackPool::is_ready(ReadbackToken const & token) const -> bool
+    {
+        return this->gpu_timeline.value() >= token.timeline_value;
+    }
+
+    void ReadbackPool::wait(ReadbackToken const & token)
+    {
+        [[maybe_unused]] auto _timeout = this->gpu_timeline.wait_for_value(token.timeline_value);
+    }
+
+    auto ReadbackPool::data(ReadbackToken const & token) const -> std::optional<std::span<std::byte const>>
+    {
+        if (!this->is_ready(token))
+        {
+            return std::nullopt;
+        }
+        return std::span<std::byte const>{this->buffer_host_address + token.buffer_offset, token.size};
+    }
+
+    void ReadbackPool::release(ReadbackToken const & token)
+    {
+        auto const iter = this->live_readbacks.find(token.buffer_offset);
+        if (iter == this->live_readbacks.end() || iter->second.timeline_value != token.timeline_value)
+        {
+            return;
+        }
+        this->released_readbacks.push_back(iter->second);
+        this->live_readbacks.erase(iter);
+    }
+
+    auto ReadbackPool::timeline_value() const -> u64
+    {
+        return this->current_timeline_value;
+    }
+
+    auto ReadbackPool::timeline_semaphore() const -> TimelineSemaphore const &
+    {
+        return this->gpu_timeline;
+    }
+
+    auto ReadbackPool::buffer() const -> daxa::BufferId
+    {
+        return this->m_buffer;
+    }
+
+    auto ReadbackPool::info() const -> ReadbackPoolInfo const &
+    {
+        return this->m_info;
+    }
+
+    BlasCompactor::BlasCompactor(BlasCompactorInfo a_info)
+        : m_info{std::move(a_info)}
+    {
+        this->query_pool = this->m_info.device.create_query_pool({
+            .query_type = QueryType::ACCELERATION_STRUCTURE_COMPACTED_SIZE,
+            .query_count = this->m_info.max_pending_blas,
+            .name = this->m_info.name,
+        });
+        // Popped from the back, so that queries are handed out in ascending order.
+        this->free_queries.reserve(this->m_info.max_pending_blas);
+        for (u32 i = this->m_info.max_pending_blas; i > 0; --i)
+        {
+            this->free_queries.push_back(i - 1);
+        }
+    }
+
+    BlasCompactor::~BlasCompactor() = default;
+
+    auto BlasCompactor::record_size_queries(CommandRecorder & recorder, std::span<BlasId const> blas) -> u32
+    {
+        u32 const count = static_cast<u32>(std::min(blas.size(), this->free_queries.size()));
+        if (count == 0)
+        {
+            return 0;
+        }
+        recorder.pipeline_barrier({
+            .src_access = AccessConsts::ACCELERATION_STRUCTURE_BUILD_WRITE,
+            .dst_access = AccessConsts::ACCELERATION_STRUCTURE_BUILD_READ,
+        });
+        // Free queries are always reset, consecutive ones are written with a single command.
+        u32 run_begin = 0;
+        while (run_begin < count)
+        {
+            u32 const first_query = this->free_queries.back();
+            u32 run_end = run_begin;
+            while (run_end < count && this->free_queries.back() == first_query + (run_end - run_begin))
+            {
+                this->pending.push_back(PendingBlas{.blas = blas[run_end], .query_index = this->free_queries.back()});
+                this->free_queries.pop_back();
+                run_end += 1;
+                if (this->free_queries.empty())
+                {
+                    break;
+                }
+            }
+            recorder.write_blas_compacted_sizes({
+                .query_pool = this->query_pool,
+                .first_query = first_query,
+                .blas = blas.subspan(run_begin, run_end - run_begin),
+            });
+            run_begin = run_end;
+        }
+        return count;
+    }
+
+    auto BlasCompactor::record_compactions(CommandRecorder & recorder) -> std::vector<BlasCompaction>
+    {
+        std::vector<BlasCompaction> ret = {};
+        if (this->pending.empty())
+        {
+            return ret;
+        }
+        // Results are pairs of compacted size and availability.
+        auto const results = this->query_pool.get_query_results(0, this->m_info.max_pending_blas);
+        auto & device = this->m_info.device;
+        std::erase_if(this->pending, [&](PendingBlas const & pending_blas)
+        {
+            u64 const compacted_size = results[pending_blas.query_index * 2];
+            bool const available = results[pending_blas.query_index * 2 + 1] != 0;
+            if (!available)
+            {
+                return false;
+            }
+            // Resetting on the host right away makes sure that a later reuse of the query never sees this result.
+            this->query_pool.reset(pending_blas.query_index, 1);
+            this->free_queries.push_back(pending_blas.query_index);
+            // The blas may have been destroyed while its size was queried.
+            if (!device.is_blas_id_valid(pending_blas.blas))
+            {
+                return true;
+            }
+            auto const old_info = device.blas_info(pending_blas.blas).value();
+            if (compacted_size == 0 || compacted_size >= old_info.size)
+            {
+                return true;
+            }
+            auto const new_blas = device.create_blas({.size = compacted_size, .name = old_info.name});
+            recorder.copy_blas({.src_blas = pending_blas.blas, .dst_blas = new_blas, .mode = AccelerationStructureCopyMode::COMPACT});
+            recorder.destroy_blas_deferred(pending_blas.blas);
+            ret.push_back(BlasCompaction{
+                .old_blas = pending_blas.blas,
+                .new_blas = new_blas,
+                .old_size = old_info.size,
+                .new_size = compacted_size,
+            });
+            this->m_statistics.compacted_blas += 1;
+            this->m_statistics.bytes_before += old_info.size;
+            this->m_statistics.bytes_after += compacted_size;
+            return true;
+        });
+        if (!ret.empty())
+        {
+            recorder.pipeline_barrier({
+                .src_access = AccessConsts::ACCELERATION_STRUCTURE_BUILD_WRITE,
+                .dst_access = AccessConsts::READ,
+            });
+        }
+        return ret;
+    }
+
+    auto BlasCompactor::pending_blas() const -> u32
+    {
+        return static_cast<u32>(this->pending.size());
+    }
+
+    auto BlasCompactor::statistics() const -> BlasCompactorStatistics const &
+    {
+        return this->m_statistics;
+    }
+
+    auto BlasCompactor::info() const -> BlasCompactorInfo const &
+    {
+        return this->m_info;
+    }
+
+    static auto align_up(u64 value, u64 alignment) -> u64
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    BlasBuildScheduler::BlasBuildScheduler(BlasBuildSchedulerInfo a_info)
+        : m_info{std::move(a_info)},
+          scratch_alignment{this->m_info.device.properties().acceleration_structure_properties.value().min_acceleration_structure_scratch_offset_alignment}
+    {
+        // Padded so that the ring can start at an aligned address.
+        this->scratch_buffer = this->m_info.device.create_buffer({
+            .size = this->m_info.scratch_capacity + this->scratch_alignment,
+            .name = this->m_info.name,
+        });
+        this->scratch_address = align_up(this->m_info.device.buffer_device_address(this->scratch_buffer).value(), this->scratch_alignment);
+    }
+
+    BlasBuildScheduler::~BlasBuildScheduler()
+    {
+        this->m_info.device.destroy_buffer(this->scratch_buffer);
+    }
+
+    auto BlasBuildScheduler::enqueue(BlasBuildInfo const & info, std::string_view name) -> BlasId
+    {
+        auto build = QueuedBuild{.build_info = info};
+        if (auto const * triangles = daxa::get_if<Span<BlasTriangleGeometryInfo const>>(&info.geometries))
+        {
+            build.triangles.assign(triangles->data(), triangles->data() + triangles->size());
+            build.build_info.geometries = Span<BlasTriangleGeometryInfo const>{build.triangles.data(), build.triangles.size()};
+        }
+        else if (auto const * aabbs = daxa::get_if<Span<BlasAabbGeometryInfo const>>(&info.geometries))
+        {
+            build.aabbs.assign(aabbs->data(), aabbs->data() + aabbs->size());
+            build.build_info.geometries = Span<BlasAabbGeometryInfo const>{build.aabbs.data(), build.aabbs.size()};
+        }
+        auto const build_sizes = this->m_info.device.blas_build_sizes(build.build_info);
+        build.scratch_size = build_sizes.build_scratch_size;
+        build.blas_size = build_sizes.acceleration_structure_size;
+        build.build_info.dst_blas = this->m_info.device.create_blas({
+            .size = build.blas_size,
+            .name = name.empty() ? SmallString{this->m_info.name} : SmallString{name},
+        });
+        BlasId const ret = build.build_info.dst_blas;
+        // Moving the vectors keeps their memory, the geometry spans stay valid.
+        this->queue.push_back(std::move(build));
+        return ret;
+    }
+
+    auto BlasBuildScheduler::record_builds(CommandRecorder & recorder) -> std::vector<BlasId>
+    {
+        std::vector<BlasId> ret = {};
+        if (this->queue.empty())
+        {
+            return ret;
+        }
+        auto & device = this->m_info.device;
+        auto flush_batch = [&]()
+        {
+            if (!this->batch.empty())
+            {
+                recorder.build_acceleration_structures({.blas_build_infos = this->batch});
+                this->m_statistics.batches += 1;
+                this->batch.clear();
+            }
+        };
+        // Builds of the previous frame may still use the scratch ring, they are ordered before these on the same queue.
+        recorder.pipeline_barrier({
+            .src_access = AccessConsts::ACCELERATION_STRUCTURE_BUILD_WRITE,
+            .dst_access = AccessConsts::ACCELERATION_STRUCTURE_BUILD_READ_WRITE,
+        });
+        u64 built_bytes = 0;
+        u64 head = 0;
+        while (!this->queue.empty() && (built_bytes == 0 || built_bytes + this->queue.front().blas_size <= this->m_info.build_budget_per_frame))
+        {
+            auto & build = this->queue.front();
+            if (build.scratch_size > this->m_info.scratch_capacity)
+            {
+                auto const dedicated_scratch = device.create_buffer({
+                    .size = build.scratch_size + this->scratch_alignment,
+                    .name = this->m_info.name,
+                });
+                build.build_info.scratch_data = align_up(device.buffer_device_address(dedicated_scratch).value(), this->scratch_alignment);
+                recorder.destroy_buffer_deferred(dedicated_scratch);
+                this->m_statistics.dedicated_scratch_builds += 1;
+            }
+            else
+            {
+                if (head + build.scratch_size > this->m_info.scratch_capacity)
+                {
+                    // The ring wraps around, the next batch reuses the scratch memory of the previous ones.
+                    flush_batch();
+                    recorder.pipeline_barrier({
+                        .src_access = AccessConsts::ACCELERATION_STRUCTURE_BUILD_WRITE,
+                        .dst_access = AccessConsts::ACCELERATION_STRUCTURE_BUILD_READ_WRITE,
+                    });
+                    head = 0;
+                }
+                build.build_info.scratch_data = this->scratch_address + head;
+                this->m_statistics.scratch_peak = std::max(this->m_statistics.scratch_peak, head + build.scratch_size);
+                head = align_up(head + build.scratch_size, this->scratch_alignment);
+            }
+            built_bytes += build.blas_size;
+            ret.push_back(build.build_info.dst_blas);
+            this->batch.push_back(build.build_info);
+            // Keeps the geometry alive until the batch is recorded.
+            this->recorded.push_back(std::move(build));
+            this->queue.pop_front();
+        }
+        flush_batch();
+        recorder.pipeline_barrier({
+            .src_access = AccessConsts::ACCELERATION_STRUCTURE_BUILD_WRITE,
+            .dst_access = AccessConsts::READ,
+        });
+        this->recorded.clear();
+        this->m_statistics.built_blas += ret.size();
+        this->m_statistics.built_bytes += built_bytes;
+        return ret;
+    }
+
+    auto BlasBuildScheduler::queued_builds() const -> u32
+    {
+        return static_cast<u32>(this->queue.size());
+    }
+
+    auto BlasBuildScheduler::statistics() const -> BlasBuildSchedulerStatistics const &
+    {
+        return this->m_statistics;
+    }
+
+    auto BlasBuildScheduler::info() const -> BlasBuildSchedulerInfo const &
+    {
+        return this->m_info;
+    }
 } // namespace daxa
 
 #endif
@@ -131,9 +131,22 @@ static constexpr TBuiltInResource DAXA_DEFAULT_BUILTIN_RESOURCE = {
 #include <sstream>
 #include <iostream>
 #include <string>
-// for std::hash<std::string>
+#include <random>
+#include <set>
 #include <unordered_map>
 
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 // static auto const PRAGMA_ONCE_REGEX = RE2(R"regex(\s*#\s*pragma\s+once\s*)regex");
 static void shader_preprocess(std::string & file_str, std::filesystem::path const & path)
 {
@@ -453,10 +466,32 @@ namespace daxa
             }
             ++pipeline_manager_count;
         }
+
+        if (this->info.enable_background_hot_reload)
+        {
+            file_watcher.initialize();
+            background_thread = std::thread{[this]()
+                                            { this->background_reload_loop(); }};
+        }
     }
 
     ImplPipelineManager::~ImplPipelineManager()
     {
+        if (background_thread.joinable())
+        {
+            background_thread_should_stop.store(true);
+            {
+                // The background thread may swap the watcher to polling mode while holding the lock.
+                auto lock = std::lock_guard{mtx};
+                file_watcher.wake();
+            }
+            background_thread.join();
+            file_watcher.cleanup();
+        }
+        for (auto & [cache_folder, archive] : spirv_cache_archives)
+        {
+            archive->flush();
+        }
 #if DAXA_BUILT_WITH_UTILS_PIPELINE_MANAGER_GLSLANG
         {
             auto lock = std::lock_guard{glslang_init_mtx};
@@ -482,7 +517,6 @@ namespace daxa
         auto pipe_result = RayTracingPipelineState{
             .pipeline_ptr = std::make_shared<RayTracingPipeline>(),
             .info = a_info,
-            .last_hotload_time = std::chrono::file_clock::now(),
             .observed_hotload_files = {},
         };
         this->current_observed_hotload_files = &pipe_result.observed_hotload_files;
@@ -547,6 +581,7 @@ namespace daxa
                         shader_compile_info.compile_options.required_subgroup_size.has_value() ? 
                         Optional{shader_compile_info.compile_options.required_subgroup_size.value()} : 
                         daxa::None,
+                    .specialization_constants = {shader_compile_info.specialization_constants.data(), shader_compile_info.specialization_constants.size()},
                 });
                 if (shader_compile_info.compile_options.entry_point.has_value() && (shader_compile_info.compile_options.language != ShaderLanguage::SLANG))
                 {
@@ -579,7 +614,6 @@ namespace daxa
         auto pipe_result = ComputePipelineState{
             .pipeline_ptr = std::make_shared<ComputePipeline>(),
             .info = a_info,
-            .last_hotload_time = std::chrono::file_clock::now(),
             .observed_hotload_files = {},
         };
         this->current_observed_hotload_files = &pipe_result.observed_hotload_files;
@@ -612,6 +646,7 @@ namespace daxa
                     Optional{a_info.shader_info.compile_options.required_subgroup_size.value()} : 
                     daxa::None,
                 .entry_point = entry_point,
+                .specialization_constants = {pipe_result.info.shader_info.specialization_constants.data(), pipe_result.info.shader_info.specialization_constants.size()},
             },
             .push_constant_size = a_info.push_constant_size,
             .name = a_info.name.c_str(),
@@ -632,7 +667,6 @@ namespace daxa
         auto pipe_result = RasterPipelineState{
             .pipeline_ptr = std::make_shared<RasterPipeline>(),
             .info = a_info,
-            .last_hotload_time = std::chrono::file_clock::now(),
             .observed_hotload_files = {},
         };
         this->current_observed_hotload_files = &pipe_result.observed_hotload_files;
@@ -685,6 +719,7 @@ namespace daxa
                         pipe_result_shader_info->value().compile_options.required_subgroup_size.has_value() ? 
                         Optional{pipe_result_shader_info->value().compile_options.required_subgroup_size.value()} : 
                         daxa::None,
+                    .specialization_constants = {pipe_result_shader_info->value().specialization_constants.data(), pipe_result_shader_info->value().specialization_constants.size()},
                 };
                 if (pipe_result_shader_info->value().compile_options.language != ShaderLanguage::SLANG)
                 {
@@ -699,6 +734,8 @@ namespace daxa
     auto ImplPipelineManager::add_ray_tracing_pipeline(RayTracingPipelineCompileInfo const & a_info) -> Result<std::shared_ptr<RayTracingPipeline>>
     {
         // DAXA_DBG_ASSERT_TRUE_M(!daxa::holds_alternative<daxa::Monostate>(a_info.shader_info.source), "must provide shader source");
+        auto lock = std::lock_guard{mtx};
+        background_force_check.store(true);
         auto modified_info = a_info;
         for (auto & shader_compile_info : modified_info.ray_gen_infos)
         {
@@ -730,6 +767,7 @@ namespace daxa
         {
             return Result<std::shared_ptr<RayTracingPipeline>>(pipe_result.m);
         }
+        this->dependency_graph.add_dependent(pipe_result.value().pipeline_ptr.get(), pipe_result.value().observed_hotload_files);
         this->ray_tracing_pipelines.push_back(pipe_result.value());
         if (this->info.register_null_pipelines_when_first_compile_fails)
         {
@@ -746,6 +784,8 @@ namespace daxa
     auto ImplPipelineManager::add_compute_pipeline(ComputePipelineCompileInfo const & a_info) -> Result<std::shared_ptr<ComputePipeline>>
     {
         DAXA_DBG_ASSERT_TRUE_M(!daxa::holds_alternative<daxa::Monostate>(a_info.shader_info.source), "must provide shader source");
+        auto lock = std::lock_guard{mtx};
+        background_force_check.store(true);
         auto modified_info = a_info;
         modified_info.shader_info.compile_options.inherit(this->info.shader_compile_options);
         auto pipe_result = create_compute_pipeline(modified_info);
@@ -753,6 +793,7 @@ namespace daxa
         {
             return Result<std::shared_ptr<ComputePipeline>>(pipe_result.m);
         }
+        this->dependency_graph.add_dependent(pipe_result.value().pipeline_ptr.get(), pipe_result.value().observed_hotload_files);
         this->compute_pipelines.push_back(pipe_result.value());
         if (this->info.register_null_pipelines_when_first_compile_fails)
         {
@@ -768,6 +809,8 @@ namespace daxa
 
     auto ImplPipelineManager::add_raster_pipeline(RasterPipelineCompileInfo const & a_info) -> Result<std::shared_ptr<RasterPipeline>>
     {
+        auto lock = std::lock_guard{mtx};
+        background_force_check.store(true);
         auto modified_info = a_info;
         auto const modified_shader_compile_infos = std::array<Optional<ShaderCompileInfo> *, 6>{
             &modified_info.vertex_shader_info,
@@ -789,6 +832,7 @@ namespace daxa
         {
             return Result<std::shared_ptr<RasterPipeline>>(pipe_result.m);
         }
+        this->dependency_graph.add_dependent(pipe_result.value().pipeline_ptr.get(), pipe_result.value().observed_hotload_files);
         this->raster_pipelines.push_back(pipe_result.value());
         if (this->info.register_null_pipelines_when_first_compile_fails)
         {
@@ -804,6 +848,7 @@ namespace daxa
 
     void ImplPipelineManager::remove_ray_tracing_pipeline(std::shared_ptr<RayTracingPipeline> const & pipeline)
     {
+        auto lock = std::lock_guard{mtx};
         auto pipeline_iter = std::find_if(
             this->ray_tracing_pipelines.begin(),
             this->ray_tracing_pipelines.end(),
@@ -815,11 +860,13 @@ namespace daxa
         {
             return;
         }
+        this->dependency_graph.remove_dependent(pipeline_iter->pipeline_ptr.get(), pipeline_iter->observed_hotload_files);
         this->ray_tracing_pipelines.erase(pipeline_iter);
     }
 
     void ImplPipelineManager::remove_compute_pipeline(std::shared_ptr<ComputePipeline> const & pipeline)
     {
+        auto lock = std::lock_guard{mtx};
         auto pipeline_iter = std::find_if(
             this->compute_pipelines.begin(),
             this->compute_pipelines.end(),
@@ -831,11 +878,13 @@ namespace daxa
         {
             return;
         }
+        this->dependency_graph.remove_dependent(pipeline_iter->pipeline_ptr.get(), pipeline_iter->observed_hotload_files);
         this->compute_pipelines.erase(pipeline_iter);
     }
 
     void ImplPipelineManager::remove_raster_pipeline(std::shared_ptr<RasterPipeline> const & pipeline)
     {
+        auto lock = std::lock_guard{mtx};
         auto pipeline_iter = std::find_if(
             this->raster_pipelines.begin(),
             this->raster_pipelines.end(),
@@ -847,85 +896,87 @@ namespace daxa
         {
             return;
         }
+        this->dependency_graph.remove_dependent(pipeline_iter->pipeline_ptr.get(), pipeline_iter->observed_hotload_files);
         this->raster_pipelines.erase(pipeline_iter);
     }
 
-    using FileWriteTimeLookupTable = std::unordered_map<std::string, std::filesystem::file_time_type>;
-
-    static auto check_if_sources_changed(std::chrono::file_clock::time_point & last_hotload_time, ShaderFileTimeSet & observed_hotload_files, VirtualFileSet & virtual_files, FileWriteTimeLookupTable & lookup_table) -> bool
+    void ShaderDependencyGraph::add_dependent(void const * pipeline, ShaderFileTimeSet const & observed_files)
     {
-        using namespace std::chrono_literals;
-        static constexpr auto HOTRELOAD_MIN_TIME = 250ms;
-
-        auto now = std::chrono::file_clock::now();
-        using namespace std::chrono_literals;
-        if (now - last_hotload_time < HOTRELOAD_MIN_TIME)
+        for (auto const & [path, write_time] : observed_files)
         {
-            return false;
+            auto [iter, inserted] = nodes.try_emplace(path.string());
+            // Keep the oldest time, so that a change one dependent has not seen yet is still detected for it.
+            if (inserted || write_time < iter->second.last_write_time)
+            {
+                iter->second.last_write_time = write_time;
+            }
+            iter->second.dependents.insert(pipeline);
         }
-        last_hotload_time = now;
-        bool reload = false;
+    }
 
-        auto get_last_file_write_time = [&](std::filesystem::path const & path)
+    void ShaderDependencyGraph::remove_dependent(void const * pipeline, ShaderFileTimeSet const & observed_files)
+    {
+        for (auto const & [path, write_time] : observed_files)
         {
-            auto full_path_str = std::filesystem::absolute(path).string();
-            auto iter = lookup_table.find(full_path_str);
-            if (iter != lookup_table.end())
+            auto iter = nodes.find(path.string());
+            if (iter == nodes.end())
             {
-                return iter->second;
+                continue;
             }
-            else
+            iter->second.dependents.erase(pipeline);
+            if (iter->second.dependents.empty())
             {
-                auto latest_write_time = std::filesystem::last_write_time(path);
-                lookup_table[full_path_str] = latest_write_time;
-                return latest_write_time;
+                nodes.erase(iter);
             }
-        };
+        }
+    }
 
-        for (auto & [path, recorded_write_time] : observed_hotload_files)
+    auto ShaderDependencyGraph::collect_changed(VirtualFileSet const & virtual_files) -> std::unordered_set<void const *>
+    {
+        auto changed = std::unordered_set<void const *>{};
+        for (auto & [path, node] : nodes)
         {
-            auto path_str = path.string();
-            if (virtual_files.contains(path_str))
+            auto latest_write_time = std::chrono::file_clock::time_point{};
+            if (auto virtual_file_iter = virtual_files.find(path); virtual_file_iter != virtual_files.end())
             {
-                auto latest_write_time = virtual_files[path_str].timestamp;
-                if (latest_write_time > recorded_write_time)
-                {
-                    reload = true;
-                }
+                latest_write_time = virtual_file_iter->second.timestamp;
             }
-            else // if (std::filesystem::exists(path))
+            else
             {
-                auto latest_write_time = get_last_file_write_time(path);
-                if (latest_write_time > recorded_write_time)
+                auto ec = std::error_code{};
+                latest_write_time = std::filesystem::last_write_time(path, ec);
+                if (ec)
                 {
-                    reload = true;
+                    // Deleted or currently being replaced by an editor, check again next time.
+                    continue;
                 }
             }
-            // else
-            // {
-            //     std::cout << "How?" << std::endl;
-            // }
-        }
-        if (reload)
-        {
-            for (auto & pair : observed_hotload_files)
+            if (latest_write_time > node.last_write_time)
             {
-                auto path_str = pair.first.string();
-                if (virtual_files.contains(path_str))
-                {
-                    pair.second = virtual_files[path_str].timestamp;
-                }
-                else if (std::filesystem::exists(pair.first))
-                {
-                    pair.second = get_last_file_write_time(pair.first);
-                }
+                node.last_write_time = latest_write_time;
+                changed.insert(node.dependents.begin(), node.dependents.end());
             }
         }
-        return reload;
-    };
+        return changed;
+    }
+
+    static auto hotload_throttled(std::chrono::file_clock::time_point & last_hotload_time) -> bool
+    {
+        using namespace std::chrono_literals;
+        static constexpr auto HOTRELOAD_MIN_TIME = 250ms;
+
+        auto now = std::chrono::file_clock::now();
+        if (now - last_hotload_time < HOTRELOAD_MIN_TIME)
+        {
+            return true;
+        }
+        last_hotload_time = now;
+        return false;
+    }
 
     void ImplPipelineManager::add_virtual_file(VirtualFileInfo const & virtual_info)
     {
+        auto lock = std::lock_guard{mtx};
         virtual_files[virtual_info.name] = VirtualFileState{
             .contents = virtual_info.contents,
             .timestamp = std::chrono::file_clock::now(),
@@ -936,22 +987,49 @@ namespace daxa
             this->info.custom_preprocessor(virtual_file.contents, virtual_info.name);
         }
         shader_preprocess(virtual_file.contents, virtual_info.name);
+        spirv_variant_cache.clear();
+        if (this->info.enable_background_hot_reload)
+        {
+            background_force_check.store(true);
+            file_watcher.wake();
+        }
     }
 
     auto ImplPipelineManager::reload_all() -> PipelineReloadResult
     {
-        bool reloaded = false;
+        if (this->info.enable_background_hot_reload)
+        {
+            return apply_pending_reloads();
+        }
 
-        // Optimization for caching the write times so that multiple pipelines don't check the
-        // filesystem for the same file's write-time. Filesystem checks are really slow...
-        auto lookup_table = FileWriteTimeLookupTable{};
+        auto lock = std::lock_guard{mtx};
+        if (hotload_throttled(last_hotload_time))
+        {
+            return NoPipelineChanged{};
+        }
+        auto reloads = PendingReloads{};
+        recompile_changed_pipelines(reloads);
+        return apply_reloads(reloads);
+    }
 
-        for (auto & [pipeline, compile_info, last_hotload_time, observed_hotload_files] : this->compute_pipelines)
+    void ImplPipelineManager::recompile_changed_pipelines(PendingReloads & reloads)
+    {
+        auto const changed = dependency_graph.collect_changed(virtual_files);
+        if (changed.empty())
         {
-            if (check_if_sources_changed(last_hotload_time, observed_hotload_files, virtual_files, lookup_table))
+            return;
+        }
+        // Variant keys do not cover file contents, any changed file may invalidate any variant.
+        spirv_variant_cache.clear();
+        auto recompile = [&](auto & pipeline_states, auto create_pipeline, auto & out_reloads)
+        {
+            for (auto & pipeline_state : pipeline_states)
             {
-                reloaded = true;
-                auto new_pipeline = create_compute_pipeline(compile_info);
+                if (!changed.contains(pipeline_state.pipeline_ptr.get()))
+                {
+                    continue;
+                }
+                auto new_pipeline = (this->*create_pipeline)(pipeline_state.info);
                 bool is_valid = true;
                 if (this->info.register_null_pipelines_when_first_compile_fails)
                 {
@@ -963,79 +1041,131 @@ namespace daxa
                 }
                 if (is_valid)
                 {
-                    *pipeline = std::move(*new_pipeline.value().pipeline_ptr);
+                    // The includes may have changed, so the edges of this pipeline are replaced with the ones seen by the new compilation.
+                    dependency_graph.remove_dependent(pipeline_state.pipeline_ptr.get(), pipeline_state.observed_hotload_files);
+                    pipeline_state.observed_hotload_files = std::move(new_pipeline.value().observed_hotload_files);
+                    dependency_graph.add_dependent(pipeline_state.pipeline_ptr.get(), pipeline_state.observed_hotload_files);
+                    out_reloads.emplace_back(pipeline_state.pipeline_ptr, std::move(*new_pipeline.value().pipeline_ptr));
                 }
                 else
                 {
-                    return PipelineReloadError{new_pipeline.m};
+                    reloads.errors.push_back(new_pipeline.m);
                 }
             }
+        };
+        recompile(this->compute_pipelines, &ImplPipelineManager::create_compute_pipeline, reloads.compute_pipelines);
+        recompile(this->raster_pipelines, &ImplPipelineManager::create_raster_pipeline, reloads.raster_pipelines);
+        recompile(this->ray_tracing_pipelines, &ImplPipelineManager::create_ray_tracing_pipeline, reloads.ray_tracing_pipelines);
+        // A hot reload is a natural batch, persist its results right away instead of waiting for the destructor.
+        for (auto & [cache_folder, archive] : spirv_cache_archives)
+        {
+            archive->flush();
         }
+    }
 
-        for (auto & [pipeline, compile_info, last_hotload_time, observed_hotload_files] : this->raster_pipelines)
+    auto ImplPipelineManager::apply_reloads(PendingReloads & reloads) -> PipelineReloadResult
+    {
+        // Assigning over the old pipeline drops its last reference.
+        // The old pipeline then becomes a zombie and is only destroyed once the device timeline passed all submits that may use it.
+        for (auto & [pipeline, new_pipeline] : reloads.compute_pipelines)
+        {
+            *pipeline = std::move(new_pipeline);
+        }
+        for (auto & [pipeline, new_pipeline] : reloads.raster_pipelines)
+        {
+            *pipeline = std::move(new_pipeline);
+        }
+        for (auto & [pipeline, new_pipeline] : reloads.ray_tracing_pipelines)
+        {
+            *pipeline = std::move(new_pipeline);
+        }
+        if (!reloads.errors.empty())
         {
-            if (check_if_sources_changed(last_hotload_time, observed_hotload_files, virtual_files, lookup_table))
+            auto message = std::string{};
+            for (auto const & error : reloads.errors)
             {
-                reloaded = true;
-                auto new_pipeline = create_raster_pipeline(compile_info);
-                bool is_valid = true;
-                if (this->info.register_null_pipelines_when_first_compile_fails)
-                {
-                    is_valid = new_pipeline.is_ok() && new_pipeline.value().pipeline_ptr->is_valid();
-                }
-                else
-                {
-                    is_valid = new_pipeline.is_ok();
-                }
-                if (is_valid)
-                {
-                    *pipeline = std::move(*new_pipeline.value().pipeline_ptr);
-                }
-                else
-                {
-                    return PipelineReloadError{new_pipeline.m};
-                }
+                message += error;
+                message += "\n";
+            }
+            return PipelineReloadError{message};
+        }
+        if (!reloads.compute_pipelines.empty() || !reloads.raster_pipelines.empty() || !reloads.ray_tracing_pipelines.empty())
+        {
+            return PipelineReloadSuccess{};
+        }
+        return NoPipelineChanged{};
+    }
+
+    auto ImplPipelineManager::apply_pending_reloads() -> PipelineReloadResult
+    {
+        auto reloads = PendingReloads{};
+        {
+            auto lock = std::lock_guard{pending_reloads_mtx};
+            std::swap(reloads, pending_reloads);
+        }
+        return apply_reloads(reloads);
+    }
+
+    void ImplPipelineManager::background_reload_loop()
+    {
+        using namespace std::chrono_literals;
+        static constexpr auto BACKGROUND_POLL_INTERVAL = 250ms;
+        // Editors tend to write files in multiple steps (truncate, write, rename).
+        // Waiting a little after the first change event avoids compiling half written files.
+        static constexpr auto BACKGROUND_CHANGE_SETTLE_TIME = 20ms;
+
+        while (!background_thread_should_stop.load())
+        {
+            bool files_changed = file_watcher.wait(BACKGROUND_POLL_INTERVAL);
+            if (background_thread_should_stop.load())
+            {
+                break;
+            }
+            if (files_changed && file_watcher.watches_files())
+            {
+                std::this_thread::sleep_for(BACKGROUND_CHANGE_SETTLE_TIME);
             }
+            bool const force_check = background_force_check.exchange(false);
+            if (!files_changed && !force_check)
+            {
+                continue;
+            }
+            background_reload_changed_pipelines(force_check);
         }
+    }
+
+    void ImplPipelineManager::background_reload_changed_pipelines(bool watch_new_directories)
+    {
+        auto lock = std::lock_guard{mtx};
 
-        for (auto & [pipeline, compile_info, last_hotload_time, observed_hotload_files] : this->ray_tracing_pipelines)
+        if (watch_new_directories && file_watcher.watches_files())
         {
-            if (check_if_sources_changed(last_hotload_time, observed_hotload_files, virtual_files, lookup_table))
+            for (auto const & [path, node] : dependency_graph.nodes)
             {
-                reloaded = true;
-                auto new_pipeline = create_ray_tracing_pipeline(compile_info);
-                bool is_valid = true;
-                if (this->info.register_null_pipelines_when_first_compile_fails)
-                {
-                    is_valid = new_pipeline.is_ok() && new_pipeline.value().pipeline_ptr->is_valid();
-                }
-                else
+                if (!virtual_files.contains(path))
                 {
-                    is_valid = new_pipeline.is_ok();
-                }
-                if (is_valid)
-                {
-                    *pipeline = std::move(*new_pipeline.value().pipeline_ptr);
-                }
-                else
-                {
-                    return PipelineReloadError{new_pipeline.m};
+                    file_watcher.watch_directory(std::filesystem::path{path}.parent_path());
                 }
             }
         }
 
-        if (reloaded)
-        {
-            return PipelineReloadSuccess{};
-        }
-        else
+        auto reloads = PendingReloads{};
+        recompile_changed_pipelines(reloads);
+
+        auto pending_lock = std::lock_guard{pending_reloads_mtx};
+        auto append = [](auto & dst, auto & src)
         {
-            return NoPipelineChanged{};
-        }
+            dst.insert(dst.end(), std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()));
+        };
+        append(pending_reloads.compute_pipelines, reloads.compute_pipelines);
+        append(pending_reloads.raster_pipelines, reloads.raster_pipelines);
+        append(pending_reloads.ray_tracing_pipelines, reloads.ray_tracing_pipelines);
+        append(pending_reloads.errors, reloads.errors);
     }
 
     auto ImplPipelineManager::all_pipelines_valid() const -> bool
     {
+        auto lock = std::lock_guard{mtx};
         for (RasterPipelineState const & raster_pipeline_state : this->raster_pipelines)
         {
             if (!raster_pipeline_state.pipeline_ptr->is_valid())
@@ -1062,171 +1192,759 @@ namespace daxa
         return true;
     }
 
-    static auto hash_shader_info(std::string const & source_string, ShaderCompileOptions const & compile_options, ImplPipelineManager::ShaderStage shader_stage) -> uint64_t
+    void ShaderFileWatcher::initialize()
     {
-        auto result = uint64_t{};
+#if defined(__linux__)
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd != -1)
+        {
+            wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (wake_fd == -1)
+            {
+                close(inotify_fd);
+                inotify_fd = -1;
+            }
+        }
+#endif
+    }
 
-        auto hash_combine = [](uint64_t h1, uint64_t h2) -> uint64_t
+    void ShaderFileWatcher::cleanup()
+    {
+#if defined(__linux__)
+        if (inotify_fd != -1)
         {
-            return h1 ^ (h2 << 1);
-        };
+            // Closing the inotify instance also removes all of its watches.
+            close(inotify_fd);
+            close(wake_fd);
+        }
+#endif
+        inotify_fd = -1;
+        wake_fd = -1;
+        watched_directories.clear();
+    }
+
+    auto ShaderFileWatcher::watches_files() const -> bool
+    {
+        return inotify_fd != -1;
+    }
+
+    void ShaderFileWatcher::watch_directory([[maybe_unused]] std::filesystem::path const & directory)
+    {
+#if defined(__linux__)
+        if (inotify_fd == -1)
+        {
+            return;
+        }
+        auto directory_str = directory.string();
+        if (directory_str.empty() || watched_directories.contains(directory_str))
+        {
+            return;
+        }
+        int const watch = inotify_add_watch(inotify_fd, directory_str.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF);
+        if (watch == -1)
+        {
+            // Most likely the user watch limit was hit. We can not see changes in all files anymore, so fall back to polling.
+            cleanup();
+            return;
+        }
+        watched_directories[directory_str] = watch;
+#endif
+    }
+
+    auto ShaderFileWatcher::wait(std::chrono::milliseconds timeout) -> bool
+    {
+#if defined(__linux__)
+        if (inotify_fd != -1)
+        {
+            auto poll_fds = std::array{
+                pollfd{.fd = inotify_fd, .events = POLLIN, .revents = 0},
+                pollfd{.fd = wake_fd, .events = POLLIN, .revents = 0},
+            };
+            int const ready = poll(poll_fds.data(), static_cast<nfds_t>(poll_fds.size()), static_cast<int>(timeout.count()));
+            bool changed = false;
+            if (ready > 0)
+            {
+                // Drain all queued events. Which file changed does not matter, the write times are compared afterwards.
+                alignas(inotify_event) std::array<char, 4096> event_buffer = {};
+                while (read(inotify_fd, event_buffer.data(), event_buffer.size()) > 0)
+                {
+                    changed = true;
+                }
+                auto wake_count = u64{};
+                [[maybe_unused]] auto _ = read(wake_fd, &wake_count, sizeof(wake_count));
+            }
+            return changed;
+        }
+#endif
+        auto lock = std::unique_lock{wake_mtx};
+        wake_cv.wait_for(lock, timeout, [&]
+                         { return wake_requested; });
+        wake_requested = false;
+        return true;
+    }
 
-        auto hash_shader_compile_options = [&hash_combine](ShaderCompileOptions const & options) -> uint64_t
+    void ShaderFileWatcher::wake()
+    {
+#if defined(__linux__)
+        if (wake_fd != -1)
+        {
+            auto const one = u64{1};
+            [[maybe_unused]] auto _ = write(wake_fd, &one, sizeof(one));
+            return;
+        }
+#endif
         {
-            auto result = uint64_t{};
-            if (options.entry_point.has_value())
+            auto lock = std::lock_guard{wake_mtx};
+            wake_requested = true;
+        }
+        wake_cv.notify_one();
+    }
+
+    namespace
+    {
+        // Minimal streaming SHA-256 (FIPS 180-4) for spirv cache keys.
+        // std::hash is neither collision resistant nor stable across builds, so it is unfit for keys shared between machines.
+        struct Sha256
+        {
+            static constexpr std::array<u32, 64> ROUND_CONSTANTS = {
+                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+            };
+
+            std::array<u32, 8> state = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+            std::array<u8, 64> block = {};
+            usize block_size = {};
+            u64 total_size = {};
+
+            void process_block()
             {
-                result = hash_combine(result, std::hash<std::string>{}(options.entry_point.value()));
+                auto w = std::array<u32, 64>{};
+                for (usize i = 0; i < 16; ++i)
+                {
+                    w[i] = (u32{block[i * 4 + 0]} << 24) | (u32{block[i * 4 + 1]} << 16) | (u32{block[i * 4 + 2]} << 8) | u32{block[i * 4 + 3]};
+                }
+                for (usize i = 16; i < 64; ++i)
+                {
+                    u32 const s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                    u32 const s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+                }
+                auto [a, b, c, d, e, f, g, h] = state;
+                for (usize i = 0; i < 64; ++i)
+                {
+                    u32 const s1 = std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+                    u32 const ch = (e & f) ^ (~e & g);
+                    u32 const t1 = h + s1 + ch + ROUND_CONSTANTS[i] + w[i];
+                    u32 const s0 = std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+                    u32 const maj = (a & b) ^ (a & c) ^ (b & c);
+                    u32 const t2 = s0 + maj;
+                    h = g;
+                    g = f;
+                    f = e;
+                    e = d + t1;
+                    d = c;
+                    c = b;
+                    b = a;
+                    a = t1 + t2;
+                }
+                state[0] += a;
+                state[1] += b;
+                state[2] += c;
+                state[3] += d;
+                state[4] += e;
+                state[5] += f;
+                state[6] += g;
+                state[7] += h;
             }
-            for (auto const & path : options.root_paths)
+
+            void update(void const * data, usize size)
             {
-                result = hash_combine(result, std::hash<std::string>{}(path.string()));
+                auto const * bytes = static_cast<u8 const *>(data);
+                total_size += size;
+                for (usize i = 0; i < size; ++i)
+                {
+                    block[block_size++] = bytes[i];
+                    if (block_size == block.size())
+                    {
+                        process_block();
+                        block_size = 0;
+                    }
+                }
             }
-            if (options.language.has_value())
+
+            // Strings are length prefixed, so that different splits of the same characters hash differently.
+            void update(std::string_view str)
             {
-                result = hash_combine(result, std::hash<uint32_t>{}(static_cast<uint32_t>(options.language.value())));
+                update_value(static_cast<u64>(str.size()));
+                update(str.data(), str.size());
             }
-            for (auto const & define : options.defines)
+
+            template <typename T>
+                requires std::is_trivially_copyable_v<T>
+            void update_value(T const & value)
             {
-                result = hash_combine(result, std::hash<std::string>{}(define.name));
-                result = hash_combine(result, std::hash<std::string>{}(define.value));
+                update(&value, sizeof(T));
             }
-            if (options.enable_debug_info.has_value())
+
+            auto finalize() -> std::array<u8, 32>
             {
-                result = hash_combine(result, std::hash<uint32_t>{}(static_cast<uint32_t>(options.enable_debug_info.value())));
+                u64 const bit_size = total_size * 8;
+                u8 const padding_start = 0x80;
+                update(&padding_start, 1);
+                u8 const zero = 0;
+                while (block_size != 56)
+                {
+                    update(&zero, 1);
+                }
+                for (i32 i = 7; i >= 0; --i)
+                {
+                    u8 const size_byte = static_cast<u8>(bit_size >> (i * 8));
+                    update(&size_byte, 1);
+                }
+                auto digest = std::array<u8, 32>{};
+                for (usize i = 0; i < 8; ++i)
+                {
+                    digest[i * 4 + 0] = static_cast<u8>(state[i] >> 24);
+                    digest[i * 4 + 1] = static_cast<u8>(state[i] >> 16);
+                    digest[i * 4 + 2] = static_cast<u8>(state[i] >> 8);
+                    digest[i * 4 + 3] = static_cast<u8>(state[i]);
+                }
+                return digest;
+            }
+        };
+
+        // Collects the files referenced by include directives (glsl and slang) and slang imports.
+        // This is a plain text scan, so directives in inactive preprocessor branches are also reported,
+        // which can only ever make the cache key more conservative.
+        struct IncludeDirective
+        {
+            std::string name = {};
+            bool is_system = {};
+        };
+
+        // Textual scan, does not run the preprocessor. Returns nullopt for includes of macros (#include MY_HEADER),
+        // their target is only known after preprocessing, so such shaders can not be keyed by their contents.
+        auto find_include_directives(std::string_view source, ShaderLanguage language) -> std::optional<std::vector<IncludeDirective>>
+        {
+            auto result = std::vector<IncludeDirective>{};
+            auto skip_whitespace = [&](usize pos) -> usize
+            {
+                while (pos < source.size() && (source[pos] == ' ' || source[pos] == '\t'))
+                {
+                    ++pos;
+                }
+                return pos;
+            };
+            auto starts_with_at = [&](usize pos, std::string_view word) -> bool
+            {
+                return source.substr(pos, word.size()) == word;
+            };
+            usize line_start = 0;
+            while (line_start < source.size())
+            {
+                usize line_end = source.find('\n', line_start);
+                if (line_end == std::string_view::npos)
+                {
+                    line_end = source.size();
+                }
+                auto const line = source.substr(0, line_end);
+                usize pos = skip_whitespace(line_start);
+                bool is_include = false;
+                if (pos < line.size() && line[pos] == '#')
+                {
+                    pos = skip_whitespace(pos + 1);
+                    is_include = starts_with_at(pos, "include");
+                    pos += 7;
+                }
+                else if (starts_with_at(pos, "__include"))
+                {
+                    is_include = true;
+                    pos += 9;
+                }
+                if (is_include)
+                {
+                    pos = skip_whitespace(pos);
+                    if (pos < line.size() && (line[pos] == '"' || line[pos] == '<'))
+                    {
+                        char const closing = line[pos] == '"' ? '"' : '>';
+                        usize const name_end = line.find(closing, pos + 1);
+                        if (name_end != std::string_view::npos)
+                        {
+                            result.push_back({.name = std::string{line.substr(pos + 1, name_end - pos - 1)}, .is_system = closing == '>'});
+                        }
+                    }
+                    else if (pos < line.size() && line[pos] != '\r')
+                    {
+                        return std::nullopt;
+                    }
+                }
+                else if (language == ShaderLanguage::SLANG && starts_with_at(pos, "import") && (pos + 6 < line.size()) && (line[pos + 6] == ' ' || line[pos + 6] == '\t'))
+                {
+                    pos = skip_whitespace(pos + 6);
+                    if (pos < line.size() && line[pos] == '"')
+                    {
+                        usize const name_end = line.find('"', pos + 1);
+                        if (name_end != std::string_view::npos)
+                        {
+                            result.push_back({.name = std::string{line.substr(pos + 1, name_end - pos - 1)}, .is_system = false});
+                        }
+                    }
+                    else
+                    {
+                        // import a.b_c; resolves to a/b_c.slang, or a/b-c.slang when that does not exist.
+                        usize const name_end = line.find(';', pos);
+                        auto module_name = std::string{line.substr(pos, name_end == std::string_view::npos ? std::string_view::npos : name_end - pos)};
+                        while (!module_name.empty() && (module_name.back() == ' ' || module_name.back() == '\t' || module_name.back() == '\r'))
+                        {
+                            module_name.pop_back();
+                        }
+                        std::replace(module_name.begin(), module_name.end(), '.', '/');
+                        result.push_back({.name = module_name + ".slang", .is_system = false});
+                        if (module_name.find('_') != std::string::npos)
+                        {
+                            std::replace(module_name.begin(), module_name.end(), '_', '-');
+                            result.push_back({.name = module_name + ".slang", .is_system = false});
+                        }
+                    }
+                }
+                line_start = line_end + 1;
             }
             return result;
+        }
+
+        // Layout of the spirv cache archive file:
+        // SpirvCacheArchiveHeader, spirv blobs (4 byte aligned), padding to 8 bytes, SpirvCacheArchiveIndexEntry[entry_count] sorted by key.
+        constexpr auto CACHE_FILE_MAGIC_NUMBER = std::bit_cast<u64>(std::to_array("daxpipe"));
+        constexpr auto CACHE_FILE_VERSION = u64{3};
+        constexpr auto CACHE_FILE_NAME = std::string_view{"daxa_spirv_cache.bin"};
+
+        struct SpirvCacheArchiveHeader
+        {
+            u64 magic_number = {};
+            u64 version = {};
+            u64 entry_count = {};
+            u64 index_offset = {};
+        };
+
+        struct SpirvCacheArchiveIndexEntry
+        {
+            ShaderCacheKey key = {};
+            u64 blob_offset = {};
+            u64 blob_size = {};
         };
 
-        result = hash_combine(result, std::hash<std::string>{}(source_string));
-        result = hash_combine(result, hash_shader_compile_options(compile_options));
-        result = hash_combine(result, std::hash<uint32_t>{}(static_cast<uint32_t>(shader_stage)));
+        // Everything that influences the generated code except the sources.
+        void hash_compile_options(Sha256 & hasher, ShaderCompileOptions const & options, u32 shader_stage)
+        {
+            hasher.update_value(CACHE_FILE_VERSION);
+            hasher.update_value(shader_stage);
+            hasher.update(options.entry_point.value_or("main"));
+            hasher.update_value(static_cast<u32>(options.language.value_or(ShaderLanguage::GLSL)));
+            hasher.update_value(static_cast<u64>(options.defines.size()));
+            for (auto const & define : options.defines)
+            {
+                hasher.update(define.name);
+                hasher.update(define.value);
+            }
+            hasher.update_value(static_cast<u8>(options.enable_debug_info.value_or(false)));
+            hasher.update_value(options.create_flags.value_or(ShaderCreateFlagBits::NONE).data);
+            hasher.update_value(static_cast<u8>(options.required_subgroup_size.has_value()));
+            hasher.update_value(options.required_subgroup_size.value_or(0));
+        }
+    } // namespace
+
+    SpirvCacheArchive::SpirvCacheArchive(std::filesystem::path a_path) : path{std::move(a_path)}
+    {
+        map();
+    }
 
-        return result;
+    SpirvCacheArchive::~SpirvCacheArchive()
+    {
+        unmap();
     }
 
-    static constexpr auto CACHE_FILE_MAGIC_NUMBER = std::bit_cast<uint64_t>(std::to_array("daxpipe"));
-    static constexpr auto CACHE_FILE_VERSION = uint64_t{2};
+    void SpirvCacheArchive::map()
+    {
+        unmap();
+        auto ec = std::error_code{};
+        auto const file_size = std::filesystem::file_size(path, ec);
+        if (ec || file_size < sizeof(SpirvCacheArchiveHeader))
+        {
+            return;
+        }
+#if defined(__linux__) || defined(__APPLE__)
+        int const fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+        {
+            return;
+        }
+        void * mapping = mmap(nullptr, static_cast<usize>(file_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            return;
+        }
+        mapped_data = static_cast<u8 const *>(mapping);
+#else
+        auto in_file = std::ifstream{path, std::ios::binary};
+        file_data.resize(static_cast<usize>(file_size));
+        if (!in_file.read(reinterpret_cast<char *>(file_data.data()), static_cast<std::streamsize>(file_size)))
+        {
+            file_data.clear();
+            return;
+        }
+        mapped_data = file_data.data();
+#endif
+        mapped_size = static_cast<usize>(file_size);
+
+        // Anything malformed or from another version is treated as an empty archive and replaced on the next flush.
+        auto header = SpirvCacheArchiveHeader{};
+        std::memcpy(&header, mapped_data, sizeof(header));
+        bool const valid =
+            header.magic_number == CACHE_FILE_MAGIC_NUMBER &&
+            header.version == CACHE_FILE_VERSION &&
+            header.index_offset >= sizeof(SpirvCacheArchiveHeader) &&
+            header.index_offset <= mapped_size &&
+            (header.index_offset % alignof(SpirvCacheArchiveIndexEntry)) == 0 &&
+            header.entry_count <= (mapped_size - header.index_offset) / sizeof(SpirvCacheArchiveIndexEntry);
+        if (!valid)
+        {
+            unmap();
+        }
+    }
 
-    struct ShaderCacheFileHeader
+    void SpirvCacheArchive::unmap()
     {
-        uint64_t magic_number;
-        uint64_t version;
-        uint64_t dependency_n;
-        uint64_t spirv_size;
-    };
+#if defined(__linux__) || defined(__APPLE__)
+        if (mapped_data != nullptr)
+        {
+            munmap(const_cast<u8 *>(mapped_data), mapped_size);
+        }
+#else
+        file_data = {};
+#endif
+        mapped_data = nullptr;
+        mapped_size = {};
+    }
+
+    auto SpirvCacheArchive::find(ShaderCacheKey const & key) const -> std::optional<std::span<u32 const>>
+    {
+        if (auto iter = new_entries.find(key); iter != new_entries.end())
+        {
+            return std::span<u32 const>{iter->second};
+        }
+        if (mapped_data == nullptr)
+        {
+            return std::nullopt;
+        }
+        auto header = SpirvCacheArchiveHeader{};
+        std::memcpy(&header, mapped_data, sizeof(header));
+        auto const index = std::span{
+            reinterpret_cast<SpirvCacheArchiveIndexEntry const *>(mapped_data + header.index_offset),
+            static_cast<usize>(header.entry_count),
+        };
+        auto iter = std::lower_bound(
+            index.begin(), index.end(), key,
+            [](SpirvCacheArchiveIndexEntry const & entry, ShaderCacheKey const & k)
+            { return entry.key < k; });
+        if (iter == index.end() || iter->key != key)
+        {
+            return std::nullopt;
+        }
+        if (iter->blob_offset > header.index_offset ||
+            iter->blob_size > header.index_offset - iter->blob_offset ||
+            (iter->blob_offset % sizeof(u32)) != 0 ||
+            (iter->blob_size % sizeof(u32)) != 0)
+        {
+            return std::nullopt;
+        }
+        return std::span{
+            reinterpret_cast<u32 const *>(mapped_data + iter->blob_offset),
+            static_cast<usize>(iter->blob_size / sizeof(u32)),
+        };
+    }
+
+    void SpirvCacheArchive::insert(ShaderCacheKey const & key, std::vector<u32> const & spirv)
+    {
+        new_entries[key] = spirv;
+        if (new_entries.size() >= FLUSH_BATCH_SIZE)
+        {
+            flush();
+        }
+    }
+
+    void SpirvCacheArchive::flush()
+    {
+        if (new_entries.empty())
+        {
+            return;
+        }
+        // Other processes may have written to the archive in the meantime, merge with the latest version.
+        map();
+        auto header = SpirvCacheArchiveHeader{};
+        auto old_index = std::span<SpirvCacheArchiveIndexEntry const>{};
+        if (mapped_data != nullptr)
+        {
+            std::memcpy(&header, mapped_data, sizeof(header));
+            old_index = std::span{
+                reinterpret_cast<SpirvCacheArchiveIndexEntry const *>(mapped_data + header.index_offset),
+                static_cast<usize>(header.entry_count),
+            };
+        }
 
-    void ImplPipelineManager::save_shader_cache(std::filesystem::path const & cache_folder, uint64_t shader_info_hash, std::vector<u32> const & spirv)
-    {
-        std::filesystem::create_directories(cache_folder);
-        auto out_file = std::ofstream{cache_folder / std::filesystem::path{std::to_string(shader_info_hash)}, std::ios::binary};
-        auto header = ShaderCacheFileHeader{};
-        header.magic_number = CACHE_FILE_MAGIC_NUMBER;
-        header.version = CACHE_FILE_VERSION;
-        header.dependency_n = current_observed_hotload_files->size();
-        header.spirv_size = spirv.size() * sizeof(u32);
-
-        out_file.write(reinterpret_cast<char const *>(&header), sizeof(header));
-        // TODO: Save more granular dependency info
-        for (auto const & [path, time_point] : *current_observed_hotload_files)
-        {
-            auto flags = uint64_t{};
-            auto path_string = path.string();
-            auto path_string_size = uint64_t{path_string.size()};
-            auto virtual_file_iter = virtual_files.find(path_string);
-            bool is_virtual_file = virtual_file_iter != virtual_files.end();
-            flags |= (is_virtual_file << 0);
-            auto time_since_epoch = time_point.time_since_epoch().count();
-            out_file.write(reinterpret_cast<char const *>(&flags), sizeof(flags));
-            out_file.write(reinterpret_cast<char const *>(&path_string_size), sizeof(path_string_size));
-            out_file.write(path_string.data(), path_string.size());
-            if (is_virtual_file)
-            {
-                auto const & virtual_file_contents = virtual_file_iter->second.contents;
-                auto virtual_file_size = uint64_t{virtual_file_contents.size()};
-                out_file.write(reinterpret_cast<char const *>(&virtual_file_size), sizeof(virtual_file_size));
-                out_file.write(virtual_file_contents.data(), virtual_file_contents.size());
+        auto merged = std::map<ShaderCacheKey, std::span<u32 const>>{};
+        for (auto const & entry : old_index)
+        {
+            if (auto blob = find(entry.key); blob.has_value())
+            {
+                merged[entry.key] = blob.value();
             }
-            else
+        }
+        for (auto const & [key, spirv] : new_entries)
+        {
+            merged[key] = std::span<u32 const>{spirv};
+        }
+
+        auto ec = std::error_code{};
+        std::filesystem::create_directories(path.parent_path(), ec);
+        auto tmp_path = path;
+        tmp_path += ".tmp" + std::to_string(std::random_device{}());
+        {
+            auto out_file = std::ofstream{tmp_path, std::ios::binary | std::ios::trunc};
+            if (!out_file.good())
             {
-                out_file.write(reinterpret_cast<char const *>(&time_since_epoch), sizeof(time_since_epoch));
+                return;
             }
+            auto index = std::vector<SpirvCacheArchiveIndexEntry>{};
+            index.reserve(merged.size());
+            u64 offset = sizeof(SpirvCacheArchiveHeader);
+            for (auto const & [key, spirv] : merged)
+            {
+                index.push_back({.key = key, .blob_offset = offset, .blob_size = spirv.size_bytes()});
+                offset += spirv.size_bytes();
+            }
+            u64 const padding = (alignof(SpirvCacheArchiveIndexEntry) - (offset % alignof(SpirvCacheArchiveIndexEntry))) % alignof(SpirvCacheArchiveIndexEntry);
+            auto const new_header = SpirvCacheArchiveHeader{
+                .magic_number = CACHE_FILE_MAGIC_NUMBER,
+                .version = CACHE_FILE_VERSION,
+                .entry_count = index.size(),
+                .index_offset = offset + padding,
+            };
+            out_file.write(reinterpret_cast<char const *>(&new_header), sizeof(new_header));
+            for (auto const & [key, spirv] : merged)
+            {
+                out_file.write(reinterpret_cast<char const *>(spirv.data()), static_cast<std::streamsize>(spirv.size_bytes()));
+            }
+            auto const zeros = std::array<char, alignof(SpirvCacheArchiveIndexEntry)>{};
+            out_file.write(zeros.data(), static_cast<std::streamsize>(padding));
+            out_file.write(reinterpret_cast<char const *>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(SpirvCacheArchiveIndexEntry)));
+        }
+        // The merged spans point into the mapping, which must stay alive until the file is written.
+        unmap();
+        std::filesystem::rename(tmp_path, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(tmp_path, ec);
         }
-        out_file.write(reinterpret_cast<char const *>(spirv.data()), header.spirv_size);
+        new_entries.clear();
+        map();
     }
 
-    auto ImplPipelineManager::try_load_shader_cache(std::filesystem::path const & cache_folder, uint64_t shader_info_hash) -> Result<std::vector<u32>>
+    auto ImplPipelineManager::hash_shader_info(ShaderCompileInfo const & shader_info, ShaderStage shader_stage) -> Result<ShaderCacheKey>
     {
-        auto in_file = std::ifstream{cache_folder / std::filesystem::path{std::to_string(shader_info_hash)}, std::ios::binary};
-        if (in_file.good())
+        auto const language = shader_info.compile_options.language.value_or(ShaderLanguage::GLSL);
+        auto hasher = Sha256{};
+        hash_compile_options(hasher, shader_info.compile_options, static_cast<u32>(shader_stage));
+
+        auto read_file = [&](std::filesystem::path const & full_path) -> std::optional<std::string>
         {
-            auto header = ShaderCacheFileHeader{};
-            in_file.read(reinterpret_cast<char *>(&header), sizeof(header));
-            if (header.magic_number != CACHE_FILE_MAGIC_NUMBER)
+            auto in_file = std::ifstream{full_path, std::ios::binary};
+            if (!in_file.good())
             {
-                return Result<std::vector<u32>>(std::string_view{"bad cache file"});
+                return std::nullopt;
             }
-            if (header.version != CACHE_FILE_VERSION)
+            auto ec = std::error_code{};
+            current_observed_hotload_files->insert({full_path, std::filesystem::last_write_time(full_path, ec)});
+            auto str = std::string{std::istreambuf_iterator<char>(in_file), std::istreambuf_iterator<char>()};
+            if (this->info.custom_preprocessor)
             {
-                return Result<std::vector<u32>>(std::string_view{"needs update"});
+                this->info.custom_preprocessor(str, full_path);
             }
+            return str;
+        };
 
-            for (uint64_t dep_i = 0; dep_i < header.dependency_n; ++dep_i)
+        // Walk the include graph. Only contents and the include names as written in the source enter the hash,
+        // so the key is independent of where the project is checked out.
+        struct PendingSource
+        {
+            std::string contents = {};
+            std::filesystem::path directory = {};
+        };
+        auto pending = std::vector<PendingSource>{};
+        auto visited = std::set<std::string>{};
+
+        if (auto const * shader_file = daxa::get_if<ShaderFile>(&shader_info.source))
+        {
+            auto const path_string = shader_file->path.string();
+            if (auto iter = virtual_files.find(path_string); iter != virtual_files.end())
+            {
+                current_observed_hotload_files->insert({path_string, std::chrono::file_clock::now()});
+                visited.insert(path_string);
+                pending.push_back({.contents = iter->second.contents});
+            }
+            else
             {
-                auto flags = uint64_t{};
-                auto path = std::filesystem::path{};
-                auto time_since_epoch = std::chrono::system_clock::rep{};
-                auto path_string = std::string{};
-                auto path_string_size = uint64_t{};
-                in_file.read(reinterpret_cast<char *>(&flags), sizeof(flags));
-                auto is_virtual_file = ((flags >> 0) & 1) != 0;
-                in_file.read(reinterpret_cast<char *>(&path_string_size), sizeof(path_string_size));
-                path_string.resize(path_string_size);
-                in_file.read(path_string.data(), path_string_size);
-                path = path_string;
-                if (is_virtual_file)
+                auto full_path = full_path_to_file(shader_file->path);
+                if (full_path.is_err())
                 {
-                    auto virtual_file_contents = std::string{};
-                    auto virtual_file_size = uint64_t{};
-
-                    in_file.read(reinterpret_cast<char *>(&virtual_file_size), sizeof(virtual_file_size));
-                    virtual_file_contents.resize(virtual_file_size);
-                    in_file.read(virtual_file_contents.data(), virtual_file_size);
+                    return Result<ShaderCacheKey>(full_path.message());
+                }
+                auto contents = read_file(full_path.value());
+                if (!contents.has_value())
+                {
+                    return Result<ShaderCacheKey>(std::string_view{"could not read shader file"});
+                }
+                visited.insert(full_path.value().string());
+                pending.push_back({.contents = std::move(contents.value()), .directory = full_path.value().parent_path()});
+            }
+        }
+        else
+        {
+            pending.push_back({.contents = daxa::get<ShaderCode>(shader_info.source).string});
+        }
 
-                    auto virtual_file_iter = virtual_files.find(path_string);
-                    if (virtual_file_iter == virtual_files.end())
-                    {
-                        return Result<std::vector<u32>>(std::string_view{"needs update"});
-                    }
-                    if (virtual_file_iter->second.contents != virtual_file_contents)
+        while (!pending.empty())
+        {
+            auto source = std::move(pending.back());
+            pending.pop_back();
+            hasher.update(source.contents);
+            auto const includes = find_include_directives(source.contents, language);
+            if (!includes.has_value())
+            {
+                return Result<ShaderCacheKey>(std::string_view{"shaders with macro includes are not cached"});
+            }
+            for (auto const & include : includes.value())
+            {
+                hasher.update(include.name);
+                if (auto iter = virtual_files.find(include.name); iter != virtual_files.end())
+                {
+                    if (visited.insert(include.name).second)
                     {
-                        return Result<std::vector<u32>>(std::string_view{"needs update"});
+                        current_observed_hotload_files->insert({include.name, std::chrono::file_clock::now()});
+                        pending.push_back({.contents = iter->second.contents});
                     }
+                    continue;
                 }
-                else
+                auto full_path = std::filesystem::path{};
+                auto ec = std::error_code{};
+                if (!include.is_system && !source.directory.empty() && std::filesystem::exists(source.directory / include.name, ec))
                 {
-                    in_file.read(reinterpret_cast<char *>(&time_since_epoch), sizeof(time_since_epoch));
-                    if (!std::filesystem::exists(path))
-                    {
-                        return Result<std::vector<u32>>(std::string_view{"needs update"});
-                    }
-                    auto write_time = std::filesystem::last_write_time(path);
-                    if (write_time.time_since_epoch().count() > time_since_epoch)
-                    {
-                        return Result<std::vector<u32>>(std::string_view{"needs update"});
-                    }
+                    full_path = std::filesystem::canonical(source.directory / include.name, ec);
+                }
+                else if (auto result = full_path_to_file(include.name); result.is_ok())
+                {
+                    full_path = result.value();
                 }
-                // NOTE(grundlett): Setting the time to now is fine, as we successfully handle
-                // any temporal changes above. This is a bus sus tho.
-                current_observed_hotload_files->insert({path, std::chrono::file_clock::now()});
+                if (full_path.empty())
+                {
+                    // Mostly directives in inactive preprocessor branches. The name is already part of the hash.
+                    hasher.update(std::string_view{"<unresolved>"});
+                    continue;
+                }
+                if (!visited.insert(full_path.string()).second)
+                {
+                    continue;
+                }
+                auto contents = read_file(full_path);
+                if (!contents.has_value())
+                {
+                    hasher.update(std::string_view{"<unreadable>"});
+                    continue;
+                }
+                pending.push_back({.contents = std::move(contents.value()), .directory = full_path.parent_path()});
+            }
+        }
+
+        // Slang gets all virtual files as translation units, so any of them can influence the result.
+        if (language == ShaderLanguage::SLANG)
+        {
+            for (auto const & [virtual_path, virtual_file] : virtual_files)
+            {
+                hasher.update(virtual_path);
+                hasher.update(virtual_file.contents);
+            }
+        }
+
+        return Result<ShaderCacheKey>(hasher.finalize());
+    }
+
+    auto ImplPipelineManager::hash_shader_variant(ShaderCompileInfo const & shader_info, ShaderStage shader_stage) -> ShaderCacheKey
+    {
+        auto hasher = Sha256{};
+        hash_compile_options(hasher, shader_info.compile_options, static_cast<u32>(shader_stage));
+        // Includes resolve differently with other root paths or preprocessors, even for identical sources.
+        hasher.update_value(static_cast<u64>(shader_info.compile_options.root_paths.size()));
+        for (auto const & root_path : shader_info.compile_options.root_paths)
+        {
+            hasher.update(root_path.string());
+        }
+        hasher.update_value(static_cast<u8>(static_cast<bool>(this->info.custom_preprocessor)));
+        hasher.update(std::string_view{this->info.custom_preprocessor.target_type().name()});
+        if (auto const * shader_file = daxa::get_if<ShaderFile>(&shader_info.source))
+        {
+            hasher.update_value(u8{0});
+            // Virtual files are found by name first, the same name on disk is only reached without one.
+            auto const path_string = shader_file->path.string();
+            if (virtual_files.contains(path_string))
+            {
+                hasher.update(path_string);
+            }
+            else if (auto full_path = full_path_to_file(shader_file->path); full_path.is_ok())
+            {
+                hasher.update(full_path.value().string());
+            }
+            else
+            {
+                hasher.update(path_string);
             }
+        }
+        else
+        {
+            hasher.update_value(u8{1});
+            hasher.update(daxa::get<ShaderCode>(shader_info.source).string);
+        }
+        return hasher.finalize();
+    }
 
-            auto spirv = std::vector<u32>{};
-            spirv.resize(header.spirv_size / sizeof(u32));
-            in_file.read(reinterpret_cast<char *>(spirv.data()), header.spirv_size);
-            return Result<std::vector<u32>>{spirv};
+    auto ImplPipelineManager::get_spirv_cache_archive(std::filesystem::path const & cache_folder) -> SpirvCacheArchive &
+    {
+        auto & archive = spirv_cache_archives[cache_folder];
+        if (archive == nullptr)
+        {
+            archive = std::make_unique<SpirvCacheArchive>(cache_folder / CACHE_FILE_NAME);
         }
-        return Result<std::vector<u32>>(std::string_view{"no cache found"});
+        return *archive;
+    }
+
+    auto ImplPipelineManager::try_load_shader_cache(std::filesystem::path const & cache_folder, ShaderCacheKey const & shader_info_hash) -> Result<std::vector<u32>>
+    {
+        auto blob = get_spirv_cache_archive(cache_folder).find(shader_info_hash);
+        if (!blob.has_value())
+        {
+            return Result<std::vector<u32>>(std::string_view{"no cache found"});
+        }
+        return Result<std::vector<u32>>(std::vector<u32>{blob.value().begin(), blob.value().end()});
+    }
+
+    void ImplPipelineManager::save_shader_cache(std::filesystem::path const & cache_folder, ShaderCacheKey const & shader_info_hash, std::vector<u32> const & spirv)
+    {
+        get_spirv_cache_archive(cache_folder).insert(shader_info_hash, spirv);
     }
 
     auto ImplPipelineManager::get_spirv(ShaderCompileInfo const & shader_info, std::string const & debug_name_opt, ShaderStage shader_stage) -> Result<std::vector<u32>>
@@ -1273,14 +1991,39 @@ namespace daxa
                 code = daxa::get<ShaderCode>(shader_info.source);
             }
 
-            // TODO: Test if this is slow, as it's not needed if there's no shader cache.
-            auto shader_info_hash = hash_shader_info(code.string, shader_info.compile_options, shader_stage);
+            // Specialization constants are not part of the key, so all specializations of a shader reuse one compilation.
+            auto const variant_key = hash_shader_variant(shader_info, shader_stage);
+            if (auto iter = spirv_variant_cache.find(variant_key); iter != spirv_variant_cache.end())
+            {
+                current_observed_hotload_files->insert(iter->second.observed_files.begin(), iter->second.observed_files.end());
+                current_shader_info = nullptr;
+                return Result<std::vector<u32>>(iter->second.spirv);
+            }
+            // Files are observed per shader, so that later users of the variant depend on all of them as well.
+            auto variant = ShaderVariant{};
+            auto * const pipeline_observed_files = current_observed_hotload_files;
+            current_observed_hotload_files = &variant.observed_files;
+            defer
+            {
+                pipeline_observed_files->insert(variant.observed_files.begin(), variant.observed_files.end());
+                current_observed_hotload_files = pipeline_observed_files;
+            };
+
+            // Only the spirv cache archives need the content hash, computing it reads all transitive includes.
+            auto shader_info_hash = std::optional<ShaderCacheKey>{};
             if (shader_info.compile_options.spirv_cache_folder.has_value())
             {
-                auto cache_ret = try_load_shader_cache(shader_info.compile_options.spirv_cache_folder.value(), shader_info_hash);
-                if (cache_ret.is_ok())
+                if (auto hash_ret = hash_shader_info(shader_info, shader_stage); hash_ret.is_ok())
                 {
-                    return cache_ret;
+                    shader_info_hash = hash_ret.value();
+                    auto cache_ret = try_load_shader_cache(shader_info.compile_options.spirv_cache_folder.value(), shader_info_hash.value());
+                    if (cache_ret.is_ok())
+                    {
+                        variant.spirv = cache_ret.value();
+                        spirv_variant_cache[variant_key] = variant;
+                        current_shader_info = nullptr;
+                        return cache_ret;
+                    }
                 }
             }
 
@@ -1311,9 +2054,11 @@ namespace daxa
             }
 
             spirv = ret.value();
-            if (shader_info.compile_options.spirv_cache_folder.has_value())
+            variant.spirv = spirv;
+            spirv_variant_cache[variant_key] = variant;
+            if (shader_info_hash.has_value())
             {
-                save_shader_cache(shader_info.compile_options.spirv_cache_folder.value(), shader_info_hash, spirv);
+                save_shader_cache(shader_info.compile_options.spirv_cache_folder.value(), shader_info_hash.value(), spirv);
             }
         }
         current_shader_info = nullptr;
@@ -19,6 +19,16 @@
 #include <spirv-tools/libspirv.hpp>
 #endif
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <optional>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace daxa
 {
     struct ImplDevice;
@@ -33,6 +43,79 @@ namespace daxa
 
     using VirtualFileSet = std::map<std::string, VirtualFileState>;
 
+    // Reverse include graph. Maps every file observed while compiling to the pipelines depending on it.
+    // A hot reload check stats each file once and only recompiles the dependents of changed files,
+    // instead of checking every include of every pipeline separately.
+    // Pipelines are identified by the address of their shared pipeline object, which is stable while they are registered.
+    struct ShaderDependencyGraph
+    {
+        struct Node
+        {
+            std::chrono::file_clock::time_point last_write_time = {};
+            std::unordered_set<void const *> dependents = {};
+        };
+        std::unordered_map<std::string, Node> nodes = {};
+
+        void add_dependent(void const * pipeline, ShaderFileTimeSet const & observed_files);
+        void remove_dependent(void const * pipeline, ShaderFileTimeSet const & observed_files);
+        auto collect_changed(VirtualFileSet const & virtual_files) -> std::unordered_set<void const *>;
+    };
+
+    // SHA-256 of the shader stage, all compile options that influence the generated code and the contents of the source and all of its (transitive) includes.
+    // Does not contain any paths or timestamps, so keys stay valid across machines and checkouts.
+    using ShaderCacheKey = std::array<u8, 32>;
+
+    // Content addressed spirv cache, stored in a single file that can be shipped with an application.
+    // The file contains a header, all spirv blobs and a key sorted index at the end.
+    // It is memory mapped for lookups. New entries are kept in memory until flush, which merges them with
+    // the entries currently on disk and atomically replaces the file.
+    // Flushed every FLUSH_BATCH_SIZE new entries, after each hot reload and on destruction of the pipeline manager.
+    // Shaders that include a macro (#include MY_HEADER) can not be keyed by their contents and are never stored.
+    struct SpirvCacheArchive
+    {
+        static constexpr usize FLUSH_BATCH_SIZE = 32;
+
+        std::filesystem::path path = {};
+        u8 const * mapped_data = nullptr;
+        usize mapped_size = {};
+        // Backing storage on platforms without mmap.
+        std::vector<u8> file_data = {};
+        std::map<ShaderCacheKey, std::vector<u32>> new_entries = {};
+
+        SpirvCacheArchive(std::filesystem::path a_path);
+        SpirvCacheArchive(SpirvCacheArchive const &) = delete;
+        auto operator=(SpirvCacheArchive const &) -> SpirvCacheArchive & = delete;
+        ~SpirvCacheArchive();
+
+        void map();
+        void unmap();
+        auto find(ShaderCacheKey const & key) const -> std::optional<std::span<u32 const>>;
+        void insert(ShaderCacheKey const & key, std::vector<u32> const & spirv);
+        void flush();
+    };
+
+    // Wakes up the background hot reload thread.
+    // On linux, the directories of all observed files are watched with inotify, so that the thread only
+    // stats files after something actually changed. When inotify is not available, wait simply sleeps for
+    // the given timeout and reports a possible change every time, which degrades to plain polling.
+    struct ShaderFileWatcher
+    {
+        int inotify_fd = -1;
+        int wake_fd = -1;
+        std::unordered_map<std::string, int> watched_directories = {};
+        std::mutex wake_mtx = {};
+        std::condition_variable wake_cv = {};
+        bool wake_requested = false;
+
+        void initialize();
+        void cleanup();
+        auto watches_files() const -> bool;
+        void watch_directory(std::filesystem::path const & directory);
+        // Returns true when files may have changed since the last call.
+        auto wait(std::chrono::milliseconds timeout) -> bool;
+        void wake();
+    };
+
     struct ImplPipelineManager final : ImplHandle
     {
         enum class ShaderStage
@@ -64,7 +147,6 @@ namespace daxa
         {
             std::shared_ptr<PipeT> pipeline_ptr;
             InfoT info;
-            std::chrono::file_clock::time_point last_hotload_time = {};
             ShaderFileTimeSet observed_hotload_files = {};
         };
 
@@ -75,6 +157,8 @@ namespace daxa
         std::vector<ComputePipelineState> compute_pipelines;
         std::vector<RasterPipelineState> raster_pipelines;
         std::vector<RayTracingPipelineState> ray_tracing_pipelines;
+        ShaderDependencyGraph dependency_graph = {};
+        std::chrono::file_clock::time_point last_hotload_time = {};
 
         // TODO(grundlett): Maybe make the pipeline compiler *internally* thread-safe!
         // This variable is accessed by the includer, which makes that not thread-safe
@@ -82,6 +166,42 @@ namespace daxa
         // PipelineManagers from as many threads as you'd like!
         ShaderCompileInfo const * current_shader_info = nullptr;
 
+        // Guards all of the state above. The background hot reload thread holds it while checking for changes and compiling.
+        mutable std::mutex mtx = {};
+
+        // Pipelines compiled by the background thread, waiting to be swapped in by reload_all.
+        // Has its own lock, so the sync point in reload_all never has to wait for a compilation to finish.
+        struct PendingReloads
+        {
+            std::vector<std::pair<std::shared_ptr<ComputePipeline>, ComputePipeline>> compute_pipelines = {};
+            std::vector<std::pair<std::shared_ptr<RasterPipeline>, RasterPipeline>> raster_pipelines = {};
+            std::vector<std::pair<std::shared_ptr<RayTracingPipeline>, RayTracingPipeline>> ray_tracing_pipelines = {};
+            std::vector<std::string> errors = {};
+        };
+        std::mutex pending_reloads_mtx = {};
+        PendingReloads pending_reloads = {};
+
+        // In memory spirv of the shaders compiled by this manager, keyed by hash_shader_variant.
+        // Lets pipelines that only differ in specialization constants share one compilation.
+        // The keys do not cover file contents, so the cache is cleared whenever a hot reload finds changed files or a virtual file is added.
+        // In between, it holds at most one entry per distinct shader source and compile options.
+        struct ShaderVariant
+        {
+            std::vector<u32> spirv = {};
+            // Added to the observed files of every pipeline using the variant, so they hot reload with it.
+            ShaderFileTimeSet observed_files = {};
+        };
+        std::map<ShaderCacheKey, ShaderVariant> spirv_variant_cache = {};
+
+        // One archive per used spirv_cache_folder.
+        std::map<std::filesystem::path, std::unique_ptr<SpirvCacheArchive>> spirv_cache_archives = {};
+
+        ShaderFileWatcher file_watcher = {};
+        std::thread background_thread = {};
+        std::atomic_bool background_thread_should_stop = false;
+        // Set when pipelines or virtual files are added, forces the background thread to refresh its watches and check all files.
+        std::atomic_bool background_force_check = false;
+
 #if DAXA_BUILT_WITH_UTILS_PIPELINE_MANAGER_GLSLANG
         struct GlslangBackend
         {
@@ -119,8 +239,18 @@ namespace daxa
         auto reload_all() -> PipelineReloadResult;
         auto all_pipelines_valid() const -> bool;
 
-        auto try_load_shader_cache(std::filesystem::path const & cache_folder, uint64_t shader_info_hash) -> Result<std::vector<u32>>;
-        void save_shader_cache(std::filesystem::path const & out_folder, uint64_t shader_info_hash, std::vector<u32> const & spirv);
+        void background_reload_loop();
+        void background_reload_changed_pipelines(bool watch_new_directories);
+        void recompile_changed_pipelines(PendingReloads & reloads);
+        auto apply_reloads(PendingReloads & reloads) -> PipelineReloadResult;
+        auto apply_pending_reloads() -> PipelineReloadResult;
+
+        auto hash_shader_info(ShaderCompileInfo const & shader_info, ShaderStage shader_stage) -> Result<ShaderCacheKey>;
+        // Key of the stage, compile options, root paths, custom preprocessor and the resolved source path or the code, without reading any files.
+        auto hash_shader_variant(ShaderCompileInfo const & shader_info, ShaderStage shader_stage) -> ShaderCacheKey;
+        auto get_spirv_cache_archive(std::filesystem::path const & cache_folder) -> SpirvCacheArchive &;
+        auto try_load_shader_cache(std::filesystem::path const & cache_folder, ShaderCacheKey const & shader_info_hash) -> Result<std::vector<u32>>;
+        void save_shader_cache(std::filesystem::path const & cache_folder, ShaderCacheKey const & shader_info_hash, std::vector<u32> const & spirv);
         auto full_path_to_file(std::filesystem::path const & path) -> Result<std::filesystem::path>;
         auto load_shader_source_from_file(std::filesystem::path const & path) -> Result<ShaderCode>;
 
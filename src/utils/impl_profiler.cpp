@@ -0,0 +1,229 @@
+#if DAXA_BUILT_WITH_UTILS_PROFILER
+
+#include <daxa/utils/profiler.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <utility>
+
+namespace daxa
+{
+    GpuProfiler::ScopedZone::ScopedZone(GpuProfiler & a_profiler, CommandRecorder & a_recorder, u32 a_zone)
+        : profiler{&a_profiler}, recorder{&a_recorder}, zone{a_zone}
+    {
+    }
+
+    GpuProfiler::ScopedZone::~ScopedZone()
+    {
+        this->profiler->end_zone(*this->recorder, this->zone);
+    }
+
+    GpuProfiler::GpuProfiler(GpuProfilerInfo a_info)
+        : m_info{std::move(a_info)},
+          timestamp_period{static_cast<f64>(this->m_info.device.properties().limits.timestamp_period)}
+    {
+        DAXA_DBG_ASSERT_TRUE_M(this->m_info.frames_in_flight > 0, "frames_in_flight must be at least one");
+        this->frames.resize(this->m_info.frames_in_flight);
+        for (u32 i = 0; i < this->m_info.frames_in_flight; ++i)
+        {
+            this->frames[i].query_pool = this->m_info.device.create_timeline_query_pool({
+                .query_count = this->m_info.max_zones_per_frame * 2,
+                .name = this->m_info.name,
+            });
+            this->frames[i].zones.reserve(this->m_info.max_zones_per_frame);
+        }
+    }
+
+    GpuProfiler::~GpuProfiler() = default;
+
+    void GpuProfiler::begin_frame(CommandRecorder & recorder)
+    {
+        DAXA_DBG_ASSERT_TRUE_M(this->current_depth == 0, "all zones of a frame must be ended before the next frame begins");
+        this->resolve();
+        auto & frame = this->frames[this->frame_index % this->frames.size()];
+        if (frame.pending)
+        {
+            // The gpu did not finish the frame that used these queries, its results are lost.
+            this->m_dropped_frames += 1;
+        }
+        frame.zones.clear();
+        frame.frame_index = this->frame_index;
+        frame.pending = true;
+        recorder.reset_timestamps({
+            .query_pool = frame.query_pool,
+            .start_index = 0,
+            .count = frame.query_pool.info().query_count,
+        });
+        this->frame_index += 1;
+        this->current_depth = 0;
+    }
+
+    auto GpuProfiler::begin_zone(CommandRecorder & recorder, std::string_view name) -> u32
+    {
+        DAXA_DBG_ASSERT_TRUE_M(this->frame_index > 0, "begin_frame must be called before the first zone");
+        auto & frame = this->frames[(this->frame_index - 1) % this->frames.size()];
+        this->current_depth += 1;
+        if (frame.zones.size() >= this->m_info.max_zones_per_frame)
+        {
+            return std::numeric_limits<u32>::max();
+        }
+        auto statistics_index_iter = this->statistics_indices.find(std::string{name});
+        if (statistics_index_iter == this->statistics_indices.end())
+        {
+            statistics_index_iter = this->statistics_indices.emplace(std::string{name}, static_cast<u32>(this->zone_statistics.size())).first;
+            this->zone_statistics.push_back(GpuZoneStatistics{.name = std::string{name}});
+        }
+        u32 const zone = static_cast<u32>(frame.zones.size());
+        frame.zones.push_back(RecordedZone{
+            .statistics_index = statistics_index_iter->second,
+            .depth = this->current_depth - 1,
+        });
+        recorder.write_timestamp({
+            .query_pool = frame.query_pool,
+            .pipeline_stage = PipelineStageFlagBits::TOP_OF_PIPE,
+            .query_index = zone * 2,
+        });
+        return zone;
+    }
+
+    void GpuProfiler::end_zone(CommandRecorder & recorder, u32 zone)
+    {
+        DAXA_DBG_ASSERT_TRUE_M(this->current_depth > 0, "end_zone called without a matching begin_zone");
+        this->current_depth -= 1;
+        if (zone == std::numeric_limits<u32>::max())
+        {
+            return;
+        }
+        auto & frame = this->frames[(this->frame_index - 1) % this->frames.size()];
+        recorder.write_timestamp({
+            .query_pool = frame.query_pool,
+            .pipeline_stage = PipelineStageFlagBits::BOTTOM_OF_PIPE,
+            .query_index = zone * 2 + 1,
+        });
+    }
+
+    auto GpuProfiler::scoped_zone(CommandRecorder & recorder, std::string_view name) -> ScopedZone
+    {
+        return ScopedZone{*this, recorder, this->begin_zone(recorder, name)};
+    }
+
+    auto GpuProfiler::try_resolve(FrameQueries & frame) -> bool
+    {
+        if (frame.zones.empty())
+        {
+            return true;
+        }
+        // Results are pairs of timestamp and availability.
+        auto const results = frame.query_pool.get_query_results(0, static_cast<u32>(frame.zones.size() * 2));
+        for (usize i = 1; i < results.size(); i += 2)
+        {
+            if (results[i] == 0)
+            {
+                return false;
+            }
+        }
+        for (usize zone = 0; zone < frame.zones.size(); ++zone)
+        {
+            f64 const begin_ns = static_cast<f64>(results[zone * 4 + 0]) * this->timestamp_period;
+            f64 const end_ns = static_cast<f64>(results[zone * 4 + 2]) * this->timestamp_period;
+            f64 const duration_ns = std::max(end_ns - begin_ns, 0.0);
+            auto & statistics = this->zone_statistics[frame.zones[zone].statistics_index];
+            statistics.min_ns = statistics.sample_count == 0 ? duration_ns : std::min(statistics.min_ns, duration_ns);
+            statistics.max_ns = statistics.sample_count == 0 ? duration_ns : std::max(statistics.max_ns, duration_ns);
+            statistics.avg_ns = (statistics.avg_ns * static_cast<f64>(statistics.sample_count) + duration_ns) / static_cast<f64>(statistics.sample_count + 1);
+            statistics.last_ns = duration_ns;
+            statistics.sample_count += 1;
+            if (this->m_info.trace_capacity > 0)
+            {
+                if (this->trace.size() >= this->m_info.trace_capacity)
+                {
+                    this->trace.pop_front();
+                }
+                this->trace.push_back(GpuZoneEvent{
+                    .statistics_index = frame.zones[zone].statistics_index,
+                    .depth = frame.zones[zone].depth,
+                    .frame_index = frame.frame_index,
+                    .begin_ns = begin_ns,
+                    .end_ns = begin_ns + duration_ns,
+                });
+            }
+        }
+        return true;
+    }
+
+    void GpuProfiler::resolve()
+    {
+        // Resolve in submission order, so that the trace stays sorted.
+        for (u64 i = 0; i < this->frames.size(); ++i)
+        {
+            // The frame currently recorded is not submitted yet.
+            if (this->frame_index < this->frames.size() - i)
+            {
+                continue;
+            }
+            u64 const index = this->frame_index - this->frames.size() + i;
+            auto & frame = this->frames[index % this->frames.size()];
+            if (!frame.pending || index + 1 == this->frame_index)
+            {
+                continue;
+            }
+            if (!this->try_resolve(frame))
+            {
+                break;
+            }
+            frame.pending = false;
+        }
+    }
+
+    auto GpuProfiler::statistics() const -> std::vector<GpuZoneStatistics> const &
+    {
+        return this->zone_statistics;
+    }
+
+    void GpuProfiler::reset_statistics()
+    {
+        for (auto & statistics : this->zone_statistics)
+        {
+            statistics = GpuZoneStatistics{.name = std::move(statistics.name)};
+        }
+        this->trace.clear();
+        this->m_dropped_frames = 0;
+    }
+
+    auto GpuProfiler::dropped_frames() const -> u64
+    {
+        return this->m_dropped_frames;
+    }
+
+    auto GpuProfiler::write_trace(std::filesystem::path const & path) const -> bool
+    {
+        std::ofstream file{path};
+        if (!file.is_open())
+        {
+            return false;
+        }
+        f64 const origin_ns = this->trace.empty() ? 0.0 : this->trace.front().begin_ns;
+        file << "{\"traceEvents\":[\n";
+        for (usize i = 0; i < this->trace.size(); ++i)
+        {
+            auto const & event = this->trace[i];
+            // Chrome trace events are in microseconds.
+            file << "{\"name\":\"" << this->zone_statistics[event.statistics_index].name << "\""
+                 << ",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+                 << ",\"ts\":" << (event.begin_ns - origin_ns) / 1000.0
+                 << ",\"dur\":" << (event.end_ns - event.begin_ns) / 1000.0
+                 << ",\"args\":{\"frame\":" << event.frame_index << ",\"depth\":" << event.depth << "}}"
+                 << (i + 1 < this->trace.size() ? ",\n" : "\n");
+        }
+        file << "],\"displayTimeUnit\":\"ns\"}\n";
+        return file.good();
+    }
+
+    auto GpuProfiler::info() const -> GpuProfilerInfo const &
+    {
+        return this->m_info;
+    }
+} // namespace daxa
+
+#endif
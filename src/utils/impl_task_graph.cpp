@@ -384,7 +384,7 @@ namespace daxa
         case daxa::TaskBufferAccess::TRANSFER_WRITE: return std::string_view{"TRANSFER_WRITE"};
         case daxa::TaskBufferAccess::HOST_TRANSFER_READ: return std::string_view{"HOST_TRANSFER_READ"};
         case daxa::TaskBufferAccess::HOST_TRANSFER_WRITE: return std::string_view{"HOST_TRANSFER_WRITE"};
-        case daxa::TaskBufferAccess::ACCELERATION_STRUCTURE_BUILD_READ: return std::string_view{"HOST_TACCELERATION_STRUCTURE_BUILD_READRANSFER_WRITE"};
+        case daxa::TaskBufferAccess::ACCELERATION_STRUCTURE_BUILD_READ: return std::string_view{"ACCELERATION_STRUCTURE_BUILD_READ"};
         case daxa::TaskBufferAccess::ACCELERATION_STRUCTURE_BUILD_WRITE: return std::string_view{"ACCELERATION_STRUCTURE_BUILD_WRITE"};
         case daxa::TaskBufferAccess::ACCELERATION_STRUCTURE_BUILD_READ_WRITE: return std::string_view{"ACCELERATION_STRUCTURE_BUILD_READ_WRITE"};
         case daxa::TaskBufferAccess::MAX_ENUM: return std::string_view{"MAX_ENUM"};
@@ -1889,6 +1889,7 @@ namespace daxa
                             usize const barrier_index = this->barriers.size();
                             this->barriers.push_back(TaskBarrier{
                                 .image_id = {}, // {} signals that this is not an image barrier.
+                                .buffer_id = buffer_attach.translated_view,
                                 .src_access = task_buffer.latest_access,
                                 .dst_access = current_buffer_access,
                             });
@@ -2662,6 +2663,22 @@ namespace daxa
         // Check if barrier is image barrier or normal barrier (see TaskBarrier struct comments).
         if (barrier.image_id.is_empty())
         {
+            if (impl.info.use_buffer_memory_barriers && !barrier.buffer_id.is_empty())
+            {
+                auto const actual_ids = impl.get_actual_buffer_blas_tlas_generic(barrier.buffer_id, perm);
+                if (auto const * actual_buffers = std::get_if<std::span<BufferId const>>(&actual_ids))
+                {
+                    for (BufferId const buffer : *actual_buffers)
+                    {
+                        command_list.pipeline_buffer_barrier({
+                            .src_access = barrier.src_access,
+                            .dst_access = barrier.dst_access,
+                            .buffer_id = buffer,
+                        });
+                    }
+                    return;
+                }
+            }
             command_list.pipeline_barrier({
                 .src_access = barrier.src_access,
                 .dst_access = barrier.dst_access,
@@ -2737,11 +2754,32 @@ namespace daxa
                     .src_access = persistent_data.latest_access,
                     .dst_access = permutation.buffer_infos[task_buffer_index].first_access,
                 };
-                recorder.pipeline_barrier(mem_barrier_info);
-                if (impl.info.record_debug_information)
+                auto const * actual_buffers = std::get_if<std::vector<BufferId>>(&persistent_data.actual_ids);
+                if (impl.info.use_buffer_memory_barriers && actual_buffers != nullptr)
                 {
-                    fmt::format_to(std::back_inserter(out), "{}{}\n", indent, to_string(mem_barrier_info));
-                    print_separator_to(out, indent);
+                    for (BufferId const buffer : *actual_buffers)
+                    {
+                        BufferMemoryBarrierInfo const buffer_barrier_info{
+                            .src_access = mem_barrier_info.src_access,
+                            .dst_access = mem_barrier_info.dst_access,
+                            .buffer_id = buffer,
+                        };
+                        recorder.pipeline_buffer_barrier(buffer_barrier_info);
+                        if (impl.info.record_debug_information)
+                        {
+                            fmt::format_to(std::back_inserter(out), "{}{}\n", indent, to_string(buffer_barrier_info));
+                            print_separator_to(out, indent);
+                        }
+                    }
+                }
+                else
+                {
+                    recorder.pipeline_barrier(mem_barrier_info);
+                    if (impl.info.record_debug_information)
+                    {
+                        fmt::format_to(std::back_inserter(out), "{}{}\n", indent, to_string(mem_barrier_info));
+                        print_separator_to(out, indent);
+                    }
                 }
                 persistent_data.latest_access = {};
             }
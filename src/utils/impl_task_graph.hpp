@@ -100,6 +100,8 @@ namespace daxa
         // when this ID is invalid, this barrier is NOT an image memory barrier but just a memory barrier.
         // So when ID invalid => memory barrier, ID valid => image memory barrier.
         TaskImageView image_id = {};
+        // Buffer, blas or tlas the memory barrier synchronizes, used to record buffer memory barriers when enabled.
+        TaskGPUResourceView buffer_id = {};
         ImageMipArraySlice slice = {};
         ImageLayout layout_before = {};
         ImageLayout layout_after = {};
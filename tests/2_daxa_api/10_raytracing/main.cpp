@@ -1,10 +1,14 @@
+#include <cmath>
+#include <chrono>
 #include <iostream>
 #include <thread>
 #include <string>
 
 #include <daxa/daxa.hpp>
+#include <daxa/c/daxa.h>
 #include <daxa/utils/pipeline_manager.hpp>
 #include <daxa/utils/task_graph.hpp>
+#include <daxa/utils/mem.hpp>
 
 #include <0_common/window.hpp>
 #include <0_common/shared.hpp>
@@ -16,6 +20,519 @@
 
 namespace tests
 {
+    // Closest hit height reported by trace_blas_down for rays that hit nothing.
+    constexpr f32 TRACE_MISS_Z = -1000.0f;
+
+    // Traces one ray per xy straight down from z = 100 against a tlas holding only the given blas, with an identity transform.
+    // Returns the z of the closest hit of each ray, or TRACE_MISS_Z.
+    auto trace_blas_down(daxa::Device & device, daxa::BlasId blas, std::span<daxa_f32vec2 const> ray_xy) -> std::vector<f32>
+    {
+        auto instance_buffer = device.create_buffer({
+            .size = sizeof(daxa_BlasInstanceData),
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "trace instance buffer",
+        });
+        defer { device.destroy_buffer(instance_buffer); };
+        *device.buffer_host_address_as<daxa_BlasInstanceData>(instance_buffer).value() = daxa_BlasInstanceData{
+            .transform = {
+                {1, 0, 0, 0},
+                {0, 1, 0, 0},
+                {0, 0, 1, 0},
+            },
+            .instance_custom_index = 0,
+            .mask = 0xFF,
+            .instance_shader_binding_table_record_offset = 0,
+            .flags = DAXA_GEOMETRY_INSTANCE_FORCE_OPAQUE,
+            .blas_device_address = device.device_address(blas).value(),
+        };
+        auto instances = std::array{
+            daxa::TlasInstanceInfo{
+                .data = device.device_address(instance_buffer).value(),
+                .count = 1,
+                .is_data_array_of_pointers = false,
+                .flags = daxa::GeometryFlagBits::OPAQUE,
+            },
+        };
+        auto tlas_build_info = daxa::TlasBuildInfo{
+            .flags = daxa::AccelerationStructureBuildFlagBits::PREFER_FAST_TRACE,
+            .instances = instances,
+        };
+        auto const tlas_build_sizes = device.tlas_build_sizes(tlas_build_info);
+        auto tlas = device.create_tlas({.size = tlas_build_sizes.acceleration_structure_size, .name = "trace tlas"});
+        defer { device.destroy_tlas(tlas); };
+        u64 const scratch_alignment = device.properties().acceleration_structure_properties.value().min_acceleration_structure_scratch_offset_alignment;
+        auto scratch_buffer = device.create_buffer({
+            .size = tlas_build_sizes.build_scratch_size + scratch_alignment,
+            .name = "trace tlas scratch buffer",
+        });
+        defer { device.destroy_buffer(scratch_buffer); };
+        tlas_build_info.dst_tlas = tlas;
+        tlas_build_info.scratch_data = (device.device_address(scratch_buffer).value() + scratch_alignment - 1) / scratch_alignment * scratch_alignment;
+
+        auto ray_buffer = device.create_buffer({
+            .size = sizeof(daxa_f32vec2) * ray_xy.size(),
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "trace ray buffer",
+        });
+        defer { device.destroy_buffer(ray_buffer); };
+        std::memcpy(device.buffer_host_address_as<daxa_f32vec2>(ray_buffer).value(), ray_xy.data(), sizeof(daxa_f32vec2) * ray_xy.size());
+        auto hit_buffer = device.create_buffer({
+            .size = sizeof(f32) * ray_xy.size(),
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "trace hit buffer",
+        });
+        defer { device.destroy_buffer(hit_buffer); };
+
+        struct TracePush
+        {
+            daxa::TlasId tlas = {};
+            daxa::DeviceAddress ray_xy = {};
+            daxa::DeviceAddress hit_z = {};
+            u32 ray_count = {};
+            u32 pad = {};
+        };
+        daxa::PipelineManager pipeline_manager = daxa::PipelineManager({
+            .device = device,
+            .shader_compile_options = {
+                .root_paths = {DAXA_SHADER_INCLUDE_DIR},
+                .language = daxa::ShaderLanguage::GLSL,
+            },
+            .name = "trace pipeline manager",
+        });
+        pipeline_manager.add_virtual_file({
+            .name = "trace_blas_down.glsl",
+            .contents = R"glsl(
+                #extension GL_EXT_ray_query : require
+                #define DAXA_RAY_TRACING 1
+                #include <daxa/daxa.inl>
+                struct TracePush
+                {
+                    daxa_TlasId tlas;
+                    daxa_BufferPtr(daxa_f32vec2) ray_xy;
+                    daxa_RWBufferPtr(daxa_f32) hit_z;
+                    daxa_u32 ray_count;
+                    daxa_u32 pad;
+                };
+                DAXA_DECL_PUSH_CONSTANT(TracePush, push)
+                layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+                void main() {
+                    uint i = gl_GlobalInvocationID.x;
+                    if (i >= push.ray_count) {
+                        return;
+                    }
+                    rayQueryEXT ray_query;
+                    rayQueryInitializeEXT(
+                        ray_query, daxa_accelerationStructureEXT(push.tlas),
+                        gl_RayFlagsOpaqueEXT, 0xFF,
+                        vec3(deref_i(push.ray_xy, i), 100.0), 0.0, vec3(0.0, 0.0, -1.0), 1000.0);
+                    while (rayQueryProceedEXT(ray_query))
+                    {
+                    }
+                    float hit_z = -1000.0;
+                    if (rayQueryGetIntersectionTypeEXT(ray_query, true) == gl_RayQueryCommittedIntersectionTriangleEXT) {
+                        hit_z = 100.0 - rayQueryGetIntersectionTEXT(ray_query, true);
+                    }
+                    deref_i(push.hit_z, i) = hit_z;
+                }
+            )glsl",
+        });
+        auto pipeline = pipeline_manager.add_compute_pipeline({
+            .shader_info = {.source = daxa::ShaderFile{"trace_blas_down.glsl"}},
+            .push_constant_size = sizeof(TracePush),
+            .name = "trace pipeline",
+        }).value();
+
+        {
+            auto recorder = device.create_command_recorder({.name = "trace blas down"});
+            recorder.build_acceleration_structures({.tlas_build_infos = std::array{tlas_build_info}});
+            recorder.pipeline_barrier({
+                .src_access = daxa::AccessConsts::ACCELERATION_STRUCTURE_BUILD_WRITE,
+                .dst_access = daxa::AccessConsts::READ_WRITE,
+            });
+            recorder.set_pipeline(*pipeline);
+            recorder.push_constant(TracePush{
+                .tlas = tlas,
+                .ray_xy = device.device_address(ray_buffer).value(),
+                .hit_z = device.device_address(hit_buffer).value(),
+                .ray_count = static_cast<u32>(ray_xy.size()),
+            });
+            recorder.dispatch({(static_cast<u32>(ray_xy.size()) + 63) / 64, 1, 1});
+            device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+        }
+        device.wait_idle();
+        auto const * hit_z = device.buffer_host_address_as<f32>(hit_buffer).value();
+        return std::vector<f32>{hit_z, hit_z + ray_xy.size()};
+    }
+
+    void blas_compaction()
+    {
+        daxa::Instance instance = daxa::create_instance({});
+        daxa::Device device = instance.create_device_2(instance.choose_device(daxa::ImplicitFeatureFlagBits::BASIC_RAY_TRACING, {}));
+        u64 const scratch_alignment = device.properties().acceleration_structure_properties.value().min_acceleration_structure_scratch_offset_alignment;
+
+        // A grid of triangles shared by all blas.
+        constexpr u32 GRID_SIZE = 32;
+        constexpr u32 BLAS_COUNT = 64;
+        std::vector<daxa_f32vec3> vertices = {};
+        for (u32 y = 0; y <= GRID_SIZE; ++y)
+        {
+            for (u32 x = 0; x <= GRID_SIZE; ++x)
+            {
+                vertices.push_back(daxa_f32vec3{static_cast<f32>(x), static_cast<f32>(y), static_cast<f32>((x * y) % 3)});
+            }
+        }
+        auto vertex_buffer = device.create_buffer({
+            .size = sizeof(daxa_f32vec3) * vertices.size(),
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "compaction vertex buffer",
+        });
+        defer { device.destroy_buffer(vertex_buffer); };
+        std::memcpy(device.buffer_host_address_as<daxa_f32vec3>(vertex_buffer).value(), vertices.data(), sizeof(daxa_f32vec3) * vertices.size());
+        std::vector<u32> indices = {};
+        for (u32 y = 0; y < GRID_SIZE; ++y)
+        {
+            for (u32 x = 0; x < GRID_SIZE; ++x)
+            {
+                u32 const i = y * (GRID_SIZE + 1) + x;
+                indices.insert(indices.end(), {i, i + 1, i + GRID_SIZE + 1, i + 1, i + GRID_SIZE + 2, i + GRID_SIZE + 1});
+            }
+        }
+        auto index_buffer = device.create_buffer({
+            .size = sizeof(u32) * indices.size(),
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "compaction index buffer",
+        });
+        defer { device.destroy_buffer(index_buffer); };
+        std::memcpy(device.buffer_host_address_as<u32>(index_buffer).value(), indices.data(), sizeof(u32) * indices.size());
+
+        auto geometries = std::array{
+            daxa::BlasTriangleGeometryInfo{
+                .vertex_data = device.device_address(vertex_buffer).value(),
+                .max_vertex = static_cast<u32>(vertices.size() - 1),
+                .index_data = device.device_address(index_buffer).value(),
+                .count = static_cast<u32>(indices.size() / 3),
+            },
+        };
+        auto build_info = daxa::BlasBuildInfo{
+            .flags = daxa::AccelerationStructureBuildFlagBits::PREFER_FAST_TRACE | daxa::AccelerationStructureBuildFlagBits::ALLOW_COMPACTION,
+            .geometries = geometries,
+        };
+        auto const build_sizes = device.blas_build_sizes(build_info);
+        u64 const scratch_stride = (build_sizes.build_scratch_size + scratch_alignment - 1) / scratch_alignment * scratch_alignment;
+        auto scratch_buffer = device.create_buffer({
+            .size = scratch_stride * BLAS_COUNT + scratch_alignment,
+            .name = "compaction scratch buffer",
+        });
+        defer { device.destroy_buffer(scratch_buffer); };
+        u64 const scratch_address = (device.device_address(scratch_buffer).value() + scratch_alignment - 1) / scratch_alignment * scratch_alignment;
+
+        std::vector<daxa::BlasId> blas = {};
+        std::vector<daxa::BlasBuildInfo> build_infos = {};
+        // Rays through the inside of a few grid cells, all of them hit the grid.
+        std::vector<daxa_f32vec2> ray_xy = {};
+        for (u32 i = 0; i < GRID_SIZE; ++i)
+        {
+            ray_xy.push_back(daxa_f32vec2{static_cast<f32>(i) + 0.25f, static_cast<f32>((i * 7) % GRID_SIZE) + 0.5f});
+        }
+        for (u32 i = 0; i < BLAS_COUNT; ++i)
+        {
+            blas.push_back(device.create_blas({.size = build_sizes.acceleration_structure_size, .name = "compaction blas"}));
+            build_infos.push_back(build_info);
+            build_infos.back().dst_blas = blas.back();
+            build_infos.back().scratch_data = scratch_address + scratch_stride * i;
+        }
+
+        daxa::BlasCompactor compactor{daxa::BlasCompactorInfo{.device = device, .name = "blas compactor"}};
+        {
+            auto recorder = device.create_command_recorder({.name = "blas build"});
+            recorder.build_acceleration_structures({.blas_build_infos = build_infos});
+            if (compactor.record_size_queries(recorder, blas) != BLAS_COUNT)
+            {
+                std::cout << "failed test \"blas_compaction\": not all blas were queued" << std::endl;
+                exit(-1);
+            }
+            device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+        }
+        // Compacted sizes are read back without stalling, wait here only to make the test deterministic.
+        device.wait_idle();
+        auto const hits_before = trace_blas_down(device, blas.front(), ray_xy);
+        {
+            auto recorder = device.create_command_recorder({.name = "blas compaction"});
+            auto const compactions = compactor.record_compactions(recorder);
+            device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+            for (auto const & compaction : compactions)
+            {
+                std::replace(blas.begin(), blas.end(), compaction.old_blas, compaction.new_blas);
+            }
+        }
+        device.wait_idle();
+        device.collect_garbage();
+
+        auto const & statistics = compactor.statistics();
+        std::cout << "Compacted " << statistics.compacted_blas << " of " << BLAS_COUNT << " blas from " << statistics.bytes_before
+                  << " to " << statistics.bytes_after << " bytes" << std::endl;
+        if (compactor.pending_blas() != 0 || statistics.compacted_blas == 0 || statistics.bytes_after >= statistics.bytes_before)
+        {
+            std::cout << "failed test \"blas_compaction\": unexpected compaction state" << std::endl;
+            exit(-1);
+        }
+        // The compacted copy must contain the same geometry.
+        auto const hits_after = trace_blas_down(device, blas.front(), ray_xy);
+        for (usize i = 0; i < ray_xy.size(); ++i)
+        {
+            if (hits_before[i] == TRACE_MISS_Z || hits_after[i] != hits_before[i])
+            {
+                std::cout << "failed test \"blas_compaction\": ray " << i << " hit " << hits_after[i] << " after compaction, " << hits_before[i] << " before" << std::endl;
+                exit(-1);
+            }
+        }
+        for (auto const & id : blas)
+        {
+            device.destroy_blas(id);
+        }
+    }
+
+    void blas_build_scheduler()
+    {
+        daxa::Instance instance = daxa::create_instance({});
+        daxa::Device device = instance.create_device_2(instance.choose_device(daxa::ImplicitFeatureFlagBits::BASIC_RAY_TRACING, {}));
+
+        // Blas of different sizes, each built from a number of rows of a shared triangle grid.
+        constexpr u32 GRID_SIZE = 64;
+        constexpr u32 BLAS_COUNT = 1024;
+        std::vector<daxa_f32vec3> vertices = {};
+        for (u32 y = 0; y <= GRID_SIZE; ++y)
+        {
+            for (u32 x = 0; x <= GRID_SIZE; ++x)
+            {
+                vertices.push_back(daxa_f32vec3{static_cast<f32>(x), static_cast<f32>(y), static_cast<f32>((x + y) % 5)});
+            }
+        }
+        auto vertex_buffer = device.create_buffer({
+            .size = sizeof(daxa_f32vec3) * vertices.size(),
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "scheduler vertex buffer",
+        });
+        defer { device.destroy_buffer(vertex_buffer); };
+        std::memcpy(device.buffer_host_address_as<daxa_f32vec3>(vertex_buffer).value(), vertices.data(), sizeof(daxa_f32vec3) * vertices.size());
+        std::vector<u32> indices = {};
+        for (u32 y = 0; y < GRID_SIZE; ++y)
+        {
+            for (u32 x = 0; x < GRID_SIZE; ++x)
+            {
+                u32 const i = y * (GRID_SIZE + 1) + x;
+                indices.insert(indices.end(), {i, i + 1, i + GRID_SIZE + 1, i + 1, i + GRID_SIZE + 2, i + GRID_SIZE + 1});
+            }
+        }
+        auto index_buffer = device.create_buffer({
+            .size = sizeof(u32) * indices.size(),
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "scheduler index buffer",
+        });
+        defer { device.destroy_buffer(index_buffer); };
+        std::memcpy(device.buffer_host_address_as<u32>(index_buffer).value(), indices.data(), sizeof(u32) * indices.size());
+
+        daxa::BlasBuildScheduler scheduler{daxa::BlasBuildSchedulerInfo{
+            .device = device,
+            .scratch_capacity = 1ull << 20,
+            .build_budget_per_frame = 1ull << 22,
+            .name = "blas build scheduler",
+        }};
+        std::vector<daxa::BlasId> blas = {};
+        for (u32 i = 0; i < BLAS_COUNT; ++i)
+        {
+            auto geometries = std::array{
+                daxa::BlasTriangleGeometryInfo{
+                    .vertex_data = device.device_address(vertex_buffer).value(),
+                    .max_vertex = static_cast<u32>(vertices.size() - 1),
+                    .index_data = device.device_address(index_buffer).value(),
+                    .count = (i % GRID_SIZE + 1) * GRID_SIZE * 2,
+                },
+            };
+            blas.push_back(scheduler.enqueue({
+                .flags = daxa::AccelerationStructureBuildFlagBits::PREFER_FAST_TRACE,
+                .geometries = geometries,
+            }));
+        }
+
+        auto const start = std::chrono::steady_clock::now();
+        u32 frames = 0;
+        while (scheduler.queued_builds() > 0)
+        {
+            auto recorder = device.create_command_recorder({.name = "blas build frame"});
+            scheduler.record_builds(recorder);
+            device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+            frames += 1;
+        }
+        device.wait_idle();
+        f64 const seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+        device.collect_garbage();
+
+        auto const & statistics = scheduler.statistics();
+        std::cout << "Built " << statistics.built_blas << " blas (" << statistics.built_bytes << " bytes) in " << frames << " frames and "
+                  << statistics.batches << " batches, " << static_cast<f64>(statistics.built_blas) / seconds << " blas/s, scratch peak "
+                  << statistics.scratch_peak << " bytes, " << statistics.dedicated_scratch_builds << " dedicated scratch builds" << std::endl;
+        if (statistics.built_blas != BLAS_COUNT || statistics.scratch_peak > scheduler.info().scratch_capacity)
+        {
+            std::cout << "failed test \"blas_build_scheduler\": unexpected build state" << std::endl;
+            exit(-1);
+        }
+        for (auto const & id : blas)
+        {
+            device.destroy_blas(id);
+        }
+    }
+
+    void blas_refit()
+    {
+        daxa::Instance instance = daxa::create_instance({});
+        daxa::Device device = instance.create_device_2(instance.choose_device(daxa::ImplicitFeatureFlagBits::BASIC_RAY_TRACING, {}));
+
+        // A deforming grid, refit in place every iteration.
+        constexpr u32 GRID_SIZE = 256;
+        constexpr u32 ITERATIONS = 16;
+        u32 const vertex_count = (GRID_SIZE + 1) * (GRID_SIZE + 1);
+        auto vertex_buffer = device.create_buffer({
+            .size = sizeof(daxa_f32vec3) * vertex_count,
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "refit vertex buffer",
+        });
+        defer { device.destroy_buffer(vertex_buffer); };
+        auto * vertices = device.buffer_host_address_as<daxa_f32vec3>(vertex_buffer).value();
+        auto write_vertices = [&](f32 time)
+        {
+            for (u32 y = 0; y <= GRID_SIZE; ++y)
+            {
+                for (u32 x = 0; x <= GRID_SIZE; ++x)
+                {
+                    vertices[y * (GRID_SIZE + 1) + x] = daxa_f32vec3{static_cast<f32>(x), static_cast<f32>(y), std::sin(static_cast<f32>(x + y) * 0.1f + time)};
+                }
+            }
+        };
+        write_vertices(0.0f);
+        std::vector<u32> indices = {};
+        for (u32 y = 0; y < GRID_SIZE; ++y)
+        {
+            for (u32 x = 0; x < GRID_SIZE; ++x)
+            {
+                u32 const i = y * (GRID_SIZE + 1) + x;
+                indices.insert(indices.end(), {i, i + 1, i + GRID_SIZE + 1, i + 1, i + GRID_SIZE + 2, i + GRID_SIZE + 1});
+            }
+        }
+        auto index_buffer = device.create_buffer({
+            .size = sizeof(u32) * indices.size(),
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "refit index buffer",
+        });
+        defer { device.destroy_buffer(index_buffer); };
+        std::memcpy(device.buffer_host_address_as<u32>(index_buffer).value(), indices.data(), sizeof(u32) * indices.size());
+
+        auto geometries = std::array{
+            daxa::BlasTriangleGeometryInfo{
+                .vertex_data = device.device_address(vertex_buffer).value(),
+                .max_vertex = vertex_count - 1,
+                .index_data = device.device_address(index_buffer).value(),
+                .count = static_cast<u32>(indices.size() / 3),
+            },
+        };
+        auto build_info = daxa::BlasBuildInfo{
+            .flags = daxa::AccelerationStructureBuildFlagBits::PREFER_FAST_TRACE | daxa::AccelerationStructureBuildFlagBits::ALLOW_UPDATE,
+            .geometries = geometries,
+        };
+        auto const build_sizes = device.blas_build_sizes(build_info);
+        auto blas = device.create_blas({.size = build_sizes.acceleration_structure_size, .name = "refit blas"});
+        defer { device.destroy_blas(blas); };
+        build_info.dst_blas = blas;
+        u64 const scratch_alignment = device.properties().acceleration_structure_properties.value().min_acceleration_structure_scratch_offset_alignment;
+        auto scratch_buffer = device.create_buffer({
+            .size = std::max(build_sizes.build_scratch_size, build_sizes.update_scratch_size) + scratch_alignment,
+            .name = "refit scratch buffer",
+        });
+        defer { device.destroy_buffer(scratch_buffer); };
+        build_info.scratch_data = (device.device_address(scratch_buffer).value() + scratch_alignment - 1) / scratch_alignment * scratch_alignment;
+
+        auto timed_builds = [&](bool update) -> f64
+        {
+            auto const start = std::chrono::steady_clock::now();
+            for (u32 i = 0; i < ITERATIONS; ++i)
+            {
+                write_vertices(static_cast<f32>(i));
+                build_info.update = update && i > 0;
+                auto recorder = device.create_command_recorder({.name = "refit"});
+                recorder.build_acceleration_structures({.blas_build_infos = std::array{build_info}});
+                device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+                // The vertices are rewritten by the host next iteration.
+                device.wait_idle();
+            }
+            return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+        f64 const rebuild_ms = timed_builds(false);
+        f64 const refit_ms = timed_builds(true);
+        device.collect_garbage();
+        std::cout << "Blas of " << indices.size() / 3 << " triangles: " << ITERATIONS << " rebuilds took " << rebuild_ms << "ms, "
+                  << ITERATIONS << " refits took " << refit_ms << "ms (build scratch " << build_sizes.build_scratch_size
+                  << " bytes, update scratch " << build_sizes.update_scratch_size << " bytes)" << std::endl;
+
+        // The last refit moved the vertices to their final positions, rays must hit the interpolated heights of those.
+        // Each ray goes through the lower left triangle (i, i + 1, i + GRID_SIZE + 1) of a cell.
+        std::vector<daxa_f32vec2> ray_xy = {};
+        std::vector<f32> expected_z = {};
+        std::vector<f32> initial_z = {};
+        auto height = [&](u32 x, u32 y, f32 time)
+        { return std::sin(static_cast<f32>(x + y) * 0.1f + time); };
+        for (u32 i = 0; i < GRID_SIZE; i += 4)
+        {
+            u32 const x = i;
+            u32 const y = (i * 5) % GRID_SIZE;
+            constexpr f32 A = 0.25f;
+            constexpr f32 B = 0.5f;
+            ray_xy.push_back(daxa_f32vec2{static_cast<f32>(x) + A, static_cast<f32>(y) + B});
+            auto interpolate = [&](f32 time)
+            { return (1.0f - A - B) * height(x, y, time) + A * height(x + 1, y, time) + B * height(x, y + 1, time); };
+            expected_z.push_back(interpolate(static_cast<f32>(ITERATIONS - 1)));
+            initial_z.push_back(interpolate(0.0f));
+        }
+        auto const hit_z = trace_blas_down(device, blas, ray_xy);
+        u32 moved_rays = 0;
+        for (usize i = 0; i < ray_xy.size(); ++i)
+        {
+            if (std::abs(hit_z[i] - expected_z[i]) > 1e-3f)
+            {
+                std::cout << "failed test \"blas_refit\": ray " << i << " hit " << hit_z[i] << ", expected " << expected_z[i] << std::endl;
+                exit(-1);
+            }
+            moved_rays += std::abs(expected_z[i] - initial_z[i]) > 1e-2f ? 1u : 0u;
+        }
+        if (moved_rays == 0)
+        {
+            std::cout << "failed test \"blas_refit\": the refit did not move the traced triangles" << std::endl;
+            exit(-1);
+        }
+
+        // Updating a blas that was not built with ALLOW_UPDATE is rejected before anything is recorded.
+        {
+            daxa_CommandRecorder c_recorder = {};
+            daxa_CommandRecorderInfo const c_recorder_info = DAXA_DEFAULT_COMMAND_RECORDER_INFO;
+            if (daxa_dvc_create_command_recorder(device.get(), &c_recorder_info, &c_recorder) != DAXA_RESULT_SUCCESS)
+            {
+                std::cout << "failed test \"blas_refit\": could not create a command recorder" << std::endl;
+                exit(-1);
+            }
+            auto invalid_update_info = build_info;
+            invalid_update_info.flags = daxa::AccelerationStructureBuildFlagBits::PREFER_FAST_TRACE;
+            invalid_update_info.update = true;
+            auto const invalid_update_infos = std::array{invalid_update_info};
+            auto const invalid_build_info = daxa::BuildAccelerationStructuresInfo{.blas_build_infos = invalid_update_infos};
+            auto const result = daxa_cmd_build_acceleration_structures(c_recorder, reinterpret_cast<daxa_BuildAccelerationStucturesInfo const *>(&invalid_build_info));
+            daxa_destroy_command_recorder(c_recorder);
+            if (result != DAXA_RESULT_ERROR_ACCELERATION_STRUCTURE_UPDATE_WITHOUT_ALLOW_UPDATE)
+            {
+                std::cout << "failed test \"blas_refit\": update without ALLOW_UPDATE returned " << static_cast<i32>(result) << std::endl;
+                exit(-1);
+            }
+        }
+    }
+
     void ray_query_triangle()
     {
         struct Camera
@@ -772,7 +1289,9 @@ namespace tests
 
 auto main() -> int
 {
-    // TODO(Raytracing): Add acceleration structure updates.
+    tests::blas_compaction();
+    tests::blas_build_scheduler();
+    tests::blas_refit();
     tests::ray_query_triangle();
     return 0;
 }
@@ -211,6 +211,92 @@ namespace tests
         device.destroy_buffer(buffer);
     }
 
+    void exclusive_buffer_ownership_transfer()
+    {
+        daxa::Instance instance = daxa::create_instance({});
+        daxa::Device device = instance.create_device_2(instance.choose_device({}, {}));
+        if (device.queue_count(daxa::QueueFamily::TRANSFER) == 0)
+        {
+            std::cout << "Device has no async transfer queue, skipping exclusive buffer ownership transfer test.\n";
+            return;
+        }
+
+        auto sema = device.create_binary_semaphore({.name = "ownership transfer sema"});
+
+        constexpr daxa::u32 initial_value = 42u;
+        // Exclusive buffers are owned by one queue family at a time.
+        // Moving them to another family takes a release barrier on the old and an acquire barrier on the new family.
+        auto buffer = device.create_buffer({
+            .size = sizeof(daxa::u32) * 3,
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "exclusive buffer",
+            .sharing_mode = daxa::SharingMode::EXCLUSIVE,
+        });
+        *device.buffer_host_address_as<daxa::u32>(buffer).value() = initial_value;
+
+        {
+            auto rec = device.create_transfer_command_recorder({daxa::QueueFamily::TRANSFER});
+            rec.copy_buffer_to_buffer({
+                .src_buffer = buffer,
+                .dst_buffer = buffer,
+                .src_offset = sizeof(daxa::u32) * 0,
+                .dst_offset = sizeof(daxa::u32) * 1,
+                .size = sizeof(daxa::u32),
+            });
+            // Release: the dst access is ignored for the releasing queue.
+            rec.pipeline_buffer_barrier({
+                .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+                .buffer_id = buffer,
+                .src_queue_family = daxa::QueueFamily::TRANSFER,
+                .dst_queue_family = daxa::QueueFamily::MAIN,
+            });
+            auto commands = rec.complete_current_commands();
+            device.submit_commands({
+                .queue = daxa::QUEUE_TRANSFER_0,
+                .command_lists = std::array{commands},
+                .signal_binary_semaphores = std::array{sema},
+            });
+        }
+
+        {
+            auto rec = device.create_command_recorder({});
+            // Acquire: the src access is ignored for the acquiring queue.
+            rec.pipeline_buffer_barrier({
+                .dst_access = daxa::AccessConsts::TRANSFER_READ_WRITE,
+                .buffer_id = buffer,
+                .src_queue_family = daxa::QueueFamily::TRANSFER,
+                .dst_queue_family = daxa::QueueFamily::MAIN,
+            });
+            rec.copy_buffer_to_buffer({
+                .src_buffer = buffer,
+                .dst_buffer = buffer,
+                .src_offset = sizeof(daxa::u32) * 1,
+                .dst_offset = sizeof(daxa::u32) * 2,
+                .size = sizeof(daxa::u32),
+            });
+            rec.pipeline_buffer_barrier({
+                .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+                .dst_access = daxa::AccessConsts::HOST_READ,
+                .buffer_id = buffer,
+                .offset = sizeof(daxa::u32) * 2,
+                .size = sizeof(daxa::u32),
+            });
+            auto commands = rec.complete_current_commands();
+            device.submit_commands({
+                .wait_stages = daxa::PipelineStageFlagBits::TRANSFER,
+                .command_lists = std::array{commands},
+                .wait_binary_semaphores = std::array{sema},
+            });
+        }
+
+        device.queue_wait_idle(daxa::QUEUE_MAIN);
+
+        daxa::u32 result = device.buffer_host_address_as<daxa::u32>(buffer).value()[2];
+        DAXA_DBG_ASSERT_TRUE_M(result == initial_value, "ownership transfer resulted in incorrect final result!");
+
+        device.destroy_buffer(buffer);
+    }
+
     namespace mesh_shader_test
     {
 
@@ -409,6 +495,7 @@ auto main() -> int
 {
     tests::basics();
     tests::simple_submit_chain();
+    tests::exclusive_buffer_ownership_transfer();
     tests::mesh_shader_test::mesh_shader_tri();
     return 0;
 }
\ No newline at end of file
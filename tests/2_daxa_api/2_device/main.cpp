@@ -1,5 +1,9 @@
 #include <daxa/daxa.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 namespace tests
 {
@@ -165,6 +169,476 @@ namespace tests
             exit(-1);
         }
     }
+    void memory_report(daxa::Instance & instance)
+    {
+        try
+        {
+            auto device = instance.create_device_2(instance.choose_device({}, {}));
+            auto const before = device.memory_report();
+            auto test_buffer = device.create_buffer({.size = 1 << 20, .name = "memory report buffer"});
+            auto test_image = device.create_image(test_image_info);
+            auto test_memory_block = device.create_memory({.requirements = device.memory_requirements(test_buffer_info)});
+            auto const after = device.memory_report();
+
+            u64 device_local_usage = 0;
+            for (u32 heap = 0; heap < after.heap_count; ++heap)
+            {
+                std::cout << "heap " << heap << (after.heaps[heap].device_local ? " (device local)" : "") << ": " << after.heaps[heap].usage
+                          << " of " << after.heaps[heap].budget << " bytes used, " << after.heaps[heap].allocation_count << " allocations" << std::endl;
+                device_local_usage += after.heaps[heap].device_local ? after.heaps[heap].allocation_bytes : 0;
+            }
+            std::cout << "buffers: " << after.buffers.bytes << " bytes, images: " << after.images.bytes << " bytes, memory blocks: "
+                      << after.memory_blocks.bytes << " bytes, budget from driver: " << after.budget_from_driver << std::endl;
+            if (after.buffers.count != before.buffers.count + 1 || after.buffers.bytes < before.buffers.bytes + (1 << 20) ||
+                after.images.count != before.images.count + 1 || after.memory_blocks.count != before.memory_blocks.count + 1 ||
+                device_local_usage == 0)
+            {
+                std::cout << "failed test \"memory_report\": resources are missing in the report" << std::endl;
+                exit(-1);
+            }
+            auto const per_name = device.memory_report_per_name();
+            if (std::find_if(per_name.begin(), per_name.end(), [](auto const & entry)
+                             { return entry.name == "memory report buffer" && entry.count == 1; }) == per_name.end())
+            {
+                std::cout << "failed test \"memory_report\": buffer is missing in the per name report" << std::endl;
+                exit(-1);
+            }
+
+            device.destroy_image(test_image);
+            device.destroy_buffer(test_buffer);
+            test_memory_block = {};
+            // Zombies own their memory until they are collected.
+            device.wait_idle();
+            device.collect_garbage();
+            auto const collected = device.memory_report();
+            if (collected.buffers.count != before.buffers.count || collected.images.count != before.images.count ||
+                collected.memory_blocks.count != before.memory_blocks.count)
+            {
+                std::cout << "failed test \"memory_report\": destroyed resources are still reported" << std::endl;
+                exit(-1);
+            }
+        }
+        catch (std::runtime_error error)
+        {
+            std::cout << "failed test \"memory_report\": " << error.what() << std::endl;
+            exit(-1);
+        }
+    }
+    void defragmentation(daxa::Instance & instance)
+    {
+        try
+        {
+            auto device = instance.create_device_2(instance.choose_device({}, {}));
+            constexpr u32 BUFFER_COUNT = 256;
+            constexpr u32 BUFFER_SIZE = 1 << 16;
+            // Destroying every other buffer leaves holes the survivors can be moved into.
+            std::vector<daxa::BufferId> buffers = {};
+            for (u32 i = 0; i < BUFFER_COUNT; ++i)
+            {
+                buffers.push_back(device.create_buffer({.size = BUFFER_SIZE, .name = "defragmentation buffer"}));
+            }
+            {
+                auto recorder = device.create_command_recorder({});
+                for (u32 i = 0; i < BUFFER_COUNT; ++i)
+                {
+                    recorder.clear_buffer({.buffer = buffers[i], .offset = 0, .size = BUFFER_SIZE, .clear_value = i});
+                }
+                device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+            }
+            for (u32 i = 0; i < BUFFER_COUNT; i += 2)
+            {
+                device.destroy_buffer(buffers[i]);
+            }
+            device.wait_idle();
+            device.collect_garbage();
+            auto const before = device.memory_report();
+
+            device.begin_defragmentation({.max_moves_per_pass = 32});
+            while (device.defragmentation_statistics().active)
+            {
+                {
+                    auto recorder = device.create_command_recorder({});
+                    [[maybe_unused]] u32 const move_count = recorder.record_defragmentation_pass();
+                    device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+                }
+                device.wait_idle();
+                device.collect_garbage();
+            }
+            auto const statistics = device.defragmentation_statistics();
+            auto const after = device.memory_report();
+            std::cout << "defragmentation moved " << statistics.allocations_moved << " allocations (" << statistics.bytes_moved << " bytes) in "
+                      << statistics.passes << " passes, freed " << statistics.device_memory_blocks_freed << " blocks" << std::endl;
+            u64 before_block_bytes = 0;
+            u64 after_block_bytes = 0;
+            for (u32 heap = 0; heap < after.heap_count; ++heap)
+            {
+                before_block_bytes += before.heaps[heap].block_bytes;
+                after_block_bytes += after.heaps[heap].block_bytes;
+            }
+            if (after_block_bytes > before_block_bytes)
+            {
+                std::cout << "failed test \"defragmentation\": defragmentation allocated additional memory" << std::endl;
+                exit(-1);
+            }
+
+            // Moved buffers must keep their contents.
+            auto readback_buffer = device.create_buffer({
+                .size = (BUFFER_COUNT / 2) * sizeof(u32),
+                .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+                .name = "defragmentation readback buffer",
+            });
+            {
+                auto recorder = device.create_command_recorder({});
+                for (u32 i = 1; i < BUFFER_COUNT; i += 2)
+                {
+                    recorder.copy_buffer_to_buffer({
+                        .src_buffer = buffers[i],
+                        .dst_buffer = readback_buffer,
+                        .src_offset = BUFFER_SIZE - sizeof(u32),
+                        .dst_offset = (i / 2) * sizeof(u32),
+                        .size = sizeof(u32),
+                    });
+                }
+                device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+            }
+            device.wait_idle();
+            auto const * readback = device.buffer_host_address_as<u32>(readback_buffer).value();
+            for (u32 i = 1; i < BUFFER_COUNT; i += 2)
+            {
+                if (readback[i / 2] != i)
+                {
+                    std::cout << "failed test \"defragmentation\": buffer " << i << " lost its contents" << std::endl;
+                    exit(-1);
+                }
+            }
+            device.destroy_buffer(readback_buffer);
+            for (u32 i = 1; i < BUFFER_COUNT; i += 2)
+            {
+                device.destroy_buffer(buffers[i]);
+            }
+        }
+        catch (std::runtime_error error)
+        {
+            std::cout << "failed test \"defragmentation\": " << error.what() << std::endl;
+            exit(-1);
+        }
+    }
+    void defragmentation_pending_commands(daxa::Instance & instance)
+    {
+        try
+        {
+            auto device = instance.create_device_2(instance.choose_device({}, {}));
+            constexpr u32 BUFFER_COUNT = 64;
+            constexpr u32 BUFFER_SIZE = 1 << 16;
+            std::vector<daxa::BufferId> buffers = {};
+            for (u32 i = 0; i < BUFFER_COUNT; ++i)
+            {
+                buffers.push_back(device.create_buffer({.size = BUFFER_SIZE, .name = "defragmentation buffer"}));
+            }
+            {
+                auto recorder = device.create_command_recorder({});
+                for (u32 i = 0; i < BUFFER_COUNT; ++i)
+                {
+                    recorder.clear_buffer({.buffer = buffers[i], .offset = 0, .size = BUFFER_SIZE, .clear_value = i});
+                }
+                device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+            }
+            for (u32 i = 0; i < BUFFER_COUNT; i += 2)
+            {
+                device.destroy_buffer(buffers[i]);
+            }
+            device.wait_idle();
+            device.collect_garbage();
+            auto readback_buffer = device.create_buffer({
+                .size = (BUFFER_COUNT / 2) * sizeof(u32),
+                .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+                .name = "defragmentation readback buffer",
+            });
+
+            device.begin_defragmentation({.max_moves_per_pass = BUFFER_COUNT});
+            u32 move_count = 0;
+            {
+                auto recorder = device.create_command_recorder({});
+                move_count = recorder.record_defragmentation_pass();
+                device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+            }
+            device.wait_idle();
+            // Recorded while the buffers still use their old memory, submitted after the pass finished copying.
+            daxa::ExecutableCommandList pending_commands = {};
+            {
+                auto recorder = device.create_command_recorder({});
+                for (u32 i = 1; i < BUFFER_COUNT; i += 2)
+                {
+                    recorder.copy_buffer_to_buffer({
+                        .src_buffer = buffers[i],
+                        .dst_buffer = readback_buffer,
+                        .src_offset = BUFFER_SIZE - sizeof(u32),
+                        .dst_offset = (i / 2) * sizeof(u32),
+                        .size = sizeof(u32),
+                    });
+                }
+                pending_commands = recorder.complete_current_commands();
+            }
+            device.collect_garbage();
+            if (device.defragmentation_statistics().allocations_moved != 0)
+            {
+                std::cout << "failed test \"defragmentation_pending_commands\": pass finished while a completed command list was not submitted" << std::endl;
+                exit(-1);
+            }
+            device.submit_commands({.command_lists = std::array{pending_commands}});
+            // Switches the buffers to their new memory, the old memory is freed once the pending commands finished.
+            device.wait_idle();
+            device.collect_garbage();
+            if (move_count > 0 && device.defragmentation_statistics().allocations_moved == 0)
+            {
+                std::cout << "failed test \"defragmentation_pending_commands\": pass did not finish after the pending commands were submitted" << std::endl;
+                exit(-1);
+            }
+            device.wait_idle();
+            auto const * readback = device.buffer_host_address_as<u32>(readback_buffer).value();
+            for (u32 i = 1; i < BUFFER_COUNT; i += 2)
+            {
+                if (readback[i / 2] != i)
+                {
+                    std::cout << "failed test \"defragmentation_pending_commands\": buffer " << i << " read wrong contents" << std::endl;
+                    exit(-1);
+                }
+            }
+            device.end_defragmentation();
+            device.destroy_buffer(readback_buffer);
+            for (u32 i = 1; i < BUFFER_COUNT; i += 2)
+            {
+                device.destroy_buffer(buffers[i]);
+            }
+        }
+        catch (std::runtime_error error)
+        {
+            std::cout << "failed test \"defragmentation_pending_commands\": " << error.what() << std::endl;
+            exit(-1);
+        }
+    }
+    void defragmentation_held_commands(daxa::Instance & instance)
+    {
+        try
+        {
+            auto device = instance.create_device_2(instance.choose_device({}, {}));
+            constexpr u32 BUFFER_COUNT = 16;
+            constexpr u32 BUFFER_SIZE = 1 << 16;
+            std::vector<daxa::BufferId> buffers = {};
+            for (u32 i = 0; i < BUFFER_COUNT; ++i)
+            {
+                buffers.push_back(device.create_buffer({.size = BUFFER_SIZE, .name = "defragmentation buffer"}));
+            }
+            for (u32 i = 0; i < BUFFER_COUNT; i += 2)
+            {
+                device.destroy_buffer(buffers[i]);
+            }
+            device.wait_idle();
+            device.collect_garbage();
+
+            device.begin_defragmentation({.max_moves_per_pass = BUFFER_COUNT});
+            {
+                auto recorder = device.create_command_recorder({});
+                [[maybe_unused]] u32 const move_count = recorder.record_defragmentation_pass();
+                device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+            }
+            device.wait_idle();
+            // Never submitted, the pass can not switch to the moved buffers while it is alive.
+            daxa::ExecutableCommandList held_commands = {};
+            {
+                auto recorder = device.create_command_recorder({});
+                recorder.clear_buffer({.buffer = buffers[1], .offset = 0, .size = BUFFER_SIZE, .clear_value = 0});
+                held_commands = recorder.complete_current_commands();
+            }
+            auto const zombie_buffer = device.create_buffer({.size = BUFFER_SIZE, .name = "defragmentation zombie buffer"});
+            device.destroy_buffer(zombie_buffer);
+            u64 const buffer_count = device.memory_report().buffers.count;
+            // The pass is canceled after a bounded number of calls, the zombie cleanup resumes.
+            for (u32 i = 0; i < 16; ++i)
+            {
+                device.collect_garbage();
+            }
+            auto const statistics = device.defragmentation_statistics();
+            if (statistics.allocations_moved != 0)
+            {
+                std::cout << "failed test \"defragmentation_held_commands\": pass finished while a completed command list was held" << std::endl;
+                exit(-1);
+            }
+            if (device.memory_report().buffers.count != buffer_count - 1)
+            {
+                std::cout << "failed test \"defragmentation_held_commands\": zombie buffer was not destroyed while the command list was held" << std::endl;
+                exit(-1);
+            }
+            held_commands = {};
+            device.end_defragmentation();
+            for (u32 i = 1; i < BUFFER_COUNT; i += 2)
+            {
+                device.destroy_buffer(buffers[i]);
+            }
+        }
+        catch (std::runtime_error error)
+        {
+            std::cout << "failed test \"defragmentation_held_commands\": " << error.what() << std::endl;
+            exit(-1);
+        }
+    }
+    void memory_pools(daxa::Instance & instance)
+    {
+        try
+        {
+            auto device = instance.create_device_2(instance.choose_device({}, {}));
+            // Per frame scratch memory: a linear pool with a single block, used as a ring buffer.
+            auto scratch_pool = device.create_memory_pool({
+                .algorithm = daxa::MemoryPoolAlgorithm::LINEAR,
+                .block_size = 1 << 20,
+                .max_block_count = 1,
+                .name = "scratch pool",
+            });
+            std::vector<daxa::BufferId> scratch_buffers = {};
+            for (u32 i = 0; i < 8; ++i)
+            {
+                scratch_buffers.push_back(device.create_buffer_from_memory_pool({
+                    .buffer_info = {.size = 1 << 16, .name = "scratch buffer"},
+                    .memory_pool = scratch_pool,
+                }));
+            }
+            auto const scratch_statistics = scratch_pool.statistics();
+            if (scratch_statistics.block_count != 1 || scratch_statistics.allocation_count != 8 ||
+                scratch_statistics.allocation_bytes < 8 * (1 << 16))
+            {
+                std::cout << "failed test \"memory_pools\": scratch buffers are not allocated from the pool" << std::endl;
+                exit(-1);
+            }
+            for (auto const & buffer : scratch_buffers)
+            {
+                device.destroy_buffer(buffer);
+            }
+            device.wait_idle();
+            device.collect_garbage();
+            if (scratch_pool.statistics().allocation_count != 0)
+            {
+                std::cout << "failed test \"memory_pools\": destroyed buffers still occupy the pool" << std::endl;
+                exit(-1);
+            }
+
+            // Hot render targets get a higher residency priority.
+            auto render_target_pool = device.create_memory_pool({
+                .priority = 1.0f,
+                .name = "render target pool",
+            });
+            auto render_target = device.create_image_from_memory_pool({
+                .image_info = test_image_info,
+                .memory_pool = render_target_pool,
+            });
+            // Resources keep their pool alive.
+            render_target_pool = {};
+            device.destroy_image(render_target);
+            device.wait_idle();
+            device.collect_garbage();
+        }
+        catch (std::runtime_error error)
+        {
+            std::cout << "failed test \"memory_pools\": " << error.what() << std::endl;
+            exit(-1);
+        }
+    }
+    void creation_timings(daxa::Instance & instance)
+    {
+        try
+        {
+            for (u32 i = 0; i < 2; ++i)
+            {
+                auto device = instance.create_device_2(instance.choose_device({}, {}));
+                auto const timings = device.creation_timings();
+                u64 const phase_sum =
+                    timings.physical_device_query_ns +
+                    timings.vk_device_creation_ns +
+                    timings.allocator_creation_ns +
+                    timings.null_resource_creation_ns +
+                    timings.resource_table_creation_ns +
+                    timings.init_submit_ns;
+                if (timings.total_ns == 0 || phase_sum > timings.total_ns)
+                {
+                    std::cout << "failed test \"creation_timings\": phases do not add up to the total" << std::endl;
+                    exit(-1);
+                }
+                std::cout << "device creation took " << static_cast<f64>(timings.total_ns) / 1000000.0 << "ms" << std::endl;
+                // The device does not wait for its init commands, collect_garbage may run while they are in flight.
+                auto buffer = device.create_buffer({.size = 64, .name = "buffer"});
+                device.destroy_buffer(buffer);
+                device.collect_garbage();
+            }
+        }
+        catch (std::runtime_error error)
+        {
+            std::cout << "failed test \"creation_timings\": " << error.what() << std::endl;
+            exit(-1);
+        }
+    }
+    void parallel_destruction(daxa::Instance & instance)
+    {
+        try
+        {
+            auto device = instance.create_device_2(instance.choose_device({}, {}));
+            auto const before = device.memory_report();
+            u32 const thread_count = 8;
+            u32 const buffers_per_thread = 1'000;
+            u32 const rounds = 4;
+            std::chrono::nanoseconds destroy_time = {};
+            for (u32 round = 0; round < rounds; ++round)
+            {
+                std::vector<daxa::BufferId> buffers = {};
+                buffers.reserve(thread_count * buffers_per_thread);
+                for (u32 i = 0; i < thread_count * buffers_per_thread; ++i)
+                {
+                    buffers.push_back(device.create_buffer({.size = 64, .name = "parallel destruction buffer"}));
+                }
+
+                // Streaming threads destroy while the main thread keeps collecting garbage.
+                std::atomic_uint32_t finished_threads = {};
+                auto const begin = std::chrono::steady_clock::now();
+                std::vector<std::thread> threads = {};
+                for (u32 thread = 0; thread < thread_count; ++thread)
+                {
+                    threads.emplace_back([&, thread]()
+                    {
+                        for (u32 i = 0; i < buffers_per_thread; ++i)
+                        {
+                            device.destroy_buffer(buffers[thread * buffers_per_thread + i]);
+                        }
+                        finished_threads.fetch_add(1);
+                    });
+                }
+                while (finished_threads.load() < thread_count)
+                {
+                    device.collect_garbage();
+                }
+                for (auto & thread : threads)
+                {
+                    thread.join();
+                }
+                destroy_time += std::chrono::steady_clock::now() - begin;
+                device.collect_garbage();
+            }
+            auto const destroyed_buffers = static_cast<f64>(thread_count * buffers_per_thread * rounds);
+            auto const destroy_ms = static_cast<f64>(std::chrono::duration_cast<std::chrono::microseconds>(destroy_time).count()) / 1000.0;
+            std::cout << thread_count << " threads destroyed " << destroyed_buffers << " buffers in " << destroy_ms << "ms ("
+                      << destroyed_buffers / destroy_ms * 1000.0 << " buffers per second)" << std::endl;
+
+            device.wait_idle();
+            device.collect_garbage();
+            if (device.memory_report().buffers.count != before.buffers.count)
+            {
+                std::cout << "failed test \"parallel_destruction\": not all destroyed buffers were collected" << std::endl;
+                exit(-1);
+            }
+        }
+        catch (std::runtime_error error)
+        {
+            std::cout << "failed test \"parallel_destruction\": " << error.what() << std::endl;
+            exit(-1);
+        }
+    }
 } // namespace tests
 
 auto main() -> int
@@ -175,5 +649,12 @@ auto main() -> int
     tests::sro_creation(instance);
     tests::sro_aliased_suballocation(instance);
     tests::acceleration_structure_creation(instance);
+    tests::memory_report(instance);
+    tests::defragmentation(instance);
+    tests::defragmentation_pending_commands(instance);
+    tests::defragmentation_held_commands(instance);
+    tests::memory_pools(instance);
+    tests::creation_timings(instance);
+    tests::parallel_destruction(instance);
     std::cout << "completed all tests successfully!" << std::endl;
 }
@@ -1,4 +1,6 @@
 #include <daxa/daxa.hpp>
+#include <daxa/utils/profiler.hpp>
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <fmt/format.h>
@@ -323,6 +325,232 @@ namespace tests
         });
     }
 
+    void barrier_coalescing(App & app)
+    {
+        auto recorder = app.device.create_command_recorder({.name = "barrier_coalescing command list"});
+
+        constexpr u32 MIP_COUNT = 8;
+        constexpr u32 LAYER_COUNT = 4;
+        daxa::ImageId const image = app.device.create_image({
+            .size = {256, 256, 1},
+            .mip_level_count = MIP_COUNT,
+            .array_layer_count = LAYER_COUNT,
+            .usage = daxa::ImageUsageFlagBits::TRANSFER_DST | daxa::ImageUsageFlagBits::SHADER_SAMPLED,
+            .name = "barrier_coalescing image",
+        });
+
+        // More barriers than the old fixed size batch could hold. The memory barriers are merged into one,
+        // the per subresource transitions are coalesced into a single barrier covering the whole image.
+        auto const statistics_before = recorder.statistics();
+        for (u32 i = 0; i < 64; ++i)
+        {
+            recorder.pipeline_barrier({
+                .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+                .dst_access = daxa::AccessConsts::COMPUTE_SHADER_READ,
+            });
+        }
+        for (u32 layer = 0; layer < LAYER_COUNT; ++layer)
+        {
+            for (u32 mip = MIP_COUNT; mip > 0; --mip)
+            {
+                recorder.pipeline_barrier_image_transition({
+                    .dst_access = daxa::AccessConsts::TRANSFER_WRITE,
+                    .src_layout = daxa::ImageLayout::UNDEFINED,
+                    .dst_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+                    .image_slice = {.base_mip_level = mip - 1, .base_array_layer = layer},
+                    .image_id = image,
+                });
+            }
+        }
+        recorder.clear_image({
+            .dst_image_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+            .clear_value = std::array<f32, 4>{1.0f, 0.0f, 0.0f, 1.0f},
+            .dst_image = image,
+            .dst_slice = {.level_count = MIP_COUNT, .layer_count = LAYER_COUNT},
+        });
+        auto const & statistics = recorder.statistics();
+        auto const batches = statistics.pipeline_barrier_batches - statistics_before.pipeline_barrier_batches;
+        auto const memory_barriers = statistics.memory_barriers - statistics_before.memory_barriers;
+        auto const buffer_barriers = statistics.buffer_barriers - statistics_before.buffer_barriers;
+        auto const image_barriers = statistics.image_barriers - statistics_before.image_barriers;
+        if (batches != 1 || memory_barriers != 1 || buffer_barriers != 0 || image_barriers != 1)
+        {
+            std::cout << "failed test \"barrier_coalescing\": expected 1 batch with 1 memory and 1 image barrier, got "
+                      << batches << " batches, " << memory_barriers << " memory, " << buffer_barriers << " buffer and " << image_barriers << " image barriers" << std::endl;
+            exit(-1);
+        }
+        recorder.destroy_image_deferred(image);
+
+        auto executable_commands = recorder.complete_current_commands();
+        app.device.submit_commands({
+            .command_lists = std::array{executable_commands},
+        });
+        app.device.wait_idle();
+    }
+
+    void gpu_profiler(App & app)
+    {
+        static constexpr u32 FRAME_COUNT = 16;
+        daxa::GpuProfiler profiler{daxa::GpuProfilerInfo{
+            .device = app.device,
+            .frames_in_flight = 2,
+            .name = "gpu profiler",
+        }};
+        daxa::BufferId buffer = app.device.create_buffer({
+            .size = 1 << 24,
+            .name = "profiled buffer",
+        });
+
+        for (u32 frame = 0; frame < FRAME_COUNT; ++frame)
+        {
+            auto recorder = app.device.create_command_recorder({});
+            profiler.begin_frame(recorder);
+            {
+                auto frame_zone = profiler.scoped_zone(recorder, "frame");
+                {
+                    auto clear_zone = profiler.scoped_zone(recorder, "clear");
+                    recorder.clear_buffer({.buffer = buffer, .offset = 0, .size = 1 << 24, .clear_value = frame});
+                }
+                u32 const copy_zone = profiler.begin_zone(recorder, "copy");
+                recorder.pipeline_barrier({.src_access = daxa::AccessConsts::TRANSFER_WRITE, .dst_access = daxa::AccessConsts::TRANSFER_READ_WRITE});
+                recorder.copy_buffer_to_buffer({.src_buffer = buffer, .dst_buffer = buffer, .src_offset = 0, .dst_offset = 1 << 23, .size = 1 << 23});
+                profiler.end_zone(recorder, copy_zone);
+            }
+            app.device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+            // Keep at most one frame in flight.
+            app.device.wait_idle();
+            app.device.collect_garbage();
+        }
+        profiler.resolve();
+
+        auto const & statistics = profiler.statistics();
+        // The last frame is still considered in recording until the next begin_frame.
+        auto check = [&](std::string_view name)
+        {
+            auto iter = std::find_if(statistics.begin(), statistics.end(), [&](auto const & s)
+                                     { return s.name == name; });
+            if (iter == statistics.end() || iter->sample_count != FRAME_COUNT - 1 || iter->min_ns > iter->avg_ns || iter->avg_ns > iter->max_ns)
+            {
+                std::cout << "failed test \"gpu_profiler\": wrong statistics for zone " << name << std::endl;
+                exit(-1);
+            }
+            std::cout << "zone " << name << ": min " << iter->min_ns << "ns, avg " << iter->avg_ns << "ns, max " << iter->max_ns << "ns" << std::endl;
+        };
+        check("frame");
+        check("clear");
+        check("copy");
+        if (profiler.dropped_frames() != 0 || !profiler.write_trace("gpu_profiler_trace.json"))
+        {
+            std::cout << "failed test \"gpu_profiler\": dropped frames or trace not written" << std::endl;
+            exit(-1);
+        }
+        app.device.destroy_buffer(buffer);
+    }
+
+    void query_pools(App & app)
+    {
+        daxa::QueryPool occlusion_pool = app.device.create_query_pool({
+            .query_type = daxa::QueryType::OCCLUSION,
+            .query_count = 4,
+            .name = "occlusion query pool",
+        });
+        if (occlusion_pool.values_per_query() != 1)
+        {
+            std::cout << "failed test \"query_pools\": occlusion queries must have one value" << std::endl;
+            exit(-1);
+        }
+        // Value and availability for each query.
+        daxa::BufferId result_buffer = app.device.create_buffer({
+            .size = sizeof(u64) * 2 * 4,
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "query result buffer",
+        });
+
+        auto recorder = app.device.create_command_recorder({.name = "query_pools command list"});
+        recorder.reset_queries({.query_pool = occlusion_pool, .start_index = 0, .count = 4});
+        // No draws are recorded, so every query must report zero samples.
+        for (u32 i = 0; i < 4; ++i)
+        {
+            recorder.begin_query({.query_pool = occlusion_pool, .query_index = i});
+            recorder.end_query({.query_pool = occlusion_pool, .query_index = i});
+        }
+        recorder.copy_query_pool_results({
+            .query_pool = occlusion_pool,
+            .start_index = 0,
+            .count = 4,
+            .dst_buffer = result_buffer,
+            .wait = true,
+            .with_availability = true,
+        });
+        recorder.pipeline_barrier({.src_access = daxa::AccessConsts::TRANSFER_WRITE, .dst_access = daxa::AccessConsts::HOST_READ});
+        app.device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+        app.device.wait_idle();
+
+        auto const host_results = occlusion_pool.get_query_results(0, 4);
+        auto const * gpu_results = app.device.buffer_host_address_as<u64>(result_buffer).value();
+        for (u32 i = 0; i < 4; ++i)
+        {
+            if (host_results[i * 2] != 0 || host_results[i * 2 + 1] == 0 || gpu_results[i * 2] != 0 || gpu_results[i * 2 + 1] == 0)
+            {
+                std::cout << "failed test \"query_pools\": unexpected result for query " << i << std::endl;
+                exit(-1);
+            }
+        }
+
+        // Misaligned result copies and precise queries without the feature are rejected.
+        {
+            auto invalid_recorder = app.device.create_command_recorder({.name = "invalid query command list"});
+            bool misaligned_copy_rejected = false;
+            try
+            {
+                invalid_recorder.copy_query_pool_results({
+                    .query_pool = occlusion_pool,
+                    .start_index = 0,
+                    .count = 1,
+                    .dst_buffer = result_buffer,
+                    .dst_offset = sizeof(u32),
+                });
+            }
+            catch (std::runtime_error const &)
+            {
+                misaligned_copy_rejected = true;
+            }
+            bool const precise_supported = (app.device.properties().implicit_features & daxa::ImplicitFeatureFlagBits::PRECISE_OCCLUSION_QUERY) != daxa::ImplicitFeatureFlagBits::NONE;
+            bool precise_rejected = false;
+            try
+            {
+                invalid_recorder.begin_query({.query_pool = occlusion_pool, .query_index = 0, .precise = true});
+                invalid_recorder.end_query({.query_pool = occlusion_pool, .query_index = 0});
+            }
+            catch (std::runtime_error const &)
+            {
+                precise_rejected = true;
+            }
+            if (!misaligned_copy_rejected || precise_rejected == precise_supported)
+            {
+                std::cout << "failed test \"query_pools\": invalid query commands were not rejected" << std::endl;
+                exit(-1);
+            }
+        }
+
+        if (app.device.properties().implicit_features & daxa::ImplicitFeatureFlagBits::PIPELINE_STATISTICS_QUERY)
+        {
+            daxa::QueryPool statistics_pool = app.device.create_query_pool({
+                .query_type = daxa::QueryType::PIPELINE_STATISTICS,
+                .pipeline_statistics = daxa::PipelineStatisticFlagBits::VERTEX_SHADER_INVOCATIONS | daxa::PipelineStatisticFlagBits::FRAGMENT_SHADER_INVOCATIONS | daxa::PipelineStatisticFlagBits::COMPUTE_SHADER_INVOCATIONS,
+                .query_count = 1,
+                .name = "pipeline statistics query pool",
+            });
+            if (statistics_pool.values_per_query() != 3)
+            {
+                std::cout << "failed test \"query_pools\": pipeline statistics queries must have one value per statistic" << std::endl;
+                exit(-1);
+            }
+        }
+        app.device.destroy_buffer(result_buffer);
+        app.device.collect_garbage();
+    }
+
     void recreation(App & app)
     {
         std::chrono::time_point begin_time_point = std::chrono::high_resolution_clock::now();
@@ -627,6 +855,18 @@ auto main() -> int
         App app = {};
         tests::deferred_destruction(app);
     }
+    {
+        App app = {};
+        tests::barrier_coalescing(app);
+    }
+    {
+        App app = {};
+        tests::gpu_profiler(app);
+    }
+    {
+        App app = {};
+        tests::query_pools(app);
+    }
     {
         App app = {};
         tests::multiple_ecl(app);
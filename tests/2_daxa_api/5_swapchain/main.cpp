@@ -1,4 +1,6 @@
 #include <0_common/window.hpp>
+#include <algorithm>
+#include <iostream>
 #include <thread>
 
 namespace tests
@@ -140,10 +142,290 @@ namespace tests
             }
         }
     }
+
+    void headless()
+    {
+        daxa::Instance instance = daxa::create_instance({});
+        daxa::Device device = instance.create_device_2(instance.choose_device({}, {}));
+
+        // Same frame loop as clearcolor, without a window.
+        daxa::Swapchain swapchain = device.create_swapchain({
+            .native_window_platform = daxa::NativeWindowPlatform::HEADLESS,
+            .image_usage = daxa::ImageUsageFlagBits::TRANSFER_DST,
+            .max_allowed_frames_in_flight = 2,
+            .name = "swapchain (headless)",
+            .headless_extent = {64, 64},
+        });
+        if (!swapchain.presented_image().is_empty())
+        {
+            std::cout << "failed test \"headless\": presented image before the first present" << std::endl;
+            exit(-1);
+        }
+
+        auto readback_buffer = device.create_buffer({
+            .size = 64 * 64 * sizeof(u32),
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = "headless readback buffer",
+        });
+        std::vector<daxa::ImageId> acquired_images = {};
+        for (u32 frame = 0; frame < 16; ++frame)
+        {
+            auto swapchain_image = swapchain.acquire_next_image();
+            if (std::find(acquired_images.begin(), acquired_images.end(), swapchain_image) == acquired_images.end())
+            {
+                acquired_images.push_back(swapchain_image);
+            }
+            auto recorder = device.create_command_recorder({.name = "recorder (headless)"});
+            recorder.pipeline_barrier_image_transition({
+                .dst_access = daxa::AccessConsts::TRANSFER_WRITE,
+                .src_layout = daxa::ImageLayout::UNDEFINED,
+                .dst_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+                .image_id = swapchain_image,
+            });
+            recorder.clear_image({
+                .dst_image_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+                .clear_value = {std::array<f32, 4>{1, 0, 1, 1}},
+                .dst_image = swapchain_image,
+            });
+            recorder.pipeline_barrier_image_transition({
+                .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+                .src_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+                .dst_layout = daxa::ImageLayout::PRESENT_SRC,
+                .image_id = swapchain_image,
+            });
+            device.submit_commands({
+                .command_lists = std::array{recorder.complete_current_commands()},
+                .wait_binary_semaphores = std::array{swapchain.current_acquire_semaphore()},
+                .signal_binary_semaphores = std::array{swapchain.current_present_semaphore()},
+                .signal_timeline_semaphores = std::array{swapchain.current_timeline_pair()},
+            });
+            device.present_frame({
+                .wait_binary_semaphores = std::array{swapchain.current_present_semaphore()},
+                .swapchain = swapchain,
+            });
+            device.collect_garbage();
+        }
+        if (acquired_images.size() != 3)
+        {
+            std::cout << "failed test \"headless\": expected a ring of 3 images, got " << acquired_images.size() << std::endl;
+            exit(-1);
+        }
+
+        // The presented image stays untouched until it is acquired again.
+        auto presented_image = swapchain.presented_image();
+        {
+            auto recorder = device.create_command_recorder({.name = "readback recorder (headless)"});
+            recorder.pipeline_barrier_image_transition({
+                .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+                .dst_access = daxa::AccessConsts::TRANSFER_READ,
+                .src_layout = daxa::ImageLayout::PRESENT_SRC,
+                .dst_layout = daxa::ImageLayout::TRANSFER_SRC_OPTIMAL,
+                .image_id = presented_image,
+            });
+            recorder.copy_image_to_buffer({
+                .image = presented_image,
+                .image_layout = daxa::ImageLayout::TRANSFER_SRC_OPTIMAL,
+                .image_extent = {64, 64, 1},
+                .buffer = readback_buffer,
+            });
+            device.submit_commands({.command_lists = std::array{recorder.complete_current_commands()}});
+        }
+        device.wait_idle();
+        // Magenta has the same bytes in rgba and bgra.
+        auto const * pixels = device.buffer_host_address_as<u32>(readback_buffer).value();
+        for (u32 i = 0; i < 64 * 64; ++i)
+        {
+            if (pixels[i] != 0xFFFF00FF)
+            {
+                std::cout << "failed test \"headless\": presented image has the wrong contents" << std::endl;
+                exit(-1);
+            }
+        }
+        device.destroy_buffer(readback_buffer);
+        device.collect_garbage();
+    }
+
+    void frame_pacing()
+    {
+        daxa::Instance instance = daxa::create_instance({});
+        daxa::Device device = instance.create_device_2(instance.choose_device({}, {}));
+
+        daxa::Swapchain swapchain = device.create_swapchain({
+            .native_window_platform = daxa::NativeWindowPlatform::HEADLESS,
+            .image_usage = daxa::ImageUsageFlagBits::TRANSFER_DST,
+            .max_allowed_frames_in_flight = 2,
+            .name = "swapchain (frame pacing)",
+            .headless_extent = {256, 256},
+            .frame_pacing_mode = daxa::FramePacingMode::LOW_LATENCY,
+        });
+
+        u32 const frame_count = 32;
+        for (u32 frame = 0; frame < frame_count; ++frame)
+        {
+            swapchain.pace_frame();
+            auto swapchain_image = swapchain.acquire_next_image();
+            auto recorder = device.create_command_recorder({.name = "recorder (frame pacing)"});
+            recorder.pipeline_barrier_image_transition({
+                .dst_access = daxa::AccessConsts::TRANSFER_WRITE,
+                .src_layout = daxa::ImageLayout::UNDEFINED,
+                .dst_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+                .image_id = swapchain_image,
+            });
+            // Give the gpu some work, so that the frame time is measurable.
+            for (u32 clear = 0; clear < 16; ++clear)
+            {
+                recorder.clear_image({
+                    .dst_image_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+                    .clear_value = {std::array<f32, 4>{0, 0, static_cast<f32>(clear) / 16.0f, 1}},
+                    .dst_image = swapchain_image,
+                });
+            }
+            recorder.pipeline_barrier_image_transition({
+                .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+                .src_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+                .dst_layout = daxa::ImageLayout::PRESENT_SRC,
+                .image_id = swapchain_image,
+            });
+            device.submit_commands({
+                .command_lists = std::array{recorder.complete_current_commands()},
+                .wait_binary_semaphores = std::array{swapchain.current_acquire_semaphore()},
+                .signal_binary_semaphores = std::array{swapchain.current_present_semaphore()},
+                .signal_timeline_semaphores = std::array{swapchain.current_timeline_pair()},
+            });
+            device.present_frame({
+                .wait_binary_semaphores = std::array{swapchain.current_present_semaphore()},
+                .swapchain = swapchain,
+            });
+            device.collect_garbage();
+        }
+
+        auto const statistics = swapchain.frame_pacing_statistics();
+        std::cout << "frame pacing: acquire wait " << statistics.acquire_wait_ns
+                  << "ns, pacing wait " << statistics.pacing_wait_ns
+                  << "ns, pacing sleep " << statistics.pacing_sleep_ns
+                  << "ns, cpu frame " << statistics.cpu_frame_ns
+                  << "ns, gpu frame " << statistics.gpu_frame_ns << "ns" << std::endl;
+        if (statistics.frame_count != frame_count)
+        {
+            std::cout << "failed test \"frame_pacing\": expected " << frame_count << " frames, got " << statistics.frame_count << std::endl;
+            exit(-1);
+        }
+        if (statistics.cpu_frame_ns == 0)
+        {
+            std::cout << "failed test \"frame_pacing\": cpu frame time was not measured" << std::endl;
+            exit(-1);
+        }
+        if (statistics.gpu_frame_time_supported && statistics.gpu_frame_ns == 0)
+        {
+            std::cout << "failed test \"frame_pacing\": gpu frame time was not measured" << std::endl;
+            exit(-1);
+        }
+        // Headless swapchains have no presentation engine to wait for.
+        if (statistics.present_latency_supported)
+        {
+            std::cout << "failed test \"frame_pacing\": headless swapchain reports present latency support" << std::endl;
+            exit(-1);
+        }
+        device.wait_idle();
+        device.collect_garbage();
+    }
+
+    void present_latency()
+    {
+        struct App : AppWindow<App>
+        {
+            daxa::Instance daxa_ctx = daxa::create_instance({});
+            daxa::Device device = daxa_ctx.create_device_2(daxa_ctx.choose_device({}, {}));
+
+            daxa::Swapchain swapchain = device.create_swapchain({
+                .native_window = get_native_handle(),
+                .native_window_platform = get_native_platform(),
+                .present_mode = daxa::PresentMode::FIFO,
+                .image_usage = daxa::ImageUsageFlagBits::TRANSFER_DST,
+                .max_allowed_frames_in_flight = 2,
+                .name = "swapchain (present_latency)",
+                .frame_pacing_mode = daxa::FramePacingMode::LOW_LATENCY,
+            });
+
+            App() : AppWindow<App>(" (present_latency)") {}
+
+            void on_mouse_move(f32 /*unused*/, f32 /*unused*/) {}
+            void on_mouse_button(i32 /*unused*/, i32 /*unused*/) {}
+            void on_key(i32 /*unused*/, i32 /*unused*/) {}
+            void on_resize(u32 /*unused*/, u32 /*unused*/) {}
+        };
+        App app = {};
+
+        bool const has_present_wait = static_cast<bool>(app.device.properties().implicit_features & daxa::ImplicitFeatureFlagBits::PRESENT_WAIT);
+        u32 presented_frames = 0;
+        for (u32 frame = 0; frame < 32; ++frame)
+        {
+            glfwPollEvents();
+            app.swapchain.pace_frame();
+            auto swapchain_image = app.swapchain.acquire_next_image();
+            if (swapchain_image.is_empty())
+            {
+                continue;
+            }
+            auto recorder = app.device.create_command_recorder({.name = "recorder (present_latency)"});
+            recorder.pipeline_barrier_image_transition({
+                .dst_access = daxa::AccessConsts::TRANSFER_WRITE,
+                .src_layout = daxa::ImageLayout::UNDEFINED,
+                .dst_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+                .image_id = swapchain_image,
+            });
+            recorder.clear_image({
+                .dst_image_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+                .clear_value = {std::array<f32, 4>{0, 1, 0, 1}},
+                .dst_image = swapchain_image,
+            });
+            recorder.pipeline_barrier_image_transition({
+                .src_access = daxa::AccessConsts::TRANSFER_WRITE,
+                .src_layout = daxa::ImageLayout::TRANSFER_DST_OPTIMAL,
+                .dst_layout = daxa::ImageLayout::PRESENT_SRC,
+                .image_id = swapchain_image,
+            });
+            app.device.submit_commands({
+                .command_lists = std::array{recorder.complete_current_commands()},
+                .wait_binary_semaphores = std::array{app.swapchain.current_acquire_semaphore()},
+                .signal_binary_semaphores = std::array{app.swapchain.current_present_semaphore()},
+                .signal_timeline_semaphores = std::array{app.swapchain.current_timeline_pair()},
+            });
+            app.device.present_frame({
+                .wait_binary_semaphores = std::array{app.swapchain.current_present_semaphore()},
+                .swapchain = app.swapchain,
+            });
+            app.device.collect_garbage();
+            presented_frames += 1;
+        }
+
+        auto const statistics = app.swapchain.frame_pacing_statistics();
+        std::cout << "present latency: " << statistics.present_latency_ns << "ns over " << presented_frames << " frames" << std::endl;
+        if (statistics.present_latency_supported != has_present_wait)
+        {
+            std::cout << "failed test \"present_latency\": support does not match the PRESENT_WAIT implicit feature" << std::endl;
+            exit(-1);
+        }
+        if (!has_present_wait)
+        {
+            std::cout << "skipped test \"present_latency\": device does not support PRESENT_WAIT" << std::endl;
+        }
+        // pace_frame blocks on the previous present, so every presented frame after the first resolves one.
+        else if (presented_frames > 1 && statistics.present_latency_ns == 0)
+        {
+            std::cout << "failed test \"present_latency\": present latency was not measured" << std::endl;
+            exit(-1);
+        }
+        app.device.wait_idle();
+        app.device.collect_garbage();
+    }
 } // namespace tests
 
 auto main() -> int
 {
+    tests::headless();
+    tests::frame_pacing();
+    tests::present_latency();
     tests::simple_creation();
     tests::clearcolor();
 }
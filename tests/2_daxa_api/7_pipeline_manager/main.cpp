@@ -4,6 +4,7 @@ using namespace daxa::types;
 #include <daxa/utils/pipeline_manager.hpp>
 
 #include <iostream>
+#include <fstream>
 #include <thread>
 #include <chrono>
 
@@ -184,6 +185,696 @@ namespace tests
         return 0;
     }
 
+    auto specialization_constants(daxa::Device & device) -> i32
+    {
+        auto const folder = std::filesystem::temp_directory_path() / "daxa_specialization_constants";
+        std::filesystem::remove_all(folder);
+        std::filesystem::create_directories(folder);
+        auto write_shader = [&](std::string const & contents)
+        {
+            auto file = std::ofstream{folder / "specialized.glsl"};
+            file << contents;
+        };
+        write_shader(R"glsl(
+            #include <daxa/daxa.inl>
+            struct SpecializedPush
+            {
+                daxa_RWBufferPtr(daxa_f32) dst;
+            };
+            DAXA_DECL_PUSH_CONSTANT(SpecializedPush, push)
+            layout(constant_id = 0) const uint VARIANT = 0;
+            layout(constant_id = 1) const bool USE_FAST_PATH = false;
+            layout(constant_id = 2) const float SCALE = 1.0;
+
+            layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+            void main() {
+                float value = float(VARIANT) * SCALE;
+                if (USE_FAST_PATH) {
+                    value = -value;
+                }
+                deref_i(push.dst, VARIANT) = value;
+            }
+        )glsl");
+
+        daxa::PipelineManager pipeline_manager = daxa::PipelineManager({
+            .device = device,
+            .shader_compile_options = {
+                .root_paths = {DAXA_SHADER_INCLUDE_DIR, folder},
+                .language = daxa::ShaderLanguage::GLSL,
+            },
+            .name = APPNAME_PREFIX("pipeline_manager"),
+        });
+
+        static constexpr u32 VARIANT_COUNT = 32;
+        using Clock = std::chrono::steady_clock;
+        auto const t0 = Clock::now();
+        auto first_pipeline_duration = std::chrono::duration<float, std::milli>{};
+        auto pipelines = std::vector<std::shared_ptr<daxa::ComputePipeline>>{};
+        for (u32 i = 0; i < VARIANT_COUNT; ++i)
+        {
+            auto compilation_result = pipeline_manager.add_compute_pipeline({
+                .shader_info = {
+                    .source = daxa::ShaderFile{"specialized.glsl"},
+                    .specialization_constants = {
+                        daxa::SpecializationConstant::make(0, i),
+                        daxa::SpecializationConstant::make(1, (i % 2) == 0),
+                        daxa::SpecializationConstant::make(2, 0.5f * static_cast<f32>(i)),
+                    },
+                },
+                .push_constant_size = sizeof(daxa::DeviceAddress),
+                .name = APPNAME_PREFIX("specialized_compute_pipeline"),
+            });
+            if (compilation_result.is_err() || !compilation_result.value()->is_valid())
+            {
+                std::cerr << "Failed to create specialized compute_pipeline " << i << "!\n";
+                std::cerr << compilation_result.message() << std::endl;
+                return -1;
+            }
+            if (i == 0)
+            {
+                first_pipeline_duration = Clock::now() - t0;
+                // Only the first pipeline compiles the shader, all others only specialize the same spirv.
+                // Breaking the file without a reload check proves it, any further compilation would fail.
+                write_shader("this does not compile");
+            }
+            pipelines.push_back(compilation_result.value());
+        }
+        auto const remaining_duration = std::chrono::duration<float, std::milli>(Clock::now() - t0) - first_pipeline_duration;
+        std::cout << "First variant: " << first_pipeline_duration.count() << "ms, " << (VARIANT_COUNT - 1) << " further variants: " << remaining_duration.count() << "ms" << std::endl;
+
+        auto buffer = device.create_buffer({
+            .size = sizeof(f32) * VARIANT_COUNT,
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = APPNAME_PREFIX("specialization_constants_buffer"),
+        });
+        auto * values = device.buffer_host_address_as<f32>(buffer).value();
+        {
+            auto recorder = device.create_command_recorder({.name = APPNAME_PREFIX("specialization_constants_recorder")});
+            for (auto const & pipeline : pipelines)
+            {
+                recorder.set_pipeline(*pipeline);
+                recorder.push_constant(device.buffer_device_address(buffer).value());
+                recorder.dispatch({1, 1, 1});
+            }
+            auto executable_commands = recorder.complete_current_commands();
+            device.submit_commands({.command_lists = std::array{executable_commands}});
+        }
+        device.wait_idle();
+
+        for (u32 i = 0; i < VARIANT_COUNT; ++i)
+        {
+            // All used values are exactly representable, the products are exact.
+            auto const expected = static_cast<f32>(i) * 0.5f * static_cast<f32>(i) * ((i % 2) == 0 ? -1.0f : 1.0f);
+            if (values[i] != expected)
+            {
+                std::cerr << "Variant " << i << " wrote " << values[i] << ", expected " << expected << std::endl;
+                return -1;
+            }
+        }
+        device.destroy_buffer(buffer);
+        device.collect_garbage();
+        std::filesystem::remove_all(folder);
+
+        return 0;
+    }
+
+    auto spirv_cache_archive(daxa::Device & device) -> i32
+    {
+        auto const folder = std::filesystem::temp_directory_path() / "daxa_spirv_cache_archive";
+        std::filesystem::remove_all(folder);
+        std::filesystem::create_directories(folder);
+        auto write_file = [&](std::filesystem::path const & name, std::string const & contents)
+        {
+            auto file = std::ofstream{folder / name};
+            file << contents;
+        };
+        write_file("cached.glsl", R"glsl(
+            #include "cached_header.glsl"
+            layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+            void main() {
+                uint value = CACHED_VALUE;
+            }
+        )glsl");
+        write_file("cached_header.glsl", "#define CACHED_VALUE 1\n");
+
+        // Sources are read once for the cache key and once more by the compiler, so the number of
+        // preprocessed files tells cache hits from compilations.
+        auto compile = [&](u32 & preprocessed_file_count) -> i32
+        {
+            preprocessed_file_count = 0;
+            daxa::PipelineManager pipeline_manager = daxa::PipelineManager({
+                .device = device,
+                .shader_compile_options = {
+                    .root_paths = {folder},
+                    .spirv_cache_folder = folder / "cache",
+                    .language = daxa::ShaderLanguage::GLSL,
+                },
+                .custom_preprocessor = [&](std::string &, std::filesystem::path const &)
+                { ++preprocessed_file_count; },
+                .name = APPNAME_PREFIX("pipeline_manager"),
+            });
+            auto compilation_result = pipeline_manager.add_compute_pipeline({
+                .shader_info = {.source = daxa::ShaderFile{"cached.glsl"}},
+                .name = APPNAME_PREFIX("cached_compute_pipeline"),
+            });
+            if (compilation_result.is_err() || !compilation_result.value()->is_valid())
+            {
+                std::cerr << "Failed to create cached compute_pipeline!\n";
+                std::cerr << compilation_result.message() << std::endl;
+                return -1;
+            }
+            // Destroying the pipeline manager flushes the archive.
+            return 0;
+        };
+
+        u32 first_count = {};
+        if (compile(first_count) != 0)
+        {
+            return -1;
+        }
+        if (!std::filesystem::exists(folder / "cache" / "daxa_spirv_cache.bin"))
+        {
+            std::cerr << "The spirv cache archive was not written!" << std::endl;
+            return -1;
+        }
+        // A new pipeline manager reopens the archive and must find the shader without compiling it.
+        u32 cached_count = {};
+        if (compile(cached_count) != 0)
+        {
+            return -1;
+        }
+        if (cached_count >= first_count)
+        {
+            std::cerr << "Reopened spirv cache archive missed, " << cached_count << " preprocessed files, " << first_count << " when compiling" << std::endl;
+            return -1;
+        }
+        // Changing an included file changes the key, the shader has to be compiled again.
+        write_file("cached_header.glsl", "#define CACHED_VALUE 2\n");
+        u32 changed_count = {};
+        if (compile(changed_count) != 0)
+        {
+            return -1;
+        }
+        if (changed_count != first_count)
+        {
+            std::cerr << "Changed include did not invalidate the spirv cache, " << changed_count << " preprocessed files, " << first_count << " when compiling" << std::endl;
+            return -1;
+        }
+        std::filesystem::remove_all(folder);
+
+        return 0;
+    }
+
+    auto dependency_graph_perf(daxa::Device & device) -> i32
+    {
+        // Synthetic include tree: header i includes header (i - 1) / 2, shader j includes header j % HEADER_COUNT.
+        static constexpr u32 HEADER_COUNT = 200;
+        static constexpr u32 PIPELINE_COUNT = 1000;
+        auto const folder = std::filesystem::temp_directory_path() / "daxa_dependency_graph_perf";
+        std::filesystem::remove_all(folder);
+        std::filesystem::create_directories(folder);
+        auto write_header = [&](u32 i, u32 version)
+        {
+            auto file = std::ofstream{folder / ("header_" + std::to_string(i) + ".glsl"), std::ios::trunc};
+            file << "#pragma once\n";
+            if (i != 0)
+            {
+                file << "#include \"header_" << (i - 1) / 2 << ".glsl\"\n";
+            }
+            file << "#define HEADER_" << i << "_VERSION " << version << "\n";
+        };
+        for (u32 i = 0; i < HEADER_COUNT; ++i)
+        {
+            write_header(i, 0);
+        }
+        for (u32 i = 0; i < PIPELINE_COUNT; ++i)
+        {
+            auto file = std::ofstream{folder / ("shader_" + std::to_string(i) + ".glsl"), std::ios::trunc};
+            file << "#include \"header_" << i % HEADER_COUNT << ".glsl\"\n";
+            file << "layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;\n";
+            file << "void main() {}\n";
+        }
+
+        daxa::PipelineManager pipeline_manager = daxa::PipelineManager({
+            .device = device,
+            .shader_compile_options = {
+                .root_paths = {folder},
+                .language = daxa::ShaderLanguage::GLSL,
+            },
+            .name = APPNAME_PREFIX("pipeline_manager"),
+        });
+
+        using Clock = std::chrono::steady_clock;
+        auto const add_t0 = Clock::now();
+        auto pipelines = std::vector<std::shared_ptr<daxa::ComputePipeline>>{};
+        for (u32 i = 0; i < PIPELINE_COUNT; ++i)
+        {
+            auto compilation_result = pipeline_manager.add_compute_pipeline({
+                .shader_info = {.source = daxa::ShaderFile{"shader_" + std::to_string(i) + ".glsl"}},
+                .name = APPNAME_PREFIX("compute_pipeline"),
+            });
+            if (compilation_result.is_err())
+            {
+                std::cerr << "Failed to compile the compute_pipeline!\n";
+                std::cerr << compilation_result.message() << std::endl;
+                return -1;
+            }
+            pipelines.push_back(compilation_result.value());
+        }
+        std::cout << "Added " << PIPELINE_COUNT << " pipelines: " << std::chrono::duration<float, std::milli>(Clock::now() - add_t0).count() << "ms" << std::endl;
+
+        using namespace std::literals;
+        // reload_all only checks for changes every 250ms.
+        std::this_thread::sleep_for(300ms);
+        auto const poll_t0 = Clock::now();
+        auto reload_result = pipeline_manager.reload_all();
+        std::cout << "reload_all without changes: " << std::chrono::duration<float, std::milli>(Clock::now() - poll_t0).count() << "ms" << std::endl;
+        if (!daxa::holds_alternative<daxa::NoPipelineChanged>(reload_result))
+        {
+            std::cerr << "reload_all reported changes without any file being touched!" << std::endl;
+            return -1;
+        }
+
+        auto old_pipeline_objects = std::vector<daxa_ComputePipeline>{};
+        for (auto const & pipeline : pipelines)
+        {
+            old_pipeline_objects.push_back(pipeline->get());
+        }
+
+        // Leaf header, only PIPELINE_COUNT / HEADER_COUNT pipelines include it.
+        static constexpr u32 TOUCHED_HEADER = HEADER_COUNT - 1;
+        write_header(TOUCHED_HEADER, 1);
+        std::this_thread::sleep_for(300ms);
+        auto const reload_t0 = Clock::now();
+        reload_result = pipeline_manager.reload_all();
+        std::cout << "reload_all after touching one header: " << std::chrono::duration<float, std::milli>(Clock::now() - reload_t0).count() << "ms" << std::endl;
+        if (auto * reload_err = daxa::get_if<daxa::PipelineReloadError>(&reload_result))
+        {
+            std::cerr << reload_err->message << std::endl;
+            return -1;
+        }
+
+        for (u32 i = 0; i < PIPELINE_COUNT; ++i)
+        {
+            bool const should_reload = i % HEADER_COUNT == TOUCHED_HEADER;
+            bool const reloaded = pipelines[i]->get() != old_pipeline_objects[i];
+            if (should_reload != reloaded)
+            {
+                std::cerr << "Pipeline " << i << (should_reload ? " was not reloaded!" : " was reloaded without depending on the changed header!") << std::endl;
+                return -1;
+            }
+        }
+
+        std::filesystem::remove_all(folder);
+        return 0;
+    }
+
+    auto background_hot_reload(daxa::Device & device) -> i32
+    {
+        daxa::PipelineManager pipeline_manager = daxa::PipelineManager({
+            .device = device,
+            .shader_compile_options = {
+                .language = daxa::ShaderLanguage::GLSL,
+            },
+            .enable_background_hot_reload = true,
+            .name = APPNAME_PREFIX("pipeline_manager"),
+        });
+
+        auto const shader_source = std::string{R"glsl(
+            layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+            void main() {
+            }
+        )glsl"};
+        pipeline_manager.add_virtual_file({
+            .name = "background_file",
+            .contents = shader_source,
+        });
+
+        auto compilation_result = pipeline_manager.add_compute_pipeline({
+            .shader_info = {.source = daxa::ShaderFile{"background_file"}},
+            .name = APPNAME_PREFIX("compute_pipeline"),
+        });
+
+        if (compilation_result.is_err())
+        {
+            std::cerr << "Failed to compile the compute_pipeline!\n";
+            std::cerr << compilation_result.message() << std::endl;
+            return -1;
+        }
+
+        std::shared_ptr<daxa::ComputePipeline> const compute_pipeline = compilation_result.value();
+        auto const * const old_pipeline_object = compute_pipeline->get();
+
+        // Touching the file makes the background thread recompile the pipeline.
+        // reload_all never compiles in this mode, it only swaps in finished pipelines.
+        pipeline_manager.add_virtual_file({
+            .name = "background_file",
+            .contents = shader_source + "\n",
+        });
+
+        using Clock = std::chrono::steady_clock;
+        auto const t0 = Clock::now();
+        auto max_reload_all_duration = std::chrono::duration<float, std::milli>{};
+        while (true)
+        {
+            auto const reload_t0 = Clock::now();
+            auto reload_result = pipeline_manager.reload_all();
+            max_reload_all_duration = std::max(max_reload_all_duration, std::chrono::duration<float, std::milli>(Clock::now() - reload_t0));
+            if (auto * reload_err = daxa::get_if<daxa::PipelineReloadError>(&reload_result))
+            {
+                std::cerr << reload_err->message << std::endl;
+                return -1;
+            }
+            if (daxa::get_if<daxa::PipelineReloadSuccess>(&reload_result))
+            {
+                break;
+            }
+            if (Clock::now() - t0 > std::chrono::seconds{10})
+            {
+                std::cerr << "Background hot reload timed out!" << std::endl;
+                return -1;
+            }
+            using namespace std::literals;
+            std::this_thread::sleep_for(1ms);
+        }
+
+        if (compute_pipeline->get() == old_pipeline_object)
+        {
+            std::cerr << "Background hot reload did not replace the pipeline!" << std::endl;
+            return -1;
+        }
+        std::cout << "Longest reload_all: " << max_reload_all_duration.count() << "ms" << std::endl;
+
+        return 0;
+    }
+
+    auto bind_filtering_perf(daxa::Device & device) -> i32
+    {
+        daxa::PipelineManager pipeline_manager = daxa::PipelineManager({
+            .device = device,
+            .shader_compile_options = {
+                .language = daxa::ShaderLanguage::GLSL,
+            },
+            .name = APPNAME_PREFIX("pipeline_manager"),
+        });
+
+        pipeline_manager.add_virtual_file({
+            .name = "bind_filtering_file",
+            .contents = R"glsl(
+                layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+                void main() {
+                }
+            )glsl",
+        });
+
+        // a and b share a pipeline layout, c has a different push constant range and therefore layout.
+        std::array<std::shared_ptr<daxa::ComputePipeline>, 3> pipelines = {};
+        std::array<u32, 3> const push_constant_sizes = {0, 0, 8};
+        for (u32 i = 0; i < pipelines.size(); ++i)
+        {
+            auto compilation_result = pipeline_manager.add_compute_pipeline({
+                .shader_info = {
+                    .source = daxa::ShaderFile{"bind_filtering_file"},
+                    .compile_options = {.defines = {{"VARIANT", std::to_string(i)}}},
+                },
+                .push_constant_size = push_constant_sizes[i],
+                .name = APPNAME_PREFIX("compute_pipeline"),
+            });
+            if (compilation_result.is_err())
+            {
+                std::cerr << "Failed to compile the compute_pipeline!\n";
+                std::cerr << compilation_result.message() << std::endl;
+                return -1;
+            }
+            pipelines[i] = compilation_result.value();
+        }
+
+        // Typical pattern of small passes re-setting their pipeline before every dispatch.
+        std::array<u32, 6> const pattern = {0, 0, 1, 1, 2, 0};
+        constexpr u32 ITERATIONS = 100'000;
+
+        auto record_duration = std::chrono::duration<float, std::milli>{};
+        auto statistics = daxa::CommandRecorderStatistics{};
+        {
+            auto recorder = device.create_command_recorder({.name = APPNAME_PREFIX("bind_filtering_recorder")});
+            using Clock = std::chrono::steady_clock;
+            auto const t0 = Clock::now();
+            for (u32 iteration = 0; iteration < ITERATIONS; ++iteration)
+            {
+                for (u32 const pipeline_index : pattern)
+                {
+                    recorder.set_pipeline(*pipelines[pipeline_index]);
+                    recorder.dispatch({1, 1, 1});
+                }
+            }
+            record_duration = std::chrono::duration<float, std::milli>(Clock::now() - t0);
+            statistics = recorder.statistics();
+            auto executable_commands = recorder.complete_current_commands();
+            device.submit_commands({.command_lists = std::array{executable_commands}});
+        }
+        device.wait_idle();
+        device.collect_garbage();
+
+        // First iteration binds a, b, c, a. Later ones start with a still bound and only bind b, c, a.
+        // The descriptor set only needs a rebind when switching to or away from c.
+        u64 const expected_pipeline_binds = 4 + (ITERATIONS - 1) * 3;
+        u64 const expected_descriptor_set_binds = 3 + (ITERATIONS - 1) * 2;
+        u64 const set_pipeline_calls = ITERATIONS * pattern.size();
+        std::cout << "Recorded " << set_pipeline_calls << " pipeline sets in " << record_duration.count() << "ms. "
+                  << "Pipeline binds: " << statistics.pipeline_binds << " (elided " << statistics.elided_pipeline_binds << "), "
+                  << "descriptor set binds: " << statistics.descriptor_set_binds << " (elided " << statistics.elided_descriptor_set_binds << ")" << std::endl;
+        if (statistics.pipeline_binds != expected_pipeline_binds ||
+            statistics.pipeline_binds + statistics.elided_pipeline_binds != set_pipeline_calls ||
+            statistics.descriptor_set_binds != expected_descriptor_set_binds ||
+            statistics.descriptor_set_binds + statistics.elided_descriptor_set_binds != set_pipeline_calls)
+        {
+            std::cerr << "Unexpected bind statistics!" << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+
+    auto push_constant_shadowing(daxa::Device & device) -> i32
+    {
+        daxa::PipelineManager pipeline_manager = daxa::PipelineManager({
+            .device = device,
+            .shader_compile_options = {
+                .root_paths = {DAXA_SHADER_INCLUDE_DIR},
+                .language = daxa::ShaderLanguage::GLSL,
+            },
+            .name = APPNAME_PREFIX("pipeline_manager"),
+        });
+
+        pipeline_manager.add_virtual_file({
+            .name = "push_constant_shadowing_file",
+            .contents = R"glsl(
+                #include <daxa/daxa.inl>
+                struct ShadowingPush
+                {
+                    daxa_RWBufferPtr(daxa_u32) dst;
+                    daxa_u32 index;
+                    daxa_u32 pad;
+                    daxa_u32 values[28];
+                };
+                DAXA_DECL_PUSH_CONSTANT(ShadowingPush, push)
+                layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+                void main() {
+                    deref_i(push.dst, push.index) = push.values[push.index];
+                }
+            )glsl",
+        });
+
+        // Uses the full 128 bytes, so that a naive upload would always push all of them.
+        struct ShadowingPush
+        {
+            daxa::DeviceAddress dst = {};
+            u32 index = {};
+            u32 pad = {};
+            std::array<u32, 28> values = {};
+        };
+        static_assert(sizeof(ShadowingPush) == 128);
+
+        auto compilation_result = pipeline_manager.add_compute_pipeline({
+            .shader_info = {.source = daxa::ShaderFile{"push_constant_shadowing_file"}},
+            .push_constant_size = sizeof(ShadowingPush),
+            .name = APPNAME_PREFIX("compute_pipeline"),
+        });
+        if (compilation_result.is_err())
+        {
+            std::cerr << "Failed to compile the compute_pipeline!\n";
+            std::cerr << compilation_result.message() << std::endl;
+            return -1;
+        }
+        auto pipeline = compilation_result.value();
+
+        auto buffer = device.create_buffer({
+            .size = sizeof(u32) * 28,
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = APPNAME_PREFIX("push_constant_shadowing_buffer"),
+        });
+        auto push = ShadowingPush{.dst = device.buffer_device_address(buffer).value()};
+
+        auto statistics = daxa::CommandRecorderStatistics{};
+        {
+            auto recorder = device.create_command_recorder({.name = APPNAME_PREFIX("push_constant_shadowing_recorder")});
+            recorder.set_pipeline(*pipeline);
+            for (u32 i = 0; i < 28; ++i)
+            {
+                // Typical draw loop, pushing the whole struct with only a few fields changed.
+                push.index = i;
+                push.values[i] = i * 3 + 1;
+                recorder.push_constant(push);
+                // Pushing identical data again must not record anything.
+                recorder.push_constant(push);
+                recorder.dispatch({1, 1, 1});
+            }
+            statistics = recorder.statistics();
+            auto executable_commands = recorder.complete_current_commands();
+            device.submit_commands({.command_lists = std::array{executable_commands}});
+        }
+        device.wait_idle();
+
+        auto const * results = device.buffer_host_address_as<u32>(buffer).value();
+        for (u32 i = 0; i < 28; ++i)
+        {
+            if (results[i] != i * 3 + 1)
+            {
+                std::cerr << "Wrong push constant value " << results[i] << " at index " << i << std::endl;
+                return -1;
+            }
+        }
+        std::cout << "Push constant uploads: " << statistics.push_constant_uploads << ", bytes uploaded: " << statistics.push_constant_bytes_uploaded
+                  << ", elided pushes: " << statistics.elided_push_constants << std::endl;
+        // The first upload contains all bytes, later ones only the range from the index to the changed value.
+        if (statistics.push_constant_uploads != 28 ||
+            statistics.elided_push_constants < 28 ||
+            statistics.push_constant_bytes_uploaded >= 28 * sizeof(ShadowingPush))
+        {
+            std::cerr << "Unexpected push constant statistics!" << std::endl;
+            return -1;
+        }
+        device.destroy_buffer(buffer);
+        device.collect_garbage();
+        return 0;
+    }
+
+    auto dispatch_indirect_batch(daxa::Device & device) -> i32
+    {
+        daxa::PipelineManager pipeline_manager = daxa::PipelineManager({
+            .device = device,
+            .shader_compile_options = {
+                .root_paths = {DAXA_SHADER_INCLUDE_DIR},
+                .language = daxa::ShaderLanguage::GLSL,
+            },
+            .name = APPNAME_PREFIX("pipeline_manager"),
+        });
+
+        pipeline_manager.add_virtual_file({
+            .name = "dispatch_indirect_batch_file",
+            .contents = R"glsl(
+                #include <daxa/daxa.inl>
+                struct BatchPush
+                {
+                    daxa_RWBufferPtr(daxa_u32) counter;
+                };
+                DAXA_DECL_PUSH_CONSTANT(BatchPush, push)
+                layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+                void main() {
+                    atomicAdd(deref(push.counter), 1);
+                }
+            )glsl",
+        });
+
+        auto compilation_result = pipeline_manager.add_compute_pipeline({
+            .shader_info = {.source = daxa::ShaderFile{"dispatch_indirect_batch_file"}},
+            .push_constant_size = sizeof(daxa::DeviceAddress),
+            .name = APPNAME_PREFIX("compute_pipeline"),
+        });
+        if (compilation_result.is_err())
+        {
+            std::cerr << "Failed to compile the compute_pipeline!\n";
+            std::cerr << compilation_result.message() << std::endl;
+            return -1;
+        }
+        auto pipeline = compilation_result.value();
+
+        // Dispatch i launches i + 1 workgroups. Commands are padded to 16 bytes to exercise the stride.
+        constexpr u32 DISPATCH_COUNT = 64;
+        constexpr u32 STRIDE = sizeof(u32) * 4;
+        auto indirect_buffer = device.create_buffer({
+            .size = STRIDE * DISPATCH_COUNT,
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_SEQUENTIAL_WRITE,
+            .name = APPNAME_PREFIX("indirect_buffer"),
+        });
+        auto * commands = device.buffer_host_address_as<std::array<u32, 4>>(indirect_buffer).value();
+        for (u32 i = 0; i < DISPATCH_COUNT; ++i)
+        {
+            commands[i] = {i + 1, 1, 1, 0};
+        }
+        auto counter_buffer = device.create_buffer({
+            .size = sizeof(u32) * 2,
+            .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+            .name = APPNAME_PREFIX("counter_buffer"),
+        });
+        auto * counters = device.buffer_host_address_as<u32>(counter_buffer).value();
+        counters[0] = 0;
+        counters[1] = 0;
+
+        {
+            auto recorder = device.create_command_recorder({.name = APPNAME_PREFIX("dispatch_indirect_batch_recorder")});
+            recorder.set_pipeline(*pipeline);
+            for (u32 chained = 0; chained < 2; ++chained)
+            {
+                recorder.push_constant(device.buffer_device_address(counter_buffer).value() + sizeof(u32) * chained);
+                recorder.dispatch_indirect_batch({
+                    .indirect_buffer = indirect_buffer,
+                    .dispatch_count = DISPATCH_COUNT,
+                    .stride = STRIDE,
+                    .chained = chained != 0,
+                });
+            }
+            auto executable_commands = recorder.complete_current_commands();
+            device.submit_commands({.command_lists = std::array{executable_commands}});
+        }
+        device.wait_idle();
+
+        // Batches reaching past the indirect buffer and strides below the command size are rejected.
+        for (auto const & invalid_info : std::array{
+                 daxa::DispatchIndirectBatchInfo{.indirect_buffer = indirect_buffer, .offset = STRIDE, .dispatch_count = DISPATCH_COUNT, .stride = STRIDE},
+                 daxa::DispatchIndirectBatchInfo{.indirect_buffer = indirect_buffer, .dispatch_count = DISPATCH_COUNT, .stride = sizeof(u32) * 2},
+                 daxa::DispatchIndirectBatchInfo{.indirect_buffer = indirect_buffer, .dispatch_count = DISPATCH_COUNT, .stride = sizeof(u32) * 3 + 2},
+             })
+        {
+            auto recorder = device.create_command_recorder({.name = APPNAME_PREFIX("invalid_dispatch_indirect_batch_recorder")});
+            recorder.set_pipeline(*pipeline);
+            bool rejected = false;
+            try
+            {
+                recorder.dispatch_indirect_batch(invalid_info);
+            }
+            catch (std::runtime_error const &)
+            {
+                rejected = true;
+            }
+            if (!rejected)
+            {
+                std::cerr << "Invalid indirect dispatch batch with offset " << invalid_info.offset << " and stride " << invalid_info.stride << " was not rejected" << std::endl;
+                return -1;
+            }
+        }
+
+        u32 const expected = DISPATCH_COUNT * (DISPATCH_COUNT + 1) / 2;
+        if (counters[0] != expected || counters[1] != expected)
+        {
+            std::cerr << "Unexpected workgroup counts " << counters[0] << " and " << counters[1] << ", expected " << expected << std::endl;
+            return -1;
+        }
+        device.destroy_buffer(indirect_buffer);
+        device.destroy_buffer(counter_buffer);
+        device.collect_garbage();
+        return 0;
+    }
+
     auto tesselation_shaders(daxa::Device & device) -> i32
     {
         daxa::PipelineManager pipeline_manager = daxa::PipelineManager({
@@ -287,6 +978,34 @@ auto main() -> int
     {
         return ret;
     }
+    if (ret = tests::specialization_constants(device); ret != 0)
+    {
+        return ret;
+    }
+    if (ret = tests::spirv_cache_archive(device); ret != 0)
+    {
+        return ret;
+    }
+    if (ret = tests::dependency_graph_perf(device); ret != 0)
+    {
+        return ret;
+    }
+    if (ret = tests::background_hot_reload(device); ret != 0)
+    {
+        return ret;
+    }
+    if (ret = tests::bind_filtering_perf(device); ret != 0)
+    {
+        return ret;
+    }
+    if (ret = tests::push_constant_shadowing(device); ret != 0)
+    {
+        return ret;
+    }
+    if (ret = tests::dispatch_indirect_batch(device); ret != 0)
+    {
+        return ret;
+    }
     if (ret = tests::multi_thread(device); ret != 0)
     {
         return ret;
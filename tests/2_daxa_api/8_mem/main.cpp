@@ -3,11 +3,345 @@ using namespace daxa::types;
 
 #include <daxa/utils/mem.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <optional>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
 
 static inline constexpr usize ITERATION_COUNT = {1000};
 static inline constexpr usize ELEMENT_COUNT = {17};
 
+static inline constexpr usize THREAD_COUNT = {16};
+static inline constexpr usize FRAME_COUNT = {64};
+static inline constexpr usize ALLOCATIONS_PER_THREAD_PER_FRAME = {1024};
+
+struct SmallUpload
+{
+    u64 thread_index = {};
+    u64 frame_index = {};
+    u64 allocation_index = {};
+    u64 padding[5] = {};
+};
+
+// Many threads make many small allocations each frame.
+// Compares the lock free ConcurrentTransferMemoryPool against a TransferMemoryPool guarded by a mutex.
+static void concurrent_allocation_benchmark(daxa::Device & device)
+{
+    std::atomic_uint64_t error_count = {};
+    auto run_frames = [&](auto && allocate, auto && end_frame) -> f64
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (u64 frame = 0; frame < FRAME_COUNT; ++frame)
+        {
+            std::vector<std::thread> threads = {};
+            for (u64 thread_index = 0; thread_index < THREAD_COUNT; ++thread_index)
+            {
+                threads.push_back(std::thread{[&, thread_index]()
+                {
+                    std::vector<std::pair<SmallUpload *, SmallUpload>> written = {};
+                    written.reserve(ALLOCATIONS_PER_THREAD_PER_FRAME);
+                    for (u64 i = 0; i < ALLOCATIONS_PER_THREAD_PER_FRAME; ++i)
+                    {
+                        SmallUpload const value = {.thread_index = thread_index, .frame_index = frame, .allocation_index = i};
+                        auto * host_address = allocate(value);
+                        if (host_address == nullptr)
+                        {
+                            error_count += 1;
+                            continue;
+                        }
+                        written.push_back({host_address, value});
+                    }
+                    // Overlapping allocations would have overwritten some of the values.
+                    for (auto const & [host_address, value] : written)
+                    {
+                        if (host_address->thread_index != value.thread_index ||
+                            host_address->frame_index != value.frame_index ||
+                            host_address->allocation_index != value.allocation_index)
+                        {
+                            error_count += 1;
+                        }
+                    }
+                }});
+            }
+            for (auto & thread : threads)
+            {
+                thread.join();
+            }
+            end_frame();
+        }
+        device.wait_idle();
+        return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    u64 const frame_size = THREAD_COUNT * ALLOCATIONS_PER_THREAD_PER_FRAME * sizeof(SmallUpload);
+
+    f64 concurrent_ms = {};
+    {
+        daxa::ConcurrentTransferMemoryPool pool{daxa::ConcurrentTransferMemoryPoolInfo{
+            .device = device,
+            .capacity = frame_size * 4,
+            .name = "concurrent transfer memory pool",
+        }};
+        concurrent_ms = run_frames(
+            [&](SmallUpload const & value) -> SmallUpload *
+            {
+                auto allocation = pool.allocate_fill(value, 64);
+                return allocation.has_value() ? reinterpret_cast<SmallUpload *>(allocation->host_address) : nullptr;
+            },
+            [&]()
+            {
+                daxa::CommandRecorder cmd = device.create_command_recorder({});
+                device.submit_commands({.command_lists = std::array{cmd.complete_current_commands()}});
+                pool.mark_submitted();
+                device.collect_garbage();
+            });
+    }
+
+    f64 mutex_ms = {};
+    {
+        daxa::TransferMemoryPool pool{daxa::TransferMemoryPoolInfo{
+            .device = device,
+            .capacity = static_cast<u32>(frame_size * 4),
+            .name = "mutex guarded transfer memory pool",
+        }};
+        std::mutex mtx = {};
+        mutex_ms = run_frames(
+            [&](SmallUpload const & value) -> SmallUpload *
+            {
+                std::unique_lock lock{mtx};
+                auto allocation = pool.allocate_fill(value, 64);
+                return allocation.has_value() ? reinterpret_cast<SmallUpload *>(allocation->host_address) : nullptr;
+            },
+            [&]()
+            {
+                daxa::CommandRecorder cmd = device.create_command_recorder({});
+                device.submit_commands({
+                    .command_lists = std::array{cmd.complete_current_commands()},
+                    .signal_timeline_semaphores = std::array{std::pair{pool.timeline_semaphore(), pool.timeline_value()}},
+                });
+                device.collect_garbage();
+            });
+    }
+
+    std::cout << "concurrent allocation benchmark (" << THREAD_COUNT << " threads, " << FRAME_COUNT * THREAD_COUNT * ALLOCATIONS_PER_THREAD_PER_FRAME << " allocations):\n"
+              << "  ConcurrentTransferMemoryPool: " << concurrent_ms << "ms\n"
+              << "  mutex guarded TransferMemoryPool: " << mutex_ms << "ms\n";
+    if (error_count != 0)
+    {
+        std::cout << "error: " << error_count << " allocations failed or overlapped\n";
+        std::exit(-1);
+    }
+}
+
+// Throughput of the UploadQueue for many small uploads from several threads and few large uploads.
+static void upload_queue_benchmark(daxa::Device & device)
+{
+    static constexpr u64 SMALL_UPLOAD_SIZE = 256;
+    static constexpr u64 SMALL_UPLOAD_COUNT = 1 << 15;
+    static constexpr u64 LARGE_UPLOAD_SIZE = 1 << 22;
+    static constexpr u64 LARGE_UPLOAD_COUNT = 8;
+    static constexpr u64 UPLOAD_THREAD_COUNT = 8;
+
+    daxa::UploadQueue upload_queue{daxa::UploadQueueInfo{
+        .device = device,
+        .name = "upload queue",
+    }};
+    daxa::BufferId dst_buffer = device.create_buffer({
+        .size = std::max(SMALL_UPLOAD_SIZE * SMALL_UPLOAD_COUNT, LARGE_UPLOAD_SIZE * LARGE_UPLOAD_COUNT),
+        .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+        .name = "upload destination",
+    });
+
+    u64 errors = {};
+    auto run = [&](u64 upload_size, u64 upload_count, u64 thread_count) -> f64
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads = {};
+        for (u64 thread_index = 0; thread_index < thread_count; ++thread_index)
+        {
+            threads.push_back(std::thread{[&, thread_index]()
+            {
+                std::vector<u32> data(upload_size / sizeof(u32));
+                for (u64 upload_index = thread_index; upload_index < upload_count; upload_index += thread_count)
+                {
+                    std::fill(data.begin(), data.end(), static_cast<u32>(upload_index));
+                    upload_queue.upload(daxa::BufferUploadInfo{
+                        .dst_buffer = dst_buffer,
+                        .dst_offset = upload_index * upload_size,
+                        .data = std::as_bytes(std::span{data}),
+                    });
+                }
+            }});
+        }
+        for (auto & thread : threads)
+        {
+            thread.join();
+        }
+        upload_queue.wait(upload_queue.flush());
+        return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    u32 const * elements = device.buffer_host_address_as<u32>(dst_buffer).value();
+    auto validate = [&](u64 upload_size, u64 upload_count)
+    {
+        for (u64 upload_index = 0; upload_index < upload_count; ++upload_index)
+        {
+            errors += elements[(upload_index + 1) * upload_size / sizeof(u32) - 1] != upload_index ? 1 : 0;
+        }
+    };
+    f64 const small_ms = run(SMALL_UPLOAD_SIZE, SMALL_UPLOAD_COUNT, UPLOAD_THREAD_COUNT);
+    validate(SMALL_UPLOAD_SIZE, SMALL_UPLOAD_COUNT);
+    f64 const large_ms = run(LARGE_UPLOAD_SIZE, LARGE_UPLOAD_COUNT, 1);
+    validate(LARGE_UPLOAD_SIZE, LARGE_UPLOAD_COUNT);
+
+    auto megabytes_per_second = [](u64 bytes, f64 ms)
+    { return static_cast<f64>(bytes) / (1024.0 * 1024.0) / (ms / 1000.0); };
+    std::cout << "upload queue benchmark:\n"
+              << "  " << SMALL_UPLOAD_COUNT << " x " << SMALL_UPLOAD_SIZE << "b from " << UPLOAD_THREAD_COUNT << " threads: " << small_ms << "ms, "
+              << megabytes_per_second(SMALL_UPLOAD_SIZE * SMALL_UPLOAD_COUNT, small_ms) << "mb/s\n"
+              << "  " << LARGE_UPLOAD_COUNT << " x " << LARGE_UPLOAD_SIZE << "b: " << large_ms << "ms, "
+              << megabytes_per_second(LARGE_UPLOAD_SIZE * LARGE_UPLOAD_COUNT, large_ms) << "mb/s\n";
+
+    // Uploads that can never fit into the staging memory must fail instead of retrying forever.
+    bool oversized_upload_failed = false;
+    try
+    {
+        std::vector<std::byte> const oversized_data(upload_queue.info().staging_capacity);
+        upload_queue.upload(daxa::BufferUploadInfo{
+            .dst_buffer = dst_buffer,
+            .data = std::span{oversized_data},
+        });
+    }
+    catch (std::runtime_error const &)
+    {
+        oversized_upload_failed = true;
+    }
+    device.destroy_buffer(dst_buffer);
+    if (errors != 0)
+    {
+        std::cout << "error: " << errors << " uploads did not arrive\n";
+        std::exit(-1);
+    }
+    if (!oversized_upload_failed)
+    {
+        std::cout << "error: upload larger than the staging memory did not fail\n";
+        std::exit(-1);
+    }
+}
+
+// Latency of small readbacks polled every frame and throughput of large readbacks.
+static void readback_pool_test(daxa::Device & device)
+{
+    static constexpr u64 LATENCY_ITERATIONS = 256;
+    static constexpr u64 THROUGHPUT_CHUNK_SIZE = 1 << 22;
+    static constexpr u64 THROUGHPUT_CHUNK_COUNT = 16;
+
+    daxa::ReadbackPool readback_pool{daxa::ReadbackPoolInfo{
+        .device = device,
+        .capacity = THROUGHPUT_CHUNK_SIZE * 4,
+        .name = "readback pool",
+    }};
+    daxa::BufferId gpu_buffer = device.create_buffer({
+        .size = THROUGHPUT_CHUNK_SIZE,
+        .name = "readback source",
+    });
+    u64 errors = {};
+
+    f64 total_latency_ms = {};
+    for (u32 iteration = 0; iteration < LATENCY_ITERATIONS; ++iteration)
+    {
+        daxa::CommandRecorder cmd = device.create_command_recorder({});
+        cmd.clear_buffer({.buffer = gpu_buffer, .offset = 0, .size = sizeof(u32), .clear_value = iteration});
+        cmd.pipeline_barrier({.src_access = daxa::AccessConsts::TRANSFER_WRITE, .dst_access = daxa::AccessConsts::TRANSFER_READ});
+        daxa::ReadbackToken token = readback_pool.record_readback(cmd, daxa::BufferReadbackInfo{.src_buffer = gpu_buffer, .size = sizeof(u32)}).value();
+        device.submit_commands({
+            .command_lists = std::array{cmd.complete_current_commands()},
+            .signal_timeline_semaphores = std::array{std::pair{readback_pool.timeline_semaphore(), readback_pool.timeline_value()}},
+        });
+        auto start = std::chrono::steady_clock::now();
+        // Poll like a frame loop would, instead of blocking.
+        std::optional<u32> value = {};
+        while (!value.has_value())
+        {
+            value = readback_pool.try_read<u32>(token);
+        }
+        total_latency_ms += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+        errors += value.value() != iteration ? 1 : 0;
+        device.collect_garbage();
+    }
+
+    auto throughput_start = std::chrono::steady_clock::now();
+    std::vector<daxa::ReadbackToken> tokens = {};
+    for (u32 chunk = 0; chunk < THROUGHPUT_CHUNK_COUNT; ++chunk)
+    {
+        // Waits for the oldest readbacks to keep at most three in flight.
+        if (tokens.size() >= 3)
+        {
+            readback_pool.wait(tokens.front());
+            errors += *reinterpret_cast<u32 const *>(readback_pool.data(tokens.front()).value().data()) != chunk - 3 ? 1 : 0;
+            readback_pool.release(tokens.front());
+            tokens.erase(tokens.begin());
+        }
+        daxa::CommandRecorder cmd = device.create_command_recorder({});
+        cmd.clear_buffer({.buffer = gpu_buffer, .offset = 0, .size = THROUGHPUT_CHUNK_SIZE, .clear_value = chunk});
+        cmd.pipeline_barrier({.src_access = daxa::AccessConsts::TRANSFER_WRITE, .dst_access = daxa::AccessConsts::TRANSFER_READ});
+        tokens.push_back(readback_pool.record_readback(cmd, daxa::BufferReadbackInfo{.src_buffer = gpu_buffer, .size = THROUGHPUT_CHUNK_SIZE}).value());
+        device.submit_commands({
+            .command_lists = std::array{cmd.complete_current_commands()},
+            .signal_timeline_semaphores = std::array{std::pair{readback_pool.timeline_semaphore(), readback_pool.timeline_value()}},
+        });
+        device.collect_garbage();
+    }
+    for (auto const & token : tokens)
+    {
+        readback_pool.wait(token);
+        readback_pool.release(token);
+    }
+    f64 const throughput_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - throughput_start).count();
+
+    // A token that is never released must not block later readbacks.
+    u64 failed_readbacks = {};
+    {
+        daxa::CommandRecorder cmd = device.create_command_recorder({});
+        daxa::ReadbackToken held_token = readback_pool.record_readback(cmd, daxa::BufferReadbackInfo{.src_buffer = gpu_buffer, .size = sizeof(u32)}).value();
+        for (u32 chunk = 0; chunk < 8; ++chunk)
+        {
+            auto token = readback_pool.record_readback(cmd, daxa::BufferReadbackInfo{.src_buffer = gpu_buffer, .size = THROUGHPUT_CHUNK_SIZE});
+            failed_readbacks += token.has_value() ? 0 : 1;
+            device.submit_commands({
+                .command_lists = std::array{cmd.complete_current_commands()},
+                .signal_timeline_semaphores = std::array{std::pair{readback_pool.timeline_semaphore(), readback_pool.timeline_value()}},
+            });
+            if (token.has_value())
+            {
+                readback_pool.wait(token.value());
+                readback_pool.release(token.value());
+            }
+        }
+        readback_pool.release(held_token);
+    }
+
+    std::cout << "readback pool:\n"
+              << "  average latency of " << LATENCY_ITERATIONS << " small readbacks: " << total_latency_ms / LATENCY_ITERATIONS << "ms\n"
+              << "  throughput of " << THROUGHPUT_CHUNK_COUNT << " x " << THROUGHPUT_CHUNK_SIZE << "b: "
+              << static_cast<f64>(THROUGHPUT_CHUNK_COUNT * THROUGHPUT_CHUNK_SIZE) / (1024.0 * 1024.0) / (throughput_ms / 1000.0) << "mb/s\n";
+    device.wait_idle();
+    device.destroy_buffer(gpu_buffer);
+    if (errors != 0)
+    {
+        std::cout << "error: " << errors << " readbacks returned wrong values\n";
+        std::exit(-1);
+    }
+    if (failed_readbacks != 0)
+    {
+        std::cout << "error: " << failed_readbacks << " readbacks failed while an older token was held\n";
+        std::exit(-1);
+    }
+}
+
 auto main() -> int
 {
     daxa::Instance daxa_ctx = daxa::create_instance({});
@@ -91,5 +425,9 @@ auto main() -> int
     }
     device.destroy_buffer(result_buffer);
     device.collect_garbage();
+
+    concurrent_allocation_benchmark(device);
+    upload_queue_benchmark(device);
+    readback_pool_test(device);
     std::cout << std::flush;
 }
@@ -75,6 +75,9 @@ struct App : BaseApp<App>
     daxa::TaskBlas task_blas{{.initial_blas = {.blas = std::array{blas}}, .name = "blas_task"}};
     daxa::TaskTlas task_tlas{{.initial_tlas = {.tlas = std::array{tlas}}, .name = "tlas_task"}};
     const daxa_u32 ACCELERATION_STRUCTURE_BUILD_OFFSET_ALIGMENT = 256; // NOTE: Requested by the spec
+    // Refitting moving particles degrades the trace performance of the acceleration structures, a full rebuild restores it.
+    const daxa_u32 ACCELERATION_STRUCTURE_REBUILD_INTERVAL = 60;
+    daxa_u32 acceleration_structure_frame = 0;
     void update_virtual_shader()
     {
         if (my_toggle)
@@ -915,14 +918,20 @@ struct App : BaseApp<App>
 
     void build_accel_structs() {  
 
+        // The particle count never changes, so the acceleration structures are created once and refit in place afterwards.
+        bool const rebuild = (acceleration_structure_frame % ACCELERATION_STRUCTURE_REBUILD_INTERVAL) == 0;
+        acceleration_structure_frame += 1;
+        if (!blas.is_empty())
+        {
+            blas_build_info.update = !rebuild;
+            tlas_build_info.update = !rebuild;
+            return;
+        }
+
         // BUILDING BLAS
 
-        if(!blas.is_empty()) {
-            device.destroy_blas(blas);
-            // ti.device.destroy_buffer(blas_buffer);
-        }
         blas_build_info = daxa::BlasBuildInfo{
-            .flags = daxa::AccelerationStructureBuildFlagBits::PREFER_FAST_BUILD, // Is also default
+            .flags = daxa::AccelerationStructureBuildFlagBits::PREFER_FAST_BUILD | daxa::AccelerationStructureBuildFlagBits::ALLOW_UPDATE,
             .dst_blas = {},                                                       // Ignored in get_acceleration_structure_build_sizes.       // Is also default
             .geometries = geometry,
             .scratch_data = {}, // Ignored in get_acceleration_structure_build_sizes.   // Is also default
@@ -941,11 +950,6 @@ struct App : BaseApp<App>
 
         // BUILDIING TLAS
 
-        if (!tlas.is_empty())
-        {
-            device.destroy_tlas(tlas);
-        }
-
         // define blas instances
         auto blas_instance_array = std::array{
             daxa_BlasInstanceData{
@@ -968,7 +972,7 @@ struct App : BaseApp<App>
 
         // build tlas info
         tlas_build_info = daxa::TlasBuildInfo{
-            .flags = daxa::AccelerationStructureBuildFlagBits::PREFER_FAST_BUILD,
+            .flags = daxa::AccelerationStructureBuildFlagBits::PREFER_FAST_BUILD | daxa::AccelerationStructureBuildFlagBits::ALLOW_UPDATE,
             .dst_tlas = {}, // Ignored in get_acceleration_structure_build_sizes.
             .instances = blas_instances,
             .scratch_data = {}, // Ignored in get_acceleration_structure_build_sizes.
@@ -991,12 +995,12 @@ struct App : BaseApp<App>
         new_task_graph.add_task({
             .attachments = {
                 daxa::inl_attachment(daxa::TaskBufferAccess::TRANSFER_READ, task_aabb_buffer),
-                daxa::inl_attachment(daxa::TaskBlasAccess::BUILD_WRITE, task_blas),
+                daxa::inl_attachment(daxa::TaskBlasAccess::BUILD_UPDATE, task_blas),
             },
             .task = [this](daxa::TaskInterface const &ti) {
                 // create scratch buffer
                 auto blas_scratch_buffer = device.create_buffer({
-                    .size = blas_build_sizes.build_scratch_size,
+                    .size = blas_build_info.update ? blas_build_sizes.update_scratch_size : blas_build_sizes.build_scratch_size,
                     .name = "blas build scratch buffer",
                 });
                 // add to deferred destruction
@@ -1013,12 +1017,12 @@ struct App : BaseApp<App>
         new_task_graph.add_task({
             .attachments = {
                 daxa::inl_attachment(daxa::TaskBlasAccess::BUILD_READ, task_blas),
-                daxa::inl_attachment(daxa::TaskTlasAccess::BUILD_WRITE, task_tlas),
+                daxa::inl_attachment(daxa::TaskTlasAccess::BUILD_UPDATE, task_tlas),
             },
             .task = [this](daxa::TaskInterface const &ti) {
                 // create scratch buffer
                 auto tlas_scratch_buffer = device.create_buffer({
-                    .size = tlas_build_sizes.build_scratch_size,
+                    .size = tlas_build_info.update ? tlas_build_sizes.update_scratch_size : tlas_build_sizes.build_scratch_size,
                     .name = "tlas build scratch buffer",
                 });
                 // add to deferred destruction